@@ -93,6 +93,7 @@ static const emitter_t IREmitters[] = {
     {IR_INSTR_NOT,      emit_not         },
     {IR_INSTR_PUSH_XMM, emit_stack_xmm   },
     {IR_INSTR_POP_XMM,  emit_stack_xmm   },
+    {IR_INSTR_JMP_FUNC, emit_call,       .op = 0xE9},
 };
 
 //===========================================================================//
@@ -14,8 +14,11 @@
 #include "nodes_dsl.h"
 #include "custom_assert.h"
 #include "buffer.h"
+#include "output.h"
 #include "encoder.h"
 #include "optimize_ir.h"
+#include "mapped_file.h"
+#include "build_cache.h"
 
 //===========================================================================//
 
@@ -25,7 +28,6 @@ static const size_t ElfHeadersSize        = sizeof(Elf64_Ehdr) +
                                             2 * sizeof(Elf64_Phdr);
 static const size_t BaseLoadingAddress    = 0x400000;
 static const size_t SectionsAlignment     = 0x1000;
-static const size_t MaxDoubleLength       = 64;
 static const size_t MaxSystemCommandSize  = 256;
 
 //===========================================================================//
@@ -63,11 +65,22 @@ static language_error_t global_vars_write_bin      (language_t    *ctx);
 language_error_t backend_ctor(language_t *ctx, int argc, const char *argv[]) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(backend_ir_ctor(ctx, IRDefaultCapacity));
-    _RETURN_IF_ERROR(fixups_ctor(ctx, FixupsDefaultCapacity));
     _RETURN_IF_ERROR(parse_flags(ctx, argc, argv));
-    _RETURN_IF_ERROR(read_tree(ctx));
+    _RETURN_IF_ERROR(build_cache_lookup(ctx));
+    _RETURN_IF_ERROR(read_tree_reachable(ctx));
     _RETURN_IF_ERROR(dump_ctor(ctx, "backend"));
+    _RETURN_IF_ERROR(backend_state_ctor(ctx));
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t backend_state_ctor(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(backend_ir_ctor(ctx, IRDefaultCapacity));
+    _RETURN_IF_ERROR(fixups_ctor(ctx, FixupsDefaultCapacity));
     //-----------------------------------------------------------------------//
     ctx->backend_info.output = fopen(ctx->output_file, "wb");
     if(ctx->backend_info.output == NULL) {
@@ -91,7 +104,7 @@ language_error_t compile_elf(language_t *ctx) {
                                         &main_index));
     //-----------------------------------------------------------------------//
     // Program start, calling main end exit is here
-    ir_add_node(ctx, IR_INSTR_CALL, _CUSTOM(main_index), (ir_arg_t){});
+    _RETURN_IF_ERROR(x86_compile_main_call(ctx, main_index));
     ir_add_node(ctx, IR_INSTR_MOV, _REG(REGISTER_RDI), _REG(REGISTER_RAX));
     ir_add_node(ctx, IR_INSTR_MOV, _REG(REGISTER_RAX), _IMM(0x3C));
     ir_add_node(ctx, IR_INSTR_SYSCALL, (ir_arg_t){}, (ir_arg_t){});
@@ -105,13 +118,12 @@ language_error_t compile_elf(language_t *ctx) {
     _RETURN_IF_ERROR(write_stdlib(ctx));
     //-----------------------------------------------------------------------//
     // Saving .text size and alignment, adding alignment bytes
-    size_t text_size = ctx->backend_info.buffer_size - ElfHeadersSize;
+    size_t text_size = ctx->backend_info.buffer.size - ElfHeadersSize;
     size_t alignment = (SectionsAlignment -
                         text_size % SectionsAlignment) % SectionsAlignment;
     // Adding alignment to text section
     text_size += alignment;
-    _RETURN_IF_ERROR(buffer_check_size(ctx, alignment));
-    ctx->backend_info.buffer_size += alignment;
+    _RETURN_IF_ERROR(output_fill(&ctx->backend_info.buffer, 0, alignment));
     //-----------------------------------------------------------------------//
     // Adding global variables addresses and adding their init in .data
     _RETURN_IF_ERROR(global_vars_init(ctx));
@@ -136,22 +148,23 @@ language_error_t compile_elf(language_t *ctx) {
 language_error_t compile_spu(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(variables_stack_ctor(ctx, ctx->nodes.capacity));
+    _RETURN_IF_ERROR(variables_stack_ctor(ctx, VariablesStackCapacity));
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(compile_only(ctx, OPERATION_NEW_VAR));
     //-----------------------------------------------------------------------//
-    fprintf(ctx->backend_info.output,
-            ";setting bx value to global variables number\r\n"
-            "\tpush " SZ_SP "\r\n"
-            "\tpop bx\r\n\r\n"
-            ";calling main\r\n"
-            "\tcall main:\r\n"
-            "\tpush ax\r\n"
-            "\tout\r\n"
-            "\thlt\r\n\r\n",
-            ctx->backend_info.used_globals);
+    _RETURN_IF_ERROR(output_format(&ctx->backend_info.buffer,
+                                   ";setting bx value to global variables number\r\n"
+                                   "\tpush " SZ_SP "\r\n"
+                                   "\tpop bx\r\n\r\n"
+                                   ";calling main\r\n"
+                                   "\tcall main:\r\n"
+                                   "\tpush ax\r\n"
+                                   "\tout\r\n"
+                                   "\thlt\r\n\r\n",
+                                   ctx->backend_info.used_globals));
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(compile_only(ctx, OPERATION_NEW_FUNC));
+    _RETURN_IF_ERROR(buffer_reset(ctx));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -169,7 +182,7 @@ language_error_t compile_nasm(language_t *ctx) {
                                         &main_index));
     //-----------------------------------------------------------------------//
     // Program start, calling main end exit is here
-    ir_add_node(ctx, IR_INSTR_CALL, _CUSTOM(main_index), (ir_arg_t){});
+    _RETURN_IF_ERROR(x86_compile_main_call(ctx, main_index));
     ir_add_node(ctx, IR_INSTR_MOV, _REG(REGISTER_RDI), _REG(REGISTER_RAX));
     ir_add_node(ctx, IR_INSTR_MOV, _REG(REGISTER_RAX), _IMM(0x3C));
     ir_add_node(ctx, IR_INSTR_SYSCALL, (ir_arg_t){}, (ir_arg_t){});
@@ -210,10 +223,10 @@ language_error_t compile_nasm(language_t *ctx) {
 language_error_t compile_only(language_t *ctx, operation_t opcode) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    language_node_t *node = ctx->root;
+    language_node_t *node = nodes_storage_get(ctx, ctx->root);
     ctx->backend_info.used_locals = 0;
     while(node != NULL) {
-        if(is_node_oper_eq(node->left, opcode)) {
+        if(is_node_oper_eq(node_left(ctx, node), opcode)) {
             switch(ctx->machine_flag) {
                 case MACHINE_SPU: {
                     _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left));
@@ -230,72 +243,90 @@ language_error_t compile_only(language_t *ctx, operation_t opcode) {
                 }
             }
         }
-        node = node->right;
+        node = node_right(ctx, node);
     }
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
+language_error_t compile_program(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    switch(ctx->machine_flag) {
+        case MACHINE_SPU: {
+            return compile_spu(ctx);
+        }
+        case MACHINE_ELF_X86: {
+            return compile_elf(ctx);
+        }
+        case MACHINE_ASM_X86: {
+            return compile_nasm(ctx);
+        }
+        default: {
+            print_error("Unexpected machine flag.");
+            return LANGUAGE_UNEXPECTED_MACHINE;
+        }
+    }
+}
+
+//===========================================================================//
+
 language_error_t backend_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    free(ctx->input);
-    fclose(ctx->backend_info.output);
-    ctx->backend_info.output = NULL;
-    ctx->input = NULL;
-    _RETURN_IF_ERROR(backend_ir_dtor(ctx));
+    _RETURN_IF_ERROR(input_close(ctx));
+    _RETURN_IF_ERROR(backend_state_dtor(ctx));
     _RETURN_IF_ERROR(name_table_dtor(ctx));
     _RETURN_IF_ERROR(nodes_storage_dtor(ctx));
     _RETURN_IF_ERROR(dump_dtor(ctx));
-    _RETURN_IF_ERROR(fixups_dtor(ctx));
-    free(ctx->backend_info.buffer);
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t write_stdlib(language_t *ctx) {
+language_error_t backend_state_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    FILE *stdlib_file = fopen(StdLibFilename, "rb");
-    if(stdlib_file == NULL) {
-        print_error("Error while opening stdlib file to read.");
-        return LANGUAGE_OPENING_FILE_ERROR;
+    if(ctx->backend_info.output != NULL) {
+        fclose(ctx->backend_info.output);
+        ctx->backend_info.output = NULL;
     }
+    _RETURN_IF_ERROR(backend_ir_dtor(ctx));
+    _RETURN_IF_ERROR(fixups_dtor(ctx));
+    _RETURN_IF_ERROR(output_dtor(&ctx->backend_info.buffer));
     //-----------------------------------------------------------------------//
-    size_t size = file_size(stdlib_file);
-    language_error_t error_code = buffer_check_size(ctx, size);
-    if(error_code != LANGUAGE_SUCCESS) {
-        fclose(stdlib_file);
-        return error_code;
-    }
-    uint8_t *read_dst = ctx->backend_info.buffer + ctx->backend_info.buffer_size;
-    if(fread(read_dst, sizeof(uint8_t), size, stdlib_file) != size) {
-        fclose(stdlib_file);
-        print_error("Error while reading stdlib file to buffer.");
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t write_stdlib(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    mapped_file_t stdlib_file = {};
+    _RETURN_IF_ERROR(mapped_file_open(&stdlib_file, StdLibFilename));
+    if(stdlib_file.size < 2 * sizeof(uint32_t)) {
+        mapped_file_close(&stdlib_file);
+        print_error("Stdlib file is too small to contain functions table.");
         return LANGUAGE_READING_STDLIB_ERROR;
     }
     //-----------------------------------------------------------------------//
-    size_t funcs_size = ctx->backend_info.buffer_size;
-    ctx->backend_info.buffer_size += size;
+    size_t funcs_size = ctx->backend_info.buffer.size;
+    language_error_t error_code = buffer_write(ctx,
+                                               (const uint8_t *)stdlib_file.data,
+                                               stdlib_file.size);
+    mapped_file_close(&stdlib_file);
+    _RETURN_IF_ERROR(error_code);
     //-----------------------------------------------------------------------//
-    uint32_t *addresses = (uint32_t *)(ctx->backend_info.buffer +
+    uint32_t *addresses = (uint32_t *)(ctx->backend_info.buffer.data +
                                        funcs_size);
     size_t std_in_rip  = addresses[0] + funcs_size - ElfHeadersSize;
     size_t std_out_rip = addresses[1] + funcs_size - ElfHeadersSize;
 
-    size_t std_in_index = 0;
-    size_t std_out_index = 0;
-    _RETURN_IF_ERROR(find_func_id_index(ctx,
-                                        StdInName,
-                                        StdInLen,
-                                        &std_in_index ));
-    _RETURN_IF_ERROR(find_func_id_index(ctx,
-                                        StdOutName,
-                                        StdOutLen,
-                                        &std_out_index));
+    size_t std_in_index  = ctx->backend_info.std_in_index;
+    size_t std_out_index = ctx->backend_info.std_out_index;
     identifier_t *std_in_ident  = ctx->name_table.identifiers + std_in_index;
     identifier_t *std_out_ident = ctx->name_table.identifiers + std_out_index;
     std_in_ident->memory_addr  = (long)std_in_rip;
@@ -312,12 +343,12 @@ language_error_t add_stdlib_id(language_t *ctx) {
     _RETURN_IF_ERROR(name_table_add(ctx,
                                     StdInName,
                                     StdInLen,
-                                    NULL,
+                                    &ctx->backend_info.std_in_index,
                                     IDENTIFIER_FUNCTION));
     _RETURN_IF_ERROR(name_table_add(ctx,
                                     StdOutName,
                                     StdOutLen,
-                                    NULL,
+                                    &ctx->backend_info.std_out_index,
                                     IDENTIFIER_FUNCTION));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -484,18 +515,11 @@ language_error_t find_func_id_index(language_t *ctx,
     _C_ASSERT(name   != NULL, return LANGUAGE_INPUT_NULL );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
-    size_t func_id_index = ctx->name_table.size;
-    for(size_t i = 0; i < ctx->name_table.size; i++) {
-        identifier_t *ident = ctx->name_table.identifiers + i;
-        if(ident->type == IDENTIFIER_FUNCTION &&
-           ident->length == len &&
-           ident->name != NULL &&
-           strncmp(ident->name, name, len) == 0) {
-            func_id_index = i;
-            break;
-        }
-    }
-    if(func_id_index == ctx->name_table.size) {
+    size_t symbol        = 0;
+    size_t func_id_index = PoisonIndex;
+    _RETURN_IF_ERROR(used_names_add(ctx, name, len, &symbol));
+    _RETURN_IF_ERROR(name_table_find_function(ctx, symbol, &func_id_index));
+    if(func_id_index == PoisonIndex) {
         print_error("There is no standard function '%.*s' in name table.",
                     len,
                     name);
@@ -511,28 +535,28 @@ language_error_t find_func_id_index(language_t *ctx,
 language_error_t global_vars_init(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    language_node_t *node = ctx->root;
+    language_node_t *node = nodes_storage_get(ctx, ctx->root);
     while(node != NULL) {
-        if(is_node_oper_eq(node->left, OPERATION_NEW_VAR)) {
+        if(is_node_oper_eq(node_left(ctx, node), OPERATION_NEW_VAR)) {
             ctx->backend_info.used_globals++;
             language_node_t *var = NULL;
-            if(is_node_oper_eq(node->left->left, OPERATION_ASSIGNMENT)) {
-                var = node->left->left->left;
+            if(is_node_oper_eq(node_left(ctx, node_left(ctx, node)), OPERATION_ASSIGNMENT)) {
+                var = node_left(ctx, node_left(ctx, node_left(ctx, node)));
             }
             else {
-                var = node->left->left;
+                var = node_left(ctx, node_left(ctx, node));
             }
             identifier_t *ident = ctx->name_table.identifiers +
-                                  var->value.identifier;
+                                  node_identifier(var);
 
-            if(is_node_oper_eq(node->left->left, OPERATION_ASSIGNMENT)) {
-                ident->init_value = node->left->left->right->value.number;
+            if(is_node_oper_eq(node_left(ctx, node_left(ctx, node)), OPERATION_ASSIGNMENT)) {
+                ident->init_value = node_number(node_right(ctx, node_left(ctx, node_left(ctx, node))));
             }
             else {
                 ident->init_value = 0;
             }
         }
-        node = node->right;
+        node = node_right(ctx, node);
     }
     //-----------------------------------------------------------------------//
     // Adding initialize values of global variables in .data segment
@@ -555,7 +579,7 @@ language_error_t fixup_headers_sizes(language_t *ctx,
                                      size_t      data_size) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    Elf64_Phdr *text_phdr_ptr = (Elf64_Phdr *)(ctx->backend_info.buffer +
+    Elf64_Phdr *text_phdr_ptr = (Elf64_Phdr *)(ctx->backend_info.buffer.data +
                                                sizeof(Elf64_Ehdr));
     Elf64_Phdr *data_phdr_ptr = text_phdr_ptr + 1;
 
@@ -577,7 +601,7 @@ language_error_t fixup_headers_sizes(language_t *ctx,
 long current_rip(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    return (long)(ctx->backend_info.buffer_size - ElfHeadersSize);
+    return (long)(ctx->backend_info.buffer.size - ElfHeadersSize);
 }
 
 //===========================================================================//
@@ -586,24 +610,11 @@ language_error_t global_vars_write_text(language_t *ctx) {
     for(size_t i = 0; i < ctx->name_table.size; i++) {
         identifier_t *ident = ctx->name_table.identifiers + i;
         if(ident->is_global) {
-            _RETURN_IF_ERROR(buffer_write_string(ctx,
-                                                 ident->name,
-                                                 ident->length));
-            _RETURN_IF_ERROR(buffer_write_byte(ctx, ' '));
-            _RETURN_IF_ERROR(buffer_write_byte(ctx, 'd'));
-            _RETURN_IF_ERROR(buffer_write_byte(ctx, 'q'));
-            _RETURN_IF_ERROR(buffer_write_byte(ctx, ' '));
-
-            _RETURN_IF_ERROR(buffer_check_size(ctx, MaxDoubleLength));
-            uint8_t *buffer = ctx->backend_info.buffer +
-                              ctx->backend_info.buffer_size;
-            int printed_symbols = snprintf((char *)buffer,
-                                           MaxDoubleLength,
-                                           "%.1f",
-                                           ident->init_value);
-            ctx->backend_info.buffer_size += (size_t)printed_symbols;
-
-            _RETURN_IF_ERROR(buffer_write_byte(ctx, '\n'));
+            output_t *buffer = &ctx->backend_info.buffer;
+            _RETURN_IF_ERROR(output_string(buffer, ident->name, ident->length));
+            _RETURN_IF_ERROR(output_string(buffer, " dq ", 4));
+            _RETURN_IF_ERROR(output_double_fixed(buffer, ident->init_value));
+            _RETURN_IF_ERROR(output_char(buffer, '\n'));
         }
     }
     return LANGUAGE_SUCCESS;
@@ -6,12 +6,12 @@
 #include "custom_assert.h"
 #include "colors.h"
 #include "buffer.h"
+#include "output.h"
 
 //===========================================================================//
 
 static const size_t MaxInfoSz    = 5 * 5;
-static const size_t MaxImmSize   = 64 / 4 + 2;
-static const int    LabelNumSize = 8;
+static const size_t LabelNumSize = 8;
 
 //===========================================================================//
 
@@ -161,6 +161,14 @@ static const instr_info_t CallAsmInfo = {
 
 //---------------------------------------------------------------------------//
 
+static const instr_info_t JmpFuncAsmInfo = {
+    .supported_args = {_ARGS(ARG_TYPE_CST, ARG_TYPE_INVALID, "jmp")},
+    .supported_size = 1,
+    .special = NULL,
+};
+
+//---------------------------------------------------------------------------//
+
 static const instr_info_t CmplAsmInfo = {
     .supported_args = {_ARGS(ARG_TYPE_XMM, ARG_TYPE_XMM, "cmpltsd")},
     .supported_size = 1,
@@ -296,7 +304,8 @@ static const all_instr_info_t AsmInfos[] = {
     {IR_INSTR_SQRT,          &SqrtAsmInfo},
     {IR_INSTR_NOT,            &NotAsmInfo},
     {IR_INSTR_PUSH_XMM,   &PushXmmAsmInfo},
-    {IR_INSTR_POP_XMM,     &PopXmmAsmInfo}
+    {IR_INSTR_POP_XMM,     &PopXmmAsmInfo},
+    {IR_INSTR_JMP_FUNC,   &JmpFuncAsmInfo}
 };
 
 //===========================================================================//
@@ -390,11 +399,8 @@ language_error_t write_asm_imm(language_t *ctx, ir_arg_t *arg) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL );
     _C_ASSERT(arg != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(buffer_check_size(ctx, MaxImmSize));
-    uint8_t *buffer = ctx->backend_info.buffer + ctx->backend_info.buffer_size;
-
-    int size = sprintf((char *)buffer, "0x%lx", (uint64_t)arg->imm);
-    ctx->backend_info.buffer_size += (size_t)size;
+    _RETURN_IF_ERROR(output_string(&ctx->backend_info.buffer, "0x", 2));
+    _RETURN_IF_ERROR(output_hex(&ctx->backend_info.buffer, (uint64_t)arg->imm));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -434,7 +440,8 @@ language_error_t write_asm_cst(language_t *ctx, ir_node_t *node) {
         _RETURN_IF_ERROR(write_asm_cst_jmp(ctx, node));
     }
     //-----------------------------------------------------------------------//
-    else if(node->instruction == IR_INSTR_CALL ||
+    else if(node->instruction == IR_INSTR_CALL     ||
+            node->instruction == IR_INSTR_JMP_FUNC ||
             node->instruction == IR_CONTROL_FUNC) {
         ir_arg_t *arg = &node->first;
         size_t id_index = (size_t)arg->custom;
@@ -476,13 +483,9 @@ language_error_t write_asm_mem(language_t *ctx, ir_arg_t *arg) {
         }
         _RETURN_IF_ERROR(buffer_write_byte(ctx, ' '));
         //-------------------------------------------------------------------//
-        _RETURN_IF_ERROR(buffer_check_size(ctx, sizeof(uint32_t) / 4 + 2));
-        uint8_t *buffer = ctx->backend_info.buffer +
-                          ctx->backend_info.buffer_size;
-        int printed_symbols = sprintf((char *)buffer,
-                                      "0x%x",
-                                      (uint32_t)arg->mem.offset);
-        ctx->backend_info.buffer_size += (size_t)printed_symbols;
+        _RETURN_IF_ERROR(output_string(&ctx->backend_info.buffer, "0x", 2));
+        _RETURN_IF_ERROR(output_hex(&ctx->backend_info.buffer,
+                                    (uint32_t)arg->mem.offset));
         //-------------------------------------------------------------------//
     }
     //-----------------------------------------------------------------------//
@@ -579,11 +582,10 @@ language_error_t write_asm_cst_jmp(language_t *ctx,
         }
     }
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(buffer_check_size(ctx, LabelNumSize + 5));
-    uint8_t *buffer = ctx->backend_info.buffer +
-                      ctx->backend_info.buffer_size;
-    sprintf((char *)buffer, ".loc_%0*lu", LabelNumSize, label_num);
-    ctx->backend_info.buffer_size += LabelNumSize + 5;
+    _RETURN_IF_ERROR(output_string(&ctx->backend_info.buffer, ".loc_", 5));
+    _RETURN_IF_ERROR(output_unsigned(&ctx->backend_info.buffer,
+                                     label_num,
+                                     LabelNumSize));
     //-----------------------------------------------------------------------//
     if(node->instruction == IR_CONTROL_JMP) {
         _RETURN_IF_ERROR(buffer_write_byte(ctx, ':'));
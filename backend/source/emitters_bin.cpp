@@ -553,15 +553,16 @@ language_error_t emit_mov_mem_xmm(language_t *ctx, ir_node_t *node) {
 language_error_t emit_call   (language_t *ctx, ir_node_t *node) {
     _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
     _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
-    _C_ASSERT(node->instruction == IR_INSTR_CALL,
+    _C_ASSERT(node->instruction == IR_INSTR_CALL ||
+              node->instruction == IR_INSTR_JMP_FUNC,
               return LANGUAGE_UNEXPECTED_IR_INSTR);
     //-----------------------------------------------------------------------//
-    // call func --> 0xE8 offs32
+    // call func --> 0xE8 offs32, jmp func --> 0xE9 offs32
     uint8_t call[MaxInstructionSize] = {};
     size_t pos = 0;
     //-----------------------------------------------------------------------//
     // Opcode
-    call[pos++] = IREmitters[IR_INSTR_CALL].op;
+    call[pos++] = IREmitters[node->instruction].op;
     //-----------------------------------------------------------------------//
     // Call offset
     _RETURN_IF_ERROR(add_fixup(ctx, pos, (size_t)node->first.custom));
@@ -747,7 +748,7 @@ language_error_t emit_fix_jmp(language_t *ctx, ir_node_t *node) {
         // buffer offset to fix address
         ir_node_t *jmp_node    = (ir_node_t *)node->first.custom;
         size_t     jmp_end_rip = (size_t)jmp_node->first.custom;
-        uint8_t   *fix_addr    = ctx->backend_info.buffer + jmp_end_rip - 4 +
+        char      *fix_addr    = ctx->backend_info.buffer.data + jmp_end_rip - 4 +
                                  sizeof(Elf64_Ehdr) + 2 * sizeof(Elf64_Phdr);
         *(uint32_t *)fix_addr = (uint32_t)((size_t)current_rip(ctx) -
                                            jmp_end_rip);
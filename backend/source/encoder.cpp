@@ -92,7 +92,7 @@ language_error_t add_fixup(language_t *ctx, size_t offset, size_t id_index) {
     }
     //-----------------------------------------------------------------------//
     // Saving address to change value, identifier index and instruction end RIP
-    fixups[size].position = ctx->backend_info.buffer_size + offset;
+    fixups[size].position = ctx->backend_info.buffer.size + offset;
     fixups[size].id_index = id_index;
     fixups[size].rip      = (size_t)current_rip(ctx) + offset + 4;
     size++;
@@ -117,7 +117,7 @@ language_error_t run_fixups(language_t *ctx) {
         identifier_t *ident     = ctx->name_table.identifiers +
                                   fixups[i].id_index;
         // Pointer to fix address
-        uint32_t     *value_pos = (uint32_t *)(ctx->backend_info.buffer +
+        uint32_t     *value_pos = (uint32_t *)(ctx->backend_info.buffer.data +
                                                position);
         //-------------------------------------------------------------------//
         uint32_t dest_rip              = (uint32_t)ident->memory_addr;
@@ -6,12 +6,12 @@
 #include "backend.h"
 #include "language.h"
 #include "lang_dump.h"
+#include "build_cache.h"
 #include "colors.h"
 
 //===========================================================================//
 
 static int main_exit_failure(language_t *language);
-static language_error_t run_compilation(language_t *language);
 
 //===========================================================================//
 
@@ -26,15 +26,17 @@ int main(int argc, const char *argv[]) {
     }
     //-----------------------------------------------------------------------//
     language_t language = {};
-    if(backend_ctor(&language, argc, argv) != LANGUAGE_SUCCESS) {
+    language_error_t error_code = backend_ctor(&language, argc, argv);
+    if(error_code == LANGUAGE_BUILD_CACHE_HIT) {
+        backend_dtor(&language);
+        return EXIT_SUCCESS;
+    }
+    if(error_code != LANGUAGE_SUCCESS) {
         return main_exit_failure(&language);
     }
     color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully initialized context\n");
     //-----------------------------------------------------------------------//
-    if(read_tree(&language) != LANGUAGE_SUCCESS) {
-        return main_exit_failure(&language);
-    }
     if(add_stdlib_id(&language) != LANGUAGE_SUCCESS) {
         return main_exit_failure(&language);
     }
@@ -47,11 +49,12 @@ int main(int argc, const char *argv[]) {
     color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully dumped tree\n");
     //-----------------------------------------------------------------------//
-    if(run_compilation(&language) != LANGUAGE_SUCCESS) {
+    if(compile_program(&language) != LANGUAGE_SUCCESS) {
         return main_exit_failure(&language);
     }
     color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully wrote compiled code\n");
+    build_cache_store(&language);
     //-----------------------------------------------------------------------//
     backend_dtor(&language);
     return EXIT_SUCCESS;
@@ -65,23 +68,3 @@ int main_exit_failure(language_t *language) {
 }
 
 //===========================================================================//
-
-language_error_t run_compilation(language_t *language) {
-    switch(language->machine_flag) {
-        case MACHINE_SPU: {
-            return compile_spu(language);
-        }
-        case MACHINE_ELF_X86: {
-            return compile_elf(language);
-        }
-        case MACHINE_ASM_X86: {
-            return compile_nasm(language);
-        }
-        default: {
-            print_error("Unexpected machine flag.");
-            return LANGUAGE_UNEXPECTED_MACHINE;
-        }
-    }
-}
-
-//===========================================================================//
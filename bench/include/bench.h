@@ -0,0 +1,85 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+struct bench_mode_t {
+    const char                      *name;
+    language_error_t               (*run)(int argc, const char *argv[]);
+    const char                      *description;
+};
+
+//===========================================================================//
+
+static const char *const BenchSourceFile = "logs/bench.kvm";
+static const size_t BenchDefaultFunctions = 20000;
+static const size_t BenchDefaultRepeats   = 5;
+static const size_t BenchDefaultFields    = 4000000;
+static const size_t BenchReachablePart    = 10;
+static const size_t BenchNameSize         = 32;
+
+//===========================================================================//
+
+double           bench_time_now      (void);
+
+size_t           bench_get_size      (int         argc,
+                                      const char *argv[],
+                                      int         position,
+                                      size_t      default_value);
+
+language_error_t bench_write_program (const char *filename,
+                                      size_t      functions);
+
+language_error_t bench_write_library (const char *filename,
+                                      size_t      functions,
+                                      size_t      reachable);
+
+void             bench_function_name (char       *name,
+                                      size_t      index);
+
+language_error_t bench_build_tree    (language_t *ctx,
+                                      const char *argv0);
+
+language_error_t bench_same_files    (const char *first,
+                                      const char *second);
+
+language_error_t bench_lexer         (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_threads       (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_symbols       (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_numbers       (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_incremental   (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_trees         (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_output        (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_lazy          (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_build         (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_dag           (int         argc,
+                                      const char *argv[]);
+
+language_error_t bench_worklist      (int         argc,
+                                      const char *argv[]);
+
+//===========================================================================//
+
+#endif
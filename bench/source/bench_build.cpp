@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "frontend.h"
+#include "syntax_parser.h"
+#include "build_cache.h"
+#include "utils.h"
+#include "colors.h"
+
+//===========================================================================//
+
+static const char *const BenchBuildDirectory = "logs/bench.build";
+static const char *const BenchBuildObjects   = "logs/bench.build/objects";
+static const char *const BenchBuildTree      = "logs/bench.build.tree";
+static const char *const BenchBuildFresh     = "logs/bench.build.fresh.tree";
+static const size_t      BenchBuildPathSize  = 256;
+
+//===========================================================================//
+
+static language_error_t bench_build_time  (const char *argv0,
+                                           const char *directory,
+                                           const char *output,
+                                           bool        is_cold,
+                                           size_t      repeats,
+                                           double     *best_time);
+
+static language_error_t bench_build_once  (const char *argv0,
+                                           const char *directory,
+                                           const char *output,
+                                           bool        is_cold,
+                                           char       *key);
+
+static void             bench_build_clean (const char *key);
+
+static void             bench_object_path (char       *path,
+                                           const char *key);
+
+//===========================================================================//
+
+language_error_t bench_build(int argc, const char *argv[]) {
+    size_t functions = bench_get_size(argc, argv, 2, BenchDefaultFunctions);
+    size_t repeats   = bench_get_size(argc, argv, 3, BenchDefaultRepeats  );
+    _RETURN_IF_ERROR(bench_write_program(BenchSourceFile, functions));
+    bench_build_clean(NULL);
+    //-----------------------------------------------------------------------//
+    // Build without cache, build which misses and stores the output and
+    // build which copies the stored output.
+    double full_time = 0;
+    double miss_time = 0;
+    double hit_time  = 0;
+    _RETURN_IF_ERROR(bench_build_time(argv[0], NULL               , BenchBuildFresh, false, repeats, &full_time));
+    _RETURN_IF_ERROR(bench_build_time(argv[0], BenchBuildDirectory, BenchBuildTree , true , repeats, &miss_time));
+    char key[BuildCacheKeyLength + 1] = {};
+    _RETURN_IF_ERROR(bench_build_once(argv[0], BenchBuildDirectory, BenchBuildTree , false, key));
+    _RETURN_IF_ERROR(bench_build_time(argv[0], BenchBuildDirectory, BenchBuildTree , false, repeats, &hit_time ));
+    language_error_t error_code = bench_same_files(BenchBuildFresh, BenchBuildTree);
+    bench_build_clean(key);
+    _RETURN_IF_ERROR(error_code);
+    //-----------------------------------------------------------------------//
+    printf("build: " SZ_SP " functions, best of " SZ_SP
+           ": no cache %.3f ms, miss and store %.3f ms, hit %.3f ms, x%.2f\n",
+           functions,
+           repeats,
+           full_time * 1e3,
+           miss_time * 1e3,
+           hit_time  * 1e3,
+           full_time / hit_time);
+    printf("output taken from cache is the same as built one\n");
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_build_time(const char *argv0,
+                                  const char *directory,
+                                  const char *output,
+                                  bool        is_cold,
+                                  size_t      repeats,
+                                  double     *best_time) {
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        double start = bench_time_now();
+        _RETURN_IF_ERROR(bench_build_once(argv0, directory, output, is_cold, NULL));
+        double time  = bench_time_now() - start;
+        if(repeat == 0 || time < *best_time) {
+            *best_time = time;
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_build_once(const char *argv0,
+                                  const char *directory,
+                                  const char *output,
+                                  bool        is_cold,
+                                  char       *key) {
+    // Same steps as frontend main, hashing of the input is measured too.
+    const char *frontend_argv[] = {argv0, "-i", BenchSourceFile,
+                                   "-o", output, "-b", directory};
+    int frontend_argc = directory == NULL ? 5 : 7;
+    //-----------------------------------------------------------------------//
+    language_t       ctx        = {};
+    language_error_t error_code = frontend_ctor(&ctx, frontend_argc, frontend_argv);
+    if(error_code == LANGUAGE_BUILD_CACHE_HIT) {
+        frontend_dtor(&ctx);
+        return is_cold ? LANGUAGE_TREE_ERROR : LANGUAGE_SUCCESS;
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = parse_tokens(&ctx);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = parse_syntax(&ctx);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = write_tree(&ctx);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = build_cache_store(&ctx);
+    }
+    //-----------------------------------------------------------------------//
+    // Stored object is removed, so the next cold build misses again.
+    if(is_cold) {
+        char object[BenchBuildPathSize] = {};
+        bench_object_path(object, ctx.build_cache.key);
+        remove(object);
+    }
+    if(key != NULL) {
+        memcpy(key, ctx.build_cache.key, sizeof(ctx.build_cache.key));
+    }
+    frontend_dtor(&ctx);
+    return error_code;
+}
+
+//===========================================================================//
+
+void bench_build_clean(const char *key) {
+    char path[BenchBuildPathSize] = {};
+    if(key != NULL) {
+        bench_object_path(path, key);
+        remove(path);
+    }
+    snprintf(path, sizeof(path), "%s/hits", BenchBuildDirectory);
+    remove(path);
+    snprintf(path, sizeof(path), "%s/misses", BenchBuildDirectory);
+    remove(path);
+    remove(BenchBuildObjects);
+    remove(BenchBuildDirectory);
+    remove(BenchBuildTree);
+    remove(BenchBuildFresh);
+}
+
+//===========================================================================//
+
+void bench_object_path(char *path, const char *key) {
+    snprintf(path, BenchBuildPathSize, "%s/%s", BenchBuildObjects, key);
+}
+
+//===========================================================================//
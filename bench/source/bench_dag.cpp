@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "frontend.h"
+#include "middleend.h"
+#include "name_table.h"
+#include "mapped_file.h"
+#include "utils.h"
+#include "colors.h"
+
+//===========================================================================//
+
+struct bench_dag_mode_t {
+    const char                      *name;
+    tree_format_t                    format;
+    const char                      *tree_file;
+    const char                      *check_file;
+    double                           load_time;
+    double                           optimize_time;
+    size_t                           size;
+};
+
+//===========================================================================//
+
+static language_error_t bench_write_repeated (const char       *filename,
+                                              size_t            functions);
+
+static language_error_t bench_optimize_time  (bench_dag_mode_t *mode,
+                                              size_t            repeats);
+
+static language_error_t bench_optimize_once  (bench_dag_mode_t *mode,
+                                              bool              is_checked,
+                                              double           *load_time,
+                                              double           *optimize_time);
+
+//===========================================================================//
+
+language_error_t bench_dag(int argc, const char *argv[]) {
+    size_t functions = bench_get_size(argc, argv, 2, BenchDefaultFunctions);
+    size_t repeats   = bench_get_size(argc, argv, 3, BenchDefaultRepeats  );
+    _RETURN_IF_ERROR(bench_write_repeated(BenchSourceFile, functions));
+    //-----------------------------------------------------------------------//
+    bench_dag_mode_t modes[] = {
+        {"tree", TREE_FORMAT_BINARY, "logs/bench.btree", "logs/bench.btree.check", 0, 0, 0},
+        {"dag" , TREE_FORMAT_DAG   , "logs/bench.dtree", "logs/bench.dtree.check", 0, 0, 0}};
+    size_t modes_number = sizeof(modes) / sizeof(modes[0]);
+    //-----------------------------------------------------------------------//
+    language_t       ctx        = {};
+    language_error_t error_code = bench_build_tree(&ctx, argv[0]);
+    for(size_t elem = 0; elem < modes_number && error_code == LANGUAGE_SUCCESS; elem++) {
+        ctx.output_file = modes[elem].tree_file;
+        ctx.tree_format = modes[elem].format;
+        error_code      = write_tree(&ctx);
+    }
+    size_t nodes = ctx.nodes.size;
+    frontend_dtor(&ctx);
+    _RETURN_IF_ERROR(error_code);
+    for(size_t elem = 0; elem < modes_number; elem++) {
+        _RETURN_IF_ERROR(bench_optimize_time(modes + elem, repeats));
+    }
+    //-----------------------------------------------------------------------//
+    printf("dag: " SZ_SP " functions, " SZ_SP " nodes, best of " SZ_SP "\n",
+           functions,
+           nodes,
+           repeats);
+    for(size_t elem = 0; elem < modes_number; elem++) {
+        bench_dag_mode_t *mode = modes + elem;
+        printf("%-4s: " SZ_SP " bytes, load %.3f ms, optimize %.3f ms\n",
+               mode->name,
+               mode->size,
+               mode->load_time     * 1e3,
+               mode->optimize_time * 1e3);
+    }
+    printf("dag vs tree: size x%.2f, load x%.2f, optimize x%.2f\n",
+           (double)modes[0].size / (double)modes[1].size,
+           modes[0].load_time     / modes[1].load_time,
+           modes[0].optimize_time / modes[1].optimize_time);
+    //-----------------------------------------------------------------------//
+    // Both optimized trees are written without sharing and compared.
+    _RETURN_IF_ERROR(bench_same_files(modes[0].check_file, modes[1].check_file));
+    printf("optimized trees are identical\n");
+    for(size_t elem = 0; elem < modes_number; elem++) {
+        remove(modes[elem].tree_file);
+        remove(modes[elem].check_file);
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_write_repeated(const char *filename, size_t functions) {
+    // Every function repeats the same constant chains and variable
+    // expressions, as generated code usually does.
+    FILE *output = fopen(filename, "wb");
+    if(output == NULL) {
+        print_error("Error while opening benchmark source file '%s'.\n",
+                    filename);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    char name[BenchNameSize] = {};
+    for(size_t function = 0; function < functions; function++) {
+        bench_function_name(name, function);
+        fprintf(output,
+                "func %s(var alpha, var beta) {\n"
+                "    var gamma = alpha * (2 * 3 + 4 / 2) + beta * (2 * 3 + 4 / 2);\n"
+                "    var delta = (alpha + beta) * (alpha + beta) + (1 + 2 * 3 - 4) * (alpha - 0);\n"
+                "    if(gamma > (2 * 3 + 4 / 2) * (1 + 2 * 3 - 4)) {\n"
+                "        gamma = gamma - (alpha + beta) * (1 + 2 * 3 - 4);\n"
+                "    }\n"
+                "    gamma = gamma + delta * (2 * 3 + 4 / 2) - 0 * (alpha + beta);\n"
+                "    return gamma + delta * (1 + 2 * 3 - 4);\n"
+                "}\n\n",
+                name);
+    }
+    //-----------------------------------------------------------------------//
+    fprintf(output,
+            "func main() {\n"
+            "    var x = 0;\n"
+            "    input(x);\n"
+            "    output(%s(x, x));\n"
+            "    return 0;\n"
+            "}\n",
+            name);
+    fclose(output);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_optimize_time(bench_dag_mode_t *mode, size_t repeats) {
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        double load_time     = 0;
+        double optimize_time = 0;
+        _RETURN_IF_ERROR(bench_optimize_once(mode, repeat == 0, &load_time, &optimize_time));
+        if(repeat == 0 || load_time < mode->load_time) {
+            mode->load_time = load_time;
+        }
+        if(repeat == 0 || optimize_time < mode->optimize_time) {
+            mode->optimize_time = optimize_time;
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_optimize_once(bench_dag_mode_t *mode,
+                                     bool              is_checked,
+                                     double           *load_time,
+                                     double           *optimize_time) {
+    // Same steps as middleend main, hash-consing is a part of optimization.
+    language_t ctx = {};
+    ctx.input_file  = mode->tree_file;
+    ctx.tree_format = mode->format;
+    double start = bench_time_now();
+    language_error_t error_code = read_tree(&ctx);
+    *load_time = bench_time_now() - start;
+    if(error_code == LANGUAGE_SUCCESS) {
+        start          = bench_time_now();
+        error_code     = optimize_tree(&ctx);
+        *optimize_time = bench_time_now() - start;
+    }
+    //-----------------------------------------------------------------------//
+    if(error_code == LANGUAGE_SUCCESS && is_checked) {
+        FILE *tree = fopen(mode->tree_file, "rb");
+        if(tree != NULL) {
+            mode->size = file_size(tree);
+            fclose(tree);
+        }
+        ctx.output_file = mode->check_file;
+        ctx.tree_format = TREE_FORMAT_BINARY;
+        error_code      = write_tree(&ctx);
+    }
+    nodes_storage_dtor(&ctx);
+    name_table_dtor   (&ctx);
+    input_close       (&ctx);
+    return error_code;
+}
+
+//===========================================================================//
@@ -0,0 +1,367 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "frontend.h"
+#include "syntax_parser.h"
+#include "function_cache.h"
+#include "utils.h"
+#include "colors.h"
+#include "text_scan.h"
+
+//===========================================================================//
+
+static const size_t      BenchNumberSize = 32;
+static const char *const BenchCacheFile  = "logs/bench.cache";
+
+//===========================================================================//
+
+static language_error_t bench_lex_time  (const char *argv0,
+                                         size_t      threads,
+                                         size_t      repeats,
+                                         double     *best_time,
+                                         size_t     *tokens,
+                                         size_t     *bytes);
+
+static language_error_t bench_parse_time(const char *argv0,
+                                         size_t      threads,
+                                         size_t      repeats,
+                                         double     *best_time,
+                                         size_t     *identifiers);
+
+static language_error_t bench_cache_time(const char *argv0,
+                                         const char *cache_file,
+                                         bool        is_cold,
+                                         size_t      repeats,
+                                         double     *best_time,
+                                         size_t     *reused);
+
+static language_error_t bench_edit_program
+                                        (const char *filename);
+
+//===========================================================================//
+
+language_error_t bench_lexer(int argc, const char *argv[]) {
+    size_t functions = bench_get_size(argc, argv, 2, BenchDefaultFunctions);
+    size_t repeats   = bench_get_size(argc, argv, 3, BenchDefaultRepeats  );
+    _RETURN_IF_ERROR(bench_write_program(BenchSourceFile, functions));
+    //-----------------------------------------------------------------------//
+    double best_time = 0;
+    size_t tokens    = 0;
+    size_t bytes     = 0;
+    _RETURN_IF_ERROR(bench_lex_time(argv[0],
+                                    1,
+                                    repeats,
+                                    &best_time,
+                                    &tokens,
+                                    &bytes));
+    //-----------------------------------------------------------------------//
+    printf("lexer (%s): " SZ_SP " functions, " SZ_SP " bytes, " SZ_SP " tokens\n"
+           "best of " SZ_SP ": %.3f ms, %.2f Mtokens/s, %.2f MB/s\n",
+           scan_level_name(),
+           functions,
+           bytes,
+           tokens,
+           repeats,
+           best_time * 1e3,
+           (double)tokens / best_time * 1e-6,
+           (double)bytes  / best_time * 1e-6);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_threads(int argc, const char *argv[]) {
+    size_t functions = bench_get_size(argc, argv, 2, BenchDefaultFunctions);
+    size_t repeats   = bench_get_size(argc, argv, 3, BenchDefaultRepeats  );
+    _RETURN_IF_ERROR(bench_write_program(BenchSourceFile, functions));
+    //-----------------------------------------------------------------------//
+    // At least two threads are run so the parallel path is always measured.
+    long   online      = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = online > 2 ? (size_t)online : 2;
+    double single_time       = 0;
+    double single_parse_time = 0;
+    size_t single_tokens     = 0;
+    for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double best_time   = 0;
+        double parse_time  = 0;
+        size_t tokens      = 0;
+        size_t bytes       = 0;
+        size_t identifiers = 0;
+        _RETURN_IF_ERROR(bench_lex_time(argv[0],
+                                        threads,
+                                        repeats,
+                                        &best_time,
+                                        &tokens,
+                                        &bytes));
+        _RETURN_IF_ERROR(bench_parse_time(argv[0],
+                                          threads,
+                                          repeats,
+                                          &parse_time,
+                                          &identifiers));
+        if(threads == 1) {
+            single_time       = best_time;
+            single_parse_time = parse_time;
+            single_tokens     = tokens;
+        }
+        else if(tokens != single_tokens) {
+            print_error("Parallel lexer produced " SZ_SP " tokens "
+                        "instead of " SZ_SP ".\n",
+                        tokens,
+                        single_tokens);
+            return LANGUAGE_THREAD_ERROR;
+        }
+        //-------------------------------------------------------------------//
+        printf("threads: " SZ_SP " threads, " SZ_SP " bytes, best of " SZ_SP
+               ": lexer %.3f ms, %.2f Mtokens/s, x%.2f, "
+               "lexer and parser %.3f ms, x%.2f\n",
+               threads,
+               bytes,
+               repeats,
+               best_time * 1e3,
+               (double)tokens / best_time * 1e-6,
+               single_time / best_time,
+               parse_time * 1e3,
+               single_parse_time / parse_time);
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_lex_time(const char *argv0,
+                                size_t      threads,
+                                size_t      repeats,
+                                double     *best_time,
+                                size_t     *tokens,
+                                size_t     *bytes) {
+    char threads_string[BenchNumberSize] = {};
+    snprintf(threads_string, BenchNumberSize, SZ_SP, threads);
+    const char *frontend_argv[] = {argv0, "-i", BenchSourceFile,
+                                   "-j", threads_string};
+    int frontend_argc = (int)(sizeof(frontend_argv) / sizeof(frontend_argv[0]));
+    //-----------------------------------------------------------------------//
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        language_t ctx = {};
+        language_error_t error_code = frontend_ctor(&ctx,
+                                                    frontend_argc,
+                                                    frontend_argv);
+        if(error_code != LANGUAGE_SUCCESS) {
+            frontend_dtor(&ctx);
+            return error_code;
+        }
+        //-------------------------------------------------------------------//
+        double start = bench_time_now();
+        error_code = parse_tokens(&ctx);
+        double time = bench_time_now() - start;
+        //-------------------------------------------------------------------//
+        *tokens = ctx.nodes.size;
+        *bytes  = ctx.input_size;
+        frontend_dtor(&ctx);
+        _RETURN_IF_ERROR(error_code);
+        if(repeat == 0 || time < *best_time) {
+            *best_time = time;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_symbols(int argc, const char *argv[]) {
+    size_t functions = bench_get_size(argc, argv, 2, BenchDefaultFunctions);
+    size_t repeats   = bench_get_size(argc, argv, 3, BenchDefaultRepeats  );
+    //-----------------------------------------------------------------------//
+    // Doubling the program should roughly double the time when name
+    // resolution is linear, and quadruple it when it is quadratic.
+    double previous_time = 0;
+    for(size_t step = 4; step >= 1; step /= 2) {
+        size_t step_functions = functions / step;
+        _RETURN_IF_ERROR(bench_write_program(BenchSourceFile, step_functions));
+        //-------------------------------------------------------------------//
+        double best_time   = 0;
+        size_t identifiers = 0;
+        _RETURN_IF_ERROR(bench_parse_time(argv[0],
+                                          1,
+                                          repeats,
+                                          &best_time,
+                                          &identifiers));
+        //-------------------------------------------------------------------//
+        printf("symbols: " SZ_SP " functions, " SZ_SP " identifiers, "
+               "best of " SZ_SP ": %.3f ms",
+               step_functions,
+               identifiers,
+               repeats,
+               best_time * 1e3);
+        if(step != 4) {
+            printf(", x%.2f", best_time / previous_time);
+        }
+        printf("\n");
+        previous_time = best_time;
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_parse_time(const char *argv0,
+                                  size_t      threads,
+                                  size_t      repeats,
+                                  double     *best_time,
+                                  size_t     *identifiers) {
+    char threads_string[BenchNumberSize] = {};
+    snprintf(threads_string, BenchNumberSize, SZ_SP, threads);
+    const char *frontend_argv[] = {argv0, "-i", BenchSourceFile,
+                                   "-j", threads_string};
+    int frontend_argc = (int)(sizeof(frontend_argv) / sizeof(frontend_argv[0]));
+    //-----------------------------------------------------------------------//
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        language_t ctx = {};
+        language_error_t error_code = frontend_ctor(&ctx,
+                                                    frontend_argc,
+                                                    frontend_argv);
+        if(error_code != LANGUAGE_SUCCESS) {
+            frontend_dtor(&ctx);
+            return error_code;
+        }
+        //-------------------------------------------------------------------//
+        double start = bench_time_now();
+        error_code = parse_tokens(&ctx);
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = parse_syntax(&ctx);
+        }
+        double time = bench_time_now() - start;
+        //-------------------------------------------------------------------//
+        *identifiers = ctx.name_table.size;
+        frontend_dtor(&ctx);
+        _RETURN_IF_ERROR(error_code);
+        if(repeat == 0 || time < *best_time) {
+            *best_time = time;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_incremental(int argc, const char *argv[]) {
+    size_t functions = bench_get_size(argc, argv, 2, BenchDefaultFunctions);
+    size_t repeats   = bench_get_size(argc, argv, 3, BenchDefaultRepeats  );
+    _RETURN_IF_ERROR(bench_write_program(BenchSourceFile, functions));
+    //-----------------------------------------------------------------------//
+    // Full build, build filling the cache, build with nothing changed and
+    // build after one function body is edited.
+    double full_time   = 0;
+    double cold_time   = 0;
+    double warm_time   = 0;
+    double edited_time = 0;
+    size_t reused      = 0;
+    size_t edited      = 0;
+    _RETURN_IF_ERROR(bench_cache_time(argv[0], NULL, false, repeats, &full_time, &reused));
+    _RETURN_IF_ERROR(bench_cache_time(argv[0], BenchCacheFile, true , repeats, &cold_time, &reused));
+    _RETURN_IF_ERROR(bench_cache_time(argv[0], BenchCacheFile, false, repeats, &warm_time, &reused));
+    _RETURN_IF_ERROR(bench_edit_program(BenchSourceFile));
+    _RETURN_IF_ERROR(bench_cache_time(argv[0], BenchCacheFile, false, 1, &edited_time, &edited));
+    remove(BenchCacheFile);
+    //-----------------------------------------------------------------------//
+    printf("incremental: " SZ_SP " functions, best of " SZ_SP
+           ": no cache %.3f ms, cold cache %.3f ms, "
+           "warm cache %.3f ms (" SZ_SP " reused), x%.2f, "
+           "one function edited %.3f ms (" SZ_SP " reused), x%.2f\n",
+           functions,
+           repeats,
+           full_time   * 1e3,
+           cold_time   * 1e3,
+           warm_time   * 1e3,
+           reused,
+           full_time / warm_time,
+           edited_time * 1e3,
+           edited,
+           full_time / edited_time);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_cache_time(const char *argv0,
+                                  const char *cache_file,
+                                  bool        is_cold,
+                                  size_t      repeats,
+                                  double     *best_time,
+                                  size_t     *reused) {
+    const char *frontend_argv[] = {argv0, "-i", BenchSourceFile,
+                                   "-c", cache_file};
+    int frontend_argc = cache_file == NULL ? 3 : 5;
+    //-----------------------------------------------------------------------//
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        if(is_cold) {
+            remove(cache_file);
+        }
+        // Cache is opened in constructor, so it is measured too.
+        language_t ctx   = {};
+        double     start = bench_time_now();
+        language_error_t error_code = frontend_ctor(&ctx,
+                                                    frontend_argc,
+                                                    frontend_argv);
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = parse_tokens(&ctx);
+        }
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = parse_syntax(&ctx);
+        }
+        if(error_code == LANGUAGE_CACHE_OUTDATED) {
+            error_code = function_cache_reparse(&ctx);
+        }
+        double time = bench_time_now() - start;
+        //-------------------------------------------------------------------//
+        if(ctx.frontend_info.cache != NULL) {
+            *reused = ctx.frontend_info.cache->reused;
+        }
+        frontend_dtor(&ctx);
+        _RETURN_IF_ERROR(error_code);
+        if(repeat == 0 || time < *best_time) {
+            *best_time = time;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_edit_program(const char *filename) {
+    FILE *file = fopen(filename, "r+b");
+    if(file == NULL) {
+        print_error("Error while opening benchmark source file '%s'.\n",
+                    filename);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    // Constant in the middle function changes, its signature stays.
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, size / 2, SEEK_SET);
+    const char *pattern  = "3.5";
+    size_t      matched  = 0;
+    int         symbol   = 0;
+    while(pattern[matched] != '\0' && (symbol = fgetc(file)) != EOF) {
+        matched = symbol == pattern[matched] ? matched + 1 :
+                  symbol == pattern[0]       ? 1           : 0;
+    }
+    if(pattern[matched] == '\0') {
+        fseek(file, -(long)matched, SEEK_CUR);
+        fputc('4', file);
+    }
+    fclose(file);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
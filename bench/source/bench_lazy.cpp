@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "frontend.h"
+#include "name_table.h"
+#include "mapped_file.h"
+#include "utils.h"
+#include "colors.h"
+
+//===========================================================================//
+
+struct bench_loading_t {
+    const char                      *name;
+    language_error_t               (*read)(language_t *);
+    double                           time;
+    long                             faults;
+    size_t                           statements;
+};
+
+//===========================================================================//
+
+static const char *const BenchLazyTree = "logs/bench.lazy.btree";
+
+//===========================================================================//
+
+static language_error_t bench_loading_time (bench_loading_t *loading,
+                                            size_t           repeats);
+
+static language_error_t bench_load_once    (bench_loading_t *loading,
+                                            double          *time,
+                                            long            *faults);
+
+static long             bench_minor_faults (void);
+
+//===========================================================================//
+
+language_error_t bench_lazy(int argc, const char *argv[]) {
+    size_t functions = bench_get_size(argc, argv, 2, BenchDefaultFunctions);
+    size_t repeats   = bench_get_size(argc, argv, 3, BenchDefaultRepeats  );
+    size_t reachable = functions / BenchReachablePart == 0 ? 1 :
+                       functions / BenchReachablePart;
+    _RETURN_IF_ERROR(bench_write_library(BenchSourceFile, functions, reachable));
+    //-----------------------------------------------------------------------//
+    language_t       ctx        = {};
+    language_error_t error_code = bench_build_tree(&ctx, argv[0]);
+    if(error_code == LANGUAGE_SUCCESS) {
+        ctx.output_file = BenchLazyTree;
+        ctx.tree_format = TREE_FORMAT_BINARY;
+        error_code      = write_tree(&ctx);
+    }
+    frontend_dtor(&ctx);
+    _RETURN_IF_ERROR(error_code);
+    //-----------------------------------------------------------------------//
+    bench_loading_t loadings[] = {
+        {"whole"    , read_tree          , 0, 0, 0},
+        {"reachable", read_tree_reachable, 0, 0, 0}};
+    size_t loadings_number = sizeof(loadings) / sizeof(loadings[0]);
+    for(size_t elem = 0; elem < loadings_number; elem++) {
+        _RETURN_IF_ERROR(bench_loading_time(loadings + elem, repeats));
+    }
+    //-----------------------------------------------------------------------//
+    printf("lazy: " SZ_SP " functions, " SZ_SP " reachable, best of " SZ_SP "\n",
+           functions,
+           reachable,
+           repeats);
+    for(size_t elem = 0; elem < loadings_number; elem++) {
+        bench_loading_t *loading = loadings + elem;
+        printf("%-9s: " SZ_SP " statements, load %.3f ms, %ld page faults\n",
+               loading->name,
+               loading->statements,
+               loading->time * 1e3,
+               loading->faults);
+    }
+    printf("reachable vs whole: load x%.2f, page faults x%.2f\n",
+           loadings[0].time / loadings[1].time,
+           (double)loadings[0].faults / (double)loadings[1].faults);
+    //-----------------------------------------------------------------------//
+    // Global variable, reachable functions and main are left in chain.
+    if(loadings[0].statements != functions + 2 ||
+       loadings[1].statements != reachable + 2) {
+        print_error("Unexpected number of loaded statements.\n");
+        return LANGUAGE_TREE_ERROR;
+    }
+    printf("only reachable functions are loaded\n");
+    remove(BenchLazyTree);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_loading_time(bench_loading_t *loading, size_t repeats) {
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        double time   = 0;
+        long   faults = 0;
+        _RETURN_IF_ERROR(bench_load_once(loading, &time, &faults));
+        if(repeat == 0 || time < loading->time) {
+            loading->time   = time;
+            loading->faults = faults;
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_load_once(bench_loading_t *loading,
+                                 double          *time,
+                                 long            *faults) {
+    // Page faults show how much of the mapped file became private memory.
+    language_t ctx = {};
+    ctx.input_file = BenchLazyTree;
+    long   start_faults = bench_minor_faults();
+    double start        = bench_time_now();
+    language_error_t error_code = loading->read(&ctx);
+    *time   = bench_time_now() - start;
+    *faults = bench_minor_faults() - start_faults;
+    //-----------------------------------------------------------------------//
+    loading->statements = 0;
+    for(language_node_t *node = nodes_storage_get(&ctx, ctx.root); node != NULL; node = node_right(&ctx, node)) {
+        loading->statements++;
+    }
+    nodes_storage_dtor(&ctx);
+    name_table_dtor   (&ctx);
+    input_close       (&ctx);
+    return error_code;
+}
+
+//===========================================================================//
+
+long bench_minor_faults(void) {
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+//===========================================================================//
@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glob.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "colors.h"
+#include "utils.h"
+#include "mapped_file.h"
+#include "number_parser.h"
+
+//===========================================================================//
+
+typedef const char *(*double_parser_t)(const char *position, double *value);
+typedef const char *(*size_parser_t  )(const char *position, size_t *value);
+
+//===========================================================================//
+
+static const char *const BenchTreesPattern = "samples/*/pr.tree";
+
+//===========================================================================//
+
+static language_error_t bench_read_corpus (char             **corpus,
+                                           size_t            *corpus_size,
+                                           size_t            *fields,
+                                           size_t            *files);
+
+static language_error_t bench_scale_corpus(char             **corpus,
+                                           size_t            *corpus_size,
+                                           size_t            *fields,
+                                           size_t             needed);
+
+static bool             is_field_separator(char               symbol);
+
+static bool             is_number_start   (const char        *field,
+                                           const char        *end);
+
+static const char      *skip_field        (const char        *position);
+
+static double           time_doubles      (const char        *corpus,
+                                           double_parser_t    parser,
+                                           size_t             repeats,
+                                           double            *checksum);
+
+static double           time_sizes        (const char        *corpus,
+                                           size_parser_t      parser,
+                                           size_t             repeats,
+                                           size_t            *checksum);
+
+static const char      *libc_double       (const char        *position,
+                                           double            *value);
+
+static const char      *libc_size         (const char        *position,
+                                           size_t            *value);
+
+//===========================================================================//
+
+language_error_t bench_numbers(int argc, const char *argv[]) {
+    size_t needed  = bench_get_size(argc, argv, 2, BenchDefaultFields );
+    size_t repeats = bench_get_size(argc, argv, 3, BenchDefaultRepeats);
+    //-----------------------------------------------------------------------//
+    char  *corpus      = NULL;
+    size_t corpus_size = 0;
+    size_t fields      = 0;
+    size_t files       = 0;
+    _RETURN_IF_ERROR(bench_read_corpus(&corpus, &corpus_size, &fields, &files));
+    language_error_t error_code = bench_scale_corpus(&corpus,
+                                                     &corpus_size,
+                                                     &fields,
+                                                     needed);
+    if(error_code != LANGUAGE_SUCCESS) {
+        free(corpus);
+        return error_code;
+    }
+    //-----------------------------------------------------------------------//
+    double libc_sum_double = 0;
+    double fast_sum_double = 0;
+    size_t libc_sum_size   = 0;
+    size_t fast_sum_size   = 0;
+    double libc_double_time = time_doubles(corpus, libc_double , repeats, &libc_sum_double);
+    double fast_double_time = time_doubles(corpus, parse_double, repeats, &fast_sum_double);
+    double libc_size_time   = time_sizes  (corpus, libc_size   , repeats, &libc_sum_size  );
+    double fast_size_time   = time_sizes  (corpus, parse_size  , repeats, &fast_sum_size  );
+    free(corpus);
+    //-----------------------------------------------------------------------//
+    double per_field = 1e9 / (double)fields;
+    printf("numbers: " SZ_SP " fields (" SZ_SP " bytes) from " SZ_SP
+           " sample trees, best of " SZ_SP "\n"
+           "double: strtod   %.2f ns/field, parse_double %.2f ns/field, x%.2f\n"
+           "size  : strtoull %.2f ns/field, parse_size   %.2f ns/field, x%.2f\n",
+           fields,
+           corpus_size,
+           files,
+           repeats,
+           libc_double_time * per_field,
+           fast_double_time * per_field,
+           libc_double_time / fast_double_time,
+           libc_size_time   * per_field,
+           fast_size_time   * per_field,
+           libc_size_time   / fast_size_time);
+    //-----------------------------------------------------------------------//
+    if(memcmp(&libc_sum_double, &fast_sum_double, sizeof(double)) != 0 ||
+       libc_sum_size != fast_sum_size) {
+        print_error("Parsed values differ from libc results.\n");
+        return LANGUAGE_READING_TREE_ERROR;
+    }
+    printf("results are identical to libc\n");
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_read_corpus(char   **corpus,
+                                   size_t  *corpus_size,
+                                   size_t  *fields,
+                                   size_t  *files) {
+    glob_t trees = {};
+    if(glob(BenchTreesPattern, 0, NULL, &trees) != 0) {
+        print_error("No trees matching '%s', run from repository root.\n",
+                    BenchTreesPattern);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    size_t capacity = 0;
+    for(size_t elem = 0; elem < trees.gl_pathc; elem++) {
+        mapped_file_t file = {};
+        if(mapped_file_open(&file, trees.gl_pathv[elem]) != LANGUAGE_SUCCESS) {
+            continue;
+        }
+        //-------------------------------------------------------------------//
+        // Only numeric fields are kept, separated by single spaces.
+        char *new_corpus = (char *)realloc(*corpus, capacity + file.size + 1);
+        if(new_corpus == NULL) {
+            mapped_file_close(&file);
+            globfree(&trees);
+            print_error("Error while allocating numbers corpus.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        *corpus   = new_corpus;
+        capacity += file.size + 1;
+        //-------------------------------------------------------------------//
+        const char *position = file.data;
+        const char *end      = file.data + file.size;
+        while(position < end) {
+            while(position < end && is_field_separator(*position)) {
+                position++;
+            }
+            const char *field = position;
+            while(position < end && !is_field_separator(*position)) {
+                position++;
+            }
+            if(is_number_start(field, position)) {
+                memcpy(*corpus + *corpus_size, field, (size_t)(position - field));
+                *corpus_size += (size_t)(position - field);
+                (*corpus)[(*corpus_size)++] = ' ';
+                (*fields)++;
+            }
+        }
+        (*files)++;
+        mapped_file_close(&file);
+    }
+    globfree(&trees);
+    //-----------------------------------------------------------------------//
+    if(*fields == 0) {
+        print_error("Sample trees do not contain numbers.\n");
+        return LANGUAGE_READING_TREE_ERROR;
+    }
+    (*corpus)[*corpus_size] = '\0';
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_scale_corpus(char   **corpus,
+                                    size_t  *corpus_size,
+                                    size_t  *fields,
+                                    size_t   needed) {
+    size_t copies = (needed + *fields - 1) / *fields;
+    char *scaled = (char *)calloc(*corpus_size * copies + 1, sizeof(char));
+    if(scaled == NULL) {
+        print_error("Error while allocating numbers corpus.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    for(size_t copy = 0; copy < copies; copy++) {
+        memcpy(scaled + copy * *corpus_size, *corpus, *corpus_size);
+    }
+    free(*corpus);
+    *corpus       = scaled;
+    *corpus_size *= copies;
+    *fields      *= copies;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+bool is_field_separator(char symbol) {
+    return symbol == ' ' || symbol == '\n' || symbol == '\t' ||
+           symbol == '{' || symbol == '}';
+}
+
+//===========================================================================//
+
+bool is_number_start(const char *field, const char *end) {
+    if(field < end && *field == '-') {
+        field++;
+    }
+    return field < end && *field >= '0' && *field <= '9';
+}
+
+//===========================================================================//
+
+const char *skip_field(const char *position) {
+    while(*position != ' ' && *position != '\0') {
+        position++;
+    }
+    while(*position == ' ') {
+        position++;
+    }
+    return position;
+}
+
+//===========================================================================//
+
+double time_doubles(const char      *corpus,
+                    double_parser_t  parser,
+                    size_t           repeats,
+                    double          *checksum) {
+    double best_time = 0;
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        double      sum      = 0;
+        const char *position = corpus;
+        double      start    = bench_time_now();
+        while(*position != '\0') {
+            double value = 0;
+            parser(position, &value);
+            sum     += value;
+            position = skip_field(position);
+        }
+        double time = bench_time_now() - start;
+        //-------------------------------------------------------------------//
+        *checksum = sum;
+        if(repeat == 0 || time < best_time) {
+            best_time = time;
+        }
+    }
+    return best_time;
+}
+
+//===========================================================================//
+
+double time_sizes(const char    *corpus,
+                  size_parser_t  parser,
+                  size_t         repeats,
+                  size_t        *checksum) {
+    double best_time = 0;
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        size_t      sum      = 0;
+        const char *position = corpus;
+        double      start    = bench_time_now();
+        while(*position != '\0') {
+            size_t value = 0;
+            parser(position, &value);
+            sum     += value;
+            position = skip_field(position);
+        }
+        double time = bench_time_now() - start;
+        //-------------------------------------------------------------------//
+        *checksum = sum;
+        if(repeat == 0 || time < best_time) {
+            best_time = time;
+        }
+    }
+    return best_time;
+}
+
+//===========================================================================//
+
+const char *libc_double(const char *position, double *value) {
+    char *end = NULL;
+    *value = strtod(position, &end);
+    return end;
+}
+
+//===========================================================================//
+
+const char *libc_size(const char *position, size_t *value) {
+    char *end = NULL;
+    *value = strtoull(position, &end, 10);
+    return end;
+}
+
+//===========================================================================//
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "frontend.h"
+#include "output.h"
+#include "utils.h"
+#include "colors.h"
+
+//===========================================================================//
+
+struct bench_output_data_t {
+    language_t                       ctx;
+    double                          *numbers;
+    size_t                          *sizes;
+    size_t                           fields;
+};
+
+//---------------------------------------------------------------------------//
+
+struct bench_writer_t {
+    const char                      *name;
+    language_error_t               (*write)(bench_output_data_t *, const char *);
+    const char                      *file;
+    double                           time;
+    size_t                           size;
+};
+
+//===========================================================================//
+
+static language_error_t bench_fields_ctor  (bench_output_data_t *data);
+
+static language_error_t bench_writer_time  (bench_output_data_t *data,
+                                            bench_writer_t      *writer,
+                                            size_t               repeats);
+
+static language_error_t fields_stdio       (bench_output_data_t *data,
+                                            const char          *filename);
+
+static language_error_t fields_output      (bench_output_data_t *data,
+                                            const char          *filename);
+
+static language_error_t fields_write       (bench_output_data_t *data,
+                                            output_t            *buffer);
+
+static language_error_t tree_output        (bench_output_data_t *data,
+                                            const char          *filename);
+
+static language_error_t source_output      (bench_output_data_t *data,
+                                            const char          *filename);
+
+//===========================================================================//
+
+language_error_t bench_output(int argc, const char *argv[]) {
+    bench_output_data_t data = {};
+    data.fields    = bench_get_size(argc, argv, 2, BenchDefaultFields );
+    size_t repeats = bench_get_size(argc, argv, 3, BenchDefaultRepeats);
+    _RETURN_IF_ERROR(bench_write_program(BenchSourceFile, BenchDefaultFunctions));
+    //-----------------------------------------------------------------------//
+    // Numbers have at most six digits, so %lg and shortest digits agree.
+    bench_writer_t writers[] = {
+        {"fields stdio" , fields_stdio , "logs/bench.fields.stdio" , 0, 0},
+        {"fields output", fields_output, "logs/bench.fields.output", 0, 0},
+        {"tree text"    , tree_output  , "logs/bench.tree"         , 0, 0},
+        {"source"       , source_output, "logs/bench.source.kvm"   , 0, 0}};
+    size_t writers_number = sizeof(writers) / sizeof(writers[0]);
+    //-----------------------------------------------------------------------//
+    language_error_t error_code = bench_fields_ctor(&data);
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = bench_build_tree(&data.ctx, argv[0]);
+    }
+    for(size_t elem = 0; elem < writers_number && error_code == LANGUAGE_SUCCESS; elem++) {
+        error_code = bench_writer_time(&data, writers + elem, repeats);
+    }
+    frontend_dtor(&data.ctx);
+    free(data.numbers);
+    free(data.sizes);
+    _RETURN_IF_ERROR(error_code);
+    //-----------------------------------------------------------------------//
+    printf("output: " SZ_SP " fields, " SZ_SP " functions, best of " SZ_SP "\n",
+           data.fields,
+           BenchDefaultFunctions,
+           repeats);
+    for(size_t elem = 0; elem < writers_number; elem++) {
+        bench_writer_t *writer = writers + elem;
+        printf("%-13s: " SZ_SP " bytes, %.3f ms (%.1f MB/s)\n",
+               writer->name,
+               writer->size,
+               writer->time * 1e3,
+               (double)writer->size / writer->time * 1e-6);
+    }
+    printf("output vs stdio: x%.2f\n", writers[0].time / writers[1].time);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(bench_same_files(writers[0].file, writers[1].file));
+    printf("fields files are identical\n");
+    for(size_t elem = 0; elem < writers_number; elem++) {
+        remove(writers[elem].file);
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_fields_ctor(bench_output_data_t *data) {
+    data->numbers = (double *)calloc(data->fields, sizeof(data->numbers[0]));
+    data->sizes   = (size_t *)calloc(data->fields, sizeof(data->sizes  [0]));
+    if(data->numbers == NULL || data->sizes == NULL) {
+        print_error("Error while allocating benchmark fields.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    for(size_t field = 0; field < data->fields; field++) {
+        data->numbers[field] = (double)(field * 7919 % 1000000) / 100.0;
+        data->sizes  [field] = field * 2654435761 % 1000000007;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_writer_time(bench_output_data_t *data,
+                                   bench_writer_t      *writer,
+                                   size_t               repeats) {
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        double start = bench_time_now();
+        _RETURN_IF_ERROR(writer->write(data, writer->file));
+        double time  = bench_time_now() - start;
+        if(repeat == 0 || time < writer->time) {
+            writer->time = time;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    FILE *file = fopen(writer->file, "rb");
+    if(file == NULL) {
+        print_error("Error while opening '%s'.\n", writer->file);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    writer->size = file_size(file);
+    fclose(file);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t fields_stdio(bench_output_data_t *data, const char *filename) {
+    FILE *file = fopen(filename, "wb");
+    if(file == NULL) {
+        print_error("Error while opening '%s'.\n", filename);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    for(size_t field = 0; field < data->fields; field++) {
+        fprintf(file, "%lg " SZ_SP "\n", data->numbers[field], data->sizes[field]);
+    }
+    fclose(file);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t fields_output(bench_output_data_t *data, const char *filename) {
+    FILE *file = fopen(filename, "wb");
+    if(file == NULL) {
+        print_error("Error while opening '%s'.\n", filename);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    output_t         buffer     = {};
+    language_error_t error_code = fields_write(data, &buffer);
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = output_flush(&buffer, file);
+    }
+    output_dtor(&buffer);
+    fclose(file);
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t fields_write(bench_output_data_t *data, output_t *buffer) {
+    for(size_t field = 0; field < data->fields; field++) {
+        _RETURN_IF_ERROR(output_double  (buffer, data->numbers[field]));
+        _RETURN_IF_ERROR(output_char    (buffer, ' '));
+        _RETURN_IF_ERROR(output_unsigned(buffer, data->sizes[field], 0));
+        _RETURN_IF_ERROR(output_char    (buffer, '\n'));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t tree_output(bench_output_data_t *data, const char *filename) {
+    data->ctx.output_file = filename;
+    data->ctx.tree_format = TREE_FORMAT_TEXT;
+    return write_tree(&data->ctx);
+}
+
+//===========================================================================//
+
+language_error_t source_output(bench_output_data_t *data, const char *filename) {
+    // Same as frontstart_write, which is not linked to benchmark.
+    language_t *ctx = &data->ctx;
+    ctx->frontstart_info.output = fopen(filename, "wb");
+    if(ctx->frontstart_info.output == NULL) {
+        print_error("Error while opening '%s'.\n", filename);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    language_error_t error_code = LANGUAGE_SUCCESS;
+    language_node_t *node       = nodes_storage_get(ctx, ctx->root);
+    while(node != NULL && error_code == LANGUAGE_SUCCESS) {
+        error_code = to_source_subtree(ctx, node_left(ctx, node));
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = output_string(&ctx->frontstart_info.buffer, "\r\n\r\n", 4);
+        }
+        node = node_right(ctx, node);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = output_flush(&ctx->frontstart_info.buffer,
+                                  ctx->frontstart_info.output);
+    }
+    output_dtor(&ctx->frontstart_info.buffer);
+    fclose(ctx->frontstart_info.output);
+    ctx->frontstart_info.output = NULL;
+    return error_code;
+}
+
+//===========================================================================//
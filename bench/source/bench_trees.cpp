@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "frontend.h"
+#include "name_table.h"
+#include "mapped_file.h"
+#include "utils.h"
+#include "colors.h"
+
+//===========================================================================//
+
+struct bench_tree_format_t {
+    const char                      *name;
+    tree_format_t                    format;
+    const char                      *tree_file;
+    const char                      *check_file;
+    double                           store_time;
+    double                           load_time;
+    size_t                           size;
+};
+
+//===========================================================================//
+
+static language_error_t bench_store_time (language_t          *ctx,
+                                          bench_tree_format_t *format,
+                                          size_t               repeats);
+
+static language_error_t bench_load_time  (bench_tree_format_t *format,
+                                          size_t               repeats);
+
+static language_error_t bench_load_tree  (const char          *tree_file,
+                                          const char          *check_file,
+                                          double              *time);
+
+//===========================================================================//
+
+language_error_t bench_trees(int argc, const char *argv[]) {
+    size_t functions = bench_get_size(argc, argv, 2, BenchDefaultFunctions);
+    size_t repeats   = bench_get_size(argc, argv, 3, BenchDefaultRepeats  );
+    _RETURN_IF_ERROR(bench_write_program(BenchSourceFile, functions));
+    //-----------------------------------------------------------------------//
+    bench_tree_format_t formats[] = {
+        {"text"  , TREE_FORMAT_TEXT  , "logs/bench.tree" , "logs/bench.tree.check" , 0, 0, 0},
+        {"binary", TREE_FORMAT_BINARY, "logs/bench.btree", "logs/bench.btree.check", 0, 0, 0},
+        {"dag"   , TREE_FORMAT_DAG   , "logs/bench.dtree", "logs/bench.dtree.check", 0, 0, 0}};
+    size_t formats_number = sizeof(formats) / sizeof(formats[0]);
+    //-----------------------------------------------------------------------//
+    language_t       ctx        = {};
+    language_error_t error_code = bench_build_tree(&ctx, argv[0]);
+    for(size_t elem = 0; elem < formats_number && error_code == LANGUAGE_SUCCESS; elem++) {
+        error_code = bench_store_time(&ctx, formats + elem, repeats);
+    }
+    size_t nodes = ctx.nodes.size;
+    frontend_dtor(&ctx);
+    _RETURN_IF_ERROR(error_code);
+    for(size_t elem = 0; elem < formats_number; elem++) {
+        _RETURN_IF_ERROR(bench_load_time(formats + elem, repeats));
+    }
+    //-----------------------------------------------------------------------//
+    printf("trees: " SZ_SP " functions, " SZ_SP " nodes, best of " SZ_SP "\n",
+           functions,
+           nodes,
+           repeats);
+    for(size_t elem = 0; elem < formats_number; elem++) {
+        bench_tree_format_t *format = formats + elem;
+        printf("%-6s: " SZ_SP " bytes, store %.3f ms (%.1f MB/s), "
+               "load %.3f ms (%.1f MB/s)\n",
+               format->name,
+               format->size,
+               format->store_time * 1e3,
+               (double)format->size / format->store_time * 1e-6,
+               format->load_time  * 1e3,
+               (double)format->size / format->load_time  * 1e-6);
+    }
+    printf("binary vs text: store x%.2f, load x%.2f\n",
+           formats[0].store_time / formats[1].store_time,
+           formats[0].load_time  / formats[1].load_time);
+    printf("dag vs binary: size x%.2f, store x%.2f, load x%.2f\n",
+           (double)formats[1].size / (double)formats[2].size,
+           formats[1].store_time / formats[2].store_time,
+           formats[1].load_time  / formats[2].load_time);
+    //-----------------------------------------------------------------------//
+    // Trees loaded from all files are written without sharing and compared.
+    for(size_t elem = 1; elem < formats_number; elem++) {
+        _RETURN_IF_ERROR(bench_same_files(formats[0].check_file, formats[elem].check_file));
+    }
+    printf("loaded trees are identical\n");
+    for(size_t elem = 0; elem < formats_number; elem++) {
+        remove(formats[elem].tree_file);
+        remove(formats[elem].check_file);
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_store_time(language_t          *ctx,
+                                  bench_tree_format_t *format,
+                                  size_t               repeats) {
+    ctx->output_file = format->tree_file;
+    ctx->tree_format = format->format;
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        double start = bench_time_now();
+        _RETURN_IF_ERROR(write_tree(ctx));
+        double time  = bench_time_now() - start;
+        if(repeat == 0 || time < format->store_time) {
+            format->store_time = time;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    FILE *tree = fopen(format->tree_file, "rb");
+    if(tree == NULL) {
+        print_error("Error while opening '%s'.\n", format->tree_file);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    format->size = file_size(tree);
+    fclose(tree);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_load_time(bench_tree_format_t *format, size_t repeats) {
+    for(size_t repeat = 0; repeat < repeats; repeat++) {
+        double time = 0;
+        _RETURN_IF_ERROR(bench_load_tree(format->tree_file,
+                                         repeat == 0 ? format->check_file : NULL,
+                                         &time));
+        if(repeat == 0 || time < format->load_time) {
+            format->load_time = time;
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_load_tree(const char *tree_file,
+                                 const char *check_file,
+                                 double     *time) {
+    // Opening file is a part of loading, it is mapped for both formats.
+    language_t ctx = {};
+    ctx.input_file = tree_file;
+    double start = bench_time_now();
+    language_error_t error_code = read_tree(&ctx);
+    *time = bench_time_now() - start;
+    //-----------------------------------------------------------------------//
+    if(error_code == LANGUAGE_SUCCESS && check_file != NULL) {
+        ctx.output_file = check_file;
+        ctx.tree_format = TREE_FORMAT_BINARY;
+        error_code      = write_tree(&ctx);
+    }
+    nodes_storage_dtor(&ctx);
+    name_table_dtor   (&ctx);
+    input_close       (&ctx);
+    return error_code;
+}
+
+//===========================================================================//
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "colors.h"
+#include "utils.h"
+#include "frontend.h"
+#include "syntax_parser.h"
+#include "mapped_file.h"
+
+//===========================================================================//
+
+double bench_time_now(void) {
+    timespec time = {};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+//===========================================================================//
+
+size_t bench_get_size(int         argc,
+                      const char *argv[],
+                      int         position,
+                      size_t      default_value) {
+    if(position >= argc) {
+        return default_value;
+    }
+    //-----------------------------------------------------------------------//
+    char *end = NULL;
+    size_t value = strtoull(argv[position], &end, 10);
+    if(*end != '\0' || value == 0) {
+        return default_value;
+    }
+    return value;
+}
+
+//===========================================================================//
+
+language_error_t bench_write_program(const char *filename, size_t functions) {
+    return bench_write_library(filename, functions, functions);
+}
+
+//===========================================================================//
+
+language_error_t bench_write_library(const char *filename,
+                                     size_t      functions,
+                                     size_t      reachable) {
+    // Every function calls previous one and main calls the last reachable
+    // function, so the rest are dead.
+    FILE *output = fopen(filename, "wb");
+    if(output == NULL) {
+        print_error("Error while opening benchmark source file '%s'.\n",
+                    filename);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    char name    [BenchNameSize] = {};
+    char previous[BenchNameSize] = {};
+    fprintf(output, "var counter = 0;\n\n");
+    for(size_t function = 0; function < functions; function++) {
+        bench_function_name(name, function);
+        fprintf(output,
+                "func %s(var alpha, var beta) {\n"
+                "    /* synthetic function number " SZ_SP " */\n"
+                "    var gamma = alpha * beta + 3.5;\n"
+                "    counter = counter + 1;\n"
+                "    if(gamma > 10) {\n"
+                "        gamma = gamma - 1;\n"
+                "    }\n"
+                "    while(gamma < 100) {\n"
+                "        gamma = gamma * 2 + sqrt(beta);\n"
+                "    }\n",
+                name,
+                function);
+        if(function == 0) {
+            fprintf(output, "    return gamma;\n}\n\n");
+        }
+        else {
+            fprintf(output,
+                    "    return gamma + %s(alpha, gamma);\n}\n\n",
+                    previous);
+        }
+        bench_function_name(previous, function);
+    }
+    bench_function_name(name, reachable - 1);
+    //-----------------------------------------------------------------------//
+    fprintf(output,
+            "func main() {\n"
+            "    var x = 0;\n"
+            "    input(x);\n"
+            "    output(%s(x, x));\n"
+            "    return 0;\n"
+            "}\n",
+            name);
+    fclose(output);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_build_tree(language_t *ctx, const char *argv0) {
+    const char *frontend_argv[] = {argv0, "-i", BenchSourceFile};
+    int frontend_argc = sizeof(frontend_argv) / sizeof(frontend_argv[0]);
+    _RETURN_IF_ERROR(frontend_ctor(ctx, frontend_argc, frontend_argv));
+    _RETURN_IF_ERROR(parse_tokens(ctx));
+    _RETURN_IF_ERROR(parse_syntax(ctx));
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_same_files(const char *first, const char *second) {
+    mapped_file_t first_file  = {};
+    mapped_file_t second_file = {};
+    _RETURN_IF_ERROR(mapped_file_open(&first_file, first));
+    language_error_t error_code = mapped_file_open(&second_file, second);
+    if(error_code != LANGUAGE_SUCCESS) {
+        mapped_file_close(&first_file);
+        return error_code;
+    }
+    //-----------------------------------------------------------------------//
+    if(first_file.size != second_file.size ||
+       memcmp(first_file.data, second_file.data, first_file.size) != 0) {
+        print_error("Files '%s' and '%s' differ.\n", first, second);
+        error_code = LANGUAGE_TREE_ERROR;
+    }
+    mapped_file_close(&first_file);
+    mapped_file_close(&second_file);
+    return error_code;
+}
+
+//===========================================================================//
+
+void bench_function_name(char *name, size_t index) {
+    size_t position = 0;
+    name[position++] = 'f';
+    name[position++] = '_';
+    do {
+        name[position++] = (char)('a' + index % 26);
+        index /= 26;
+    } while(index != 0 && position < BenchNameSize - 1);
+    name[position] = '\0';
+}
+
+//===========================================================================//
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "frontend.h"
+#include "middleend.h"
+#include "name_table.h"
+#include "mapped_file.h"
+#include "utils.h"
+#include "colors.h"
+
+//===========================================================================//
+
+static const char *const BenchWorklistTree     = "logs/bench.worklist.tree";
+static const size_t      BenchWorklistDepths[] = {1, 4, 16, 64};
+
+//===========================================================================//
+
+static language_error_t bench_write_nested   (const char *filename,
+                                              size_t      functions,
+                                              size_t      depth);
+
+static language_error_t bench_worklist_once  (size_t      depth,
+                                              size_t      repeats,
+                                              const char *argv0,
+                                              size_t      functions);
+
+//===========================================================================//
+
+language_error_t bench_worklist(int argc, const char *argv[]) {
+    size_t functions = bench_get_size(argc, argv, 2, BenchDefaultFunctions / 10);
+    size_t repeats   = bench_get_size(argc, argv, 3, BenchDefaultRepeats       );
+    printf("worklist: " SZ_SP " functions, best of " SZ_SP "\n",
+           functions,
+           repeats);
+    //-----------------------------------------------------------------------//
+    // Every level of nesting can be folded only after the level under it,
+    // so time per node shows whether optimization depends on nesting.
+    size_t depths_number = sizeof(BenchWorklistDepths) / sizeof(BenchWorklistDepths[0]);
+    for(size_t elem = 0; elem < depths_number; elem++) {
+        _RETURN_IF_ERROR(bench_worklist_once(BenchWorklistDepths[elem], repeats, argv[0], functions));
+    }
+    remove(BenchWorklistTree);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_worklist_once(size_t      depth,
+                                     size_t      repeats,
+                                     const char *argv0,
+                                     size_t      functions) {
+    _RETURN_IF_ERROR(bench_write_nested(BenchSourceFile, functions, depth));
+    language_t       ctx        = {};
+    language_error_t error_code = bench_build_tree(&ctx, argv0);
+    if(error_code == LANGUAGE_SUCCESS) {
+        ctx.output_file = BenchWorklistTree;
+        ctx.tree_format = TREE_FORMAT_BINARY;
+        error_code      = write_tree(&ctx);
+    }
+    frontend_dtor(&ctx);
+    _RETURN_IF_ERROR(error_code);
+    //-----------------------------------------------------------------------//
+    double           best_time = 0;
+    size_t           nodes     = 0;
+    middleend_info_t info      = {};
+    for(size_t repeat = 0; repeat < repeats && error_code == LANGUAGE_SUCCESS; repeat++) {
+        ctx             = {};
+        ctx.input_file  = BenchWorklistTree;
+        ctx.tree_format = TREE_FORMAT_BINARY;
+        error_code      = read_tree(&ctx);
+        if(error_code == LANGUAGE_SUCCESS) {
+            double start = bench_time_now();
+            error_code   = optimize_tree(&ctx);
+            double time  = bench_time_now() - start;
+            if(repeat == 0 || time < best_time) {
+                best_time = time;
+            }
+        }
+        nodes = ctx.nodes.size;
+        info  = ctx.middleend_info;
+        nodes_storage_dtor(&ctx);
+        name_table_dtor   (&ctx);
+        input_close       (&ctx);
+    }
+    _RETURN_IF_ERROR(error_code);
+    //-----------------------------------------------------------------------//
+    printf("depth " SZ_SP ": " SZ_SP " nodes, optimize %.3f ms, %.1f ns per node, "
+           "visits per node: folding %.2f, simplification %.2f\n",
+           depth,
+           nodes,
+           best_time * 1e3,
+           best_time * 1e9 / (double)nodes,
+           (double)info.folding_visits  / (double)nodes,
+           (double)info.simplify_visits / (double)nodes);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t bench_write_nested(const char *filename,
+                                    size_t      functions,
+                                    size_t      depth) {
+    // Product with zero is simplified to a number, then every level is
+    // folded after the level under it.
+    FILE *output = fopen(filename, "wb");
+    if(output == NULL) {
+        print_error("Error while opening benchmark source file '%s'.\n",
+                    filename);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    char name[BenchNameSize] = {};
+    for(size_t function = 0; function < functions; function++) {
+        bench_function_name(name, function);
+        fprintf(output, "func %s(var alpha) {\n    var gamma = ", name);
+        for(size_t level = 0; level < depth; level++) {
+            fprintf(output, "1 + (");
+        }
+        fprintf(output, "alpha * 0");
+        for(size_t level = 0; level < depth; level++) {
+            fputc(')', output);
+        }
+        fprintf(output, ";\n    return gamma;\n}\n\n");
+    }
+    //-----------------------------------------------------------------------//
+    fprintf(output,
+            "func main() {\n"
+            "    var x = 0;\n"
+            "    input(x);\n"
+            "    output(%s(x));\n"
+            "    return 0;\n"
+            "}\n",
+            name);
+    fclose(output);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
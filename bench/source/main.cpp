@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "bench.h"
+#include "colors.h"
+
+//===========================================================================//
+
+static const bench_mode_t BenchModes[] = {
+    {"lexer"      , bench_lexer      , "frontend lexer throughput, tokens per second"},
+    {"threads"    , bench_threads    , "parallel lexer and parser scaling, threads"  },
+    {"symbols"    , bench_symbols    , "name resolution scaling with program size"   },
+    {"numbers"    , bench_numbers    , "number parsing on sample trees, libc vs own" },
+    {"incremental", bench_incremental, "function cache, full vs cached rebuilds"     },
+    {"trees"      , bench_trees      , "tree files store and load, text, binary, dag"},
+    {"output"     , bench_output     , "text writers throughput, stdio vs output"    },
+    {"lazy"       , bench_lazy       , "binary tree load, whole vs reachable from main"},
+    {"build"      , bench_build      , "build cache, full build vs miss vs hit"      },
+    {"dag"        , bench_dag        , "middleend on shared subtrees, tree vs dag"   },
+    {"worklist"   , bench_worklist   , "middleend rewrites with nesting depth"       },
+};
+
+//===========================================================================//
+
+static int print_usage(const char *program);
+
+//===========================================================================//
+
+int main(int argc, const char *argv[]) {
+    if(argc < 2) {
+        return print_usage(argv[0]);
+    }
+    if(verify_keywords() != LANGUAGE_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+    //-----------------------------------------------------------------------//
+    size_t modes_number = sizeof(BenchModes) / sizeof(BenchModes[0]);
+    for(size_t mode = 0; mode < modes_number; mode++) {
+        if(strcmp(BenchModes[mode].name, argv[1]) == 0) {
+            if(BenchModes[mode].run(argc, argv) != LANGUAGE_SUCCESS) {
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    print_error("Unknown benchmark '%s'.\n", argv[1]);
+    return print_usage(argv[0]);
+}
+
+//===========================================================================//
+
+int print_usage(const char *program) {
+    printf("usage: %s <benchmark> [size] [repeats]\n", program);
+    size_t modes_number = sizeof(BenchModes) / sizeof(BenchModes[0]);
+    for(size_t mode = 0; mode < modes_number; mode++) {
+        printf("    %-12s %s\n",
+               BenchModes[mode].name,
+               BenchModes[mode].description);
+    }
+    return EXIT_FAILURE;
+}
+
+//===========================================================================//
@@ -21,52 +21,55 @@ language_error_t ir_remove_node             (language_t        *ctx,
                                              ir_node_t         *node);
 
 language_error_t x86_compile_subtree        (language_t        *ctx,
-                                             language_node_t   *root);
+                                             uint32_t           root);
+
+language_error_t x86_compile_main_call      (language_t        *ctx,
+                                             size_t             main_index);
 
 language_error_t x86_assemble_two_args      (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_one_arg       (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_comparison    (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_statements    (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_if            (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_while         (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_return        (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_params_line   (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_new_var       (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_new_func      (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_assignment    (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_in            (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_out           (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_call          (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 language_error_t x86_assemble_exit          (language_t        *ctx,
-                                             language_node_t   *node);
+                                             visit_frame_t     *frame);
 
 extern const char   *StdInName;
 extern const size_t  StdInLen;
@@ -0,0 +1,30 @@
+#ifndef BUILD_CACHE_H
+#define BUILD_CACHE_H
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Whole-program build cache, enabled by '-b DIR'. Output of a stage is
+   stored as DIR/objects/<key>, where key is SHA-256 of the running
+   executable, stdlib, flags which change the output (machine and tree
+   format) and the input bytes. On lookup the object is copied to the
+   output file and the stage stops. Objects are written to temporary files
+   and renamed, so parallel builds never see partial objects and need no
+   locks. Hits update modification time of the object, after every store
+   the oldest objects are removed until the cache fits '-l MB' (256 MB by
+   default). Hits and misses are counted in DIR/hits and DIR/misses as
+   fixed width decimal numbers updated under file lock. Cache problems are
+   reported as warnings and the output is built as without cache.         */
+
+//===========================================================================//
+
+language_error_t build_cache_lookup (language_t *ctx);
+
+language_error_t build_cache_store  (language_t *ctx);
+
+//===========================================================================//
+
+#endif
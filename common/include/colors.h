@@ -2,6 +2,7 @@
 #define COLORS_H
 
 #include <stdarg.h>
+#include <stdio.h>
 
 enum color_t {
     RED_TEXT    ,
@@ -44,4 +45,6 @@ int  color_vprintf (color_t      color,
 
 int  print_error   (const char *message, ...);
 
+void color_output  (FILE       *stream);
+
 #endif
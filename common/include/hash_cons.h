@@ -0,0 +1,67 @@
+#ifndef HASH_CONS_H
+#define HASH_CONS_H
+
+//===========================================================================//
+
+#include <stdint.h>
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Hash-consing of pure expressions: numbers, variables and arithmetic
+   operations over them. Nodes with equal type, value and children get one
+   canonical record, so structurally identical subtrees are written once.
+   Keys are raw bits, children are record numbers of the binary tree
+   writer. New scope forgets all entries without clearing the table.     */
+
+//===========================================================================//
+
+struct hash_cons_entry_t {
+    uint64_t                         scope;
+    uint64_t                         type;
+    uint64_t                         value;
+    uint64_t                         left;
+    uint64_t                         right;
+    uint64_t                         canonical;
+};
+
+//---------------------------------------------------------------------------//
+
+struct hash_cons_t {
+    hash_cons_entry_t               *entries;
+    size_t                           capacity;
+    size_t                           size;
+    uint64_t                         scope;
+    size_t                           shared;
+};
+
+//===========================================================================//
+
+language_error_t   hash_cons_ctor    (hash_cons_t             *table,
+                                      size_t                   capacity);
+
+language_error_t   hash_cons_dtor    (hash_cons_t             *table);
+
+void               hash_cons_scope   (hash_cons_t             *table);
+
+language_error_t   hash_cons_insert  (hash_cons_t             *table,
+                                      const hash_cons_entry_t *key,
+                                      hash_cons_entry_t      **entry);
+
+hash_cons_entry_t *hash_cons_find    (hash_cons_t             *table,
+                                      const hash_cons_entry_t *key);
+
+//---------------------------------------------------------------------------//
+
+bool               hash_cons_is_pure (language_t              *ctx,
+                                      const language_node_t   *node);
+
+void               hash_cons_key     (const language_node_t   *node,
+                                      hash_cons_entry_t       *key);
+
+//===========================================================================//
+
+#endif
@@ -17,6 +17,10 @@ language_error_t dump_ctor  (language_t    *ctx,
 language_error_t dump_tree  (language_t    *ctx,
                              const char    *format, ...);
 
+language_error_t dump_message
+                            (language_t    *ctx,
+                             const char    *format, ...);
+
 language_error_t dump_dtor  (language_t    *ctx);
 
 language_error_t dump_ir    (language_t    *ctx);
@@ -5,6 +5,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 //===========================================================================//
 
@@ -53,6 +54,12 @@ enum language_error_t {
     LANGUAGE_UNEXPECTED_MACHINE      = 40,
     LANGUAGE_BROKEN_ASM_TABLE        = 41,
     LANGUAGE_READING_STDLIB_ERROR    = 42,
+    LANGUAGE_THREAD_ERROR            = 43,
+    LANGUAGE_CACHE_OUTDATED          = 44,
+    LANGUAGE_CACHE_ERROR             = 45,
+    LANGUAGE_OUTPUT_FORMAT_ERROR     = 46,
+    LANGUAGE_OUTPUT_WRITING_ERROR    = 47,
+    LANGUAGE_BUILD_CACHE_HIT         = 48,
 };
 
 //---------------------------------------------------------------------------//
@@ -163,7 +170,8 @@ enum ir_instr_t {
     IR_INSTR_SQRT                    = 19,
     IR_INSTR_NOT                     = 20,
     IR_INSTR_PUSH_XMM                = 21,
-    IR_INSTR_POP_XMM                 = 22
+    IR_INSTR_POP_XMM                 = 22,
+    IR_INSTR_JMP_FUNC                = 23,
 };
 
 //---------------------------------------------------------------------------//
@@ -192,6 +200,15 @@ enum machine_t {
     MACHINE_ELF_X86                  = 3,
 };
 
+//---------------------------------------------------------------------------//
+
+enum tree_format_t {
+    TREE_FORMAT_TEXT                 = 1,
+    TREE_FORMAT_BINARY               = 2,
+    TREE_FORMAT_DAG                  = 3,
+    TREE_FORMAT_STREAM               = 4,
+};
+
 //===========================================================================//
 
 union value_t {
@@ -210,12 +227,15 @@ struct source_info_t {
 
 //---------------------------------------------------------------------------//
 
+/* Node takes 16 bytes. Value is NaN-boxed: numbers keep bits of double,
+   other nodes keep NodeTagBase + type in the high word, which is a NaN
+   never stored as a number, and opcode or identifier in the low word.
+   Children are indices in nodes storage, NodeNone if there is no child.
+   Source info is kept aside in nodes storage, see nodes_storage_source(). */
 struct language_node_t {
-    source_info_t                    source_info;
-    node_type_t                      type;
-    value_t                          value;
-    language_node_t                 *left;
-    language_node_t                 *right;
+    uint64_t                         value;
+    uint32_t                         left;
+    uint32_t                         right;
 };
 
 //---------------------------------------------------------------------------//
@@ -223,6 +243,7 @@ struct language_node_t {
 struct identifier_t {
     const char                      *name;
     size_t                           length;
+    size_t                           symbol;
     identifier_type_t                type;
     size_t                           parameters_number;
     bool                             is_defined;
@@ -243,30 +264,112 @@ struct name_t {
 
 //---------------------------------------------------------------------------//
 
+struct name_binding_t {
+    size_t                           function;
+    size_t                           variable;
+};
+
+//---------------------------------------------------------------------------//
+
+struct variable_entry_t {
+    size_t                           nt_index;
+    size_t                           shadowed;
+};
+
+//---------------------------------------------------------------------------//
+
 struct name_table_t {
     identifier_t                    *identifiers;
     size_t                           size;
     size_t                           capacity;
-    size_t                          *stack;
+    variable_entry_t                *stack;
     size_t                           stack_size;
+    size_t                           stack_capacity;
+    size_t                          *scopes;
+    size_t                           scopes_size;
+    size_t                           scopes_capacity;
+    name_binding_t                  *bindings;
+    size_t                           bindings_capacity;
     name_t                          *used_names;
     size_t                           used_names_size;
+    size_t                           used_names_capacity;
+    size_t                          *used_names_buckets;
+    size_t                           used_names_buckets_capacity;
+    char                           **owned_names;
+    size_t                           owned_names_size;
+    size_t                           owned_names_capacity;
 };
 
 //---------------------------------------------------------------------------//
 
-struct nodes_storage_t {
-    language_node_t                 *nodes;
+struct mapped_file_t {
+    char                            *data;
+    size_t                           size;
+    size_t                           mapping_size;
+    size_t                           capacity;
+    int                              descriptor;
+    bool                             is_streaming;
+    bool                             owns_descriptor;
+};
+
+//---------------------------------------------------------------------------//
+
+struct tree_stream_t {
+    size_t                           offset;
+    uint32_t                         last;
+    bool                             is_reading;
+    char                           **blocks;
+    size_t                           blocks_number;
+    size_t                           blocks_capacity;
+    FILE                            *output;
+    bool                            *sent;
+    size_t                           sent_capacity;
+    size_t                           frames;
+};
+
+//---------------------------------------------------------------------------//
+
+struct output_t {
+    char                            *data;
     size_t                           size;
     size_t                           capacity;
 };
 
 //---------------------------------------------------------------------------//
 
+static const size_t BuildCacheKeyLength = 64;
+
+//---------------------------------------------------------------------------//
+
+struct build_cache_t {
+    const char                      *directory;
+    size_t                           limit;
+    char                             key[BuildCacheKeyLength + 1];
+    bool                             is_enabled;
+};
+
+//---------------------------------------------------------------------------//
+
+struct nodes_storage_t {
+    language_node_t                **chunks;
+    source_info_t                  **sources;
+    size_t                           chunks_number;
+    size_t                           chunks_capacity;
+    size_t                           size;
+    size_t                           attached_chunks;
+};
+
+//---------------------------------------------------------------------------//
+
+struct function_cache_t;
+
+//---------------------------------------------------------------------------//
+
 struct frontend_info_t {
     language_node_t                 *position;
+    size_t                           position_index;
     size_t                           current_line;
-    size_t                           used_locals;
+    function_cache_t                *cache;
 };
 
 //---------------------------------------------------------------------------//
@@ -315,6 +418,7 @@ struct backend_info_t {
     size_t                           used_globals;
     size_t                           used_labels;
     size_t                           used_locals;
+    size_t                           max_params;
     int                              scope;
     FILE                            *output;
     ir_node_t                       *nodes;
@@ -324,15 +428,16 @@ struct backend_info_t {
     fixup_t                         *fixups;
     size_t                           fixups_size;
     size_t                           fixups_capacity;
-    uint8_t                         *buffer;
-    size_t                           buffer_size;
-    size_t                           buffer_capacity;
+    output_t                         buffer;
+    size_t                           std_in_index;
+    size_t                           std_out_index;
 };
 
 //---------------------------------------------------------------------------//
 
 struct frontstart_info_t {
     FILE                            *output;
+    output_t                         buffer;
     int                              depth;
 };
 
@@ -340,6 +445,14 @@ struct frontstart_info_t {
 
 struct middleend_info_t {
     size_t                           changes_counter;
+    size_t                           shared_subtrees;
+    size_t                           folding_visits;
+    size_t                           simplify_visits;
+    size_t                           propagated_constants;
+    size_t                           eliminated_statements;
+    size_t                           eliminated_functions;
+    size_t                           inlined_calls;
+    size_t                           tail_calls;
 };
 
 //---------------------------------------------------------------------------//
@@ -357,17 +470,26 @@ struct language_t {
     dump_info_t                      dump_info;
     name_table_t                     name_table;
     nodes_storage_t                  nodes;
-    language_node_t                 *root;
+    uint32_t                         root;
+    mapped_file_t                    input_map;
     char                            *input;
     size_t                           input_size;
     const char                      *input_position;
+    tree_stream_t                    tree_stream;
     frontend_info_t                  frontend_info;
     backend_info_t                   backend_info;
     frontstart_info_t                frontstart_info;
     middleend_info_t                 middleend_info;
     const char                      *input_file;
     const char                      *output_file;
+    const char                      *cache_file;
+    build_cache_t                    build_cache;
     machine_t                        machine_flag;
+    tree_format_t                    tree_format;
+    size_t                           threads_number;
+    bool                             save_temps;
+    size_t                           inline_limit;
+    bool                             has_inline_limit;
 };
 
 //===========================================================================//
@@ -398,14 +520,25 @@ struct language_t {
 //===========================================================================//
 
 language_error_t nodes_storage_ctor (language_t       *ctx,
-                                     size_t            capacity);
+                                     size_t            capacity,
+                                     bool              with_sources);
 
 language_error_t nodes_storage_add  (language_t       *ctx,
                                      node_type_t       type,
                                      value_t           value,
                                      const char       *name,
                                      size_t            length,
-                                     language_node_t **output);
+                                     uint32_t         *output);
+
+language_error_t nodes_storage_reserve
+                                    (language_t       *ctx,
+                                     size_t            number,
+                                     size_t           *first);
+
+language_error_t nodes_storage_attach
+                                    (language_t       *ctx,
+                                     language_node_t  *nodes,
+                                     size_t            number);
 
 language_error_t nodes_storage_dtor (language_t       *ctx);
 
@@ -415,12 +548,21 @@ language_error_t parse_flags        (language_t       *ctx,
 
 language_error_t read_tree          (language_t       *ctx);
 
+language_error_t read_tree_reachable(language_t       *ctx);
+
+language_error_t read_tree_streaming(language_t       *ctx);
+
 language_error_t write_tree         (language_t       *ctx);
 
+FILE            *tree_file_open     (language_t       *ctx);
+
+void             tree_file_close    (FILE             *output);
+
 language_error_t verify_keywords    (void);
 
 //===========================================================================//
 
+#include "tree_visitor.h"
 #include "asm_x86.h"
 #include "asm_spu.h"
 #include "to_source.h"
@@ -432,20 +574,20 @@ struct keyword_t {
     const char                      *name;
     size_t                           length;
     operation_t                      code;
-    language_error_t               (*asm_spu)(language_t *, language_node_t *);
-    language_error_t               (*asm_x86)(language_t *, language_node_t *);
+    language_error_t               (*asm_spu)(language_t *, visit_frame_t *);
+    language_error_t               (*asm_x86)(language_t *, visit_frame_t *);
     const char                      *assembler_command;
     bool                             is_expression_element;
     language_error_t               (*to_source)(language_t *, language_node_t *);
     size_t                           priority;
-    language_error_t               (*simplifier)(language_t *,language_node_t **);
+    language_error_t               (*simplifier)(language_t *, uint32_t *);
 };
 
 //===========================================================================//
 
 #define STR_LEN(_string) (_string), sizeof(_string) - 1
 
-static const keyword_t KeyWords[] = {
+static constexpr keyword_t KeyWords[] = {
     {/*______________________________THIS_FIELD_MUST_BE_HERE_AS_IT_IS_FOR_UNKNOWN_COMMAND______________________________*/},
     {STR_LEN("+"        ), OPERATION_ADD          , spu_assemble_two_args   , x86_assemble_two_args   , "add" , false, to_source_math_op        , 3, simplify_add},
     {STR_LEN("-"        ), OPERATION_SUB          , spu_assemble_two_args   , x86_assemble_two_args   , "sub" , false, to_source_math_op        , 3, simplify_sub},
@@ -490,6 +632,117 @@ static const keyword_t KeyWords[] = {
 
 static const size_t PoisonIndex = (size_t)(-1);
 
+//---------------------------------------------------------------------------//
+
+/* Nodes are stored in fixed size chunks, so pointers to nodes stay valid
+   when storage grows and the node with index i is found by shift and mask. */
+static const size_t NodesChunkShift = 10;
+static const size_t NodesChunkSize  = (size_t)1 << NodesChunkShift;
+
+//---------------------------------------------------------------------------//
+
+static const uint32_t NodeNone         = UINT32_MAX;
+static const uint32_t NodeTagBase      = 0xFFFFFFF0u;
+static const uint64_t NodeCanonicalNaN = 0x7FF8000000000000ull;
+static const uint64_t NodeExponentMask = 0x7FF0000000000000ull;
+static const uint64_t NodeMantissaMask = 0x000FFFFFFFFFFFFFull;
+static const uint64_t NodePayloadMask  = 0x00000000FFFFFFFFull;
+
+//===========================================================================//
+
+static inline language_node_t *nodes_storage_get(language_t *ctx, size_t index) {
+    if(index == NodeNone) {
+        return NULL;
+    }
+    return ctx->nodes.chunks[index >> NodesChunkShift] +
+           (index & (NodesChunkSize - 1));
+}
+
+//---------------------------------------------------------------------------//
+
+static inline source_info_t *nodes_storage_source(language_t *ctx, size_t index) {
+    if(ctx->nodes.sources == NULL || index == NodeNone) {
+        return NULL;
+    }
+    return ctx->nodes.sources[index >> NodesChunkShift] +
+           (index & (NodesChunkSize - 1));
+}
+
+//---------------------------------------------------------------------------//
+
+static inline language_node_t *node_left(language_t *ctx, const language_node_t *node) {
+    return nodes_storage_get(ctx, node->left);
+}
+
+//---------------------------------------------------------------------------//
+
+static inline language_node_t *node_right(language_t *ctx, const language_node_t *node) {
+    return nodes_storage_get(ctx, node->right);
+}
+
+//---------------------------------------------------------------------------//
+
+static inline node_type_t node_type(const language_node_t *node) {
+    uint32_t tag = (uint32_t)(node->value >> 32);
+    if(tag <= NodeTagBase) {
+        return NODE_TYPE_NUMBER;
+    }
+    return (node_type_t)(tag - NodeTagBase);
+}
+
+//---------------------------------------------------------------------------//
+
+static inline double node_number(const language_node_t *node) {
+    double number = 0;
+    memcpy(&number, &node->value, sizeof(number));
+    return number;
+}
+
+//---------------------------------------------------------------------------//
+
+static inline operation_t node_opcode(const language_node_t *node) {
+    return (operation_t)(node->value & NodePayloadMask);
+}
+
+//---------------------------------------------------------------------------//
+
+static inline size_t node_identifier(const language_node_t *node) {
+    return node->value & NodePayloadMask;
+}
+
+//---------------------------------------------------------------------------//
+
+static inline value_t node_value(const language_node_t *node) {
+    node_type_t type = node_type(node);
+    if(type == NODE_TYPE_NUMBER) {
+        return NUMBER(node_number(node));
+    }
+    if(type == NODE_TYPE_OPERATION) {
+        return OPCODE(node_opcode(node));
+    }
+    return IDENT(node_identifier(node));
+}
+
+//---------------------------------------------------------------------------//
+
+static inline void node_set_value(language_node_t *node,
+                                  node_type_t      type,
+                                  value_t          value) {
+    // NaN numbers become one canonical NaN, so they never look like tags.
+    if(type == NODE_TYPE_NUMBER) {
+        memcpy(&node->value, &value.number, sizeof(node->value));
+        if((node->value & NodeExponentMask) == NodeExponentMask &&
+           (node->value & NodeMantissaMask) != 0) {
+            node->value = NodeCanonicalNaN;
+        }
+        return;
+    }
+    uint64_t payload = type == NODE_TYPE_OPERATION ? (uint64_t)value.opcode :
+                                                     value.identifier;
+    node->value = ((uint64_t)(NodeTagBase + (uint32_t)type) << 32) |
+                  (payload & NodePayloadMask);
+}
+
 //===========================================================================//
 
 #endif
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Regular files are mapped to memory with at least one zero byte after the
+   data, so readers can rely on a terminating '\0'. Pipes, terminals and
+   stdin (filename "-" or NULL) are read to the heap buffer instead. Both
+   are private copies, writes to the data never reach the file. Streams
+   opened by mapped_file_open_stream are read only when mapped_file_fill
+   asks for more than was read, so readers use the beginning of a pipe
+   while its writer is still running. Reserve makes at least 'capacity'
+   bytes writable with zeroes after the data, with 'populate' all pages of
+   the data are copied at once.                                           */
+
+//===========================================================================//
+
+language_error_t mapped_file_open   (mapped_file_t *file,
+                                     const char    *filename);
+
+language_error_t mapped_file_open_stream
+                                    (mapped_file_t *file,
+                                     const char    *filename);
+
+language_error_t mapped_file_fill   (mapped_file_t *file,
+                                     size_t         size);
+
+language_error_t mapped_file_reserve(mapped_file_t *file,
+                                     const char    *filename,
+                                     size_t         capacity,
+                                     bool           populate);
+
+language_error_t mapped_file_close  (mapped_file_t *file);
+
+language_error_t input_open         (language_t    *ctx);
+
+language_error_t input_close        (language_t    *ctx);
+
+//===========================================================================//
+
+#endif
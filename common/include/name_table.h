@@ -11,6 +11,14 @@
 
 //===========================================================================//
 
+static const size_t NameTableDefaultCapacity = 64;
+static const size_t UsedNamesDefaultCapacity = 256;
+static const size_t VariablesStackCapacity   = 64;
+static const size_t UsedNamesBucketsCapacity = 512;
+static const size_t FreshNameSuffixSize      = 16;
+
+//===========================================================================//
+
 language_error_t name_table_ctor        (language_t         *ctx,
                                          size_t             capacity);
 
@@ -20,6 +28,15 @@ language_error_t name_table_add         (language_t        *ctx,
                                          size_t            *output,
                                          identifier_type_t  type);
 
+language_error_t name_table_add_fresh   (language_t        *ctx,
+                                         name_t             prefix,
+                                         name_t             name,
+                                         size_t            *output,
+                                         identifier_type_t  type);
+
+language_error_t name_table_reserve     (language_t        *ctx,
+                                         size_t             capacity);
+
 language_error_t name_table_dtor        (language_t        *ctx);
 
 language_error_t set_memory_addr        (language_t        *ctx,
@@ -34,6 +51,11 @@ language_error_t used_names_add         (language_t        *ctx,
                                          size_t             length,
                                          size_t            *output);
 
+language_error_t used_names_find        (language_t        *ctx,
+                                         const char        *name,
+                                         size_t             length,
+                                         size_t            *output);
+
 language_error_t used_names_dtor        (language_t        *ctx);
 
 language_error_t variables_stack_ctor   (language_t        *ctx,
@@ -47,6 +69,23 @@ language_error_t variables_stack_remove (language_t        *ctx,
 
 language_error_t variables_stack_dtor   (language_t        *ctx);
 
+language_error_t variables_scope_enter  (language_t        *ctx);
+
+language_error_t variables_scope_leave  (language_t        *ctx);
+
+language_error_t name_table_bind_function
+                                        (language_t        *ctx,
+                                         size_t             index);
+
+language_error_t name_table_find        (language_t        *ctx,
+                                         size_t             symbol,
+                                         size_t            *index);
+
+language_error_t name_table_find_function
+                                        (language_t        *ctx,
+                                         size_t             symbol,
+                                         size_t            *index);
+
 //===========================================================================//
 
 #endif
@@ -23,8 +23,8 @@ bool             is_number_eq       (language_node_t   *node,
 language_error_t set_val            (language_node_t   *node,
                                      node_type_t        type,
                                      value_t            value,
-                                     language_node_t   *left,
-                                     language_node_t   *right);
+                                     uint32_t           left,
+                                     uint32_t           right);
 
 
 //===========================================================================//
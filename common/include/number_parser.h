@@ -0,0 +1,27 @@
+#ifndef NUMBER_PARSER_H
+#define NUMBER_PARSER_H
+
+//===========================================================================//
+
+#include <stddef.h>
+
+//===========================================================================//
+
+/* Locale independent parsers for decimal numbers. Both return the position
+   right after the number or NULL if there is no number at 'position'.
+   parse_double is exact: decimals that fit 53 bits of mantissa and powers
+   of ten up to 1e22 are converted with one correctly rounded operation,
+   everything else (long mantissas, huge exponents, hex, inf and nan) is
+   passed to strtod.                                                      */
+
+//===========================================================================//
+
+const char *parse_size   (const char *position,
+                          size_t     *value);
+
+const char *parse_double (const char *position,
+                          double     *value);
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+//===========================================================================//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Buffered output shared by tree, source, SPU and NASM writers. Text is
+   collected in one growable buffer and written to file by one write() in
+   output_flush(). Numbers are converted with std::to_chars: integers
+   directly into the buffer and doubles as shortest digits which read back
+   to the same value, laid out as %g does with precision of at least six
+   digits, so values which fit into %lg are written exactly as before.
+   output_format() understands subset of printf: flags '0' and '-', width
+   and precision as numbers or '*', length modifiers and conversions d, i,
+   u, x, c, s, g (shortest digits, so without precision) and %%.          */
+
+//===========================================================================//
+
+language_error_t output_reserve      (output_t   *output,
+                                      size_t      size);
+
+language_error_t output_write        (output_t   *output,
+                                      const void *data,
+                                      size_t      size);
+
+language_error_t output_char         (output_t   *output,
+                                      char        symbol);
+
+language_error_t output_string       (output_t   *output,
+                                      const char *string,
+                                      size_t      length);
+
+language_error_t output_fill         (output_t   *output,
+                                      char        symbol,
+                                      size_t      number);
+
+language_error_t output_unsigned     (output_t   *output,
+                                      uint64_t    value,
+                                      size_t      width);
+
+language_error_t output_signed       (output_t   *output,
+                                      int64_t     value);
+
+language_error_t output_hex          (output_t   *output,
+                                      uint64_t    value);
+
+language_error_t output_double       (output_t   *output,
+                                      double      value);
+
+language_error_t output_double_fixed (output_t   *output,
+                                      double      value);
+
+language_error_t output_format       (output_t   *output,
+                                      const char *format, ...)
+                                      __attribute__((format(printf, 2, 3)));
+
+language_error_t output_vformat      (output_t   *output,
+                                      const char *format,
+                                      va_list     args)
+                                      __attribute__((format(printf, 2, 0)));
+
+language_error_t output_flush        (output_t   *output,
+                                      FILE       *file);
+
+language_error_t output_dtor         (output_t   *output);
+
+//===========================================================================//
+
+#endif
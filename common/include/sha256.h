@@ -0,0 +1,41 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+//===========================================================================//
+
+#include <stdint.h>
+#include <stddef.h>
+
+//===========================================================================//
+
+/* SHA-256 (FIPS 180-4) for keys of the build cache. Data is given by parts
+   with sha256_update(), digest is written by sha256_final().             */
+
+//===========================================================================//
+
+static const size_t Sha256DigestSize = 32;
+static const size_t Sha256BlockSize  = 64;
+
+//===========================================================================//
+
+struct sha256_t {
+    uint32_t                         state[8];
+    uint8_t                          block[Sha256BlockSize];
+    size_t                           block_size;
+    uint64_t                         length;
+};
+
+//===========================================================================//
+
+void sha256_ctor   (sha256_t   *sha);
+
+void sha256_update (sha256_t   *sha,
+                    const void *data,
+                    size_t      size);
+
+void sha256_final  (sha256_t   *sha,
+                    uint8_t    *digest);
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef TREE_BINARY_H
+#define TREE_BINARY_H
+
+//===========================================================================//
+
+#include <stdio.h>
+#include <stdint.h>
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Binary tree file: header, name table records, names blob padded to 8
+   bytes, function index and node records in postorder. Node records are
+   language_node_t as they are in memory: NaN-boxed value and absolute
+   indices of children records (NodeNone if there is no child, children
+   always precede their parent), so the file is mapped as a private
+   copy-on-write memory and used as the first chunks of nodes storage
+   after records are checked, without relocation. Several parents
+   may point to one record, so the file stores a DAG: with '-f dag' equal
+   pure subtrees of one top level statement are written once, with
+   '-f binary' every node has its own record. Definitions of the top level
+   statements chain take consecutive ranges of records and the chain
+   itself is at the end. Function index has one record for each function
+   definition with its name and the range of its records, so readers
+   which need only functions reachable from main check just them and
+   leave pages of other functions untouched. Readers detect format by
+   magic.
+
+   Stream tree ('-f stream') is written by top level statements, so it is
+   read from a pipe while its writer is still making later statements.
+   After header every statement is one frame: names which its nodes use
+   and which were not sent before, each with its name table index, names
+   blob padded to 8 bytes and node records of the statement in postorder
+   with children indices relative to the frame. The last record is the
+   statements chain node, readers link it after the previous one. Frame
+   without nodes ends the stream and carries all names not sent yet, so
+   the name table of the reader is the same as of the writer.             */
+
+//===========================================================================//
+
+struct tree_header_t {
+    char                             magic[8];
+    uint64_t                         version;
+    uint64_t                         names_number;
+    uint64_t                         names_size;
+    uint64_t                         functions_number;
+    uint64_t                         nodes_number;
+    uint64_t                         root;
+    uint64_t                         node_size;
+};
+
+//---------------------------------------------------------------------------//
+
+struct tree_name_t {
+    uint32_t                         offset;
+    uint32_t                         length;
+    uint32_t                         parameters;
+    uint8_t                          type;
+    uint8_t                          is_global;
+    uint16_t                         reserved;
+};
+
+//---------------------------------------------------------------------------//
+
+struct tree_function_t {
+    uint64_t                         identifier;
+    uint64_t                         first;
+    uint64_t                         size;
+};
+
+//---------------------------------------------------------------------------//
+
+struct tree_stream_header_t {
+    char                             magic[8];
+    uint64_t                         version;
+    uint64_t                         node_size;
+};
+
+//---------------------------------------------------------------------------//
+
+struct tree_frame_t {
+    uint64_t                         names_number;
+    uint64_t                         names_size;
+    uint64_t                         nodes_number;
+};
+
+//---------------------------------------------------------------------------//
+
+struct tree_frame_name_t {
+    uint64_t                         index;
+    tree_name_t                      name;
+};
+
+//===========================================================================//
+
+static const char     TreeMagic[8]       = {'K', 'V', 'M', 'T', 'R', 'E', 'E', '\0'};
+static const uint64_t TreeVersion        = 5;
+static const char     TreeStreamMagic[8] = {'K', 'V', 'M', 'S', 'T', 'R', 'M', '\0'};
+static const uint64_t TreeStreamVersion  = 1;
+
+//===========================================================================//
+
+bool             is_binary_tree    (const char *data,
+                                    size_t      size);
+
+language_error_t read_tree_binary  (language_t *ctx,
+                                    bool        reachable);
+
+language_error_t write_tree_binary (language_t *ctx,
+                                    FILE       *output);
+
+//---------------------------------------------------------------------------//
+
+bool             is_stream_tree    (const char *data,
+                                    size_t      size);
+
+language_error_t read_tree_stream  (language_t *ctx,
+                                    bool        whole);
+
+language_error_t read_tree_frame   (language_t *ctx,
+                                    uint32_t   *statement);
+
+language_error_t write_tree_frame  (language_t *ctx,
+                                    uint32_t    statement);
+
+language_error_t write_tree_stream (language_t *ctx);
+
+language_error_t tree_stream_close (language_t *ctx);
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef TREE_VISITOR_H
+#define TREE_VISITOR_H
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Tree traversal with explicit stack of frames owned by visitor, so depth
+   of the call stack does not depend on the tree. Pre hook is run when the
+   frame is entered, in hook between the two children and post hook after
+   them. Links hold node indices. Children links are taken from the node
+   after pre hook, so it can replace the node in link, or they can be set
+   by visit_children() to skip or reorder them. Frame which does not need post hook is replaced
+   by its second child, so right-linked chains of statements take one
+   frame and the stack depth is bounded by nesting of the program.        */
+
+//===========================================================================//
+
+enum visit_stage_t {
+    VISIT_STAGE_PRE  = 0,
+    VISIT_STAGE_IN   = 1,
+    VISIT_STAGE_POST = 2,
+};
+
+//---------------------------------------------------------------------------//
+
+union visit_state_t {
+    void                            *pointer;
+    size_t                           number;
+};
+
+//---------------------------------------------------------------------------//
+
+struct visit_frame_t {
+    uint32_t                        *link;
+    uint32_t                        *children[2];
+    visit_stage_t                    stage;
+    size_t                           level;
+    size_t                           shared_posts;
+    bool                             is_custom;
+    bool                             need_in;
+    bool                             need_post;
+    visit_state_t                    state[2];
+};
+
+//---------------------------------------------------------------------------//
+
+typedef language_error_t (*visit_hook_t)(language_t    *ctx,
+                                         visit_frame_t *frame,
+                                         void          *data);
+
+//---------------------------------------------------------------------------//
+
+/* visit_null  - links to NodeNone are visited too (reader fills them);
+   shared_post - post hook does not depend on the node, frame waiting for
+                 it is replaced by its second child anyway and the post
+                 hook is run as many times as needed when chain ends.     */
+struct tree_visitor_t {
+    visit_hook_t                     pre;
+    visit_hook_t                     in;
+    visit_hook_t                     post;
+    void                            *data;
+    bool                             visit_null;
+    bool                             shared_post;
+    visit_frame_t                   *frames;
+    size_t                           capacity;
+};
+
+//===========================================================================//
+
+language_error_t tree_visit         (language_t       *ctx,
+                                     tree_visitor_t   *visitor,
+                                     uint32_t         *root);
+
+void             visit_children     (visit_frame_t    *frame,
+                                     uint32_t         *first,
+                                     uint32_t         *second);
+
+language_error_t tree_visitor_dtor  (tree_visitor_t   *visitor);
+
+//===========================================================================//
+
+#endif
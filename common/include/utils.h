@@ -4,15 +4,30 @@
 //===========================================================================//
 
 #include <stdio.h>
+#include <stdint.h>
 
 //===========================================================================//
 
-size_t file_size        (FILE   *file);
+#include "language.h"
 
-bool   is_equal         (double  first,
-                         double  second);
+//===========================================================================//
+
+size_t           file_size        (FILE        *file);
+
+bool             is_equal         (double       first,
+                                   double       second);
+
+size_t           get_random_index (size_t       size);
+
+size_t           peak_memory_usage(void);
+
+language_error_t reserve_elements (void       **array,
+                                   size_t      *capacity,
+                                   size_t       needed,
+                                   size_t       element_size);
 
-size_t get_random_index (size_t  size);
+uint64_t         fnv1a_hash       (const char  *data,
+                                   size_t       size);
 
 //===========================================================================//
 
@@ -5,23 +5,33 @@
 
 #include "language.h"
 #include "asm_spu.h"
+#include "tree_visitor.h"
 #include "utils.h"
 #include "colors.h"
 #include "nodes_dsl.h"
 #include "name_table.h"
 #include "custom_assert.h"
+#include "output.h"
 
 //===========================================================================//
 
+static language_error_t spu_visit_node            (language_t      *ctx,
+                                                   visit_frame_t   *frame,
+                                                   void            *data);
+
 static language_error_t spu_compile_function_call (language_t      *ctx,
-                                                   language_node_t *root);
+                                                   visit_frame_t   *frame);
 
 static language_error_t spu_compile_identifier    (language_t      *ctx,
-                                                   language_node_t *root,
+                                                   visit_frame_t   *frame);
+
+static language_error_t spu_compile_variable      (language_t      *ctx,
+                                                   language_node_t *node,
                                                    const char      *command);
 
 static language_error_t write_command             (language_t      *ctx,
-                                                   const char      *format, ...);
+                                                   const char      *format, ...)
+                                                   __attribute__((format(printf, 2, 3)));
 
 //===========================================================================//
 
@@ -30,25 +40,45 @@ static language_error_t write_command             (language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t spu_compile_subtree(language_t      *ctx,
-                                 language_node_t *node) {
+language_error_t spu_compile_subtree(language_t *ctx,
+                                     uint32_t    node) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    if(node == NULL) {
-        return LANGUAGE_SUCCESS;
-    }
+    // Handlers are called on each stage of node, children are visited in
+    // between by visitor, not by handlers.
+    tree_visitor_t visitor = {};
+    visitor.pre  = spu_visit_node;
+    visitor.in   = spu_visit_node;
+    visitor.post = spu_visit_node;
+    language_error_t error_code = tree_visit(ctx, &visitor, &node);
+    tree_visitor_dtor(&visitor);
+    //-----------------------------------------------------------------------//
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t spu_visit_node(language_t    *ctx,
+                                visit_frame_t *frame,
+                                void          *) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    switch(node->type) {
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    switch(node_type(node)) {
         case NODE_TYPE_IDENTIFIER: {
-            _RETURN_IF_ERROR(spu_compile_identifier(ctx, node, "push"));
+            _RETURN_IF_ERROR(spu_compile_identifier(ctx, frame));
             break;
         }
         case NODE_TYPE_NUMBER: {
-            _CMD_WRITE("push %lg", node->value.number   );
+            _CMD_WRITE("push %lg", node_number(node));
+            visit_children(frame, NULL, NULL);
+            frame->need_in   = false;
+            frame->need_post = false;
             break;
         }
         case NODE_TYPE_OPERATION: {
-            _RETURN_IF_ERROR(KeyWords[node->value.opcode].asm_spu(ctx, node));
+            _RETURN_IF_ERROR(KeyWords[node_opcode(node)].asm_spu(ctx, frame));
             break;
         }
         default: {
@@ -62,27 +92,25 @@ language_error_t spu_compile_subtree(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t spu_compile_identifier(language_t      *ctx,
-                                        language_node_t *node,
-                                        const char      *command) {
+language_error_t spu_compile_identifier(language_t    *ctx,
+                                        visit_frame_t *frame) {
     _C_ASSERT(ctx                         != NULL, return LANGUAGE_CTX_NULL   );
-    _C_ASSERT(node                        != NULL, return LANGUAGE_NODE_NULL  );
+    _C_ASSERT(frame                       != NULL, return LANGUAGE_NODE_NULL  );
     _C_ASSERT(ctx->name_table.identifiers != NULL, return LANGUAGE_NT_NOT_INIT);
     //-----------------------------------------------------------------------//
-    identifier_t *ident = ctx->name_table.identifiers +
-                          node->value.identifier;
+    language_node_t *node  = nodes_storage_get(ctx, *frame->link);
+    identifier_t    *ident = ctx->name_table.identifiers +
+                             node_identifier(node);
     switch(ident->type) {
         case IDENTIFIER_FUNCTION: {
-            _RETURN_IF_ERROR(spu_compile_function_call(ctx, node));
+            _RETURN_IF_ERROR(spu_compile_function_call(ctx, frame));
             break;
         }
         case IDENTIFIER_VARIABLE: {
-            _CMD_WRITE("%s [%s" SZ_SP "] ;%.*s",
-                       command,
-                       !ident->is_global ? "bx + " : "",
-                       ident->memory_addr,
-                       (int)ident->length,
-                       ident->name);
+            _RETURN_IF_ERROR(spu_compile_variable(ctx, node, "push"));
+            visit_children(frame, NULL, NULL);
+            frame->need_in   = false;
+            frame->need_post = false;
             break;
         }
         default: {
@@ -96,32 +124,61 @@ language_error_t spu_compile_identifier(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t spu_compile_function_call(language_t      *ctx,
-                                           language_node_t *node) {
+language_error_t spu_compile_variable(language_t      *ctx,
+                                      language_node_t *node,
+                                      const char      *command) {
     _C_ASSERT(ctx                         != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(node                        != NULL, return LANGUAGE_NODE_NULL  );
     _C_ASSERT(ctx->name_table.identifiers != NULL, return LANGUAGE_NT_NOT_INIT);
     //-----------------------------------------------------------------------//
+    identifier_t *ident = ctx->name_table.identifiers +
+                          node_identifier(node);
+    if(ident->type != IDENTIFIER_VARIABLE) {
+        print_error("Expected variable identifier.\n");
+        return LANGUAGE_UNEXPECTED_ID_TYPE;
+    }
+    _CMD_WRITE("%s [%s%ld] ;%.*s",
+               command,
+               !ident->is_global ? "bx + " : "",
+               ident->memory_addr,
+               (int)ident->length,
+               ident->name);
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t spu_compile_function_call(language_t    *ctx,
+                                           visit_frame_t *frame) {
+    _C_ASSERT(ctx                         != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(frame                       != NULL, return LANGUAGE_NODE_NULL  );
+    _C_ASSERT(ctx->name_table.identifiers != NULL, return LANGUAGE_NT_NOT_INIT);
+    //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_ident_type(ctx, node, IDENTIFIER_FUNCTION)) {
         print_error("Expected to call compile_function_call() "
                     "only for function ids");
         return LANGUAGE_UNEXPECTED_ID_TYPE;
     }
     identifier_t    *ident = ctx->name_table.identifiers +
-                             node->value.identifier;
-    language_node_t *param = node->left;
-    _CMD_WRITE(";START CALLING %.*s",
-               (int)ident->length,
-               ident->name                     );
-    //-----------------------------------------------------------------------//
-    _CMD_WRITE(";saving BX"                    );
-    _CMD_WRITE("push bx\r\n"                   );
-    //-----------------------------------------------------------------------//
-    _CMD_WRITE(";function parameters"          );
-    ctx->backend_info.scope++;
-    while(param != NULL) {
-        _RETURN_IF_ERROR(spu_compile_subtree(ctx, param->left));
-        param = param->right;
+                             node_identifier(node);
+    if(frame->stage == VISIT_STAGE_PRE) {
+        _CMD_WRITE(";START CALLING %.*s",
+                   (int)ident->length,
+                   ident->name                     );
+        //-------------------------------------------------------------------//
+        _CMD_WRITE(";saving BX"                    );
+        _CMD_WRITE("push bx\r\n"                   );
+        //-------------------------------------------------------------------//
+        // Parameters line is compiled by visitor
+        _CMD_WRITE(";function parameters"          );
+        ctx->backend_info.scope++;
+        visit_children(frame, &node->left, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
     }
     ctx->backend_info.scope--;
     _CMD_WRITE("\r\n"                          );
@@ -154,55 +211,66 @@ language_error_t spu_compile_function_call(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t spu_assemble_two_args(language_t      *ctx,
-                                       language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_two_args(language_t    *ctx,
+                                       visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_node_type_eq(node, NODE_TYPE_OPERATION)) {
         return LANGUAGE_UNEXPECTED_NODE_TYPE;
     }
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left ));
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->right));
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
     //-----------------------------------------------------------------------//
-    const char *asm_cmd = KeyWords[node->value.opcode].assembler_command;
+    const char *asm_cmd = KeyWords[node_opcode(node)].assembler_command;
     _RETURN_IF_ERROR(write_command(ctx, "%s", asm_cmd));
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_one_arg(language_t      *ctx,
-                                      language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_one_arg(language_t    *ctx,
+                                      visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_node_type_eq(node, NODE_TYPE_OPERATION)) {
         return LANGUAGE_UNEXPECTED_NODE_TYPE;
     }
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left));
+    if(frame->stage == VISIT_STAGE_PRE) {
+        visit_children(frame, &node->left, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
     //-----------------------------------------------------------------------//
-    const char *asm_cmd = KeyWords[node->value.opcode].assembler_command;
+    const char *asm_cmd = KeyWords[node_opcode(node)].assembler_command;
     _CMD_WRITE("%s", asm_cmd                       );
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_comparison(language_t      *ctx,
-                                         language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_comparison(language_t    *ctx,
+                                         visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_node_oper_eq(node, OPERATION_BIGGER ) &&
        !is_node_oper_eq(node, OPERATION_SMALLER)) {
         return LANGUAGE_UNEXPECTED_OPER;
     }
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left ));
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->right));
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
     //-----------------------------------------------------------------------//
     size_t      num     = ctx->backend_info.used_labels++;
-    const char *asm_cmd = KeyWords[node->value.opcode].assembler_command;
+    const char *asm_cmd = KeyWords[node_opcode(node)].assembler_command;
     _CMD_WRITE("%s _cmp_t_" SZ_SP ":", asm_cmd, num);
     _CMD_WRITE("push 0  ;true"                     );
     _CMD_WRITE("jmp _cmp_t_end_" SZ_SP ":\r\n", num);
@@ -215,23 +283,30 @@ language_error_t spu_assemble_comparison(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t spu_assemble_assignment(language_t      *ctx,
-                                         language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_assignment(language_t    *ctx,
+                                         visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_node_oper_eq(node, OPERATION_ASSIGNMENT)) {
         return LANGUAGE_UNEXPECTED_OPER;
     }
-    identifier_t *ident = ctx->name_table.identifiers +
-                          node->left->value.identifier;
-    _CMD_WRITE(";assignment to %.*s",
-               (int)ident->length,
-               ident->name);
-    ctx->backend_info.scope++;
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->right));
+    if(frame->stage == VISIT_STAGE_PRE) {
+        identifier_t *ident = ctx->name_table.identifiers +
+                              node_identifier(node_left(ctx, node));
+        _CMD_WRITE(";assignment to %.*s",
+                   (int)ident->length,
+                   ident->name);
+        ctx->backend_info.scope++;
+        visit_children(frame, &node->right, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(spu_compile_identifier(ctx, node->left, "pop"));
+    _RETURN_IF_ERROR(spu_compile_variable(ctx, node_left(ctx, node), "pop"));
     ctx->backend_info.scope--;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -239,98 +314,135 @@ language_error_t spu_assemble_assignment(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t spu_assemble_statements(language_t      *ctx,
-                                         language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_statements(language_t    *ctx,
+                                         visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    size_t old_used_locals = ctx->backend_info.used_locals;
-    while(node != NULL) {
-        if(!is_node_oper_eq(node, OPERATION_STATEMENT)) {
-            return LANGUAGE_UNEXPECTED_OPER;
-        }
-        _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left));
-        node = node->right;
+    // Statement is compiled and frame is replaced by the next statement.
+    // Locals of the block are released by if, while and function.
+    if(!is_node_oper_eq(nodes_storage_get(ctx, *frame->link), OPERATION_STATEMENT)) {
+        return LANGUAGE_UNEXPECTED_OPER;
     }
-    ctx->backend_info.used_locals = old_used_locals;
+    frame->need_in   = false;
+    frame->need_post = false;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_if(language_t      *ctx,
-                                 language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_if(language_t    *ctx,
+                                 visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    if(!is_node_oper_eq(node, OPERATION_IF)) {
+    if(!is_node_oper_eq(nodes_storage_get(ctx, *frame->link), OPERATION_IF)) {
         return LANGUAGE_UNEXPECTED_OPER;
     }
-    _CMD_WRITE(";if condition"             );
-    ctx->backend_info.scope++;
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left));
-    ctx->backend_info.scope--;
-    _CMD_WRITE("\r\n"                      );
-    //-----------------------------------------------------------------------//
-    size_t num = ctx->backend_info.used_labels++;
-    _CMD_WRITE("push 0"                    );
-    _CMD_WRITE("je skip_if_" SZ_SP ":", num);
-    //-----------------------------------------------------------------------//
-    _CMD_WRITE(";if body"                  );
-    ctx->backend_info.scope++;
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->right));
-    ctx->backend_info.scope--;
-    //-----------------------------------------------------------------------//
-    _CMD_WRITE("skip_if_" SZ_SP ":", num   );
-    _CMD_WRITE("\r\n"                      );
+    switch(frame->stage) {
+        case VISIT_STAGE_PRE: {
+            _CMD_WRITE(";if condition"             );
+            ctx->backend_info.scope++;
+            break;
+        }
+        case VISIT_STAGE_IN: {
+            ctx->backend_info.scope--;
+            _CMD_WRITE("\r\n"                      );
+            //---------------------------------------------------------------//
+            size_t num = ctx->backend_info.used_labels++;
+            _CMD_WRITE("push 0"                    );
+            _CMD_WRITE("je skip_if_" SZ_SP ":", num);
+            //---------------------------------------------------------------//
+            _CMD_WRITE(";if body"                  );
+            ctx->backend_info.scope++;
+            frame->state[0].number = num;
+            frame->state[1].number = ctx->backend_info.used_locals;
+            break;
+        }
+        case VISIT_STAGE_POST: {
+            size_t num = frame->state[0].number;
+            ctx->backend_info.used_locals = frame->state[1].number;
+            ctx->backend_info.scope--;
+            //---------------------------------------------------------------//
+            _CMD_WRITE("skip_if_" SZ_SP ":", num   );
+            _CMD_WRITE("\r\n"                      );
+            break;
+        }
+        default: {
+            return LANGUAGE_UNEXPECTED_OPER;
+        }
+    }
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_while(language_t      *ctx,
-                                    language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_while(language_t    *ctx,
+                                    visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    if(!is_node_oper_eq(node, OPERATION_WHILE)) {
+    if(!is_node_oper_eq(nodes_storage_get(ctx, *frame->link), OPERATION_WHILE)) {
         return LANGUAGE_UNEXPECTED_OPER;
     }
     //-----------------------------------------------------------------------//
-    size_t num = ctx->backend_info.used_labels++;
-    _CMD_WRITE("_while_start_" SZ_SP ":", num    );
-    _CMD_WRITE(";while condition"                );
-    ctx->backend_info.scope++;
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left));
-    ctx->backend_info.scope--;
-    _CMD_WRITE("\r\n"                            );
-    _CMD_WRITE("push 0"                          );
-    _CMD_WRITE("je _skip_while_" SZ_SP ":", num  );
-    //-----------------------------------------------------------------------//
-    _CMD_WRITE(";while body"                     );
-    ctx->backend_info.scope++;
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->right));
-    ctx->backend_info.scope--;
-    _CMD_WRITE("\r\n"                            );
-    //-----------------------------------------------------------------------//
-    _CMD_WRITE("jmp _while_start_" SZ_SP ":", num);
-    _CMD_WRITE("_skip_while_" SZ_SP ":", num     );
-    _CMD_WRITE("\r\n"                            );
+    size_t num = frame->state[0].number;
+    switch(frame->stage) {
+        case VISIT_STAGE_PRE: {
+            num = ctx->backend_info.used_labels++;
+            frame->state[0].number = num;
+            _CMD_WRITE("_while_start_" SZ_SP ":", num    );
+            _CMD_WRITE(";while condition"                );
+            ctx->backend_info.scope++;
+            break;
+        }
+        case VISIT_STAGE_IN: {
+            ctx->backend_info.scope--;
+            _CMD_WRITE("\r\n"                            );
+            _CMD_WRITE("push 0"                          );
+            _CMD_WRITE("je _skip_while_" SZ_SP ":", num  );
+            //---------------------------------------------------------------//
+            _CMD_WRITE(";while body"                     );
+            ctx->backend_info.scope++;
+            frame->state[1].number = ctx->backend_info.used_locals;
+            break;
+        }
+        case VISIT_STAGE_POST: {
+            ctx->backend_info.used_locals = frame->state[1].number;
+            ctx->backend_info.scope--;
+            _CMD_WRITE("\r\n"                            );
+            //---------------------------------------------------------------//
+            _CMD_WRITE("jmp _while_start_" SZ_SP ":", num);
+            _CMD_WRITE("_skip_while_" SZ_SP ":", num     );
+            _CMD_WRITE("\r\n"                            );
+            break;
+        }
+        default: {
+            return LANGUAGE_UNEXPECTED_OPER;
+        }
+    }
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_return(language_t      *ctx,
-                                     language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_return(language_t    *ctx,
+                                     visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_node_oper_eq(node, OPERATION_RETURN)) {
         return LANGUAGE_UNEXPECTED_OPER;
     }
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left));
+    if(frame->stage == VISIT_STAGE_PRE) {
+        visit_children(frame, &node->left, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
     //-----------------------------------------------------------------------//
     _CMD_WRITE("pop ax"                         );
     _CMD_WRITE("ret"                            );
@@ -339,40 +451,39 @@ language_error_t spu_assemble_return(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t spu_assemble_params_line(language_t      *ctx,
-                                          language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_params_line(language_t    *ctx,
+                                          visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    while(node != NULL) {
-        if(!is_node_oper_eq(node, OPERATION_PARAM_LINKER)) {
-            return LANGUAGE_UNEXPECTED_OPER;
-        }
-        //----------------------------------------------------------------------------//
-        _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left));
-        node = node->right;
+    // Parameter is compiled and frame is replaced by the next linker
+    if(!is_node_oper_eq(nodes_storage_get(ctx, *frame->link), OPERATION_PARAM_LINKER)) {
+        return LANGUAGE_UNEXPECTED_OPER;
     }
+    frame->need_in   = false;
+    frame->need_post = false;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_new_var(language_t      *ctx,
-                                      language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_new_var(language_t    *ctx,
+                                      visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_node_oper_eq(node, OPERATION_NEW_VAR)) {
         return LANGUAGE_UNEXPECTED_OPER;
     }
 
     language_node_t *ident = NULL;
-    if      (is_node_oper_eq(node->left, OPERATION_ASSIGNMENT)) {
-        ident = node->left->left;
+    if      (is_node_oper_eq(node_left(ctx, node), OPERATION_ASSIGNMENT)) {
+        ident = node_left(ctx, node_left(ctx, node));
     }
-    else if (is_node_type_eq(node->left, NODE_TYPE_IDENTIFIER)) {
-        ident = node->left;
+    else if (is_node_type_eq(node_left(ctx, node), NODE_TYPE_IDENTIFIER)) {
+        ident = node_left(ctx, node);
     }
     else    /*Unknown_new_var_subtree_structure_______________*/ {
         print_error("Unknown new variable subtree structure.\n");
@@ -383,10 +494,24 @@ language_error_t spu_assemble_new_var(language_t      *ctx,
         print_error("Unknown new variable subtree structure.\n");
         return LANGUAGE_UNSUPPORTED_TREE;
     }
+    identifier_t *nt_info = ctx->name_table.identifiers +
+                            node_identifier(ident);
+    //-----------------------------------------------------------------------//
+    // Variable is counted after its assignment is compiled
+    if(frame->stage == VISIT_STAGE_POST) {
+        if     (!nt_info->is_global) {
+            ctx->backend_info.used_locals++;
+        }
+        else if(nt_info->is_global ) {
+            ctx->backend_info.used_globals++;
+        }
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_PRE) {
+        return LANGUAGE_SUCCESS;
+    }
     //-----------------------------------------------------------------------//
     size_t addr = 0;
-    identifier_t *nt_info = ctx->name_table.identifiers +
-                            ident->value.identifier;
     if     (!nt_info->is_global) {
         addr = ctx->backend_info.used_locals;
     }
@@ -400,15 +525,11 @@ language_error_t spu_assemble_new_var(language_t      *ctx,
 
     _RETURN_IF_ERROR(set_memory_addr(ctx, ident, addr));
     //-----------------------------------------------------------------------//
-    if(is_node_oper_eq(node->left, OPERATION_ASSIGNMENT)) {
-        _RETURN_IF_ERROR(spu_assemble_assignment(ctx, node->left));
+    if(is_node_oper_eq(node_left(ctx, node), OPERATION_ASSIGNMENT)) {
+        visit_children(frame, &node->left, NULL);
     }
-    //-----------------------------------------------------------------------//
-    if     (!nt_info->is_global) {
-        ctx->backend_info.used_locals++;
-    }
-    else if(nt_info->is_global ) {
-        ctx->backend_info.used_globals++;
+    else {
+        visit_children(frame, NULL, NULL);
     }
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -416,85 +537,118 @@ language_error_t spu_assemble_new_var(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t spu_assemble_new_func(language_t      *ctx,
-                                       language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_new_func(language_t    *ctx,
+                                       visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_node_oper_eq(node, OPERATION_NEW_FUNC)) {
         return LANGUAGE_UNEXPECTED_OPER;
     }
     identifier_t *ident = ctx->name_table.identifiers +
-                          node->left->value.identifier;
-    _CMD_WRITE("jmp skip_%.*s:",
-               (int)ident->length,
-               ident->name                 );
-    _CMD_WRITE("%.*s:",
-               (int)ident->length,
-               ident->name                 );
+                          node_identifier(node_left(ctx, node));
     //-----------------------------------------------------------------------//
-    ctx->backend_info.used_locals = 0;
-
-    ctx->backend_info.scope++;
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left->left));
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left->right ));
-    ctx->backend_info.scope--;
-
+    // Parameters and body are compiled by visitor, locals of the body are
+    // released after it.
+    switch(frame->stage) {
+        case VISIT_STAGE_PRE: {
+            _CMD_WRITE("jmp skip_%.*s:",
+                       (int)ident->length,
+                       ident->name                 );
+            _CMD_WRITE("%.*s:",
+                       (int)ident->length,
+                       ident->name                 );
+            ctx->backend_info.used_locals = 0;
+            ctx->backend_info.scope++;
+            language_node_t *function = node_left(ctx, node);
+            visit_children(frame, &function->left, &function->right);
+            break;
+        }
+        case VISIT_STAGE_IN: {
+            frame->state[0].number = ctx->backend_info.used_locals;
+            break;
+        }
+        case VISIT_STAGE_POST: {
+            ctx->backend_info.used_locals = frame->state[0].number;
+            ctx->backend_info.scope--;
+            _CMD_WRITE("skip_%.*s:\r\n",
+                       (int)ident->length,
+                       ident->name                      );
+            break;
+        }
+        default: {
+            return LANGUAGE_UNEXPECTED_OPER;
+        }
+    }
     //-----------------------------------------------------------------------//
-    _CMD_WRITE("skip_%.*s:\r\n",
-               (int)ident->length,
-               ident->name                      );
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_in(language_t      *ctx,
-                                 language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_in(language_t    *ctx,
+                                 visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_node_oper_eq(node, OPERATION_IN)) {
         return LANGUAGE_UNEXPECTED_OPER;
     }
+    visit_children(frame, NULL, NULL);
+    frame->need_in   = false;
+    frame->need_post = false;
     _CMD_WRITE("in"                             );
-    _RETURN_IF_ERROR(spu_compile_identifier(ctx, node->left->left, "pop"));
+    _RETURN_IF_ERROR(spu_compile_variable(ctx, node_left(ctx, node_left(ctx, node)), "pop"));
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_out(language_t      *ctx,
-                                  language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_out(language_t    *ctx,
+                                  visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(!is_node_oper_eq(node, OPERATION_OUT)) {
         return LANGUAGE_UNEXPECTED_OPER;
     }
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left));
+    if(frame->stage == VISIT_STAGE_PRE) {
+        visit_children(frame, &node->left, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
     _CMD_WRITE("out"                            );
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_call(language_t      *ctx,
-                                   language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_call(language_t    *ctx,
+                                   visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(spu_compile_subtree(ctx, node->left));
+    visit_children(frame, &nodes_storage_get(ctx, *frame->link)->left, NULL);
+    frame->need_in   = false;
+    frame->need_post = false;
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t spu_assemble_exit(language_t      *ctx,
-                                   language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t spu_assemble_exit(language_t    *ctx,
+                                   visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    visit_children(frame, NULL, NULL);
+    frame->need_in   = false;
+    frame->need_post = false;
     _CMD_WRITE("hlt");
     return LANGUAGE_SUCCESS;
 }
@@ -506,26 +660,18 @@ language_error_t write_command(language_t *ctx,
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL          );
     _C_ASSERT(format != NULL, return LANGUAGE_STRING_FORMAT_NULL);
     //-----------------------------------------------------------------------//
-    if(fprintf(ctx->backend_info.output, "%*s",
-               8 * ctx->backend_info.scope, "") < 0) {
-        print_error("Error while writing asm code to file.\n");
-        return LANGUAGE_WRITING_ASM_ERROR;
-    }
+    output_t *buffer = &ctx->backend_info.buffer;
+    _RETURN_IF_ERROR(output_fill(buffer,
+                                 ' ',
+                                 8 * (size_t)ctx->backend_info.scope));
     //-----------------------------------------------------------------------//
     va_list args;
     va_start(args, format);
-    if(vfprintf(ctx->backend_info.output, format, args) < 0) {
-        print_error("Error while writing asm code to file.\n");
-        return LANGUAGE_WRITING_ASM_ERROR;
-    }
+    language_error_t error_code = output_vformat(buffer, format, args);
     va_end(args);
+    _RETURN_IF_ERROR(error_code);
     //-----------------------------------------------------------------------//
-    if(fprintf(ctx->backend_info.output, "\r\n") < 0) {
-        print_error("Error while writing asm code to file.\n");
-        return LANGUAGE_WRITING_ASM_ERROR;
-    }
-    //-----------------------------------------------------------------------//
-    return LANGUAGE_SUCCESS;
+    return output_string(buffer, "\r\n", 2);
 }
 
 //===========================================================================//
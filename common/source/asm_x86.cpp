@@ -8,6 +8,7 @@
 
 #include "language.h"
 #include "asm_x86.h"
+#include "tree_visitor.h"
 #include "utils.h"
 #include "colors.h"
 #include "nodes_dsl.h"
@@ -16,21 +17,34 @@
 
 //===========================================================================//
 
+static language_error_t x86_visit_node            (language_t      *ctx,
+                                                   visit_frame_t   *frame,
+                                                   void            *data);
+
 static language_error_t x86_compile_function_call (language_t      *ctx,
-                                                   language_node_t *root);
+                                                   visit_frame_t   *frame);
 
 static language_error_t x86_compile_identifier    (language_t      *ctx,
-                                                   language_node_t *root);
+                                                   visit_frame_t   *frame);
 
 static ir_node_t       *ir_last_node              (language_t      *ctx);
 
 static language_error_t compile_cmp_zero          (language_t      *ctx);
 
+static language_error_t compile_tail_call         (language_t      *ctx,
+                                                   language_node_t *call);
+
+static bool             is_tail_call              (language_node_t *node);
+
 static language_error_t compile_params_addrs      (language_t      *ctx,
                                                    language_node_t *param_linker);
 
 static language_error_t compile_locals_addrs      (language_t      *ctx,
-                                                   language_node_t *st_linker);
+                                                   uint32_t         st_linker);
+
+static language_error_t compile_local_addr        (language_t      *ctx,
+                                                   visit_frame_t   *frame,
+                                                   void            *data);
 
 //===========================================================================//
 
@@ -50,28 +64,72 @@ const size_t  StdLibFilenameLen = 6;
 
 //===========================================================================//
 
-language_error_t x86_compile_subtree(language_t      *ctx,
-                                     language_node_t *node) {
+language_error_t x86_compile_subtree(language_t *ctx,
+                                     uint32_t    node) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    if(node == NULL) {
-        return LANGUAGE_SUCCESS;
+    // Handlers are called on each stage of node, children are visited in
+    // between by visitor, not by handlers.
+    tree_visitor_t visitor = {};
+    visitor.pre  = x86_visit_node;
+    visitor.in   = x86_visit_node;
+    visitor.post = x86_visit_node;
+    language_error_t error_code = tree_visit(ctx, &visitor, &node);
+    tree_visitor_dtor(&visitor);
+    //-----------------------------------------------------------------------//
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t x86_compile_main_call(language_t *ctx, size_t main_index) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    // Every call reserves slots for the longest parameters list, so tail
+    // call can write more arguments than this function has parameters
+    ctx->backend_info.max_params = 0;
+    for(size_t elem = 0; elem < ctx->name_table.size; elem++) {
+        identifier_t *ident = ctx->name_table.identifiers + elem;
+        if(ident->type == IDENTIFIER_FUNCTION &&
+           ident->parameters_number > ctx->backend_info.max_params) {
+            ctx->backend_info.max_params = ident->parameters_number;
+        }
     }
+    if(ctx->backend_info.max_params != 0) {
+        ir_add_node(ctx, IR_INSTR_SUB, _REG(REGISTER_RSP),
+                    _IMM(8 * ctx->backend_info.max_params));
+    }
+    ir_add_node(ctx, IR_INSTR_CALL, _CUSTOM(main_index), (ir_arg_t){});
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t x86_visit_node(language_t    *ctx,
+                                visit_frame_t *frame,
+                                void          *) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    switch(node->type) {
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    switch(node_type(node)) {
         case NODE_TYPE_IDENTIFIER: {
-            _RETURN_IF_ERROR(x86_compile_identifier(ctx, node));
+            _RETURN_IF_ERROR(x86_compile_identifier(ctx, frame));
             break;
         }
         case NODE_TYPE_NUMBER: {
             ir_add_node(ctx, IR_INSTR_MOV,
-                        _REG(REGISTER_RAX), _IMM(node->value.identifier));
+                        _REG(REGISTER_RAX), _IMM(node->value));
             ir_add_node(ctx, IR_INSTR_PUSH,
                         _REG(REGISTER_RAX), (ir_arg_t){});
+            visit_children(frame, NULL, NULL);
+            frame->need_in   = false;
+            frame->need_post = false;
             break;
         }
         case NODE_TYPE_OPERATION: {
-            _RETURN_IF_ERROR(KeyWords[node->value.opcode].asm_x86(ctx, node));
+            _RETURN_IF_ERROR(KeyWords[node_opcode(node)].asm_x86(ctx, frame));
             break;
         }
         default: {
@@ -85,16 +143,17 @@ language_error_t x86_compile_subtree(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_compile_identifier(language_t      *ctx,
-                                        language_node_t *node) {
+language_error_t x86_compile_identifier(language_t    *ctx,
+                                        visit_frame_t *frame) {
     _C_ASSERT(ctx                         != NULL, return LANGUAGE_CTX_NULL   );
-    _C_ASSERT(node                        != NULL, return LANGUAGE_NODE_NULL  );
+    _C_ASSERT(frame                       != NULL, return LANGUAGE_NODE_NULL  );
     _C_ASSERT(ctx->name_table.identifiers != NULL, return LANGUAGE_NT_NOT_INIT);
     //-----------------------------------------------------------------------//
-    identifier_t *ident = ctx->name_table.identifiers + node->value.identifier;
+    language_node_t *node  = nodes_storage_get(ctx, *frame->link);
+    identifier_t    *ident = ctx->name_table.identifiers + node_identifier(node);
     switch(ident->type) {
         case IDENTIFIER_FUNCTION: {
-            _RETURN_IF_ERROR(x86_compile_function_call(ctx, node));
+            _RETURN_IF_ERROR(x86_compile_function_call(ctx, frame));
             break;
         }
         case IDENTIFIER_VARIABLE: {
@@ -105,9 +164,12 @@ language_error_t x86_compile_identifier(language_t      *ctx,
             }
             else {
                 mem.base   = REGISTER_RIP;
-                mem.offset = (long)node->value.identifier;
+                mem.offset = (long)node_identifier(node);
             }
             ir_add_node(ctx, IR_INSTR_PUSH, _MEM(mem.base, mem.offset), (ir_arg_t){});
+            visit_children(frame, NULL, NULL);
+            frame->need_in   = false;
+            frame->need_post = false;
             break;
         }
         default: {
@@ -120,21 +182,33 @@ language_error_t x86_compile_identifier(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_compile_function_call(language_t      *ctx,
-                                           language_node_t *node) {
+language_error_t x86_compile_function_call(language_t    *ctx,
+                                           visit_frame_t *frame) {
     _C_ASSERT(ctx                         != NULL, return LANGUAGE_CTX_NULL   );
-    _C_ASSERT(node                        != NULL, return LANGUAGE_NODE_NULL  );
+    _C_ASSERT(frame                       != NULL, return LANGUAGE_NODE_NULL  );
     _C_ASSERT(ctx->name_table.identifiers != NULL, return LANGUAGE_NT_NOT_INIT);
-    identifier_t *ident = ctx->name_table.identifiers + node->value.identifier;
-    //-----------------------------------------------------------------------//
-    // Pushing function parameters
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
+    language_node_t *node  = nodes_storage_get(ctx, *frame->link);
+    identifier_t    *ident = ctx->name_table.identifiers + node_identifier(node);
+    //-----------------------------------------------------------------------//
+    // Reserving slots of parameters which this function does not have and
+    // pushing function parameters
+    if(frame->stage == VISIT_STAGE_PRE) {
+        size_t padding = ctx->backend_info.max_params - ident->parameters_number;
+        if(padding != 0) {
+            ir_add_node(ctx, IR_INSTR_SUB, _REG(REGISTER_RSP), _IMM(8 * padding));
+        }
+        visit_children(frame, &node->left, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
     //-----------------------------------------------------------------------//
     ir_add_node(ctx, IR_INSTR_CALL,
-                _CUSTOM(node->value.identifier), (ir_arg_t){});
+                _CUSTOM(node_identifier(node)), (ir_arg_t){});
     // Removing parameters from stack
     ir_add_node(ctx, IR_INSTR_ADD,
-                _REG(REGISTER_RSP), _IMM(8 * ident->parameters_number));
+                _REG(REGISTER_RSP), _IMM(8 * ctx->backend_info.max_params));
     // Pushing return value to stack
     ir_add_node(ctx, IR_INSTR_PUSH_XMM, _XMM(REGISTER_XMM0), (ir_arg_t){});
     //-----------------------------------------------------------------------//
@@ -143,29 +217,31 @@ language_error_t x86_compile_function_call(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_assemble_two_args(language_t      *ctx,
-                                       language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t x86_assemble_two_args(language_t    *ctx,
+                                       visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    // Calculating left and right
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->right));
+    // Left and right are calculated by visitor before post stage
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     //-----------------------------------------------------------------------//
     // Getting left and right values from stack
     ir_add_node(ctx, IR_INSTR_POP_XMM, _XMM(REGISTER_XMM1), (ir_arg_t){});
     ir_add_node(ctx, IR_INSTR_POP_XMM, _XMM(REGISTER_XMM0), (ir_arg_t){});
     ir_instr_t instruction = (ir_instr_t)0;
-    if(node->value.opcode == OPERATION_ADD) {
+    if(node_opcode(node) == OPERATION_ADD) {
         instruction = IR_INSTR_ADD;
     }
-    else if(node->value.opcode == OPERATION_SUB) {
+    else if(node_opcode(node) == OPERATION_SUB) {
         instruction = IR_INSTR_SUB;
     }
-    else if(node->value.opcode == OPERATION_MUL) {
+    else if(node_opcode(node) == OPERATION_MUL) {
         instruction = IR_INSTR_MUL;
     }
-    else if(node->value.opcode == OPERATION_DIV) {
+    else if(node_opcode(node) == OPERATION_DIV) {
         instruction = IR_INSTR_DIV;
     }
     else {
@@ -182,13 +258,20 @@ language_error_t x86_assemble_two_args(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_assemble_one_arg(language_t      *ctx,
-                                      language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t x86_assemble_one_arg(language_t    *ctx,
+                                      visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
     // Calculating result
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    if(frame->stage == VISIT_STAGE_PRE) {
+        visit_children(frame, &node->left, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
     //-----------------------------------------------------------------------//
     // Getting result from stack, calculating instruction value and pushing
     if(is_node_oper_eq(node, OPERATION_SQRT)) {
@@ -207,14 +290,16 @@ language_error_t x86_assemble_one_arg(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_assemble_comparison(language_t      *ctx,
-                                         language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t x86_assemble_comparison(language_t    *ctx,
+                                         visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    // Calculating left and right values
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->right));
+    // Left and right values are calculated by visitor before post stage
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     //-----------------------------------------------------------------------//
     // Getting left and right values from stack to XMM0 and XMM1
     ir_add_node(ctx, IR_INSTR_POP_XMM, _XMM(REGISTER_XMM1), (ir_arg_t){});
@@ -239,18 +324,25 @@ language_error_t x86_assemble_comparison(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_assemble_assignment(language_t      *ctx,
-                                     language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
-    _C_ASSERT(is_node_type_eq(node->left, NODE_TYPE_IDENTIFIER),
+language_error_t x86_assemble_assignment(language_t    *ctx,
+                                         visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    _C_ASSERT(is_node_type_eq(node_left(ctx, node), NODE_TYPE_IDENTIFIER),
               return LANGUAGE_UNEXPECTED_NODE_TYPE);
     //-----------------------------------------------------------------------//
-    size_t        id_index = node->left->value.identifier;
-    identifier_t *ident    = ctx->name_table.identifiers + id_index;
-    //-----------------------------------------------------------------------//
     // Calculating result of right node
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->right));
+    if(frame->stage == VISIT_STAGE_PRE) {
+        visit_children(frame, &node->right, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    size_t        id_index = node_identifier(node_left(ctx, node));
+    identifier_t *ident    = ctx->name_table.identifiers + id_index;
     //-----------------------------------------------------------------------//
     // Poping result to variable
     if(!ident->is_global) {
@@ -267,89 +359,127 @@ language_error_t x86_assemble_assignment(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_assemble_statements(language_t      *ctx,
-                                         language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t x86_assemble_statements(language_t    *ctx,
+                                         visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    while(node != NULL) {
-        _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
-        node = node->right;
-    }
+    // Statement is compiled and frame is replaced by the next statement
+    frame->need_in   = false;
+    frame->need_post = false;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t x86_assemble_if(language_t      *ctx,
-                                 language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t x86_assemble_if(language_t    *ctx,
+                                 visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    // Condition
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
-    if(!is_node_oper_eq(node->left, OPERATION_BIGGER) &&
-       !is_node_oper_eq(node->left, OPERATION_SMALLER)) {
-        _RETURN_IF_ERROR(compile_cmp_zero(ctx));
+    // Condition is left child and body is right child
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    switch(frame->stage) {
+        case VISIT_STAGE_PRE: {
+            break;
+        }
+        case VISIT_STAGE_IN: {
+            if(!is_node_oper_eq(node_left(ctx, node), OPERATION_BIGGER) &&
+               !is_node_oper_eq(node_left(ctx, node), OPERATION_SMALLER)) {
+                _RETURN_IF_ERROR(compile_cmp_zero(ctx));
+            }
+            // Checking if result(RAX) is FALSE
+            ir_add_node(ctx, IR_INSTR_TEST, _REG(REGISTER_RAX), _REG(REGISTER_RAX));
+            // Jump to skip body
+            ir_add_node(ctx, IR_INSTR_JZ, _CUSTOM(NULL), (ir_arg_t){});
+            frame->state[0].pointer = ir_last_node(ctx);
+            break;
+        }
+        case VISIT_STAGE_POST: {
+            // Node which is if end
+            ir_node_t *jmp_node = (ir_node_t *)frame->state[0].pointer;
+            ir_add_node(ctx, IR_CONTROL_JMP, _CUSTOM(jmp_node), (ir_arg_t){});
+            break;
+        }
+        default: {
+            return LANGUAGE_UNEXPECTED_NODE_TYPE;
+        }
     }
-    // Checking if result(RAX) is FALSE
-    ir_add_node(ctx, IR_INSTR_TEST, _REG(REGISTER_RAX), _REG(REGISTER_RAX));
-    // Jump to skip body
-    ir_add_node(ctx, IR_INSTR_JZ, _CUSTOM(NULL), (ir_arg_t){});
-    ir_node_t *jmp_node = ir_last_node(ctx);
-    //-----------------------------------------------------------------------//
-    // Body
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->right));
-    //-----------------------------------------------------------------------//
-    // Node which is if end
-    ir_add_node(ctx, IR_CONTROL_JMP, _CUSTOM(jmp_node), (ir_arg_t){});
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t x86_assemble_while(language_t      *ctx,
-                                    language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    // Condition start label
-    ir_add_node(ctx, IR_CONTROL_JMP, _CUSTOM(NULL), (ir_arg_t){});
-    // Condition
-    ir_node_t *while_start = ir_last_node(ctx);
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
-    if(!is_node_oper_eq(node->left, OPERATION_BIGGER) &&
-       !is_node_oper_eq(node->left, OPERATION_SMALLER)) {
-        _RETURN_IF_ERROR(compile_cmp_zero(ctx));
-    }
-    // Checking that result of condition is false
-    ir_add_node(ctx, IR_INSTR_TEST, _REG(REGISTER_RAX), _REG(REGISTER_RAX));
-    // Skipping body if false
-    ir_add_node(ctx, IR_INSTR_JZ, _CUSTOM(NULL), (ir_arg_t){});
-    ir_node_t *skip_jump_node = ir_last_node(ctx);
-    //-----------------------------------------------------------------------//
-    // Body
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->right));
-    //-----------------------------------------------------------------------//
-    // Jumping to condition
-    ir_add_node(ctx, IR_INSTR_JMP, _CUSTOM(while_start), (ir_arg_t){});
-    // Skip body label
-    ir_add_node(ctx, IR_CONTROL_JMP, _CUSTOM(skip_jump_node), (ir_arg_t){});
+language_error_t x86_assemble_while(language_t    *ctx,
+                                    visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // Condition is left child and body is right child
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    switch(frame->stage) {
+        case VISIT_STAGE_PRE: {
+            // Condition start label
+            ir_add_node(ctx, IR_CONTROL_JMP, _CUSTOM(NULL), (ir_arg_t){});
+            frame->state[0].pointer = ir_last_node(ctx);
+            break;
+        }
+        case VISIT_STAGE_IN: {
+            if(!is_node_oper_eq(node_left(ctx, node), OPERATION_BIGGER) &&
+               !is_node_oper_eq(node_left(ctx, node), OPERATION_SMALLER)) {
+                _RETURN_IF_ERROR(compile_cmp_zero(ctx));
+            }
+            // Checking that result of condition is false
+            ir_add_node(ctx, IR_INSTR_TEST, _REG(REGISTER_RAX), _REG(REGISTER_RAX));
+            // Skipping body if false
+            ir_add_node(ctx, IR_INSTR_JZ, _CUSTOM(NULL), (ir_arg_t){});
+            frame->state[1].pointer = ir_last_node(ctx);
+            break;
+        }
+        case VISIT_STAGE_POST: {
+            ir_node_t *while_start    = (ir_node_t *)frame->state[0].pointer;
+            ir_node_t *skip_jump_node = (ir_node_t *)frame->state[1].pointer;
+            // Jumping to condition
+            ir_add_node(ctx, IR_INSTR_JMP, _CUSTOM(while_start), (ir_arg_t){});
+            // Skip body label
+            ir_add_node(ctx, IR_CONTROL_JMP, _CUSTOM(skip_jump_node), (ir_arg_t){});
+            break;
+        }
+        default: {
+            return LANGUAGE_UNEXPECTED_NODE_TYPE;
+        }
+    }
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t x86_assemble_return(language_t      *ctx,
-                                 language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    // Calculating value of left node
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
+language_error_t x86_assemble_return(language_t    *ctx,
+                                     visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // Calculating value of left node, only arguments are calculated for
+    // tail call
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    if(frame->stage == VISIT_STAGE_PRE) {
+        if(is_tail_call(node_left(ctx, node))) {
+            visit_children(frame, &node_left(ctx, node_left(ctx, node))->left, NULL);
+        }
+        else {
+            visit_children(frame, &node->left, NULL);
+        }
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
+    if(is_tail_call(node_left(ctx, node))) {
+        return compile_tail_call(ctx, node_left(ctx, node));
+    }
     //-----------------------------------------------------------------------//
     // Return value in XMM0
     ir_add_node(ctx, IR_INSTR_POP_XMM, _XMM(REGISTER_XMM0), (ir_arg_t){});
@@ -368,57 +498,65 @@ language_error_t x86_assemble_return(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_assemble_params_line(language_t      *ctx,
-                                      language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t x86_assemble_params_line(language_t    *ctx,
+                                          visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    if(node->right != NULL) {
-        // Lower args have to be pushed first as in CDECL
-        _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->right));
-    }
-    // Calculating value of parameter and pushing it to stack
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
+    // Lower args have to be pushed first as in CDECL, then value of
+    // parameter is calculated and pushed to stack
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    visit_children(frame, &node->right, &node->left);
+    frame->need_in   = false;
+    frame->need_post = false;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t x86_assemble_new_var(language_t      *ctx,
-                                  language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t x86_assemble_new_var(language_t    *ctx,
+                                      visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    if(is_node_oper_eq(node->left, OPERATION_ASSIGNMENT)) {
-        _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    if(is_node_oper_eq(node_left(ctx, node), OPERATION_ASSIGNMENT)) {
+        visit_children(frame, &node->left, NULL);
+    }
+    else {
+        visit_children(frame, NULL, NULL);
     }
+    frame->need_in   = false;
+    frame->need_post = false;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t x86_assemble_new_func(language_t      *ctx,
-                                       language_node_t *node) {
+language_error_t x86_assemble_new_func(language_t    *ctx,
+                                       visit_frame_t *frame) {
     //-----------------------------------------------------------------------//
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
-    _C_ASSERT(is_node_type_eq(node->left, NODE_TYPE_IDENTIFIER),
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    _C_ASSERT(is_node_type_eq(node_left(ctx, node), NODE_TYPE_IDENTIFIER),
               return LANGUAGE_UNEXPECTED_NODE_TYPE);
     //-----------------------------------------------------------------------//
-    size_t id_index = node->left->value.identifier;
+    language_node_t *function = node_left(ctx, node);
+    size_t           id_index = node_identifier(function);
     // Function label in IR
     ir_add_node(ctx, IR_CONTROL_FUNC,
                 _CUSTOM(id_index), (ir_arg_t){});
     //-----------------------------------------------------------------------//
     // Adding memory addresses for parameters
-    language_node_t *params = node->left->left;
+    language_node_t *params = node_left(ctx, function);
     _RETURN_IF_ERROR(compile_params_addrs(ctx, params));
     //-----------------------------------------------------------------------//
     // Adding memory addresses for locals
     ctx->backend_info.used_locals = 1;
-    _RETURN_IF_ERROR(compile_locals_addrs(ctx, node->left->right));
+    _RETURN_IF_ERROR(compile_locals_addrs(ctx, function->right));
     ctx->backend_info.used_locals--;
     size_t total_locals = ctx->backend_info.used_locals;
 
@@ -431,7 +569,9 @@ language_error_t x86_assemble_new_func(language_t      *ctx,
                 _REG(REGISTER_RSP), _IMM(8 * total_locals));
     //-----------------------------------------------------------------------//
     // Function body
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left->right));
+    visit_children(frame, &function->right, NULL);
+    frame->need_in   = false;
+    frame->need_post = false;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -444,16 +584,16 @@ language_error_t compile_params_addrs(language_t      *ctx,
     //-----------------------------------------------------------------------//
     long counter = 0;
     while(param_linker != NULL) {
-        language_node_t *id_node = param_linker->left->left;
+        language_node_t *id_node = node_left(ctx, node_left(ctx, param_linker));
         if(!is_node_type_eq(id_node, NODE_TYPE_IDENTIFIER)) {
             print_error("Expected to see identifier in node.");
             return LANGUAGE_UNEXPECTED_NODE_TYPE;
         }
         identifier_t *ident = ctx->name_table.identifiers +
-                               id_node->value.identifier;
+                               node_identifier(id_node);
         ident->memory_addr = counter + 2;
         counter++;
-        param_linker = param_linker->right;
+        param_linker = node_right(ctx, param_linker);
     }
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -462,47 +602,56 @@ language_error_t compile_params_addrs(language_t      *ctx,
 //===========================================================================//
 
 language_error_t compile_locals_addrs(language_t *ctx,
-                                      language_node_t *node) {
+                                      uint32_t    node) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    if(node == NULL) {
-        return LANGUAGE_SUCCESS;
-    }
+    tree_visitor_t visitor = {};
+    visitor.pre = compile_local_addr;
+    language_error_t error_code = tree_visit(ctx, &visitor, &node);
+    tree_visitor_dtor(&visitor);
+    //-----------------------------------------------------------------------//
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t compile_local_addr(language_t    *ctx,
+                                    visit_frame_t *frame,
+                                    void          *) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
     if(is_node_oper_eq(node, OPERATION_NEW_VAR)) {
-        size_t id_index = node->left->value.identifier;
-        if(is_node_oper_eq(node->left, OPERATION_ASSIGNMENT)) {
-            id_index = node->left->left->value.identifier;
+        size_t id_index = node_identifier(node_left(ctx, node));
+        if(is_node_oper_eq(node_left(ctx, node), OPERATION_ASSIGNMENT)) {
+            id_index = node_identifier(node_left(ctx, node_left(ctx, node)));
         }
         identifier_t *ident = ctx->name_table.identifiers + id_index;
         ident->memory_addr = - (long)ctx->backend_info.used_locals;
         ctx->backend_info.used_locals++;
-        return LANGUAGE_SUCCESS;
+        visit_children(frame, NULL, NULL);
     }
-    _RETURN_IF_ERROR(compile_locals_addrs(ctx, node->left ));
-    _RETURN_IF_ERROR(compile_locals_addrs(ctx, node->right));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t x86_assemble_in(language_t      *ctx,
-                                 language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    // Searching for std_in in name table
-    size_t id_index = 0;
-    for(size_t i = 0; i < ctx->name_table.size; i++) {
-        identifier_t *ident = ctx->name_table.identifiers + i;
-        if(strncmp(ident->name, StdInName, StdInLen) == 0) {
-            id_index = i;
-            break;
-        }
-    }
+language_error_t x86_assemble_in(language_t    *ctx,
+                                 visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // std_in was added to name table by add_stdlib_id
+    language_node_t *node     = nodes_storage_get(ctx, *frame->link);
+    size_t           id_index = ctx->backend_info.std_in_index;
+    visit_children(frame, NULL, NULL);
+    frame->need_in   = false;
+    frame->need_post = false;
     //-----------------------------------------------------------------------//
     ir_add_node(ctx, IR_INSTR_CALL, _CUSTOM(id_index), (ir_arg_t){});
-    size_t dst_id_index = node->left->left->value.identifier;
+    size_t dst_id_index = node_identifier(node_left(ctx, node_left(ctx, node)));
     identifier_t *dst_ident = ctx->name_table.identifiers + dst_id_index;
     long mem_addr = dst_ident->memory_addr;
     if(dst_ident->is_global) {
@@ -519,23 +668,23 @@ language_error_t x86_assemble_in(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_assemble_out(language_t      *ctx,
-                              language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    // Searching for std_out in name table
-    size_t id_index = 0;
-    for(size_t i = 0; i < ctx->name_table.size; i++) {
-        identifier_t *ident = ctx->name_table.identifiers + i;
-        if(strncmp(ident->name, StdOutName, StdOutLen) == 0) {
-            id_index = i;
-            break;
-        }
-    }
+language_error_t x86_assemble_out(language_t    *ctx,
+                                  visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
     // Calculating parameter value
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left->left));
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    if(frame->stage == VISIT_STAGE_PRE) {
+        visit_children(frame, &node_left(ctx, node)->left, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(frame->stage != VISIT_STAGE_POST) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // std_out was added to name table by add_stdlib_id
+    size_t id_index = ctx->backend_info.std_out_index;
     //-----------------------------------------------------------------------//
     // Moving parameter to XMM0
     ir_add_node(ctx, IR_INSTR_POP_XMM, _XMM(REGISTER_XMM0), (ir_arg_t){});
@@ -547,27 +696,33 @@ language_error_t x86_assemble_out(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t x86_assemble_call(language_t      *ctx,
-                               language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t x86_assemble_call(language_t    *ctx,
+                                   visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
     // Skipping this node as it was added to compatibility
-    _RETURN_IF_ERROR(x86_compile_subtree(ctx, node->left));
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    visit_children(frame, &node->left, NULL);
+    frame->need_in   = false;
+    frame->need_post = false;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t x86_assemble_exit(language_t      *ctx,
-                               language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
+language_error_t x86_assemble_exit(language_t    *ctx,
+                                   visit_frame_t *frame) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
     ir_add_node(ctx, IR_INSTR_MOV, _REG(REGISTER_RAX), _IMM(0x3C));
     ir_add_node(ctx, IR_INSTR_MOV, _REG(REGISTER_RDI), _IMM(0));
     ir_add_node(ctx, IR_INSTR_SYSCALL, (ir_arg_t){}, (ir_arg_t){});
+    visit_children(frame, NULL, NULL);
+    frame->need_in   = false;
+    frame->need_post = false;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -595,6 +750,41 @@ language_error_t compile_cmp_zero(language_t *ctx) {
 
 //===========================================================================//
 
+bool is_tail_call(language_node_t *node) {
+    // Every frame has slots for the longest parameters list, so callee
+    // parameters always fit into them.
+    return is_node_oper_eq(node, OPERATION_CALL);
+}
+
+//===========================================================================//
+
+language_error_t compile_tail_call(language_t      *ctx,
+                                   language_node_t *call) {
+    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(call != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // Arguments are on stack with the first one on top, they are moved to
+    // parameters of this function
+    size_t        id_index = node_identifier(node_left(ctx, call));
+    identifier_t *ident    = ctx->name_table.identifiers + id_index;
+    for(size_t param = 0; param < ident->parameters_number; param++) {
+        ir_add_node(ctx, IR_INSTR_POP,
+                    _MEM(REGISTER_RBP, 8 * ((long)param + 2)), (ir_arg_t){});
+    }
+    // Deleting locals from stack
+    ir_add_node(ctx, IR_INSTR_ADD,
+                _REG(REGISTER_RSP), _IMM(8 * ctx->backend_info.used_locals));
+    // Resetting RBP
+    ir_add_node(ctx, IR_INSTR_POP,
+                _REG(REGISTER_RBP), (ir_arg_t){});
+    // Callee returns to caller of this function
+    ir_add_node(ctx, IR_INSTR_JMP_FUNC, _CUSTOM(id_index), (ir_arg_t){});
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
 language_error_t backend_ir_ctor(language_t *ctx, size_t capacity) {
     ctx->backend_info.nodes = (ir_node_t *)calloc(capacity, sizeof(ir_node_t));
     if(ctx->backend_info.nodes == NULL) {
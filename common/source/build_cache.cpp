@@ -0,0 +1,545 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "build_cache.h"
+#include "sha256.h"
+#include "mapped_file.h"
+#include "asm_x86.h"
+#include "colors.h"
+#include "utils.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+struct cache_object_t {
+    timespec                         used;
+    size_t                           size;
+    char                             name[BuildCacheKeyLength + 1];
+};
+
+//===========================================================================//
+
+static const char     BuildCacheMagic[8]    = {'K', 'V', 'M', 'B', 'U', 'I', 'L', 'D'};
+static const uint64_t BuildCacheVersion     = 1;
+static const char    *CompilerExecutable    = "/proc/self/exe";
+static const char    *BuildCacheObjects     = "objects/";
+static const char    *BuildCacheTemporary   = "objects/tmp.";
+static const char    *BuildCacheHits        = "hits";
+static const char    *BuildCacheMisses      = "misses";
+static const size_t   BuildCacheCounterSize = 20;
+static const size_t   BuildCachePathSize    = 1024;
+static const size_t   BuildCacheCopyChunk   = (size_t)1 << 30;
+static const size_t   BuildCacheBufferSize  = (size_t)1 << 16;
+static const time_t   BuildCacheStaleTime   = 60 * 60;
+static const mode_t   BuildCacheFileMode    = 0644;
+static const mode_t   BuildCacheDirMode     = 0755;
+
+//===========================================================================//
+
+static language_error_t compute_key     (language_t           *ctx);
+
+static bool             is_pipe         (const char           *filename);
+
+static language_error_t hash_file       (sha256_t             *sha,
+                                         const char           *filename);
+
+static language_error_t make_directories(language_t           *ctx);
+
+static bool             cache_path      (language_t           *ctx,
+                                         char                 *path,
+                                         const char           *prefix,
+                                         const char           *name);
+
+static language_error_t restore_output  (language_t           *ctx,
+                                         int                   object);
+
+static language_error_t copy_file       (int                   from,
+                                         int                   to);
+
+static language_error_t evict_objects   (language_t           *ctx,
+                                         size_t               *objects,
+                                         size_t               *size);
+
+static language_error_t read_objects    (language_t           *ctx,
+                                         DIR                  *directory,
+                                         cache_object_t      **output,
+                                         size_t               *number);
+
+static int              compare_objects (const void           *first,
+                                         const void           *second);
+
+static void             count_event     (language_t           *ctx,
+                                         const char           *name);
+
+static size_t           read_counter    (language_t           *ctx,
+                                         const char           *name);
+
+static size_t           counter_value   (int                   counter);
+
+static void             cache_warning   (language_t           *ctx,
+                                         const char           *message);
+
+//===========================================================================//
+
+language_error_t build_cache_lookup(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    // Several outputs of '-s' and streams (standard ones and named pipes)
+    // are not cached, missing input is reported by the stage itself.
+    ctx->build_cache.is_enabled = false;
+    if(ctx->build_cache.directory == NULL                              ||
+       ctx->save_temps                                                 ||
+       ctx->input_file  == NULL || strcmp(ctx->input_file , "-") == 0 ||
+       ctx->output_file == NULL || strcmp(ctx->output_file, "-") == 0 ||
+       is_pipe(ctx->input_file) || is_pipe(ctx->output_file)          ||
+       access(ctx->input_file, R_OK) != 0) {
+        return LANGUAGE_SUCCESS;
+    }
+    if(compute_key(ctx) != LANGUAGE_SUCCESS || make_directories(ctx) != LANGUAGE_SUCCESS) {
+        cache_warning(ctx, "can not be used");
+        return LANGUAGE_SUCCESS;
+    }
+    ctx->build_cache.is_enabled = true;
+    //-----------------------------------------------------------------------//
+    char path[BuildCachePathSize] = {};
+    int  object = -1;
+    if(cache_path(ctx, path, BuildCacheObjects, ctx->build_cache.key)) {
+        object = open(path, O_RDONLY);
+    }
+    if(object < 0) {
+        count_event(ctx, BuildCacheMisses);
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // Object can be removed by other build at any moment, opened one stays.
+    language_error_t error_code = restore_output(ctx, object);
+    if(error_code == LANGUAGE_SUCCESS) {
+        futimens(object, NULL);
+    }
+    close(object);
+    if(error_code != LANGUAGE_SUCCESS) {
+        cache_warning(ctx, "object was not copied to output");
+        count_event(ctx, BuildCacheMisses);
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    count_event(ctx, BuildCacheHits);
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Output was taken from build cache '%s' "
+                 "(" SZ_SP " hits, " SZ_SP " misses)\n",
+                 ctx->build_cache.directory,
+                 read_counter(ctx, BuildCacheHits),
+                 read_counter(ctx, BuildCacheMisses));
+    return LANGUAGE_BUILD_CACHE_HIT;
+}
+
+//===========================================================================//
+
+language_error_t build_cache_store(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    if(!ctx->build_cache.is_enabled) {
+        return LANGUAGE_SUCCESS;
+    }
+    ctx->build_cache.is_enabled = false;
+    char path     [BuildCachePathSize] = {};
+    char temporary[BuildCachePathSize] = {};
+    char unique   [BuildCacheKeyLength + 32] = {};
+    snprintf(unique, sizeof(unique), "%ld.%s", (long)getpid(), ctx->build_cache.key);
+    if(!cache_path(ctx, path     , BuildCacheObjects  , ctx->build_cache.key) ||
+       !cache_path(ctx, temporary, BuildCacheTemporary, unique)) {
+        cache_warning(ctx, "path is too long");
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // Object is complete before it gets its name, rename replaces objects
+    // stored by parallel builds with the same content.
+    int output = open(ctx->output_file, O_RDONLY);
+    int object = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, BuildCacheFileMode);
+    language_error_t error_code = LANGUAGE_OPENING_FILE_ERROR;
+    struct stat      output_stat = {};
+    if(output >= 0 && object >= 0 && fstat(output, &output_stat) == 0) {
+        error_code = copy_file(output, object);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        fchmod(object, output_stat.st_mode & 0777);
+    }
+    if(output >= 0) {
+        close(output);
+    }
+    if(object >= 0 && close(object) != 0) {
+        error_code = LANGUAGE_OPENING_FILE_ERROR;
+    }
+    if(error_code != LANGUAGE_SUCCESS || rename(temporary, path) != 0) {
+        unlink(temporary);
+        cache_warning(ctx, "output was not stored");
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    size_t objects = 0;
+    size_t size    = 0;
+    if(evict_objects(ctx, &objects, &size) != LANGUAGE_SUCCESS) {
+        cache_warning(ctx, "old objects were not removed");
+        return LANGUAGE_SUCCESS;
+    }
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Output was stored to build cache '%s' (" SZ_SP " objects, "
+                 SZ_SP " of " SZ_SP " KiB, " SZ_SP " hits, " SZ_SP " misses)\n",
+                 ctx->build_cache.directory,
+                 objects,
+                 size                   / 1024,
+                 ctx->build_cache.limit / 1024,
+                 read_counter(ctx, BuildCacheHits),
+                 read_counter(ctx, BuildCacheMisses));
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t compute_key(language_t *ctx) {
+    // Executable and stdlib stand for the compiler version, so rebuilt
+    // compiler never takes outputs of the old one.
+    sha256_t sha = {};
+    sha256_ctor(&sha);
+    sha256_update(&sha, BuildCacheMagic, sizeof(BuildCacheMagic));
+    sha256_update(&sha, &BuildCacheVersion, sizeof(BuildCacheVersion));
+    _RETURN_IF_ERROR(hash_file(&sha, CompilerExecutable));
+    _RETURN_IF_ERROR(hash_file(&sha, StdLibFilename));
+    uint64_t flags[] = {(uint64_t)ctx->machine_flag,
+                        (uint64_t)ctx->tree_format,
+                        (uint64_t)ctx->inline_limit,
+                        (uint64_t)ctx->has_inline_limit};
+    sha256_update(&sha, flags, sizeof(flags));
+    _RETURN_IF_ERROR(hash_file(&sha, ctx->input_file));
+    //-----------------------------------------------------------------------//
+    uint8_t digest[Sha256DigestSize] = {};
+    sha256_final(&sha, digest);
+    static const char HexDigits[] = "0123456789abcdef";
+    for(size_t elem = 0; elem < Sha256DigestSize; elem++) {
+        ctx->build_cache.key[2 * elem    ] = HexDigits[digest[elem] >> 4];
+        ctx->build_cache.key[2 * elem + 1] = HexDigits[digest[elem] & 0xf];
+    }
+    ctx->build_cache.key[BuildCacheKeyLength] = '\0';
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+bool is_pipe(const char *filename) {
+    // Missing output is created as regular file later.
+    struct stat info = {};
+    return stat(filename, &info) == 0 && !S_ISREG(info.st_mode);
+}
+
+//===========================================================================//
+
+language_error_t hash_file(sha256_t *sha, const char *filename) {
+    // Size goes first, so neighbour files can not be shifted into each other.
+    // Missing file has size which no file can have.
+    uint64_t size = UINT64_MAX;
+    if(access(filename, R_OK) != 0) {
+        sha256_update(sha, &size, sizeof(size));
+        return LANGUAGE_SUCCESS;
+    }
+    mapped_file_t file = {};
+    _RETURN_IF_ERROR(mapped_file_open(&file, filename));
+    size = file.size;
+    sha256_update(sha, &size, sizeof(size));
+    sha256_update(sha, file.data, file.size);
+    return mapped_file_close(&file);
+}
+
+//===========================================================================//
+
+language_error_t make_directories(language_t *ctx) {
+    char path[BuildCachePathSize] = {};
+    if(!cache_path(ctx, path, BuildCacheObjects, "")) {
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    if((mkdir(ctx->build_cache.directory, BuildCacheDirMode) != 0 && errno != EEXIST) ||
+       (mkdir(path                      , BuildCacheDirMode) != 0 && errno != EEXIST)) {
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+bool cache_path(language_t *ctx,
+                char       *path,
+                const char *prefix,
+                const char *name) {
+    int length = snprintf(path,
+                          BuildCachePathSize,
+                          "%s/%s%s",
+                          ctx->build_cache.directory,
+                          prefix,
+                          name);
+    return length >= 0 && (size_t)length < BuildCachePathSize;
+}
+
+//===========================================================================//
+
+language_error_t restore_output(language_t *ctx, int object) {
+    struct stat object_stat = {};
+    if(fstat(object, &object_stat) != 0) {
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    int output = open(ctx->output_file, O_WRONLY | O_CREAT | O_TRUNC, BuildCacheFileMode);
+    if(output < 0) {
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    // Output gets mode of the stored one, so ELF stays executable.
+    language_error_t error_code = copy_file(object, output);
+    if(error_code == LANGUAGE_SUCCESS &&
+       fchmod(output, object_stat.st_mode & 0777) != 0) {
+        error_code = LANGUAGE_OPENING_FILE_ERROR;
+    }
+    if(close(output) != 0) {
+        error_code = LANGUAGE_OPENING_FILE_ERROR;
+    }
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t copy_file(int from, int to) {
+    // Kernel copies data without user buffers or shares extents of the file
+    // system, read and write are used where it is not supported.
+    while(true) {
+        ssize_t copied = copy_file_range(from, NULL, to, NULL, BuildCacheCopyChunk, 0);
+        if(copied == 0) {
+            return LANGUAGE_SUCCESS;
+        }
+        if(copied < 0) {
+            break;
+        }
+    }
+    if(errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP) {
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    char *buffer = (char *)malloc(BuildCacheBufferSize);
+    if(buffer == NULL) {
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    language_error_t error_code = LANGUAGE_SUCCESS;
+    while(error_code == LANGUAGE_SUCCESS) {
+        ssize_t size = read(from, buffer, BuildCacheBufferSize);
+        if(size <= 0) {
+            error_code = size == 0 ? LANGUAGE_SUCCESS : LANGUAGE_OPENING_FILE_ERROR;
+            break;
+        }
+        for(ssize_t written = 0; written < size; ) {
+            ssize_t part = write(to, buffer + written, (size_t)(size - written));
+            if(part <= 0) {
+                error_code = LANGUAGE_OPENING_FILE_ERROR;
+                break;
+            }
+            written += part;
+        }
+    }
+    free(buffer);
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t evict_objects(language_t *ctx, size_t *objects, size_t *size) {
+    char path[BuildCachePathSize] = {};
+    if(!cache_path(ctx, path, BuildCacheObjects, "")) {
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    DIR *directory = opendir(path);
+    if(directory == NULL) {
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    cache_object_t  *list       = NULL;
+    size_t           number     = 0;
+    language_error_t error_code = read_objects(ctx, directory, &list, &number);
+    closedir(directory);
+    if(error_code != LANGUAGE_SUCCESS) {
+        free(list);
+        return error_code;
+    }
+    //-----------------------------------------------------------------------//
+    // Least recently used objects go first. Object removed by parallel
+    // build is just not counted.
+    *size = 0;
+    for(size_t elem = 0; elem < number; elem++) {
+        *size += list[elem].size;
+    }
+    qsort(list, number, sizeof(list[0]), compare_objects);
+    size_t first = 0;
+    while(*size > ctx->build_cache.limit && first < number) {
+        cache_object_t *object = list + first++;
+        if(cache_path(ctx, path, BuildCacheObjects, object->name)) {
+            unlink(path);
+        }
+        *size -= object->size;
+    }
+    *objects = number - first;
+    free(list);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_objects(language_t      *ctx,
+                              DIR             *directory,
+                              cache_object_t **output,
+                              size_t          *number) {
+    size_t capacity = 0;
+    char   path[BuildCachePathSize] = {};
+    time_t now      = time(NULL);
+    while(true) {
+        dirent *entry = readdir(directory);
+        if(entry == NULL) {
+            return LANGUAGE_SUCCESS;
+        }
+        //-------------------------------------------------------------------//
+        // Temporary files of crashed builds are removed when they are old.
+        struct stat entry_stat = {};
+        bool is_object    = strlen(entry->d_name) == BuildCacheKeyLength;
+        bool is_temporary = strncmp(entry->d_name, "tmp.", 4) == 0;
+        if((!is_object && !is_temporary)                            ||
+           !cache_path(ctx, path, BuildCacheObjects, entry->d_name) ||
+           stat(path, &entry_stat) != 0) {
+            continue;
+        }
+        if(is_temporary) {
+            if(now - entry_stat.st_mtime > BuildCacheStaleTime) {
+                unlink(path);
+            }
+            continue;
+        }
+        //-------------------------------------------------------------------//
+        if(*number == capacity) {
+            size_t          new_capacity = capacity == 0 ? 64 : capacity * 2;
+            cache_object_t *new_list     = (cache_object_t *)realloc(*output,
+                                                                     new_capacity * sizeof(new_list[0]));
+            if(new_list == NULL) {
+                return LANGUAGE_MEMORY_ERROR;
+            }
+            *output  = new_list;
+            capacity = new_capacity;
+        }
+        cache_object_t *object = *output + (*number)++;
+        object->used = entry_stat.st_mtim;
+        object->size = (size_t)entry_stat.st_size;
+        memcpy(object->name, entry->d_name, sizeof(object->name));
+    }
+}
+
+//===========================================================================//
+
+int compare_objects(const void *first, const void *second) {
+    const timespec *first_time  = &((const cache_object_t *)first )->used;
+    const timespec *second_time = &((const cache_object_t *)second)->used;
+    if(first_time->tv_sec != second_time->tv_sec) {
+        return first_time->tv_sec < second_time->tv_sec ? -1 : 1;
+    }
+    if(first_time->tv_nsec != second_time->tv_nsec) {
+        return first_time->tv_nsec < second_time->tv_nsec ? -1 : 1;
+    }
+    return 0;
+}
+
+//===========================================================================//
+
+void count_event(language_t *ctx, const char *name) {
+    // Counter is a fixed width decimal number rewritten in place under
+    // exclusive lock, so it does not grow with the number of builds.
+    char path[BuildCachePathSize] = {};
+    if(!cache_path(ctx, path, name, "")) {
+        return;
+    }
+    int counter = open(path, O_RDWR | O_CREAT, BuildCacheFileMode);
+    if(counter < 0) {
+        return;
+    }
+    char text[BuildCacheCounterSize + 1] = {};
+    if(flock(counter, LOCK_EX) != 0) {
+        cache_warning(ctx, "counter was not updated");
+        close(counter);
+        return;
+    }
+    size_t value = counter_value(counter) + 1;
+    text[BuildCacheCounterSize] = '\n';
+    for(size_t digit = BuildCacheCounterSize; digit > 0; digit--) {
+        text[digit - 1] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    if(pwrite(counter, text, BuildCacheCounterSize + 1, 0) != (ssize_t)BuildCacheCounterSize + 1 ||
+       ftruncate(counter, (off_t)BuildCacheCounterSize + 1) != 0) {
+        cache_warning(ctx, "counter was not updated");
+    }
+    close(counter);
+}
+
+//===========================================================================//
+
+size_t read_counter(language_t *ctx, const char *name) {
+    char path[BuildCachePathSize] = {};
+    if(!cache_path(ctx, path, name, "")) {
+        return 0;
+    }
+    int counter = open(path, O_RDONLY);
+    if(counter < 0) {
+        return 0;
+    }
+    size_t value = 0;
+    if(flock(counter, LOCK_SH) == 0) {
+        value = counter_value(counter);
+    }
+    close(counter);
+    return value;
+}
+
+//===========================================================================//
+
+size_t counter_value(int counter) {
+    // Counters of older caches have one byte per build, they are converted
+    // on the next update.
+    struct stat counter_stat = {};
+    if(fstat(counter, &counter_stat) != 0) {
+        return 0;
+    }
+    char text[BuildCacheCounterSize + 1] = {};
+    if((size_t)counter_stat.st_size != BuildCacheCounterSize + 1 ||
+       pread(counter, text, BuildCacheCounterSize + 1, 0) != (ssize_t)BuildCacheCounterSize + 1 ||
+       text[BuildCacheCounterSize] != '\n') {
+        return (size_t)counter_stat.st_size;
+    }
+    size_t value = 0;
+    for(size_t digit = 0; digit < BuildCacheCounterSize; digit++) {
+        if(text[digit] < '0' || text[digit] > '9') {
+            return (size_t)counter_stat.st_size;
+        }
+        value = value * 10 + (size_t)(text[digit] - '0');
+    }
+    return value;
+}
+
+//===========================================================================//
+
+void cache_warning(language_t *ctx, const char *message) {
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Build cache '%s' %s.\n",
+                 ctx->build_cache.directory,
+                 message);
+}
+
+//===========================================================================//
@@ -34,6 +34,9 @@ static const char *bold = "1";
 //start of color code
 static const char *color_code_start = "\033[";
 
+//stream of all messages
+static FILE *console_stream = stdout;
+
 static printing_state_t reset_color     (void);
 static printing_state_t print_color_code(color_t      color,
                                          boldness_t   is_bold,
@@ -63,17 +66,22 @@ int  color_vprintf (color_t      color,
                     va_list      args) {
     _C_ASSERT(format != NULL, return -1);
     print_color_code(color, is_bold, background);
-    int printed_symbols = vprintf(format, args);
+    int printed_symbols = vfprintf(console_stream, format, args);
     reset_color();
     return printed_symbols;
 }
 
+void color_output(FILE *stream) {
+    _C_ASSERT(stream != NULL, return);
+    console_stream = stream;
+}
+
 int print_error(const char *message, ...) {
     print_color_code(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND);
 
     va_list args;
     va_start(args, message);
-    int result = vprintf(message, args);
+    int result = vfprintf(console_stream, message, args);
     va_end(args);
     reset_color();
     return result;
@@ -82,39 +90,39 @@ int print_error(const char *message, ...) {
 printing_state_t print_color_code(color_t      color,
                                   boldness_t   is_bold,
                                   background_t background) {
-    printf("%s", color_code_start);
+    fprintf(console_stream, "%s", color_code_start);
     if(is_bold == BOLD_TEXT) {
-        printf("%s", bold);
+        fprintf(console_stream, "%s", bold);
         if(color != DEFAULT_TEXT || background != DEFAULT_BACKGROUND)
-            putchar(';');
+            fputc(';', console_stream);
 
         else {
-            putchar('m');
+            fputc('m', console_stream);
             return PRINTING_SUCCESS;
         }
     }
     if(color != DEFAULT_TEXT) {
         const char *code = color_code(color);
         _C_ASSERT(code != NULL, );
-        printf("%s", code);
+        fprintf(console_stream, "%s", code);
         if(background != DEFAULT_BACKGROUND)
-            putchar(';');
+            fputc(';', console_stream);
         else {
-            putchar('m');
+            fputc('m', console_stream);
             return PRINTING_SUCCESS;
         }
     }
     if(background != DEFAULT_BACKGROUND) {
         const char *code = background_code(background);
         _C_ASSERT(code != NULL, );
-        printf("%sm", code);
+        fprintf(console_stream, "%sm", code);
         return PRINTING_SUCCESS;
     }
     return reset_color();
 }
 
 printing_state_t reset_color(void){
-    if(printf("%s0m", color_code_start) <= 0)
+    if(fprintf(console_stream, "%s0m", color_code_start) <= 0)
         return PRINTING_FAILURE;
     return PRINTING_SUCCESS;
 }
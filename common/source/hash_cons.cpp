@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "hash_cons.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static const size_t HashConsMinCapacity = 64;
+
+//===========================================================================//
+
+static size_t           entry_hash        (const hash_cons_entry_t *key);
+
+static bool             is_same_key       (const hash_cons_entry_t *first,
+                                           const hash_cons_entry_t *second);
+
+static language_error_t rehash_entries    (hash_cons_t             *table,
+                                           size_t                   capacity);
+
+//===========================================================================//
+
+language_error_t hash_cons_ctor(hash_cons_t *table, size_t capacity) {
+    _C_ASSERT(table != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    // Table is at most half full, so capacity is twice the expected size.
+    size_t real_capacity = HashConsMinCapacity;
+    while(real_capacity < capacity * 2) {
+        real_capacity *= 2;
+    }
+    *table       = {};
+    table->scope = 1;
+    return rehash_entries(table, real_capacity);
+}
+
+//===========================================================================//
+
+language_error_t hash_cons_dtor(hash_cons_t *table) {
+    _C_ASSERT(table != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    free(table->entries);
+    *table = {};
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void hash_cons_scope(hash_cons_t *table) {
+    table->scope++;
+    table->size = 0;
+}
+
+//===========================================================================//
+
+language_error_t hash_cons_insert(hash_cons_t             *table,
+                                  const hash_cons_entry_t *key,
+                                  hash_cons_entry_t      **entry) {
+    _C_ASSERT(table != NULL, return LANGUAGE_NULL_OUTPUT);
+    _C_ASSERT(key   != NULL, return LANGUAGE_NULL_OUTPUT);
+    _C_ASSERT(entry != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    // Table grows before insertion, so returned entry stays in place until
+    // the next insertion.
+    if((table->size + 1) * 2 > table->capacity) {
+        _RETURN_IF_ERROR(rehash_entries(table, table->capacity * 2));
+    }
+    size_t mask   = table->capacity - 1;
+    size_t bucket = entry_hash(key) & mask;
+    while(table->entries[bucket].scope == table->scope) {
+        if(is_same_key(table->entries + bucket, key)) {
+            *entry = table->entries + bucket;
+            return LANGUAGE_SUCCESS;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+    //-----------------------------------------------------------------------//
+    table->entries[bucket]       = *key;
+    table->entries[bucket].scope = table->scope;
+    table->size++;
+    *entry = table->entries + bucket;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+hash_cons_entry_t *hash_cons_find(hash_cons_t *table, const hash_cons_entry_t *key) {
+    size_t mask   = table->capacity - 1;
+    size_t bucket = entry_hash(key) & mask;
+    while(table->entries[bucket].scope == table->scope) {
+        if(is_same_key(table->entries + bucket, key)) {
+            return table->entries + bucket;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+    return NULL;
+}
+
+//===========================================================================//
+
+bool hash_cons_is_pure(language_t *ctx, const language_node_t *node) {
+    // Operations from addition to comparisons have no side effects, calls
+    // and everything else are never shared.
+    switch(node_type(node)) {
+        case NODE_TYPE_NUMBER: {
+            return true;
+        }
+        case NODE_TYPE_IDENTIFIER: {
+            return ctx->name_table.identifiers[node_identifier(node)].type ==
+                   IDENTIFIER_VARIABLE &&
+                   node->left == NodeNone && node->right == NodeNone;
+        }
+        case NODE_TYPE_OPERATION: {
+            return node_opcode(node) >= OPERATION_ADD &&
+                   node_opcode(node) <= OPERATION_SMALLER;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+//===========================================================================//
+
+void hash_cons_key(const language_node_t *node, hash_cons_entry_t *key) {
+    // Boxed value already holds the type.
+    *key        = {};
+    key->type   = (uint64_t)node_type(node);
+    key->value  = node->value;
+    key->left   = node->left;
+    key->right  = node->right;
+}
+
+//===========================================================================//
+
+size_t entry_hash(const hash_cons_entry_t *key) {
+    // Parts are mixed by multiplication, xor-shift spreads high bits down.
+    uint64_t hash = key->type;
+    hash = (hash ^ key->value) * 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ key->left ) * 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ key->right) * 0x9E3779B97F4A7C15ull;
+    return (size_t)(hash ^ (hash >> 29));
+}
+
+//===========================================================================//
+
+bool is_same_key(const hash_cons_entry_t *first, const hash_cons_entry_t *second) {
+    return first->type  == second->type  &&
+           first->value == second->value &&
+           first->left  == second->left  &&
+           first->right == second->right;
+}
+
+//===========================================================================//
+
+language_error_t rehash_entries(hash_cons_t *table, size_t capacity) {
+    hash_cons_entry_t *entries = (hash_cons_entry_t *)calloc(capacity, sizeof(entries[0]));
+    if(entries == NULL) {
+        print_error("Error while allocating hash-consing table.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    // Only entries of the current scope are moved.
+    size_t mask = capacity - 1;
+    for(size_t elem = 0; elem < table->capacity; elem++) {
+        hash_cons_entry_t *entry = table->entries + elem;
+        if(entry->scope != table->scope) {
+            continue;
+        }
+        size_t bucket = entry_hash(entry) & mask;
+        while(entries[bucket].scope == table->scope) {
+            bucket = (bucket + 1) & mask;
+        }
+        entries[bucket] = *entry;
+    }
+    free(table->entries);
+    table->entries  = entries;
+    table->capacity = capacity;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
@@ -10,6 +10,7 @@
 
 #include "language.h"
 #include "lang_dump.h"
+#include "tree_visitor.h"
 #include "colors.h"
 #include "custom_assert.h"
 
@@ -29,10 +30,17 @@ static const size_t BufferSize = 256;
 //===========================================================================//
 
 static language_error_t dump_subtree   (language_t         *ctx,
-                                        language_node_t    *root,
-                                        size_t              level,
+                                        uint32_t            root,
                                         FILE               *dot_file);
 
+static language_error_t dump_node      (language_t         *ctx,
+                                        visit_frame_t      *frame,
+                                        void               *dot_file);
+
+static language_error_t dump_right_edge(language_t         *ctx,
+                                        visit_frame_t      *frame,
+                                        void               *dot_file);
+
 static language_error_t write_value     (language_t        *ctx,
                                          language_node_t   *node,
                                          FILE              *dot_file);
@@ -64,7 +72,9 @@ language_error_t dump_ctor(language_t *ctx, const char *filename) {
 language_error_t dump_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    fclose(ctx->dump_info.general_dump);
+    if(ctx->dump_info.general_dump != NULL) {
+        fclose(ctx->dump_info.general_dump);
+    }
     if(memset(&ctx->dump_info, 0, sizeof(ctx->dump_info)) != &ctx->dump_info) {
         print_error("Error while setting dump info to zeros\n");
         return LANGUAGE_MEMORY_ERROR;
@@ -94,7 +104,7 @@ language_error_t dump_tree(language_t *ctx, const char *format, ...) {
     fprintf(dot_file,
             "digraph {\n"
             "node[shape = Mrecord, style = filled];\n");
-    _RETURN_IF_ERROR(dump_subtree(ctx, ctx->root, 0, dot_file));
+    _RETURN_IF_ERROR(dump_subtree(ctx, ctx->root, dot_file));
     fprintf(dot_file, "}\n");
     fclose(dot_file);
     //-----------------------------------------------------------------------//
@@ -126,35 +136,85 @@ language_error_t dump_tree(language_t *ctx, const char *format, ...) {
 
 //===========================================================================//
 
+language_error_t dump_message(language_t *ctx, const char *format, ...) {
+    _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL          );
+    _C_ASSERT(format != NULL, return LANGUAGE_STRING_FORMAT_NULL);
+    //-----------------------------------------------------------------------//
+    // Programs which optimize trees without dumps do not open the file.
+    if(ctx->dump_info.general_dump == NULL) {
+        return LANGUAGE_SUCCESS;
+    }
+    fprintf(ctx->dump_info.general_dump, "<p>");
+    va_list args;
+    va_start(args, format);
+    vfprintf(ctx->dump_info.general_dump, format, args);
+    va_end(args);
+    fprintf(ctx->dump_info.general_dump, "</p>\n");
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
 language_error_t dump_subtree(language_t       *ctx,
-                              language_node_t  *root,
-                              size_t            level,
+                              uint32_t          root,
                               FILE             *dot_file) {
     _C_ASSERT(ctx      != NULL, return LANGUAGE_CTX_NULL);
-    _C_ASSERT(root     != NULL, return LANGUAGE_NODE_NULL);
     _C_ASSERT(dot_file != NULL, return LANGUAGE_DUMP_FILE_ERROR);
     //-----------------------------------------------------------------------//
-    if(fprintf(dot_file,
+    tree_visitor_t visitor = {};
+    visitor.pre  = dump_node;
+    visitor.in   = dump_right_edge;
+    visitor.data = dot_file;
+    language_error_t error_code = tree_visit(ctx, &visitor, &root);
+    tree_visitor_dtor(&visitor);
+    //-----------------------------------------------------------------------//
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t dump_node(language_t    *ctx,
+                           visit_frame_t *frame,
+                           void          *dot_file) {
+    _C_ASSERT(ctx      != NULL, return LANGUAGE_CTX_NULL);
+    _C_ASSERT(frame    != NULL, return LANGUAGE_NODE_NULL);
+    _C_ASSERT(dot_file != NULL, return LANGUAGE_DUMP_FILE_ERROR);
+    //-----------------------------------------------------------------------//
+    language_node_t *root = nodes_storage_get(ctx, *frame->link);
+    FILE            *file = (FILE *)dot_file;
+    if(fprintf(file,
                "node%p[fillcolor = \"%s\", rank = %lu, label = \"{%p | {%p | %p} | ",
                root,
                get_node_color(ctx, root),
-               level,
+               frame->level,
                root,
-               root->left,
-               root->right) < 0) {
+               node_left(ctx, root),
+               node_right(ctx, root)) < 0) {
         print_error("Error while writing to dot file.\n");
         return LANGUAGE_DUMP_FILE_ERROR;
     }
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(write_value(ctx, root, dot_file));
+    _RETURN_IF_ERROR(write_value(ctx, root, file));
     //-----------------------------------------------------------------------//
-    if(root->left != NULL) {
-        fprintf(dot_file, "node%p -> node%p;\n", root, root->left);
-        _RETURN_IF_ERROR(dump_subtree(ctx, root->left, level + 1, dot_file));
+    if(root->left != NodeNone) {
+        fprintf(file, "node%p -> node%p;\n", root, node_left(ctx, root));
     }
-    if(root->right != NULL) {
-        fprintf(dot_file, "node%p -> node%p;\n", root, root->right);
-        _RETURN_IF_ERROR(dump_subtree(ctx, root->right, level + 1, dot_file));
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t dump_right_edge(language_t    *ctx,
+                                 visit_frame_t *frame,
+                                 void          *dot_file) {
+    _C_ASSERT(ctx      != NULL, return LANGUAGE_CTX_NULL);
+    _C_ASSERT(frame    != NULL, return LANGUAGE_NODE_NULL);
+    _C_ASSERT(dot_file != NULL, return LANGUAGE_DUMP_FILE_ERROR);
+    //-----------------------------------------------------------------------//
+    language_node_t *root = nodes_storage_get(ctx, *frame->link);
+    if(root->right != NodeNone) {
+        fprintf((FILE *)dot_file, "node%p -> node%p;\n", root, node_right(ctx, root));
     }
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -169,26 +229,26 @@ language_error_t write_value(language_t      *ctx,
     _C_ASSERT(node     != NULL, return LANGUAGE_NODE_NULL      );
     _C_ASSERT(dot_file != NULL, return LANGUAGE_DUMP_FILE_ERROR);
     //-----------------------------------------------------------------------//
-    switch(node->type) {
+    switch(node_type(node)) {
         case NODE_TYPE_NUMBER: {
-            if(fprintf(dot_file, "NUMBER | %lg }\"];\n", node->value.number) < 0) {
+            if(fprintf(dot_file, "NUMBER | %lg }\"];\n", node_number(node)) < 0) {
                 print_error("Error while writing to dot_file.\n");
                 return LANGUAGE_DUMP_FILE_ERROR;
             }
             break;
         }
         case NODE_TYPE_OPERATION: {
-            const char *string_operation = KeyWords[node->value.opcode].name;
-            if     (node->value.opcode == OPERATION_BODY_START) {
+            const char *string_operation = KeyWords[node_opcode(node)].name;
+            if     (node_opcode(node) == OPERATION_BODY_START) {
                 string_operation = "body_start";
             }
-            else if(node->value.opcode == OPERATION_BODY_END) {
+            else if(node_opcode(node) == OPERATION_BODY_END) {
                 string_operation = "body_end";
             }
-            else if(node->value.opcode == OPERATION_BIGGER) {
+            else if(node_opcode(node) == OPERATION_BIGGER) {
                 string_operation = "bigger";
             }
-            else if(node->value.opcode == OPERATION_SMALLER) {
+            else if(node_opcode(node) == OPERATION_SMALLER) {
                 string_operation = "smaller";
             }
 
@@ -198,10 +258,10 @@ language_error_t write_value(language_t      *ctx,
             break;
         }
         case NODE_TYPE_IDENTIFIER: {
-            identifier_t *ident = ctx->name_table.identifiers + node->value.identifier;
+            identifier_t *ident = ctx->name_table.identifiers + node_identifier(node);
             if(fprintf(dot_file,
                        "IDENTIFIER | %lu - %.*s}\"];\n",
-                       node->value.identifier,
+                       node_identifier(node),
                        (int)ident->length,
                        ident->name) < 0) {
                 print_error("Error while writing to dot file.\n");
@@ -224,12 +284,12 @@ const char *get_node_color(language_t *ctx, language_node_t *node) {
     _C_ASSERT(ctx  != NULL, return NULL );
     _C_ASSERT(node != NULL, return NULL);
     //-----------------------------------------------------------------------//
-    switch(node->type) {
+    switch(node_type(node)) {
         case NODE_TYPE_NUMBER: {
             return node_color_number;
         }
         case NODE_TYPE_IDENTIFIER: {
-            identifier_t *ident = ctx->name_table.identifiers + node->value.identifier;
+            identifier_t *ident = ctx->name_table.identifiers + node_identifier(node);
             switch(ident->type) {
                 case IDENTIFIER_FUNCTION: {
                     return node_color_ident_function;
@@ -247,7 +307,7 @@ const char *get_node_color(language_t *ctx, language_node_t *node) {
             }
         }
         case NODE_TYPE_OPERATION: {
-            if(node->value.opcode == OPERATION_STATEMENT) {
+            if(node_opcode(node) == OPERATION_STATEMENT) {
                 return node_color_statement_end;
             }
             else {
@@ -418,6 +478,7 @@ const char *intr_string(ir_instr_t instr) {
         case IR_INSTR_NOT    : {return "not";}
         case IR_INSTR_PUSH_XMM: {return "pushXMM";}
         case IR_INSTR_POP_XMM: {return "popXMM";}
+        case IR_INSTR_JMP_FUNC: {return "jmpFunc";}
         default              : {return NULL;}
     }
 }
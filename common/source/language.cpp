@@ -10,6 +10,11 @@
 #include "utils.h"
 #include "name_table.h"
 #include "custom_assert.h"
+#include "mapped_file.h"
+#include "number_parser.h"
+#include "tree_binary.h"
+#include "tree_visitor.h"
+#include "output.h"
 //===========================================================================//
 
 struct file_elem_t {
@@ -44,16 +49,83 @@ static language_error_t handler_machine  (language_t       *ctx,
                                           size_t            position,
                                           const char       *argv[]);
 
+static language_error_t handler_threads  (language_t       *ctx,
+                                          int               argc,
+                                          size_t            position,
+                                          const char       *argv[]);
+
+static language_error_t handler_cache    (language_t       *ctx,
+                                          int               argc,
+                                          size_t            position,
+                                          const char       *argv[]);
+
+static language_error_t handler_build    (language_t       *ctx,
+                                          int               argc,
+                                          size_t            position,
+                                          const char       *argv[]);
+
+static language_error_t handler_limit    (language_t       *ctx,
+                                          int               argc,
+                                          size_t            position,
+                                          const char       *argv[]);
+
+static language_error_t handler_format   (language_t       *ctx,
+                                          int               argc,
+                                          size_t            position,
+                                          const char       *argv[]);
+
+static language_error_t handler_temps    (language_t       *ctx,
+                                          int               argc,
+                                          size_t            position,
+                                          const char       *argv[]);
+
+static language_error_t handler_inline   (language_t       *ctx,
+                                          int               argc,
+                                          size_t            position,
+                                          const char       *argv[]);
+
 static language_error_t skip_spaces      (language_t       *ctx);
 
+static language_error_t add_nodes_chunk  (language_t       *ctx);
+
 static language_error_t write_subtree    (language_t       *ctx,
-                                          language_node_t  *node,
-                                          FILE             *output);
+                                          uint32_t          node,
+                                          output_t         *output);
+
+static language_error_t write_node_start (language_t       *ctx,
+                                          visit_frame_t    *frame,
+                                          void             *output);
+
+static language_error_t write_node_middle(language_t       *ctx,
+                                          visit_frame_t    *frame,
+                                          void             *output);
+
+static language_error_t write_node_end   (language_t       *ctx,
+                                          visit_frame_t    *frame,
+                                          void             *output);
+
+static language_error_t read_tree_input  (language_t       *ctx,
+                                          bool              reachable,
+                                          bool              whole);
+
+static language_error_t read_tree_text   (language_t       *ctx);
 
 static language_error_t read_name_table  (language_t       *ctx);
 
 static language_error_t read_subtree     (language_t       *ctx,
-                                          language_node_t **output);
+                                          uint32_t         *output);
+
+static language_error_t read_node_start  (language_t       *ctx,
+                                          visit_frame_t    *frame,
+                                          void             *data);
+
+static language_error_t read_node_middle (language_t       *ctx,
+                                          visit_frame_t    *frame,
+                                          void             *data);
+
+static language_error_t read_node_end    (language_t       *ctx,
+                                          visit_frame_t    *frame,
+                                          void             *data);
 
 static language_error_t get_nt_name      (language_t        *ctx,
                                           void              *output,
@@ -87,16 +159,6 @@ static language_error_t get_node_value   (language_t        *ctx,
                                           char               symbol,
                                           file_elem_t       *rules);
 
-static language_error_t get_node_left    (language_t        *ctx,
-                                          void *             output,
-                                          char               symbol,
-                                          file_elem_t       *rules);
-
-static language_error_t get_node_right   (language_t        *ctx,
-                                          void              *output,
-                                          char               symbol,
-                                          file_elem_t       *rules);
-
 static language_error_t create_node      (language_t        *ctx,
                                           void              *output,
                                           char               symbol,
@@ -110,109 +172,269 @@ static language_error_t get_bool         (language_t        *ctx,
 //===========================================================================//
 
 static const flag_prototype_t SupportedFlags[] = {
-    {"-o", "--output" , 1, handler_output },
-    {"-i", "--input"  , 1, handler_input  },
-    {"-m", "--machine", 1, handler_machine},
+    {"-o"            , "--output"      , 1, handler_output },
+    {"-i"            , "--input"       , 1, handler_input  },
+    {"-m"            , "--machine"     , 1, handler_machine},
+    {"-j"            , "--threads"     , 1, handler_threads},
+    {"-c"            , "--cache"       , 1, handler_cache  },
+    {"-b"            , "--build-cache" , 1, handler_build  },
+    {"-l"            , "--cache-limit" , 1, handler_limit  },
+    {"-f"            , "--format"      , 1, handler_format },
+    {"-s"            , "--save-temps"  , 0, handler_temps  },
+    {"-finline-limit", "--inline-limit", 1, handler_inline },
 };
 
+//---------------------------------------------------------------------------//
+
+static const size_t BuildCacheDefaultLimit = 256;
+static const size_t BuildCacheLimitUnit    = 1024 * 1024;
+
 //===========================================================================//
 
-language_error_t nodes_storage_ctor(language_t *ctx, size_t capacity) {
+language_error_t nodes_storage_ctor(language_t *ctx, size_t capacity, bool with_sources) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    ctx->nodes.nodes = (language_node_t *)calloc(capacity,
-                                                 sizeof(ctx->nodes.nodes[0]));
-    if(ctx->nodes.nodes == NULL) {
+    size_t chunks_capacity = (capacity + NodesChunkSize - 1) >> NodesChunkShift;
+    if(chunks_capacity == 0) {
+        chunks_capacity = 1;
+    }
+    ctx->nodes.chunks = (language_node_t **)calloc(chunks_capacity,
+                                                   sizeof(ctx->nodes.chunks[0]));
+    if(ctx->nodes.chunks == NULL) {
         print_error("Error while allocating nodes memory.\n");
         return LANGUAGE_MEMORY_ERROR;
     }
+    // Source info is needed only for diagnostics of the frontend.
+    ctx->nodes.sources = NULL;
+    if(with_sources) {
+        ctx->nodes.sources = (source_info_t **)calloc(chunks_capacity,
+                                                      sizeof(ctx->nodes.sources[0]));
+        if(ctx->nodes.sources == NULL) {
+            print_error("Error while allocating nodes memory.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+    }
     //-----------------------------------------------------------------------//
-    ctx->nodes.size     = 0;
-    ctx->nodes.capacity = capacity;
+    ctx->nodes.chunks_number   = 0;
+    ctx->nodes.chunks_capacity = chunks_capacity;
+    ctx->nodes.size            = 0;
+    ctx->nodes.attached_chunks = 0;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t nodes_storage_add(language_t       *ctx,
-                                   node_type_t       type,
-                                   value_t           value,
-                                   const char       *name,
-                                   size_t            length,
-                                   language_node_t **output) {
+language_error_t nodes_storage_add(language_t *ctx,
+                                   node_type_t type,
+                                   value_t     value,
+                                   const char *name,
+                                   size_t      length,
+                                   uint32_t   *output) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    if(ctx->nodes.size >= ctx->nodes.capacity) {
-        print_error("Nodes storage size does not know how to reallocate memory. "
-                    "Plz implement it or, change capacity when initializing.\n");
-        return LANGUAGE_MEMORY_ERROR;
+    if(ctx->nodes.size == ctx->nodes.chunks_number << NodesChunkShift) {
+        _RETURN_IF_ERROR(add_nodes_chunk(ctx));
     }
     //-----------------------------------------------------------------------//
-    language_node_t *node = ctx->nodes.nodes + ctx->nodes.size;
-    ctx->nodes.size++;
-    node->type               = type;
-    node->value              = value;
-    node->source_info.name   = name;
-    node->source_info.length = length;
-    node->source_info.line   = ctx->frontend_info.current_line;
+    uint32_t         index = (uint32_t)ctx->nodes.size++;
+    language_node_t *node  = nodes_storage_get(ctx, index);
+    node_set_value(node, type, value);
+    node->left  = NodeNone;
+    node->right = NodeNone;
+    source_info_t *source = nodes_storage_source(ctx, index);
+    if(source != NULL) {
+        source->name   = name;
+        source->length = length;
+        source->line   = ctx->frontend_info.current_line;
+    }
     //-----------------------------------------------------------------------//
     if(output != NULL) {
-        *output = node;
+        *output = index;
     }
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
+language_error_t nodes_storage_reserve(language_t *ctx,
+                                       size_t      number,
+                                       size_t     *first) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(first != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    // Reserved nodes are filled later by other contexts that share these
+    // chunks, so chunks are never added while they are used.
+    *first = ctx->nodes.size;
+    while((ctx->nodes.chunks_number << NodesChunkShift) < ctx->nodes.size + number) {
+        _RETURN_IF_ERROR(add_nodes_chunk(ctx));
+    }
+    ctx->nodes.size += number;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t nodes_storage_attach(language_t      *ctx,
+                                      language_node_t *nodes,
+                                      size_t           number) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(nodes != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // Array owned by someone else becomes the first chunks, it must have
+    // room for whole chunks. Nodes added later go to the last free places
+    // and then to own chunks, attached ones are never freed.
+    size_t chunks_number = (number + NodesChunkSize - 1) >> NodesChunkShift;
+    _RETURN_IF_ERROR(nodes_storage_ctor(ctx, number, false));
+    for(size_t chunk = 0; chunk < chunks_number; chunk++) {
+        ctx->nodes.chunks[chunk] = nodes + (chunk << NodesChunkShift);
+    }
+    ctx->nodes.chunks_number   = chunks_number;
+    ctx->nodes.attached_chunks = chunks_number;
+    ctx->nodes.size            = number;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
 language_error_t nodes_storage_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    free(ctx->nodes.nodes);
-    ctx->nodes.nodes    = NULL;
-    ctx->nodes.capacity = 0;
-    ctx->nodes.size     = 0;
+    for(size_t chunk = ctx->nodes.attached_chunks;
+        chunk < ctx->nodes.chunks_number;
+        chunk++) {
+        free(ctx->nodes.chunks[chunk]);
+    }
+    if(ctx->nodes.sources != NULL) {
+        for(size_t chunk = 0; chunk < ctx->nodes.chunks_number; chunk++) {
+            free(ctx->nodes.sources[chunk]);
+        }
+    }
+    free(ctx->nodes.chunks);
+    free(ctx->nodes.sources);
+    memset(&ctx->nodes, 0, sizeof(ctx->nodes));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t read_tree(language_t *ctx) {
+language_error_t add_nodes_chunk(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    FILE *input = fopen(ctx->input_file, "rb");
+    // Indices must stay below NodeNone.
+    if((ctx->nodes.chunks_number + 1) << NodesChunkShift > NodeNone) {
+        print_error("Too many nodes.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    if(ctx->nodes.chunks_number == ctx->nodes.chunks_capacity) {
+        size_t new_capacity = ctx->nodes.chunks_capacity * 2;
+        language_node_t **new_chunks =
+            (language_node_t **)realloc(ctx->nodes.chunks,
+                                        new_capacity * sizeof(new_chunks[0]));
+        if(new_chunks == NULL) {
+            print_error("Error while reallocating nodes chunks table.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        ctx->nodes.chunks = new_chunks;
+        if(ctx->nodes.sources != NULL) {
+            source_info_t **new_sources =
+                (source_info_t **)realloc(ctx->nodes.sources,
+                                          new_capacity * sizeof(new_sources[0]));
+            if(new_sources == NULL) {
+                print_error("Error while reallocating nodes chunks table.\n");
+                return LANGUAGE_MEMORY_ERROR;
+            }
+            ctx->nodes.sources = new_sources;
+        }
+        ctx->nodes.chunks_capacity = new_capacity;
+    }
     //-----------------------------------------------------------------------//
-    if(input == NULL) {
-        print_error("Error while opening file '%s'.\n", ctx->input_file);
-        return LANGUAGE_OPENING_FILE_ERROR;
+    // All ones are a node of unknown type without children, so reserved
+    // nodes which are never filled are not taken for valid ones.
+    language_node_t *chunk = (language_node_t *)malloc(NodesChunkSize * sizeof(chunk[0]));
+    if(chunk == NULL) {
+        print_error("Error while allocating nodes memory.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    memset(chunk, 0xFF, NodesChunkSize * sizeof(chunk[0]));
+    if(ctx->nodes.sources != NULL) {
+        source_info_t *sources = (source_info_t *)calloc(NodesChunkSize, sizeof(sources[0]));
+        if(sources == NULL) {
+            free(chunk);
+            print_error("Error while allocating nodes memory.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        ctx->nodes.sources[ctx->nodes.chunks_number] = sources;
     }
+    ctx->nodes.chunks[ctx->nodes.chunks_number++] = chunk;
     //-----------------------------------------------------------------------//
-    ctx->input_size = file_size(input);
-    ctx->input = (char *)calloc(ctx->input_size, sizeof(ctx->input[0]));
-    if(fread(ctx->input,
-             sizeof(char),
-             ctx->input_size,
-             input) != ctx->input_size) {
-        print_error("Error while reading code tree file.\n");
-        fclose(input);
-        return LANGUAGE_READING_TREE_ERROR;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_tree(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    return read_tree_input(ctx, false, true);
+}
+
+//===========================================================================//
+
+language_error_t read_tree_reachable(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    // Text and stream trees have no function index, so they are read whole.
+    return read_tree_input(ctx, true, true);
+}
+
+//===========================================================================//
+
+language_error_t read_tree_streaming(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    // Statements of stream trees are left to read_tree_frame.
+    return read_tree_input(ctx, false, false);
+}
+
+//===========================================================================//
+
+language_error_t read_tree_input(language_t *ctx, bool reachable, bool whole) {
+    // Only the magic is waited for before format is known, so stream tree
+    // is read while its writer is running.
+    _RETURN_IF_ERROR(mapped_file_open_stream(&ctx->input_map, ctx->input_file));
+    _RETURN_IF_ERROR(mapped_file_fill(&ctx->input_map, sizeof(TreeStreamMagic)));
+    if(is_stream_tree(ctx->input_map.data, ctx->input_map.size)) {
+        return read_tree_stream(ctx, whole);
     }
-    fclose(input);
     //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(mapped_file_fill(&ctx->input_map, SIZE_MAX));
+    ctx->input          = ctx->input_map.data;
+    ctx->input_size     = ctx->input_map.size;
     ctx->input_position = ctx->input;
+    if(is_binary_tree(ctx->input, ctx->input_size)) {
+        return read_tree_binary(ctx, reachable);
+    }
+    return read_tree_text(ctx);
+}
+
+//===========================================================================//
+
+language_error_t read_tree_text(language_t *ctx) {
     _RETURN_IF_ERROR(read_name_table(ctx));
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(skip_spaces(ctx));
-    char *nodes_number_end = NULL;
-    size_t nodes_number = strtoull(ctx->input_position, &nodes_number_end, 10);
+    size_t      nodes_number     = 0;
+    const char *nodes_number_end = parse_size(ctx->input_position,
+                                              &nodes_number);
     if(nodes_number_end == NULL) {
         print_error("Unexpected code file structure. "
                     "It is expected to see nodes number before nodes.\n");
         return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
     }
     ctx->input_position = nodes_number_end;
-    _RETURN_IF_ERROR(nodes_storage_ctor(ctx, nodes_number));
+    _RETURN_IF_ERROR(nodes_storage_ctor(ctx, nodes_number, false));
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(read_subtree(ctx, &ctx->root));
     //-----------------------------------------------------------------------//
@@ -225,8 +447,9 @@ language_error_t read_name_table(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(skip_spaces(ctx));
-    char *length_end = NULL;
-    size_t name_table_size = strtoull(ctx->input_position, &length_end, 10);
+    size_t      name_table_size = 0;
+    const char *length_end      = parse_size(ctx->input_position,
+                                             &name_table_size);
     if(length_end == NULL) {
         print_error("Tree file expected to start with name table length.\n");
         return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
@@ -279,8 +502,8 @@ language_error_t get_size(language_t *ctx, void *length, char, file_elem_t *) {
     _C_ASSERT(length != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(skip_spaces(ctx));
-    char *name_length_end = NULL;
-    *(size_t *)length = strtoull(ctx->input_position, &name_length_end, 10);
+    const char *name_length_end = parse_size(ctx->input_position,
+                                             (size_t *)length);
     if(name_length_end == NULL) {
         return nt_error(ctx);
     }
@@ -296,9 +519,9 @@ language_error_t get_id_type(language_t *ctx, void *type, char, file_elem_t *) {
     _C_ASSERT(type != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(skip_spaces(ctx));
-    char *type_end = NULL;
-    *(identifier_type_t *)type = (identifier_type_t)strtol(ctx->input_position,
-                                                           &type_end, 10);
+    size_t      type_value = 0;
+    const char *type_end   = parse_size(ctx->input_position, &type_value);
+    *(identifier_type_t *)type = (identifier_type_t)type_value;
     if(type_end == NULL) {
         return nt_error(ctx);
     }
@@ -373,22 +596,48 @@ language_error_t nt_error(language_t *ctx) {
 
 //===========================================================================//
 
-language_error_t read_subtree(language_t *ctx, language_node_t **output) {
+language_error_t read_subtree(language_t *ctx, uint32_t *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
-    node_type_t      type  = (node_type_t)0;
-    value_t          value = {};
-    language_node_t *node  = NULL;
+    // Visitor goes through links which are filled by nodes as they are read,
+    // closing brackets of statements chain are checked when it ends.
+    tree_visitor_t visitor = {};
+    visitor.pre         = read_node_start;
+    visitor.in          = read_node_middle;
+    visitor.post        = read_node_end;
+    visitor.visit_null  = true;
+    visitor.shared_post = true;
+    language_error_t error_code = tree_visit(ctx, &visitor, output);
+    tree_visitor_dtor(&visitor);
+    //-----------------------------------------------------------------------//
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t read_node_start(language_t *ctx, visit_frame_t *frame, void *) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(skip_spaces(ctx));
+    if(*ctx->input_position == '_') {
+        ctx->input_position++;
+        visit_children(frame, NULL, NULL);
+        frame->need_in   = false;
+        frame->need_post = false;
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    node_type_t type  = (node_type_t)0;
+    value_t     value = {};
+    uint32_t    index = NodeNone;
 
     file_elem_t node_elems[] = {
         {'{', NULL  , check_char    },
         {EOF, &type , get_node_type },
         {EOF, &value, get_node_value},
-        {EOF, &node , create_node   },
-        {EOF, NULL  , get_node_left },
-        {EOF, NULL  , get_node_right},
-        {'}', NULL  , check_char    }};
+        {EOF, &index, create_node   }};
     //-----------------------------------------------------------------------//
     for(size_t i = 0; i < sizeof(node_elems) / sizeof(node_elems[0]); i++) {
         _RETURN_IF_ERROR(node_elems[i].reader(ctx,
@@ -397,7 +646,40 @@ language_error_t read_subtree(language_t *ctx, language_node_t **output) {
                                               node_elems));
     }
     //-----------------------------------------------------------------------//
-    *output = node;
+    // Empty children are skipped here, so frames are pushed only for nodes.
+    language_node_t *node = nodes_storage_get(ctx, index);
+    *frame->link = index;
+    visit_children(frame, &node->left, &node->right);
+    _RETURN_IF_ERROR(skip_spaces(ctx));
+    if(*ctx->input_position == '_') {
+        ctx->input_position++;
+        frame->children[0] = NULL;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_node_middle(language_t *ctx, visit_frame_t *frame, void *) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(frame != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(skip_spaces(ctx));
+    if(*ctx->input_position == '_') {
+        ctx->input_position++;
+        frame->children[1] = NULL;
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_node_end(language_t *ctx, visit_frame_t *, void *) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(check_char(ctx, NULL, '}', NULL));
+    //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
@@ -411,9 +693,9 @@ language_error_t get_node_type(language_t *ctx,
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(skip_spaces(ctx));
-    char *type_end = NULL;
-    node_type_t type = (node_type_t)strtol(ctx->input_position,
-                                           &type_end, 10);
+    size_t      type_value = 0;
+    const char *type_end   = parse_size(ctx->input_position, &type_value);
+    node_type_t type       = (node_type_t)type_value;
     if(type_end == NULL) {
         print_error("Nodes are written as {TYPE VALUE LEFT RIGHT}");
         return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
@@ -434,23 +716,23 @@ language_error_t get_node_value(language_t  *ctx,
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     _C_ASSERT(rules  != NULL, return LANGUAGE_RULES_NULL );
     //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(skip_spaces(ctx));
     node_type_t type = *(node_type_t *)rules[1].output;
-    char *value_end = NULL;
-    value_t *value = (value_t *)output;
+    const char *value_end = NULL;
+    value_t    *value     = (value_t *)output;
     switch(type) {
         case NODE_TYPE_IDENTIFIER: {
-            value->identifier = strtoull(ctx->input_position,
-                                         &value_end, 10);
+            value_end = parse_size(ctx->input_position, &value->identifier);
             break;
         }
         case NODE_TYPE_NUMBER: {
-            value->number = strtod(ctx->input_position,
-                                   &value_end);
+            value_end = parse_double(ctx->input_position, &value->number);
             break;
         }
         case NODE_TYPE_OPERATION: {
-            value->opcode = (operation_t)strtol(ctx->input_position,
-                                                &value_end, 10);
+            size_t opcode = 0;
+            value_end = parse_size(ctx->input_position, &opcode);
+            value->opcode = (operation_t)opcode;
             break;
         }
         default: {
@@ -459,6 +741,10 @@ language_error_t get_node_value(language_t  *ctx,
         }
     }
     //-----------------------------------------------------------------------//
+    if(value_end == NULL) {
+        print_error("Nodes are written as {TYPE VALUE LEFT RIGHT}");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
     ctx->input_position = value_end;
     return LANGUAGE_SUCCESS;
 }
@@ -476,97 +762,131 @@ language_error_t create_node(language_t *ctx, void *output, char, file_elem_t *r
                                        type,
                                        *value,
                                        NULL, 0,
-                                       (language_node_t **)output));
+                                       (uint32_t *)output));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t get_node_left(language_t *ctx, void *, char, file_elem_t *rules) {
-    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL  );
-    _C_ASSERT(rules != NULL, return LANGUAGE_RULES_NULL);
+language_error_t write_tree(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    language_node_t *node = *(language_node_t **)rules[3].output;
-    _RETURN_IF_ERROR(skip_spaces(ctx));
-    if(*ctx->input_position != '_') {
-        _RETURN_IF_ERROR(read_subtree(ctx, &node->left));
+    if(ctx->tree_format == TREE_FORMAT_STREAM) {
+        return write_tree_stream(ctx);
     }
-    else {
-        ctx->input_position++;
+    FILE *output = tree_file_open(ctx);
+    if(output == NULL) {
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    if(ctx->tree_format == TREE_FORMAT_BINARY || ctx->tree_format == TREE_FORMAT_DAG) {
+        language_error_t error_code = write_tree_binary(ctx, output);
+        tree_file_close(output);
+        return error_code;
     }
     //-----------------------------------------------------------------------//
-    return LANGUAGE_SUCCESS;
-}
-
-//===========================================================================//
-
-language_error_t get_node_right(language_t *ctx, void *, char, file_elem_t *rules) {
-    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL  );
-    _C_ASSERT(rules != NULL, return LANGUAGE_RULES_NULL);
-    //-----------------------------------------------------------------------//
-    language_node_t *node = *(language_node_t **)rules[3].output;
-    _RETURN_IF_ERROR(skip_spaces(ctx));
-    if(*ctx->input_position != '_') {
-        _RETURN_IF_ERROR(read_subtree(ctx, &node->right));
+    output_t         buffer     = {};
+    language_error_t error_code = output_format(&buffer,
+                                                SZ_SP "\r\n",
+                                                ctx->name_table.size);
+    for(size_t elem = 0;
+        elem < ctx->name_table.size && error_code == LANGUAGE_SUCCESS;
+        elem++) {
+        identifier_t *ident = ctx->name_table.identifiers + elem;
+        error_code = output_format(&buffer,
+                                   "{" SZ_SP " %.*s %d %d %lu}\n",
+                                   ident->length,
+                                   (int)ident->length,
+                                   ident->name,
+                                   ident->type,
+                                   ident->is_global,
+                                   ident->parameters_number);
     }
-    else {
-        ctx->input_position++;
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = output_format(&buffer, "\r\n" SZ_SP "\r\n", ctx->nodes.size);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = write_subtree(ctx, ctx->root, &buffer);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = output_flush(&buffer, output);
     }
     //-----------------------------------------------------------------------//
-    return LANGUAGE_SUCCESS;
+    output_dtor(&buffer);
+    tree_file_close(output);
+    return error_code;
 }
 
 //===========================================================================//
 
-language_error_t write_tree(language_t *ctx) {
-    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+FILE *tree_file_open(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return NULL);
     //-----------------------------------------------------------------------//
+    // Messages go to stderr when tree goes to stdout, see handler_output.
+    if(ctx->output_file != NULL && strcmp(ctx->output_file, "-") == 0) {
+        return stdout;
+    }
     FILE *output = fopen(ctx->output_file, "wb");
     if(output == NULL) {
         print_error("Error while opening file to write tree.\n");
-        return LANGUAGE_OPENING_FILE_ERROR;
     }
-    //-----------------------------------------------------------------------//
-    fprintf(output, SZ_SP "\r\n", ctx->name_table.size);
-    for(size_t elem = 0; elem < ctx->name_table.size; elem++) {
-        identifier_t *ident = ctx->name_table.identifiers + elem;
-        fprintf(output,
-                "{" SZ_SP " %.*s %d %d %lu}\n",
-                ident->length,
-                (int)ident->length,
-                ident->name,
-                ident->type,
-                ident->is_global,
-                ident->parameters_number);
+    return output;
+}
+
+//===========================================================================//
+
+void tree_file_close(FILE *output) {
+    if(output == stdout) {
+        fflush(output);
+    }
+    else {
+        fclose(output);
     }
+}
+
+//===========================================================================//
+
+language_error_t write_subtree(language_t *ctx, uint32_t node, output_t *output) {
+    _C_ASSERT(ctx    != NULL    , return LANGUAGE_CTX_NULL          );
+    _C_ASSERT(node   != NodeNone, return LANGUAGE_NODE_NULL         );
+    _C_ASSERT(output != NULL, return LANGUAGE_OPENING_FILE_ERROR);
     //-----------------------------------------------------------------------//
-    fprintf(output, "\r\n" SZ_SP "\r\n", ctx->nodes.size);
-    language_error_t error_code = write_subtree(ctx, ctx->root, output);
+    // Closing brackets do not depend on node, so statements chain takes one
+    // frame and its brackets are written when it ends.
+    tree_visitor_t visitor = {};
+    visitor.pre         = write_node_start;
+    visitor.in          = write_node_middle;
+    visitor.post        = write_node_end;
+    visitor.data        = output;
+    visitor.shared_post = true;
+    language_error_t error_code = tree_visit(ctx, &visitor, &node);
+    tree_visitor_dtor(&visitor);
     //-----------------------------------------------------------------------//
-    fclose(output);
     return error_code;
 }
 
 //===========================================================================//
 
-language_error_t write_subtree(language_t *ctx, language_node_t *node, FILE *output) {
-    _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL          );
-    _C_ASSERT(node   != NULL, return LANGUAGE_NODE_NULL         );
+language_error_t write_node_start(language_t *ctx, visit_frame_t *frame, void *output) {
+    _C_ASSERT(frame  != NULL, return LANGUAGE_NODE_NULL         );
     _C_ASSERT(output != NULL, return LANGUAGE_OPENING_FILE_ERROR);
-    //-----------------------------------------------------------------------//s
-    fprintf(output, "{ %d ", node->type);
-    switch(node->type) {
+    //-----------------------------------------------------------------------//
+    language_node_t *node   = nodes_storage_get(ctx, *frame->link);
+    output_t        *buffer = (output_t *)output;
+    _RETURN_IF_ERROR(output_string(buffer, "{ ", 2));
+    _RETURN_IF_ERROR(output_signed(buffer, node_type(node)));
+    _RETURN_IF_ERROR(output_char(buffer, ' '));
+    switch(node_type(node)) {
         case NODE_TYPE_IDENTIFIER: {
-            fprintf(output, SZ_SP " ", node->value.identifier);
+            _RETURN_IF_ERROR(output_unsigned(buffer, node_identifier(node), 0));
             break;
         }
         case NODE_TYPE_NUMBER: {
-            fprintf(output, "%lg ", node->value.number);
+            _RETURN_IF_ERROR(output_double(buffer, node_number(node)));
             break;
         }
         case NODE_TYPE_OPERATION: {
-            fprintf(output, "%d ", node->value.opcode);
+            _RETURN_IF_ERROR(output_signed(buffer, node_opcode(node)));
             break;
         }
         default: {
@@ -575,25 +895,33 @@ language_error_t write_subtree(language_t *ctx, language_node_t *node, FILE *out
         }
     }
     //-----------------------------------------------------------------------//
-    if(node->left != NULL) {
-        _RETURN_IF_ERROR(write_subtree(ctx, node->left, output));
+    _RETURN_IF_ERROR(output_char(buffer, ' '));
+    if(node->left == NodeNone) {
+        _RETURN_IF_ERROR(output_string(buffer, "_ ", 2));
     }
-    else {
-        fprintf(output, "_ ");
-    }
-    if(node->right != NULL) {
-        _RETURN_IF_ERROR(write_subtree(ctx, node->right, output));
-    }
-    else {
-        fprintf(output, "_ ");
-    }
-    //-----------------------------------------------------------------------//
-    fprintf(output, "} ");
+    frame->need_in = node->right == NodeNone;
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
+language_error_t write_node_middle(language_t *, visit_frame_t *, void *output) {
+    _C_ASSERT(output != NULL, return LANGUAGE_OPENING_FILE_ERROR);
+    //-----------------------------------------------------------------------//
+    // Called only for nodes without right child.
+    return output_string((output_t *)output, "_ ", 2);
+}
+
+//===========================================================================//
+
+language_error_t write_node_end(language_t *, visit_frame_t *, void *output) {
+    _C_ASSERT(output != NULL, return LANGUAGE_OPENING_FILE_ERROR);
+    //-----------------------------------------------------------------------//
+    return output_string((output_t *)output, "} ", 2);
+}
+
+//===========================================================================//
+
 language_error_t verify_keywords(void) {
     for(size_t i = 1; i < sizeof(KeyWords) / sizeof(KeyWords[0]); i++) {
         if((size_t)KeyWords[i].code != i) {
@@ -667,6 +995,10 @@ language_error_t handler_output(language_t *ctx,
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
     ctx->output_file = argv[position + 1];
+    // Output to stdout is used in pipes, so messages go to stderr.
+    if(strcmp(ctx->output_file, "-") == 0) {
+        color_output(stderr);
+    }
     return LANGUAGE_SUCCESS;
 }
 
@@ -691,6 +1023,130 @@ language_error_t handler_machine(language_t       *ctx,
 
 //===========================================================================//
 
+language_error_t handler_threads(language_t       *ctx,
+                                 int             /*argc*/,
+                                 size_t            position,
+                                 const char       *argv[]) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    size_t      threads = 0;
+    const char *end     = parse_size(argv[position + 1], &threads);
+    if(end == NULL || *end != '\0' || threads == 0) {
+        print_error("Threads number is expected to be positive integer, "
+                    "got '%s'.\n",
+                    argv[position + 1]);
+        return LANGUAGE_PARSING_FLAGS_ERROR;
+    }
+    ctx->threads_number = threads;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t handler_cache(language_t *ctx,
+                               int       /*argc*/,
+                               size_t      position,
+                               const char *argv[]) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    ctx->cache_file = argv[position + 1];
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t handler_build(language_t *ctx,
+                               int       /*argc*/,
+                               size_t      position,
+                               const char *argv[]) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    ctx->build_cache.directory = argv[position + 1];
+    if(ctx->build_cache.limit == 0) {
+        ctx->build_cache.limit = BuildCacheDefaultLimit * BuildCacheLimitUnit;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t handler_limit(language_t *ctx,
+                               int       /*argc*/,
+                               size_t      position,
+                               const char *argv[]) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    size_t      limit = 0;
+    const char *end   = parse_size(argv[position + 1], &limit);
+    if(end == NULL || *end != '\0' || limit == 0 ||
+       limit > SIZE_MAX / BuildCacheLimitUnit) {
+        print_error("Build cache limit is expected to be positive number "
+                    "of megabytes, got '%s'.\n",
+                    argv[position + 1]);
+        return LANGUAGE_PARSING_FLAGS_ERROR;
+    }
+    ctx->build_cache.limit = limit * BuildCacheLimitUnit;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t handler_format(language_t *ctx,
+                                int       /*argc*/,
+                                size_t      position,
+                                const char *argv[]) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    const char *format_flags[] = {"text", "binary", "dag", "stream"};
+    size_t flags_num = sizeof(format_flags) / sizeof(format_flags[0]);
+    for(size_t i = 0; i < flags_num; i++) {
+        if(strcmp(format_flags[i], argv[position + 1]) == 0) {
+            ctx->tree_format = (tree_format_t)(i + 1);
+            return LANGUAGE_SUCCESS;
+        }
+    }
+    print_error("Tree format is expected to be 'text', 'binary', 'dag' or 'stream', "
+                "got '%s'.\n",
+                argv[position + 1]);
+    return LANGUAGE_PARSING_FLAGS_ERROR;
+}
+
+//===========================================================================//
+
+language_error_t handler_temps(language_t *ctx,
+                               int       /*argc*/,
+                               size_t    /*position*/,
+                               const char */*argv*/[]) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    ctx->save_temps = true;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t handler_inline(language_t *ctx,
+                                int       /*argc*/,
+                                size_t      position,
+                                const char *argv[]) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    // Zero turns inlining off.
+    size_t      limit = 0;
+    const char *end   = parse_size(argv[position + 1], &limit);
+    if(end == NULL || *end != '\0') {
+        print_error("Inline limit is expected to be number of nodes, "
+                    "got '%s'.\n",
+                    argv[position + 1]);
+        return LANGUAGE_PARSING_FLAGS_ERROR;
+    }
+    ctx->inline_limit     = limit;
+    ctx->has_inline_limit = true;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
 language_error_t skip_spaces(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
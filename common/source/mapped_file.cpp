@@ -0,0 +1,296 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "mapped_file.h"
+#include "tree_binary.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static const size_t     StreamReadInitSize = 1 << 16;
+
+//===========================================================================//
+
+static language_error_t map_regular_file (mapped_file_t *file,
+                                          int            descriptor,
+                                          size_t         size,
+                                          size_t         capacity,
+                                          bool           populate);
+
+static language_error_t read_stream      (mapped_file_t *file,
+                                          int            descriptor,
+                                          bool           owns_descriptor);
+
+static void             stream_stop      (mapped_file_t *file);
+
+static bool             is_stdin_name    (const char    *filename);
+
+//===========================================================================//
+
+language_error_t mapped_file_open(mapped_file_t *file, const char *filename) {
+    _C_ASSERT(file != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(mapped_file_open_stream(file, filename));
+    return mapped_file_fill(file, SIZE_MAX);
+}
+
+//===========================================================================//
+
+language_error_t mapped_file_open_stream(mapped_file_t *file, const char *filename) {
+    _C_ASSERT(file != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    if(is_stdin_name(filename)) {
+        return read_stream(file, STDIN_FILENO, false);
+    }
+    //-----------------------------------------------------------------------//
+    int descriptor = open(filename, O_RDONLY);
+    if(descriptor < 0) {
+        print_error("Error while opening file '%s'. "
+                    "May be the file does not exist.\n",
+                    filename);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    // Pipes are read by mapped_file_fill and closed at their end.
+    struct stat file_stat = {};
+    if(fstat(descriptor, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+        return read_stream(file, descriptor, true);
+    }
+    language_error_t error_code = map_regular_file(file,
+                                                   descriptor,
+                                                   (size_t)file_stat.st_size,
+                                                   0,
+                                                   false);
+    close(descriptor);
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t mapped_file_fill(mapped_file_t *file, size_t size) {
+    _C_ASSERT(file != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    // Read returns what writer has already written, so data of a pipe is
+    // available as soon as it is written and not at its end.
+    while(file->is_streaming && file->size < size) {
+        if(file->size + 1 >= file->capacity) {
+            char *new_data = (char *)realloc(file->data, file->capacity * 2);
+            if(new_data == NULL) {
+                stream_stop(file);
+                print_error("Error while allocating memory for input.\n");
+                return LANGUAGE_MEMORY_ERROR;
+            }
+            file->data      = new_data;
+            file->capacity *= 2;
+        }
+        //-------------------------------------------------------------------//
+        ssize_t read_size = read(file->descriptor,
+                                 file->data + file->size,
+                                 file->capacity - file->size - 1);
+        if(read_size < 0 && errno == EINTR) {
+            continue;
+        }
+        if(read_size < 0) {
+            stream_stop(file);
+            print_error("Error while reading input.\n");
+            return LANGUAGE_READING_SOURCE_ERROR;
+        }
+        if(read_size == 0) {
+            stream_stop(file);
+            break;
+        }
+        file->size += (size_t)read_size;
+        file->data[file->size] = '\0';
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t mapped_file_close(mapped_file_t *file) {
+    _C_ASSERT(file != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    stream_stop(file);
+    if(file->mapping_size != 0) {
+        munmap(file->data, file->mapping_size);
+    }
+    else {
+        free(file->data);
+    }
+    memset(file, 0, sizeof(*file));
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t mapped_file_reserve(mapped_file_t *file,
+                                     const char    *filename,
+                                     size_t         capacity,
+                                     bool           populate) {
+    _C_ASSERT(file != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    if(file->mapping_size > capacity) {
+        return LANGUAGE_SUCCESS;
+    }
+    if(file->mapping_size == 0) {
+        char *new_data = (char *)realloc(file->data, capacity + 1);
+        if(new_data == NULL) {
+            print_error("Error while allocating memory for input.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        memset(new_data + file->size, 0, capacity + 1 - file->size);
+        file->data     = new_data;
+        file->capacity = capacity + 1;
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // File is mapped again with bigger reservation, its pages are private
+    // in both mappings, so nothing was changed in the old one.
+    int descriptor = open(filename, O_RDONLY);
+    if(descriptor < 0) {
+        print_error("Error while opening file '%s'.\n", filename);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    size_t size = file->size;
+    _RETURN_IF_ERROR(mapped_file_close(file));
+    language_error_t error_code = map_regular_file(file,
+                                                   descriptor,
+                                                   size,
+                                                   capacity,
+                                                   populate);
+    close(descriptor);
+    // File that could not be mapped is read to the heap buffer.
+    if(error_code == LANGUAGE_SUCCESS && file->mapping_size == 0) {
+        return mapped_file_reserve(file, filename, capacity, populate);
+    }
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t input_open(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(mapped_file_open(&ctx->input_map, ctx->input_file));
+    ctx->input          = ctx->input_map.data;
+    ctx->input_size     = ctx->input_map.size;
+    ctx->input_position = ctx->input;
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t input_close(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(tree_stream_close(ctx));
+    _RETURN_IF_ERROR(mapped_file_close(&ctx->input_map));
+    ctx->input          = NULL;
+    ctx->input_size     = 0;
+    ctx->input_position = NULL;
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t map_regular_file(mapped_file_t *file,
+                                  int            descriptor,
+                                  size_t         size,
+                                  size_t         capacity,
+                                  bool           populate) {
+    size_t page_size    = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapping_size = ((size > capacity ? size : capacity) + page_size) /
+                          page_size * page_size;
+    //-----------------------------------------------------------------------//
+    // Anonymous pages are reserved first, so the byte after the data is zero
+    // even when the file size is a multiple of the page size.
+    void *area = mmap(NULL,
+                      mapping_size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1,
+                      0);
+    if(area == MAP_FAILED) {
+        _RETURN_IF_ERROR(read_stream(file, descriptor, false));
+        return mapped_file_fill(file, SIZE_MAX);
+    }
+    //-----------------------------------------------------------------------//
+    // Data which is going to be written whole has its pages copied at once
+    // and not by one fault per page.
+    if(size != 0) {
+        void *data = mmap(area,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_FIXED | (populate ? MAP_POPULATE : 0),
+                          descriptor,
+                          0);
+        if(data == MAP_FAILED) {
+            munmap(area, mapping_size);
+            _RETURN_IF_ERROR(read_stream(file, descriptor, false));
+            return mapped_file_fill(file, SIZE_MAX);
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+    //-----------------------------------------------------------------------//
+    file->data         = (char *)area;
+    file->size         = size;
+    file->mapping_size = mapping_size;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_stream(mapped_file_t *file,
+                             int            descriptor,
+                             bool           owns_descriptor) {
+    // Data is read later by mapped_file_fill.
+    char *data = (char *)malloc(StreamReadInitSize);
+    if(data == NULL) {
+        if(owns_descriptor) {
+            close(descriptor);
+        }
+        print_error("Error while allocating memory for input.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    data[0]               = '\0';
+    file->data            = data;
+    file->size            = 0;
+    file->mapping_size    = 0;
+    file->capacity        = StreamReadInitSize;
+    file->descriptor      = descriptor;
+    file->is_streaming    = true;
+    file->owns_descriptor = owns_descriptor;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void stream_stop(mapped_file_t *file) {
+    if(file->is_streaming && file->owns_descriptor) {
+        close(file->descriptor);
+    }
+    file->is_streaming    = false;
+    file->owns_descriptor = false;
+}
+
+//===========================================================================//
+
+bool is_stdin_name(const char *filename) {
+    return filename == NULL || strcmp(filename, "-") == 0;
+}
+
+//===========================================================================//
@@ -6,11 +6,20 @@
 
 #include "language.h"
 #include "name_table.h"
+#include "utils.h"
 #include "colors.h"
 #include "custom_assert.h"
 
 //===========================================================================//
 
+static language_error_t reserve_bindings (language_t  *ctx,
+                                          size_t       symbol);
+
+static language_error_t rehash_used_names(language_t  *ctx,
+                                          size_t       capacity);
+
+//===========================================================================//
+
 language_error_t name_table_ctor(language_t *ctx, size_t capacity) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
@@ -35,9 +44,18 @@ language_error_t name_table_add(language_t         *ctx,
                                 identifier_type_t   type) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(reserve_elements((void **)&ctx->name_table.identifiers,
+                                      &ctx->name_table.capacity,
+                                      ctx->name_table.size + 1,
+                                      sizeof(ctx->name_table.identifiers[0])));
+    size_t symbol = 0;
+    _RETURN_IF_ERROR(used_names_add(ctx, name, length, &symbol));
+    //-----------------------------------------------------------------------//
     identifier_t *ident = ctx->name_table.identifiers + ctx->name_table.size;
+    memset(ident, 0, sizeof(*ident));
     ident->name     = name;
     ident->length   = length;
+    ident->symbol   = symbol;
     ident->type     = type;
     //-----------------------------------------------------------------------//
     if(output != NULL) {
@@ -49,11 +67,76 @@ language_error_t name_table_add(language_t         *ctx,
 
 //===========================================================================//
 
+language_error_t name_table_add_fresh(language_t        *ctx,
+                                      name_t             prefix,
+                                      name_t             name,
+                                      size_t            *output,
+                                      identifier_type_t  type) {
+    _C_ASSERT(ctx         != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(prefix.name != NULL, return LANGUAGE_NAME_NULL);
+    _C_ASSERT(name.name   != NULL, return LANGUAGE_NAME_NULL);
+    //-----------------------------------------------------------------------//
+    // Name is 'prefix_name', identifiers can not have digits, so letters
+    // are added after one more '_' while the name is used.
+    name_table_t *table = &ctx->name_table;
+    _RETURN_IF_ERROR(reserve_elements((void **)&table->owned_names,
+                                      &table->owned_names_capacity,
+                                      table->owned_names_size + 1,
+                                      sizeof(table->owned_names[0])));
+    size_t base  = prefix.length + 1 + name.length;
+    char  *fresh = (char *)malloc(base + FreshNameSuffixSize);
+    if(fresh == NULL) {
+        print_error("Error while allocating memory for new name.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    table->owned_names[table->owned_names_size++] = fresh;
+    memcpy(fresh, prefix.name, prefix.length);
+    fresh[prefix.length] = '_';
+    memcpy(fresh + prefix.length + 1, name.name, name.length);
+    //-----------------------------------------------------------------------//
+    size_t length = base;
+    size_t used   = 0;
+    _RETURN_IF_ERROR(used_names_find(ctx, fresh, length, &used));
+    for(size_t attempt = 0; used != PoisonIndex; attempt++) {
+        length          = base;
+        fresh[length++] = '_';
+        size_t number   = attempt;
+        do {
+            fresh[length++] = (char)('a' + number % 26);
+            number /= 26;
+        } while(number != 0);
+        _RETURN_IF_ERROR(used_names_find(ctx, fresh, length, &used));
+    }
+    //-----------------------------------------------------------------------//
+    return name_table_add(ctx, fresh, length, output, type);
+}
+
+//===========================================================================//
+
+language_error_t name_table_reserve(language_t *ctx, size_t capacity) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    return reserve_elements((void **)&ctx->name_table.identifiers,
+                            &ctx->name_table.capacity,
+                            capacity,
+                            sizeof(ctx->name_table.identifiers[0]));
+}
+
+//===========================================================================//
+
 language_error_t name_table_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
     free(ctx->name_table.identifiers);
     ctx->name_table.identifiers = NULL;
+    for(size_t elem = 0; elem < ctx->name_table.owned_names_size; elem++) {
+        free(ctx->name_table.owned_names[elem]);
+    }
+    free(ctx->name_table.owned_names);
+    ctx->name_table.owned_names          = NULL;
+    ctx->name_table.owned_names_size     = 0;
+    ctx->name_table.owned_names_capacity = 0;
+    _RETURN_IF_ERROR(used_names_dtor(ctx));
     return LANGUAGE_SUCCESS;
 }
 
@@ -65,8 +148,8 @@ language_error_t set_memory_addr(language_t      *ctx,
     _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
     _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    _C_ASSERT(node->type == NODE_TYPE_IDENTIFIER, return LANGUAGE_INVALID_NODE_TYPE);
-    size_t index = node->value.identifier;
+    _C_ASSERT(node_type(node) == NODE_TYPE_IDENTIFIER, return LANGUAGE_INVALID_NODE_TYPE);
+    size_t index = node_identifier(node);
     if(index >= ctx->name_table.size) {
         print_error("Node index is bigger that name table size.\n");
     }
@@ -79,13 +162,22 @@ language_error_t set_memory_addr(language_t      *ctx,
 language_error_t variables_stack_ctor(language_t *ctx, size_t capacity) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    ctx->name_table.stack = (size_t *)calloc(capacity, sizeof(ctx->name_table.stack[0]));
-    if(ctx->name_table.stack == NULL) {
+    name_table_t *table = &ctx->name_table;
+    table->stack  = (variable_entry_t *)calloc(capacity, sizeof(table->stack[0]));
+    table->scopes = (size_t           *)calloc(capacity, sizeof(table->scopes[0]));
+    if(table->stack == NULL || table->scopes == NULL) {
         print_error("Error while allocating memory for variables stack.\n");
         return LANGUAGE_MEMORY_ERROR;
     }
-
-    ctx->name_table.stack_size = 0;
+    //-----------------------------------------------------------------------//
+    table->stack_size      = 0;
+    table->stack_capacity  = capacity;
+    table->scopes_size     = 0;
+    table->scopes_capacity = capacity;
+    if(table->used_names_size != 0) {
+        _RETURN_IF_ERROR(reserve_bindings(ctx, table->used_names_size - 1));
+    }
+    //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
@@ -94,7 +186,20 @@ language_error_t variables_stack_ctor(language_t *ctx, size_t capacity) {
 language_error_t variables_stack_push(language_t *ctx, size_t index) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    ctx->name_table.stack[ctx->name_table.stack_size++] = index;
+    name_table_t *table = &ctx->name_table;
+    _RETURN_IF_ERROR(reserve_elements((void **)&table->stack,
+                                      &table->stack_capacity,
+                                      table->stack_size + 1,
+                                      sizeof(table->stack[0])));
+    //-----------------------------------------------------------------------//
+    size_t symbol = table->identifiers[index].symbol;
+    _RETURN_IF_ERROR(reserve_bindings(ctx, symbol));
+    //-----------------------------------------------------------------------//
+    variable_entry_t *entry = table->stack + table->stack_size++;
+    entry->nt_index = index;
+    entry->shadowed = table->bindings[symbol].variable;
+    table->bindings[symbol].variable = index;
+    //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
@@ -102,15 +207,100 @@ language_error_t variables_stack_push(language_t *ctx, size_t index) {
 
 language_error_t variables_stack_remove(language_t *ctx, size_t number) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    _C_ASSERT(number <= ctx->name_table.stack_size, return LANGUAGE_TREE_ERROR);
     //-----------------------------------------------------------------------//
-    size_t *new_end = ctx->name_table.stack +
-                      ctx->name_table.stack_size -
-                      number;
-    if(memset(new_end, 0, number * sizeof(ctx->name_table.stack[0])) != new_end) {
-        print_error("Error while setting memory to zeros.\n");
-        return LANGUAGE_MEMORY_ERROR;
+    name_table_t *table = &ctx->name_table;
+    for(size_t elem = 0; elem < number; elem++) {
+        variable_entry_t *entry  = table->stack + --table->stack_size;
+        size_t            symbol = table->identifiers[entry->nt_index].symbol;
+        table->bindings[symbol].variable = entry->shadowed;
     }
-    ctx->name_table.stack_size -= number;
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t variables_scope_enter(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    name_table_t *table = &ctx->name_table;
+    _RETURN_IF_ERROR(reserve_elements((void **)&table->scopes,
+                                      &table->scopes_capacity,
+                                      table->scopes_size + 1,
+                                      sizeof(table->scopes[0])));
+    table->scopes[table->scopes_size++] = table->stack_size;
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t variables_scope_leave(language_t *ctx) {
+    _C_ASSERT(ctx                         != NULL, return LANGUAGE_CTX_NULL  );
+    _C_ASSERT(ctx->name_table.scopes_size != 0   , return LANGUAGE_TREE_ERROR);
+    //-----------------------------------------------------------------------//
+    name_table_t *table = &ctx->name_table;
+    size_t scope_start = table->scopes[--table->scopes_size];
+    return variables_stack_remove(ctx, table->stack_size - scope_start);
+}
+
+//===========================================================================//
+
+language_error_t name_table_bind_function(language_t *ctx, size_t index) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    size_t symbol = ctx->name_table.identifiers[index].symbol;
+    _RETURN_IF_ERROR(reserve_bindings(ctx, symbol));
+    //-----------------------------------------------------------------------//
+    // The first definition wins, as it did with linear search.
+    if(ctx->name_table.bindings[symbol].function == PoisonIndex) {
+        ctx->name_table.bindings[symbol].function = index;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t name_table_find(language_t *ctx,
+                                 size_t      symbol,
+                                 size_t     *index) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(index != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    *index = PoisonIndex;
+    if(symbol >= ctx->name_table.bindings_capacity) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // Functions shadow variables with the same name.
+    name_binding_t *binding = ctx->name_table.bindings + symbol;
+    if(binding->function != PoisonIndex) {
+        *index = binding->function;
+    }
+    else {
+        *index = binding->variable;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t name_table_find_function(language_t *ctx,
+                                          size_t      symbol,
+                                          size_t     *index) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(index != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    *index = PoisonIndex;
+    for(size_t elem = 0; elem < ctx->name_table.size; elem++) {
+        identifier_t *ident = ctx->name_table.identifiers + elem;
+        if(ident->type == IDENTIFIER_FUNCTION && ident->symbol == symbol) {
+            *index = elem;
+            break;
+        }
+    }
+    //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
@@ -119,8 +309,16 @@ language_error_t variables_stack_remove(language_t *ctx, size_t number) {
 language_error_t variables_stack_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    free(ctx->name_table.stack);
-    ctx->name_table.stack = NULL;
+    name_table_t *table = &ctx->name_table;
+    free(table->stack);
+    free(table->scopes);
+    free(table->bindings);
+    table->stack             = NULL;
+    table->scopes            = NULL;
+    table->bindings          = NULL;
+    table->stack_size        = table->stack_capacity  = 0;
+    table->scopes_size       = table->scopes_capacity = 0;
+    table->bindings_capacity = 0;
     return LANGUAGE_SUCCESS;
 }
 
@@ -135,8 +333,9 @@ language_error_t used_names_ctor(language_t *ctx, size_t capacity) {
         print_error("Error while allocating used names memory.\n");
         return LANGUAGE_MEMORY_ERROR;
     }
-    ctx->name_table.used_names_size = 0;
-    return LANGUAGE_SUCCESS;
+    ctx->name_table.used_names_size     = 0;
+    ctx->name_table.used_names_capacity = capacity;
+    return rehash_used_names(ctx, UsedNamesBucketsCapacity);
 }
 
 //===========================================================================//
@@ -145,14 +344,69 @@ language_error_t used_names_add(language_t *ctx,
                                 const char *name,
                                 size_t      length,
                                 size_t     *index) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(name != NULL, return LANGUAGE_NAME_NULL);
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(name  != NULL, return LANGUAGE_NAME_NULL  );
+    _C_ASSERT(index != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    name_table_t *table = &ctx->name_table;
+    if(table->used_names_buckets_capacity == 0) {
+        _RETURN_IF_ERROR(rehash_used_names(ctx, UsedNamesBucketsCapacity));
+    }
     //-----------------------------------------------------------------------//
-    ctx->name_table.used_names[ctx->name_table.used_names_size].length = length;
-    ctx->name_table.used_names[ctx->name_table.used_names_size].name   = name;
-    *index = ctx->name_table.used_names_size;
+    size_t mask   = table->used_names_buckets_capacity - 1;
+    size_t bucket = fnv1a_hash(name, length) & mask;
+    while(table->used_names_buckets[bucket] != PoisonIndex) {
+        name_t *used = table->used_names + table->used_names_buckets[bucket];
+        if(used->length == length && memcmp(used->name, name, length) == 0) {
+            *index = table->used_names_buckets[bucket];
+            return LANGUAGE_SUCCESS;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(reserve_elements((void **)&table->used_names,
+                                      &table->used_names_capacity,
+                                      table->used_names_size + 1,
+                                      sizeof(table->used_names[0])));
+    table->used_names[table->used_names_size].length = length;
+    table->used_names[table->used_names_size].name   = name;
+    table->used_names_buckets[bucket]                = table->used_names_size;
+    *index = table->used_names_size;
+    table->used_names_size++;
+    //-----------------------------------------------------------------------//
+    if(table->used_names_size * 2 > table->used_names_buckets_capacity) {
+        _RETURN_IF_ERROR(rehash_used_names(ctx,
+                                           table->used_names_buckets_capacity * 2));
+    }
+    return LANGUAGE_SUCCESS;
+}
 
-    ctx->name_table.used_names_size++;
+//===========================================================================//
+
+language_error_t used_names_find(language_t *ctx,
+                                 const char *name,
+                                 size_t      length,
+                                 size_t     *index) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(name  != NULL, return LANGUAGE_NAME_NULL  );
+    _C_ASSERT(index != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    // Same lookup as in used_names_add, but the table is never changed.
+    name_table_t *table = &ctx->name_table;
+    *index = PoisonIndex;
+    if(table->used_names_buckets_capacity == 0) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t mask   = table->used_names_buckets_capacity - 1;
+    size_t bucket = fnv1a_hash(name, length) & mask;
+    while(table->used_names_buckets[bucket] != PoisonIndex) {
+        name_t *used = table->used_names + table->used_names_buckets[bucket];
+        if(used->length == length && memcmp(used->name, name, length) == 0) {
+            *index = table->used_names_buckets[bucket];
+            return LANGUAGE_SUCCESS;
+        }
+        bucket = (bucket + 1) & mask;
+    }
     return LANGUAGE_SUCCESS;
 }
 
@@ -162,7 +416,61 @@ language_error_t used_names_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
     free(ctx->name_table.used_names);
-    ctx->name_table.used_names = NULL;
+    free(ctx->name_table.used_names_buckets);
+    ctx->name_table.used_names                  = NULL;
+    ctx->name_table.used_names_buckets          = NULL;
+    ctx->name_table.used_names_size             = 0;
+    ctx->name_table.used_names_capacity         = 0;
+    ctx->name_table.used_names_buckets_capacity = 0;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t reserve_bindings(language_t *ctx, size_t symbol) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    name_table_t *table = &ctx->name_table;
+    size_t old_capacity = table->bindings_capacity;
+    _RETURN_IF_ERROR(reserve_elements((void **)&table->bindings,
+                                      &table->bindings_capacity,
+                                      symbol + 1,
+                                      sizeof(table->bindings[0])));
+    for(size_t elem = old_capacity; elem < table->bindings_capacity; elem++) {
+        table->bindings[elem].function = PoisonIndex;
+        table->bindings[elem].variable = PoisonIndex;
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t rehash_used_names(language_t *ctx, size_t capacity) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    _C_ASSERT((capacity & (capacity - 1)) == 0, return LANGUAGE_TREE_ERROR);
+    //-----------------------------------------------------------------------//
+    name_table_t *table = &ctx->name_table;
+    size_t *buckets = (size_t *)malloc(capacity * sizeof(buckets[0]));
+    if(buckets == NULL) {
+        print_error("Error while allocating used names hash table.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    memset(buckets, 0xFF, capacity * sizeof(buckets[0]));
+    //-----------------------------------------------------------------------//
+    size_t mask = capacity - 1;
+    for(size_t elem = 0; elem < table->used_names_size; elem++) {
+        name_t *used   = table->used_names + elem;
+        size_t  bucket = fnv1a_hash(used->name, used->length) & mask;
+        while(buckets[bucket] != PoisonIndex) {
+            bucket = (bucket + 1) & mask;
+        }
+        buckets[bucket] = elem;
+    }
+    //-----------------------------------------------------------------------//
+    free(table->used_names_buckets);
+    table->used_names_buckets          = buckets;
+    table->used_names_buckets_capacity = capacity;
     return LANGUAGE_SUCCESS;
 }
 
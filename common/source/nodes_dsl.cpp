@@ -9,7 +9,7 @@
 bool is_node_type_eq(language_node_t *node, node_type_t type) {
     _C_ASSERT(node != NULL, return false);
     //-----------------------------------------------------------------------//
-    if(node->type == type) {
+    if(node_type(node) == type) {
         return true;
     }
     return false;
@@ -20,7 +20,7 @@ bool is_node_type_eq(language_node_t *node, node_type_t type) {
 bool is_node_oper_eq(language_node_t *node, operation_t opcode) {
     _C_ASSERT(node != NULL, return false);
     //-----------------------------------------------------------------------//
-    if(node->type == NODE_TYPE_OPERATION && node->value.opcode == opcode) {
+    if(node_type(node) == NODE_TYPE_OPERATION && node_opcode(node) == opcode) {
         return true;
     }
     return false;
@@ -34,8 +34,8 @@ bool is_ident_type(language_t       *ctx,
     _C_ASSERT(ctx  != NULL, return false);
     _C_ASSERT(node != NULL, return false);
     //-----------------------------------------------------------------------//
-    if(node->type == NODE_TYPE_IDENTIFIER &&
-       ctx->name_table.identifiers[node->value.identifier].type == type) {
+    if(node_type(node) == NODE_TYPE_IDENTIFIER &&
+       ctx->name_table.identifiers[node_identifier(node)].type == type) {
         return true;
     }
     return false;
@@ -46,12 +46,11 @@ bool is_ident_type(language_t       *ctx,
 language_error_t set_val(language_node_t   *node,
                          node_type_t        type,
                          value_t            value,
-                         language_node_t   *left,
-                         language_node_t   *right) {
+                         uint32_t           left,
+                         uint32_t           right) {
     _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    node->type = type;
-    node->value = value;
+    node_set_value(node, type, value);
     node->left = left;
     node->right = right;
     return LANGUAGE_SUCCESS;
@@ -63,10 +62,10 @@ bool is_number_eq(language_node_t *node, double value) {
     _C_ASSERT(node != NULL, return false);
     //-----------------------------------------------------------------------//
     double epsilon = 10e-6;
-    if(node->type != NODE_TYPE_NUMBER) {
+    if(node_type(node) != NODE_TYPE_NUMBER) {
         return false;
     }
-    if(fabs(node->value.number - value) < epsilon) {
+    if(fabs(node_number(node) - value) < epsilon) {
         return true;
     }
     return false;
@@ -0,0 +1,155 @@
+#include <stdlib.h>
+#include <stdint.h>
+
+//===========================================================================//
+
+#include "number_parser.h"
+
+//===========================================================================//
+
+static const double ExactPowersOfTen[] = {
+    1e0 , 1e1 , 1e2 , 1e3 , 1e4 , 1e5 , 1e6 , 1e7 ,
+    1e8 , 1e9 , 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static const long     MaxExactPower     = 22;
+static const uint64_t MaxExactMantissa  = (uint64_t)1 << 53;
+static const size_t   MaxMantissaDigits = 19;
+static const long     MaxExponentValue  = 100000;
+
+//===========================================================================//
+
+static inline bool  is_digit          (char        symbol);
+
+static const char  *parse_double_libc (const char *position,
+                                       double     *value);
+
+//===========================================================================//
+
+const char *parse_size(const char *position, size_t *value) {
+    const char *start  = position;
+    size_t      result = 0;
+    while(is_digit(*position)) {
+        result = result * 10 + (size_t)(*position - '0');
+        position++;
+    }
+    //-----------------------------------------------------------------------//
+    if(position == start) {
+        return NULL;
+    }
+    // Only overflowing numbers are longer, let libc saturate them.
+    if((size_t)(position - start) > MaxMantissaDigits) {
+        char *end = NULL;
+        *value = strtoull(start, &end, 10);
+        return end;
+    }
+    //-----------------------------------------------------------------------//
+    *value = result;
+    return position;
+}
+
+//===========================================================================//
+
+const char *parse_double(const char *position, double *value) {
+    const char *start    = position;
+    bool        negative = false;
+    if(*position == '-' || *position == '+') {
+        negative = *position == '-';
+        position++;
+    }
+    //-----------------------------------------------------------------------//
+    if(position[0] == '0' && (position[1] == 'x' || position[1] == 'X')) {
+        return parse_double_libc(start, value);
+    }
+    //-----------------------------------------------------------------------//
+    uint64_t    mantissa = 0;
+    size_t      digits   = 0;
+    long        exponent = 0;
+    const char *mantissa_start = position;
+    while(is_digit(*position)) {
+        mantissa = mantissa * 10 + (uint64_t)(*position - '0');
+        digits  += mantissa != 0;
+        position++;
+    }
+    if(*position == '.') {
+        position++;
+        while(is_digit(*position)) {
+            mantissa = mantissa * 10 + (uint64_t)(*position - '0');
+            digits  += mantissa != 0;
+            exponent--;
+            position++;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    // No digits at all: ".", "inf" and "nan" are left to libc.
+    if(position == mantissa_start ||
+       (position == mantissa_start + 1 && *mantissa_start == '.')) {
+        return parse_double_libc(start, value);
+    }
+    if(digits > MaxMantissaDigits) {
+        return parse_double_libc(start, value);
+    }
+    //-----------------------------------------------------------------------//
+    if(*position == 'e' || *position == 'E') {
+        const char *exponent_start    = position + 1;
+        bool        exponent_negative = false;
+        if(*exponent_start == '-' || *exponent_start == '+') {
+            exponent_negative = *exponent_start == '-';
+            exponent_start++;
+        }
+        if(is_digit(*exponent_start)) {
+            long exponent_value = 0;
+            for(position = exponent_start; is_digit(*position); position++) {
+                if(exponent_value < MaxExponentValue) {
+                    exponent_value = exponent_value * 10 + (*position - '0');
+                }
+            }
+            exponent += exponent_negative ? -exponent_value : exponent_value;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    if(mantissa == 0) {
+        *value = negative ? -0.0 : 0.0;
+        return position;
+    }
+    // Mantissa may absorb extra powers of ten while it stays exact.
+    while(exponent > MaxExactPower && mantissa < MaxExactMantissa / 10) {
+        mantissa *= 10;
+        exponent--;
+    }
+    if(mantissa > MaxExactMantissa ||
+       exponent > MaxExactPower    ||
+       exponent < -MaxExactPower) {
+        return parse_double_libc(start, value);
+    }
+    //-----------------------------------------------------------------------//
+    // Both operands are exact doubles, so one IEEE operation rounds correctly.
+    double result = (double)mantissa;
+    if(exponent < 0) {
+        result /= ExactPowersOfTen[-exponent];
+    }
+    else {
+        result *= ExactPowersOfTen[exponent];
+    }
+    *value = negative ? -result : result;
+    return position;
+}
+
+//===========================================================================//
+
+bool is_digit(char symbol) {
+    return (unsigned char)(symbol - '0') < 10;
+}
+
+//===========================================================================//
+
+const char *parse_double_libc(const char *position, double *value) {
+    char *end = NULL;
+    *value = strtod(position, &end);
+    if(end == position) {
+        return NULL;
+    }
+    return end;
+}
+
+//===========================================================================//
@@ -0,0 +1,464 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <math.h>
+#include <charconv>
+
+//===========================================================================//
+
+#include "language.h"
+#include "output.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static const size_t OutputDefaultCapacity = 4096;
+static const size_t MaxIntegerLength      = 24;
+static const size_t MaxScientificLength   = 32;
+static const size_t MaxFixedLength        = 400;
+static const size_t MaxDoubleLength       = 48;
+static const int    MinDoublePrecision    = 6;
+static const int    MinFixedExponent      = -4;
+
+//===========================================================================//
+
+static language_error_t output_pad      (output_t   *output,
+                                         size_t      start,
+                                         size_t      width,
+                                         bool        left,
+                                         bool        zero);
+
+static size_t           layout_double   (char       *output,
+                                         const char *scientific,
+                                         size_t      length);
+
+//===========================================================================//
+
+language_error_t output_reserve(output_t *output, size_t size) {
+    _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    if(output->size + size <= output->capacity) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t capacity = output->capacity == 0 ?
+                      OutputDefaultCapacity :
+                      output->capacity * 2;
+    while(capacity < output->size + size) {
+        capacity *= 2;
+    }
+    //-----------------------------------------------------------------------//
+    char *data = (char *)realloc(output->data, capacity);
+    if(data == NULL) {
+        print_error("Error while reallocating output buffer.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    output->data     = data;
+    output->capacity = capacity;
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_write(output_t *output, const void *data, size_t size) {
+    _C_ASSERT(data != NULL, return LANGUAGE_INPUT_NULL);
+    //-----------------------------------------------------------------------//
+    if(size == 0) {
+        return LANGUAGE_SUCCESS;
+    }
+    _RETURN_IF_ERROR(output_reserve(output, size));
+    memcpy(output->data + output->size, data, size);
+    output->size += size;
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_char(output_t *output, char symbol) {
+    _RETURN_IF_ERROR(output_reserve(output, 1));
+    output->data[output->size++] = symbol;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_string(output_t *output, const char *string, size_t length) {
+    return output_write(output, string, length);
+}
+
+//===========================================================================//
+
+language_error_t output_fill(output_t *output, char symbol, size_t number) {
+    if(number == 0) {
+        return LANGUAGE_SUCCESS;
+    }
+    _RETURN_IF_ERROR(output_reserve(output, number));
+    memset(output->data + output->size, symbol, number);
+    output->size += number;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_unsigned(output_t *output, uint64_t value, size_t width) {
+    _RETURN_IF_ERROR(output_reserve(output, MaxIntegerLength + width));
+    //-----------------------------------------------------------------------//
+    size_t start = output->size;
+    char  *end   = std::to_chars(output->data + start,
+                                 output->data + start + MaxIntegerLength,
+                                 value).ptr;
+    output->size = (size_t)(end - output->data);
+    return output_pad(output, start, width, false, true);
+}
+
+//===========================================================================//
+
+language_error_t output_signed(output_t *output, int64_t value) {
+    _RETURN_IF_ERROR(output_reserve(output, MaxIntegerLength));
+    //-----------------------------------------------------------------------//
+    char *start = output->data + output->size;
+    char *end   = std::to_chars(start, start + MaxIntegerLength, value).ptr;
+    output->size += (size_t)(end - start);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_hex(output_t *output, uint64_t value) {
+    _RETURN_IF_ERROR(output_reserve(output, MaxIntegerLength));
+    //-----------------------------------------------------------------------//
+    char *start = output->data + output->size;
+    char *end   = std::to_chars(start, start + MaxIntegerLength, value, 16).ptr;
+    output->size += (size_t)(end - start);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_double(output_t *output, double value) {
+    _RETURN_IF_ERROR(output_reserve(output, MaxDoubleLength));
+    //-----------------------------------------------------------------------//
+    char *start = output->data + output->size;
+    if(!isfinite(value)) {
+        char *end = std::to_chars(start, start + MaxDoubleLength, value).ptr;
+        output->size += (size_t)(end - start);
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    char  scientific[MaxScientificLength] = {};
+    char *end = std::to_chars(scientific,
+                              scientific + MaxScientificLength,
+                              value,
+                              std::chars_format::scientific).ptr;
+    output->size += layout_double(start,
+                                  scientific,
+                                  (size_t)(end - scientific));
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_double_fixed(output_t *output, double value) {
+    _RETURN_IF_ERROR(output_reserve(output, MaxFixedLength));
+    //-----------------------------------------------------------------------//
+    char *start = output->data + output->size;
+    char *end   = std::to_chars(start,
+                                start + MaxFixedLength,
+                                value,
+                                std::chars_format::fixed).ptr;
+    output->size += (size_t)(end - start);
+    if(isfinite(value) && memchr(start, '.', (size_t)(end - start)) == NULL) {
+        _RETURN_IF_ERROR(output_string(output, ".0", 2));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_format(output_t *output, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    language_error_t error_code = output_vformat(output, format, args);
+    va_end(args);
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t output_vformat(output_t *output, const char *format, va_list args) {
+    _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT        );
+    _C_ASSERT(format != NULL, return LANGUAGE_STRING_FORMAT_NULL);
+    //-----------------------------------------------------------------------//
+    const char *position = format;
+    while(*position != '\0') {
+        const char *percent = strchr(position, '%');
+        if(percent == NULL) {
+            return output_string(output, position, strlen(position));
+        }
+        _RETURN_IF_ERROR(output_string(output,
+                                       position,
+                                       (size_t)(percent - position)));
+        position = percent + 1;
+        if(*position == '%') {
+            _RETURN_IF_ERROR(output_char(output, '%'));
+            position++;
+            continue;
+        }
+        //-------------------------------------------------------------------//
+        bool left = false;
+        bool zero = false;
+        for(;; position++) {
+            if(*position == '-') {
+                left = true;
+            }
+            else if(*position == '0') {
+                zero = true;
+            }
+            else {
+                break;
+            }
+        }
+        //-------------------------------------------------------------------//
+        size_t width = 0;
+        if(*position == '*') {
+            int value = va_arg(args, int);
+            if(value < 0) {
+                left  = true;
+                value = -value;
+            }
+            width = (size_t)value;
+            position++;
+        }
+        while(*position >= '0' && *position <= '9') {
+            width = width * 10 + (size_t)(*position++ - '0');
+        }
+        //-------------------------------------------------------------------//
+        bool   has_precision = false;
+        size_t precision     = 0;
+        if(*position == '.') {
+            has_precision = true;
+            position++;
+            if(*position == '*') {
+                int value = va_arg(args, int);
+                has_precision = value >= 0;
+                precision     = value >= 0 ? (size_t)value : 0;
+                position++;
+            }
+            while(*position >= '0' && *position <= '9') {
+                precision = precision * 10 + (size_t)(*position++ - '0');
+            }
+        }
+        //-------------------------------------------------------------------//
+        size_t longs  = 0;
+        bool   sizes  = false;
+        while(*position == 'l' || *position == 'h' ||
+              *position == 'z' || *position == 'L') {
+            longs += *position == 'l';
+            sizes |= *position == 'z';
+            position++;
+        }
+        //-------------------------------------------------------------------//
+        size_t start = output->size;
+        switch(*position) {
+            case 'd':
+            case 'i': {
+                int64_t value = 0;
+                if(sizes || longs == 1) {
+                    value = va_arg(args, long);
+                }
+                else if(longs > 1) {
+                    value = va_arg(args, long long);
+                }
+                else {
+                    value = va_arg(args, int);
+                }
+                _RETURN_IF_ERROR(output_signed(output, value));
+                break;
+            }
+            case 'u':
+            case 'x': {
+                uint64_t value = 0;
+                if(sizes) {
+                    value = va_arg(args, size_t);
+                }
+                else if(longs == 1) {
+                    value = va_arg(args, unsigned long);
+                }
+                else if(longs > 1) {
+                    value = va_arg(args, unsigned long long);
+                }
+                else {
+                    value = va_arg(args, unsigned);
+                }
+                if(*position == 'x') {
+                    _RETURN_IF_ERROR(output_hex(output, value));
+                }
+                else {
+                    _RETURN_IF_ERROR(output_unsigned(output, value, 0));
+                }
+                break;
+            }
+            case 'c': {
+                _RETURN_IF_ERROR(output_char(output, (char)va_arg(args, int)));
+                zero = false;
+                break;
+            }
+            case 's': {
+                const char *string = va_arg(args, const char *);
+                size_t      length = has_precision ?
+                                     strnlen(string, precision) :
+                                     strlen(string);
+                _RETURN_IF_ERROR(output_string(output, string, length));
+                zero = false;
+                break;
+            }
+            case 'g': {
+                if(has_precision) {
+                    print_error("Precision of doubles is not supported in "
+                                "output format '%s'.\n", format);
+                    return LANGUAGE_OUTPUT_FORMAT_ERROR;
+                }
+                _RETURN_IF_ERROR(output_double(output, va_arg(args, double)));
+                break;
+            }
+            default: {
+                print_error("Unsupported conversion in output format '%s'.\n",
+                            format);
+                return LANGUAGE_OUTPUT_FORMAT_ERROR;
+            }
+        }
+        position++;
+        _RETURN_IF_ERROR(output_pad(output, start, width, left, zero));
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_flush(output_t *output, FILE *file) {
+    _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT        );
+    _C_ASSERT(file   != NULL, return LANGUAGE_OPENING_FILE_ERROR);
+    //-----------------------------------------------------------------------//
+    // Anything written to the file with stdio goes before the buffer.
+    if(fflush(file) != 0) {
+        print_error("Error while flushing output file.\n");
+        return LANGUAGE_OUTPUT_WRITING_ERROR;
+    }
+    int    descriptor = fileno(file);
+    size_t written    = 0;
+    while(written < output->size) {
+        ssize_t result = write(descriptor,
+                               output->data + written,
+                               output->size - written);
+        if(result < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            print_error("Error while writing output to file.\n");
+            return LANGUAGE_OUTPUT_WRITING_ERROR;
+        }
+        written += (size_t)result;
+    }
+    output->size = 0;
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_dtor(output_t *output) {
+    _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    free(output->data);
+    output->data     = NULL;
+    output->size     = 0;
+    output->capacity = 0;
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t output_pad(output_t *output,
+                            size_t    start,
+                            size_t    width,
+                            bool      left,
+                            bool      zero) {
+    size_t length = output->size - start;
+    if(length >= width) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t padding = width - length;
+    if(left) {
+        return output_fill(output, ' ', padding);
+    }
+    _RETURN_IF_ERROR(output_reserve(output, padding));
+    //-----------------------------------------------------------------------//
+    // Zeros go after the sign, spaces before it.
+    char *field = output->data + start;
+    if(zero && *field == '-') {
+        field++;
+        length--;
+    }
+    memmove(field + padding, field, length);
+    memset(field, zero ? '0' : ' ', padding);
+    output->size += padding;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+size_t layout_double(char *output, const char *scientific, size_t length) {
+    // Scientific form is [-]d[.ddd]e(+|-)dd, which is what %g writes for
+    // big and small exponents, other values are written without exponent.
+    const char *exponent_start = (const char *)memchr(scientific, 'e', length);
+    int         exponent       = atoi(exponent_start + 1);
+    const char *digits         = scientific;
+    char       *position       = output;
+    if(*digits == '-') {
+        *position++ = *digits++;
+    }
+    //-----------------------------------------------------------------------//
+    char mantissa[MaxScientificLength] = {};
+    int  digits_number                 = 0;
+    for(const char *symbol = digits; symbol < exponent_start; symbol++) {
+        if(*symbol != '.') {
+            mantissa[digits_number++] = *symbol;
+        }
+    }
+    int precision = digits_number > MinDoublePrecision ?
+                    digits_number :
+                    MinDoublePrecision;
+    if(exponent < MinFixedExponent || exponent >= precision) {
+        memcpy(output, scientific, length);
+        return length;
+    }
+    //-----------------------------------------------------------------------//
+    if(exponent < 0) {
+        *position++ = '0';
+        *position++ = '.';
+        for(int zero = -1; zero > exponent; zero--) {
+            *position++ = '0';
+        }
+        memcpy(position, mantissa, (size_t)digits_number);
+        position += digits_number;
+        return (size_t)(position - output);
+    }
+    //-----------------------------------------------------------------------//
+    for(int digit = 0; digit <= exponent; digit++) {
+        *position++ = digit < digits_number ? mantissa[digit] : '0';
+    }
+    if(digits_number > exponent + 1) {
+        *position++ = '.';
+        memcpy(position, mantissa + exponent + 1,
+               (size_t)(digits_number - exponent - 1));
+        position += digits_number - exponent - 1;
+    }
+    return (size_t)(position - output);
+}
+
+//===========================================================================//
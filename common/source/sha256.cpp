@@ -0,0 +1,143 @@
+#include <string.h>
+
+//===========================================================================//
+
+#include "sha256.h"
+
+//===========================================================================//
+
+static const uint32_t Sha256Rounds[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t Sha256Initial[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+//===========================================================================//
+
+static void     sha256_block (sha256_t      *sha,
+                              const uint8_t *block);
+
+static uint32_t rotate_right (uint32_t       value,
+                              uint32_t       shift);
+
+//===========================================================================//
+
+void sha256_ctor(sha256_t *sha) {
+    memcpy(sha->state, Sha256Initial, sizeof(sha->state));
+    sha->block_size = 0;
+    sha->length     = 0;
+}
+
+//===========================================================================//
+
+void sha256_update(sha256_t *sha, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    sha->length += size;
+    //-----------------------------------------------------------------------//
+    // Whole blocks are hashed straight from the data, only tails are copied.
+    if(sha->block_size != 0) {
+        size_t part = Sha256BlockSize - sha->block_size;
+        if(part > size) {
+            part = size;
+        }
+        memcpy(sha->block + sha->block_size, bytes, part);
+        sha->block_size += part;
+        bytes           += part;
+        size            -= part;
+        if(sha->block_size < Sha256BlockSize) {
+            return;
+        }
+        sha256_block(sha, sha->block);
+        sha->block_size = 0;
+    }
+    while(size >= Sha256BlockSize) {
+        sha256_block(sha, bytes);
+        bytes += Sha256BlockSize;
+        size  -= Sha256BlockSize;
+    }
+    if(size != 0) {
+        memcpy(sha->block, bytes, size);
+        sha->block_size = size;
+    }
+}
+
+//===========================================================================//
+
+void sha256_final(sha256_t *sha, uint8_t *digest) {
+    uint64_t bits = sha->length * 8;
+    sha->block[sha->block_size++] = 0x80;
+    if(sha->block_size > Sha256BlockSize - sizeof(bits)) {
+        memset(sha->block + sha->block_size, 0, Sha256BlockSize - sha->block_size);
+        sha256_block(sha, sha->block);
+        sha->block_size = 0;
+    }
+    memset(sha->block + sha->block_size,
+           0,
+           Sha256BlockSize - sizeof(bits) - sha->block_size);
+    for(size_t elem = 0; elem < sizeof(bits); elem++) {
+        sha->block[Sha256BlockSize - 1 - elem] = (uint8_t)(bits >> (8 * elem));
+    }
+    sha256_block(sha, sha->block);
+    //-----------------------------------------------------------------------//
+    for(size_t elem = 0; elem < Sha256DigestSize; elem++) {
+        digest[elem] = (uint8_t)(sha->state[elem / 4] >> (24 - 8 * (elem % 4)));
+    }
+}
+
+//===========================================================================//
+
+void sha256_block(sha256_t *sha, const uint8_t *block) {
+    uint32_t words[64] = {};
+    for(size_t elem = 0; elem < 16; elem++) {
+        words[elem] = (uint32_t)block[4 * elem    ] << 24 |
+                      (uint32_t)block[4 * elem + 1] << 16 |
+                      (uint32_t)block[4 * elem + 2] <<  8 |
+                      (uint32_t)block[4 * elem + 3];
+    }
+    for(size_t elem = 16; elem < 64; elem++) {
+        uint32_t low  = words[elem - 15];
+        uint32_t high = words[elem - 2];
+        uint32_t s0   = rotate_right(low ,  7) ^ rotate_right(low , 18) ^ (low  >>  3);
+        uint32_t s1   = rotate_right(high, 17) ^ rotate_right(high, 19) ^ (high >> 10);
+        words[elem]   = words[elem - 16] + s0 + words[elem - 7] + s1;
+    }
+    //-----------------------------------------------------------------------//
+    uint32_t a = sha->state[0], b = sha->state[1], c = sha->state[2], d = sha->state[3];
+    uint32_t e = sha->state[4], f = sha->state[5], g = sha->state[6], h = sha->state[7];
+    for(size_t elem = 0; elem < 64; elem++) {
+        uint32_t s1    = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+        uint32_t ch    = (e & f) ^ (~e & g);
+        uint32_t temp1 = h + s1 + ch + Sha256Rounds[elem] + words[elem];
+        uint32_t s0    = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+        uint32_t maj   = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t temp2 = s0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+    sha->state[0] += a; sha->state[1] += b; sha->state[2] += c; sha->state[3] += d;
+    sha->state[4] += e; sha->state[5] += f; sha->state[6] += g; sha->state[7] += h;
+}
+
+//===========================================================================//
+
+uint32_t rotate_right(uint32_t value, uint32_t shift) {
+    return value >> shift | value << (32 - shift);
+}
+
+//===========================================================================//
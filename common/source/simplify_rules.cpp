@@ -9,19 +9,21 @@
 
 //===========================================================================//
 
-language_error_t simplify_add(language_t *ctx, language_node_t **node) {
-    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node  != NULL, return LANGUAGE_NODE_NULL);
-    _C_ASSERT(*node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->left, 0)) {
-        *node = (*node)->right;
+language_error_t simplify_add(language_t *ctx, uint32_t *node) {
+    _C_ASSERT(ctx   != NULL    , return LANGUAGE_CTX_NULL );
+    _C_ASSERT(node  != NULL    , return LANGUAGE_NODE_NULL);
+    _C_ASSERT(*node != NodeNone, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    language_node_t *root  = nodes_storage_get(ctx, *node);
+    language_node_t *left  = node_left (ctx, root);
+    if(is_number_eq(left, 0)) {
+        *node = root->right;
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
     //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->left, 0)) {
-        *node = (*node)->left;
+    if(is_number_eq(left, 0)) {
+        *node = root->left;
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
@@ -31,13 +33,15 @@ language_error_t simplify_add(language_t *ctx, language_node_t **node) {
 
 //===========================================================================//
 
-language_error_t simplify_sub(language_t *ctx, language_node_t **node) {
-    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node  != NULL, return LANGUAGE_NODE_NULL);
-    _C_ASSERT(*node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->right, 0)) {
-        *node = (*node)->left;
+language_error_t simplify_sub(language_t *ctx, uint32_t *node) {
+    _C_ASSERT(ctx   != NULL    , return LANGUAGE_CTX_NULL );
+    _C_ASSERT(node  != NULL    , return LANGUAGE_NODE_NULL);
+    _C_ASSERT(*node != NodeNone, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    language_node_t *root  = nodes_storage_get(ctx, *node);
+    language_node_t *right = node_right(ctx, root);
+    if(is_number_eq(right, 0)) {
+        *node = root->left;
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
@@ -47,25 +51,28 @@ language_error_t simplify_sub(language_t *ctx, language_node_t **node) {
 
 //===========================================================================//
 
-language_error_t simplify_mul(language_t *ctx, language_node_t **node) {
-    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node  != NULL, return LANGUAGE_NODE_NULL);
-    _C_ASSERT(*node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->left, 0) || is_number_eq((*node)->right, 0)) {
-        _RETURN_IF_ERROR(set_val(*node, NODE_TYPE_NUMBER, NUMBER(0), NULL, NULL));
+language_error_t simplify_mul(language_t *ctx, uint32_t *node) {
+    _C_ASSERT(ctx   != NULL    , return LANGUAGE_CTX_NULL );
+    _C_ASSERT(node  != NULL    , return LANGUAGE_NODE_NULL);
+    _C_ASSERT(*node != NodeNone, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    language_node_t *root  = nodes_storage_get(ctx, *node);
+    language_node_t *left  = node_left (ctx, root);
+    language_node_t *right = node_right(ctx, root);
+    if(is_number_eq(left, 0) || is_number_eq(right, 0)) {
+        _RETURN_IF_ERROR(set_val(root, NODE_TYPE_NUMBER, NUMBER(0), NodeNone, NodeNone));
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
     //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->left, 1)) {
-        *node = (*node)->right;
+    if(is_number_eq(left, 1)) {
+        *node = root->right;
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
     //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->right, 1)) {
-        *node = (*node)->left;
+    if(is_number_eq(right, 1)) {
+        *node = root->left;
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
@@ -75,19 +82,22 @@ language_error_t simplify_mul(language_t *ctx, language_node_t **node) {
 
 //===========================================================================//
 
-language_error_t simplify_div(language_t *ctx, language_node_t **node) {
-    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node  != NULL, return LANGUAGE_NODE_NULL);
-    _C_ASSERT(*node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->left, 0)) {
-        _RETURN_IF_ERROR(set_val(*node, NODE_TYPE_NUMBER, NUMBER(0), NULL, NULL));
+language_error_t simplify_div(language_t *ctx, uint32_t *node) {
+    _C_ASSERT(ctx   != NULL    , return LANGUAGE_CTX_NULL );
+    _C_ASSERT(node  != NULL    , return LANGUAGE_NODE_NULL);
+    _C_ASSERT(*node != NodeNone, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    language_node_t *root  = nodes_storage_get(ctx, *node);
+    language_node_t *left  = node_left (ctx, root);
+    language_node_t *right = node_right(ctx, root);
+    if(is_number_eq(left, 0)) {
+        _RETURN_IF_ERROR(set_val(root, NODE_TYPE_NUMBER, NUMBER(0), NodeNone, NodeNone));
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
     //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->right, 1)) {
-        *node = (*node)->left;
+    if(is_number_eq(right, 1)) {
+        *node = root->left;
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
@@ -97,25 +107,28 @@ language_error_t simplify_div(language_t *ctx, language_node_t **node) {
 
 //===========================================================================//
 
-language_error_t simplify_pow(language_t *ctx, language_node_t **node) {
-    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node  != NULL, return LANGUAGE_NODE_NULL);
-    _C_ASSERT(*node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->left, 0) && !is_number_eq((*node)->right, 0)) {
-        _RETURN_IF_ERROR(set_val(*node, NODE_TYPE_NUMBER, NUMBER(0), NULL, NULL));
+language_error_t simplify_pow(language_t *ctx, uint32_t *node) {
+    _C_ASSERT(ctx   != NULL    , return LANGUAGE_CTX_NULL );
+    _C_ASSERT(node  != NULL    , return LANGUAGE_NODE_NULL);
+    _C_ASSERT(*node != NodeNone, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    language_node_t *root  = nodes_storage_get(ctx, *node);
+    language_node_t *left  = node_left (ctx, root);
+    language_node_t *right = node_right(ctx, root);
+    if(is_number_eq(left, 0) && !is_number_eq(right, 0)) {
+        _RETURN_IF_ERROR(set_val(root, NODE_TYPE_NUMBER, NUMBER(0), NodeNone, NodeNone));
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
     //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->right, 0)) {
-        _RETURN_IF_ERROR(set_val(*node, NODE_TYPE_NUMBER, NUMBER(1), NULL, NULL));
+    if(is_number_eq(right, 0)) {
+        _RETURN_IF_ERROR(set_val(root, NODE_TYPE_NUMBER, NUMBER(1), NodeNone, NodeNone));
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
     //-----------------------------------------------------------------------//
-    if(is_number_eq((*node)->left, 1)) {
-        _RETURN_IF_ERROR(set_val(*node, NODE_TYPE_NUMBER, NUMBER(1), NULL, NULL));
+    if(is_number_eq(left, 1)) {
+        _RETURN_IF_ERROR(set_val(root, NODE_TYPE_NUMBER, NUMBER(1), NodeNone, NodeNone));
         ctx->middleend_info.changes_counter++;
         return LANGUAGE_SUCCESS;
     }
@@ -8,6 +8,7 @@
 #include "nodes_dsl.h"
 #include "colors.h"
 #include "custom_assert.h"
+#include "output.h"
 
 //===========================================================================//
 
@@ -20,7 +21,8 @@ static language_error_t to_source_ident     (language_t        *ctx,
                                              language_node_t   *node);
 
 static language_error_t write_source        (language_t        *ctx,
-                                             const char        *format, ...);
+                                             const char        *format, ...)
+                                             __attribute__((format(printf, 2, 3)));
 
 //===========================================================================//
 
@@ -32,17 +34,17 @@ language_error_t to_source_subtree(language_t *ctx, language_node_t *node) {
     _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
     _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    switch(node->type) {
+    switch(node_type(node)) {
         case NODE_TYPE_IDENTIFIER: {
             _RETURN_IF_ERROR(to_source_ident(ctx, node));
             break;
         }
         case NODE_TYPE_NUMBER: {
-            _WRITE_SRC("%lg", node->value.number);
+            _WRITE_SRC("%lg", node_number(node));
             break;
         }
         case NODE_TYPE_OPERATION: {
-            _RETURN_IF_ERROR(KeyWords[node->value.opcode].to_source(ctx, node));
+            _RETURN_IF_ERROR(KeyWords[node_opcode(node)].to_source(ctx, node));
             break;
         }
         default: {
@@ -59,17 +61,17 @@ language_error_t to_source_ident(language_t *ctx, language_node_t *node) {
     _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
     _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    identifier_t *ident = ctx->name_table.identifiers + node->value.identifier;
+    identifier_t *ident = ctx->name_table.identifiers + node_identifier(node);
     switch(ident->type) {
         case IDENTIFIER_FUNCTION: {
             _WRITE_SRC("%.*s(", (int)ident->length, ident->name);
-            if(node->left != NULL) {
-                _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+            if(node->left != NodeNone) {
+                _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
             }
             _WRITE_SRC(")");
-            if(node->right != NULL) {
+            if(node->right != NodeNone) {
                 _WRITE_SRC(" {\r\n");
-                _RETURN_IF_ERROR(to_source_subtree(ctx, node->right));
+                _RETURN_IF_ERROR(to_source_subtree(ctx, node_right(ctx, node)));
                 _WRITE_SRC("}");
             }
             break;
@@ -96,22 +98,22 @@ language_error_t to_source_math_op(language_t *ctx, language_node_t *node) {
         _RETURN_IF_ERROR(write_source(ctx, "%*s", ctx->frontstart_info.depth * 8, ""));
     }
     //-----------------------------------------------------------------------//
-    bool branches_left = is_bigger_priority(node, node->left);
+    bool branches_left = is_bigger_priority(node, node_left(ctx, node));
     if(branches_left) {
         _WRITE_SRC("(");
     }
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
     if(branches_left) {
         _WRITE_SRC(")");
     }
     //-----------------------------------------------------------------------//
-    _WRITE_SRC(" %s ", KeyWords[node->value.opcode].name);
+    _WRITE_SRC(" %s ", KeyWords[node_opcode(node)].name);
     //-----------------------------------------------------------------------//
-    bool branches_right = is_bigger_priority(node, node->right);
+    bool branches_right = is_bigger_priority(node, node_right(ctx, node));
     if(branches_right) {
         _WRITE_SRC("(");
     }
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->right));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_right(ctx, node)));
     if(branches_right) {
         _WRITE_SRC(")");
     }
@@ -128,16 +130,16 @@ language_error_t to_source_math_func(language_t *ctx, language_node_t *node) {
     _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
     _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    _WRITE_SRC("%s", KeyWords[node->value.opcode].name);
+    _WRITE_SRC("%s", KeyWords[node_opcode(node)].name);
     bool branches = true;
-    if(is_leaf(node->left)) {
+    if(is_leaf(node_left(ctx, node))) {
         branches = false;
     }
 
     if(branches) {
         _WRITE_SRC("(");
     }
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
     if(branches) {
         _WRITE_SRC(")");
     }
@@ -152,9 +154,15 @@ language_error_t to_source_statements_line(language_t *ctx, language_node_t *nod
     //-----------------------------------------------------------------------//
     ctx->frontstart_info.depth++;
     while(node != NULL) {
-        _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+        _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
+        // Declaration without assignment has no semicolon of its own.
+        language_node_t *statement = node_left(ctx, node);
+        if(statement != NULL && is_node_oper_eq(statement, OPERATION_NEW_VAR) &&
+           !is_node_oper_eq(node_left(ctx, statement), OPERATION_ASSIGNMENT)) {
+            _WRITE_SRC(";");
+        }
         _WRITE_SRC("\r\n");
-        node = node->right;
+        node = node_right(ctx, node);
     }
     ctx->frontstart_info.depth--;
     return LANGUAGE_SUCCESS;
@@ -170,9 +178,9 @@ language_error_t to_source_if(language_t *ctx, language_node_t *node) {
                ctx->frontstart_info.depth * 8, "",
                KeyWords[OPERATION_IF].name);
 
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
     _WRITE_SRC(") {\r\n");
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->right));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_right(ctx, node)));
 
     _WRITE_SRC("%*s}",
                ctx->frontstart_info.depth * 8, "");
@@ -189,9 +197,9 @@ language_error_t to_source_while(language_t *ctx, language_node_t *node) {
                ctx->frontstart_info.depth * 8, "",
                KeyWords[OPERATION_WHILE].name);
 
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
     _WRITE_SRC(") {\r\n");
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->right));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_right(ctx, node)));
 
     _WRITE_SRC("%*s}",
                ctx->frontstart_info.depth * 8, "");
@@ -208,7 +216,7 @@ language_error_t to_source_return(language_t *ctx, language_node_t *node) {
                ctx->frontstart_info.depth * 8, "",
                KeyWords[OPERATION_RETURN].name);
 
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
     _WRITE_SRC(";");
     return LANGUAGE_SUCCESS;
 }
@@ -220,13 +228,13 @@ language_error_t to_source_params_line(language_t *ctx, language_node_t *node) {
     _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
     while(node != NULL) {
-        if(node->left != NULL) {
-            _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+        if(node->left != NodeNone) {
+            _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
         }
-        if(node->right != NULL) {
+        if(node->right != NodeNone) {
             _WRITE_SRC(", ");
         }
-        node = node->right;
+        node = node_right(ctx, node);
     }
     return LANGUAGE_SUCCESS;
 }
@@ -242,7 +250,7 @@ language_error_t to_source_new_var(language_t *ctx, language_node_t *node) {
                                   KeyWords[OPERATION_NEW_VAR].name));
     int old_depth = ctx->frontstart_info.depth;
     ctx->frontstart_info.depth = 0;
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
     ctx->frontstart_info.depth = old_depth;
     return LANGUAGE_SUCCESS;
 }
@@ -254,7 +262,7 @@ language_error_t to_source_new_func(language_t *ctx, language_node_t *node) {
     _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
     _WRITE_SRC("%s ", KeyWords[OPERATION_NEW_FUNC].name);
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
     return LANGUAGE_SUCCESS;
 }
 
@@ -266,14 +274,14 @@ language_error_t to_source_in(language_t *ctx, language_node_t *node) {
     _WRITE_SRC("%*s%s(",
                ctx->frontstart_info.depth * 8, "",
                KeyWords[OPERATION_IN].name);
-    if(node->left == NULL || node->left->left == NULL ||
-       !is_ident_type(ctx, node->left->left, IDENTIFIER_VARIABLE)) {
+    if(node->left == NodeNone || node_left(ctx, node)->left == NodeNone ||
+       !is_ident_type(ctx, node_left(ctx, node_left(ctx, node)), IDENTIFIER_VARIABLE)) {
         print_error("Old input format.\n");
         return LANGUAGE_TREE_ERROR;
     }
     identifier_t *ident = ctx->name_table.identifiers +
-                          node->left->left->value.identifier;
-    _WRITE_SRC("%.*s", ident->length, ident->name);
+                          node_identifier(node_left(ctx, node_left(ctx, node)));
+    _WRITE_SRC("%.*s", (int)ident->length, ident->name);
     _WRITE_SRC(");");
 
     return LANGUAGE_SUCCESS;
@@ -288,7 +296,7 @@ language_error_t to_source_out(language_t *ctx, language_node_t *node) {
     _WRITE_SRC("%*s%s(",
                ctx->frontstart_info.depth * 8, "",
                KeyWords[OPERATION_OUT].name);
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
     _WRITE_SRC(");");
     return LANGUAGE_SUCCESS;
 }
@@ -299,7 +307,7 @@ language_error_t to_source_call(language_t *ctx, language_node_t *node) {
     _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
     _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
+    _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
     return LANGUAGE_SUCCESS;
 }
 
@@ -321,13 +329,13 @@ bool is_bigger_priority(language_node_t *node, language_node_t *child) {
     _C_ASSERT(node  != NULL, return false);
     _C_ASSERT(child != NULL, return false);
     //-----------------------------------------------------------------------//
-    if(child->type == NODE_TYPE_IDENTIFIER || child->type == NODE_TYPE_NUMBER) {
+    if(node_type(child) == NODE_TYPE_IDENTIFIER || node_type(child) == NODE_TYPE_NUMBER) {
         return false;
     }
     //-----------------------------------------------------------------------//
-    if(node->type == NODE_TYPE_OPERATION && child->type == NODE_TYPE_OPERATION) {
-        size_t priority_node  = KeyWords[node->value.opcode].priority;
-        size_t priority_child = KeyWords[node->value.opcode].priority;
+    if(node_type(node) == NODE_TYPE_OPERATION && node_type(child) == NODE_TYPE_OPERATION) {
+        size_t priority_node  = KeyWords[node_opcode(node)].priority;
+        size_t priority_child = KeyWords[node_opcode(node)].priority;
 
         if(priority_node >= priority_child) {
             return false;
@@ -340,7 +348,7 @@ bool is_bigger_priority(language_node_t *node, language_node_t *child) {
 //===========================================================================//
 
 bool is_leaf(language_node_t *node) {
-    if(node->left == NULL && node->right == NULL) {
+    if(node->left == NodeNone && node->right == NodeNone) {
         return true;
     }
     return false;
@@ -353,12 +361,11 @@ language_error_t write_source(language_t *ctx, const char *format, ...) {
     _C_ASSERT(format != NULL, return LANGUAGE_STRING_FORMAT_NULL);
     va_list args;
     va_start(args, format);
-    if(vfprintf(ctx->frontstart_info.output, format, args) < 0) {
-        return LANGUAGE_SOURCE_WRITING_ERROR;
-    }
-    fflush(ctx->frontstart_info.output);
+    language_error_t error_code = output_vformat(&ctx->frontstart_info.buffer,
+                                                 format,
+                                                 args);
     va_end(args);
-    return LANGUAGE_SUCCESS;
+    return error_code;
 }
 
 //===========================================================================//
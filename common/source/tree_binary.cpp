@@ -0,0 +1,1177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "tree_binary.h"
+#include "tree_visitor.h"
+#include "name_table.h"
+#include "colors.h"
+#include "utils.h"
+#include "custom_assert.h"
+#include "mapped_file.h"
+#include "hash_cons.h"
+
+//===========================================================================//
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "Binary tree records are read and written in host order.");
+static_assert(sizeof(double) == sizeof(uint64_t),
+              "Numbers are stored as 64 bit doubles.");
+static_assert(sizeof(language_node_t) == 16,
+              "Binary tree node records are 16 byte nodes.");
+
+//===========================================================================//
+
+struct tree_writer_t {
+    language_node_t                 *nodes;
+    bool                            *is_pure;
+    size_t                           size;
+    size_t                           capacity;
+    uint32_t                        *results;
+    size_t                           results_size;
+    size_t                           results_capacity;
+    uint32_t                         spine;
+    hash_cons_t                     *shared;
+    tree_function_t                 *functions;
+    size_t                           functions_number;
+};
+
+//---------------------------------------------------------------------------//
+
+struct tree_loader_t {
+    const tree_function_t           *functions;
+    size_t                           functions_number;
+    size_t                          *by_name;
+    size_t                          *stack;
+    size_t                           stack_size;
+    bool                            *loaded;
+    size_t                           loaded_number;
+};
+
+//===========================================================================//
+
+static const size_t TreeNamesAlignment = 8;
+
+//===========================================================================//
+
+static language_error_t write_names      (language_t          *ctx,
+                                          FILE                *output,
+                                          uint64_t             names_size);
+
+static language_error_t write_functions  (tree_writer_t       *writer);
+
+static bool             definition_function
+                                         (const tree_writer_t *writer,
+                                          uint32_t             definition,
+                                          tree_function_t     *function);
+
+static language_error_t writer_enter     (language_t          *ctx,
+                                          visit_frame_t       *frame,
+                                          void                *writer);
+
+static language_error_t writer_add_node  (language_t          *ctx,
+                                          visit_frame_t       *frame,
+                                          void                *writer);
+
+static language_error_t writer_reserve   (tree_writer_t       *writer,
+                                          size_t               records,
+                                          size_t               results);
+
+static void             writer_dtor      (tree_writer_t       *writer);
+
+static language_error_t read_names       (language_t          *ctx,
+                                          const tree_header_t *header,
+                                          const tree_name_t   *names,
+                                          const char          *blob);
+
+static language_error_t check_nodes      (language_t          *ctx,
+                                          language_node_t     *nodes,
+                                          uint64_t             first,
+                                          uint64_t             number,
+                                          tree_loader_t       *loader);
+
+static language_error_t loader_ctor      (language_t          *ctx,
+                                          tree_loader_t       *loader);
+
+static language_error_t loader_push      (tree_loader_t       *loader,
+                                          size_t               identifier);
+
+static language_error_t loader_dtor      (tree_loader_t       *loader);
+
+static language_error_t load_reachable   (language_t          *ctx,
+                                          const tree_header_t *header,
+                                          tree_loader_t       *loader,
+                                          language_node_t     *nodes);
+
+static language_error_t load_statements  (language_t          *ctx,
+                                          const tree_header_t *header,
+                                          tree_loader_t       *loader,
+                                          language_node_t     *nodes);
+
+static bool             is_valid_record  (language_t            *ctx,
+                                          const language_node_t *record,
+                                          uint64_t               index,
+                                          uint64_t               first);
+
+static language_error_t stream_wait      (language_t            *ctx,
+                                          size_t                 size);
+
+static language_error_t read_frame_names (language_t              *ctx,
+                                          const tree_frame_t      *frame,
+                                          const tree_frame_name_t *names,
+                                          const char              *blob);
+
+static language_error_t set_stream_name  (language_t            *ctx,
+                                          const tree_frame_name_t *record,
+                                          const char            *name);
+
+static language_error_t read_frame_nodes (language_t            *ctx,
+                                          const tree_frame_t    *frame,
+                                          const language_node_t *records,
+                                          uint32_t              *statement);
+
+static language_error_t stream_open      (language_t            *ctx);
+
+static language_error_t write_frame      (language_t            *ctx,
+                                          const language_node_t *records,
+                                          size_t                 records_number);
+
+static void             mark_name        (language_t            *ctx,
+                                          size_t                 index,
+                                          size_t                *names,
+                                          size_t                *names_number);
+
+//===========================================================================//
+
+bool is_binary_tree(const char *data, size_t size) {
+    return data != NULL              &&
+           size >= sizeof(TreeMagic) &&
+           memcmp(data, TreeMagic, sizeof(TreeMagic)) == 0;
+}
+
+//===========================================================================//
+
+language_error_t write_tree_binary(language_t *ctx, FILE *output) {
+    _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL          );
+    _C_ASSERT(output != NULL, return LANGUAGE_OPENING_FILE_ERROR);
+    //-----------------------------------------------------------------------//
+    // Nodes are numbered before anything is written, so header is known.
+    // Equal pure subtrees of one top level statement become one record
+    // when tree is written as DAG.
+    tree_writer_t writer = {};
+    hash_cons_t   shared = {};
+    writer.spine = ctx->root;
+    language_error_t error_code = writer_reserve(&writer,
+                                                 ctx->nodes.size == 0 ? 1 : ctx->nodes.size,
+                                                 1);
+    if(error_code == LANGUAGE_SUCCESS && ctx->tree_format == TREE_FORMAT_DAG) {
+        writer.shared = &shared;
+        error_code    = hash_cons_ctor(&shared, 0);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        tree_visitor_t visitor = {};
+        visitor.pre  = writer_enter;
+        visitor.post = writer_add_node;
+        visitor.data = &writer;
+        error_code   = tree_visit(ctx, &visitor, &ctx->root);
+        tree_visitor_dtor(&visitor);
+    }
+    uint64_t root = ctx->root == NodeNone ? NodeNone : writer.size - 1;
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = write_functions(&writer);
+    }
+    //-----------------------------------------------------------------------//
+    uint64_t names_size = 0;
+    if(error_code == LANGUAGE_SUCCESS) {
+        tree_header_t header = {};
+        memcpy(header.magic, TreeMagic, sizeof(TreeMagic));
+        header.version          = TreeVersion;
+        header.names_number     = ctx->name_table.size;
+        header.functions_number = writer.functions_number;
+        header.nodes_number     = writer.size;
+        header.root             = root;
+        header.node_size        = sizeof(language_node_t);
+        for(size_t elem = 0; elem < ctx->name_table.size; elem++) {
+            names_size += ctx->name_table.identifiers[elem].length;
+        }
+        header.names_size = (names_size + TreeNamesAlignment - 1) /
+                            TreeNamesAlignment * TreeNamesAlignment;
+        //-------------------------------------------------------------------//
+        fwrite(&header, sizeof(header), 1, output);
+        error_code = write_names(ctx, output, names_size);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        fwrite(writer.functions,
+               sizeof(writer.functions[0]),
+               writer.functions_number,
+               output);
+        fwrite(writer.nodes, sizeof(writer.nodes[0]), writer.size, output);
+        if(ferror(output)) {
+            print_error("Error while writing binary tree.\n");
+            error_code = LANGUAGE_OPENING_FILE_ERROR;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    hash_cons_dtor(&shared);
+    writer_dtor(&writer);
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t write_names(language_t *ctx,
+                             FILE       *output,
+                             uint64_t    names_size) {
+    uint32_t offset = 0;
+    for(size_t elem = 0; elem < ctx->name_table.size; elem++) {
+        identifier_t *ident  = ctx->name_table.identifiers + elem;
+        tree_name_t   record = {};
+        if(ident->length > UINT32_MAX - offset) {
+            print_error("Name table is too big for binary tree.\n");
+            return LANGUAGE_TREE_ERROR;
+        }
+        record.offset     = offset;
+        record.length     = (uint32_t)ident->length;
+        record.parameters = (uint32_t)ident->parameters_number;
+        record.type       = (uint8_t)ident->type;
+        record.is_global  = ident->is_global;
+        offset           += record.length;
+        fwrite(&record, sizeof(record), 1, output);
+    }
+    //-----------------------------------------------------------------------//
+    for(size_t elem = 0; elem < ctx->name_table.size; elem++) {
+        identifier_t *ident = ctx->name_table.identifiers + elem;
+        fwrite(ident->name, sizeof(char), ident->length, output);
+    }
+    static const char Padding[TreeNamesAlignment] = {};
+    fwrite(Padding,
+           sizeof(char),
+           (TreeNamesAlignment - names_size % TreeNamesAlignment) %
+           TreeNamesAlignment,
+           output);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t write_functions(tree_writer_t *writer) {
+    // Statements chain is the left spine from the root record, definition
+    // is the left subtree which starts right after the previous one. First
+    // pass counts functions, second one fills the index.
+    for(size_t pass = 0; pass < 2; pass++) {
+        size_t   number    = 0;
+        uint64_t begin     = 0;
+        uint32_t statement = writer->size == 0 ? NodeNone : (uint32_t)(writer->size - 1);
+        while(statement != NodeNone) {
+            const language_node_t *record = writer->nodes + statement;
+            if(record->left != NodeNone) {
+                uint32_t        definition = record->left;
+                tree_function_t function   = {};
+                if(definition_function(writer, definition, &function)) {
+                    function.first = begin;
+                    function.size  = definition - begin + 1;
+                    if(writer->functions != NULL) {
+                        writer->functions[number] = function;
+                    }
+                    number++;
+                }
+                begin = definition + 1;
+            }
+            statement = record->right;
+        }
+        //-------------------------------------------------------------------//
+        if(pass == 0 && number != 0) {
+            writer->functions = (tree_function_t *)calloc(number,
+                                                          sizeof(writer->functions[0]));
+            if(writer->functions == NULL) {
+                print_error("Error while allocating binary tree function index.\n");
+                return LANGUAGE_MEMORY_ERROR;
+            }
+        }
+        writer->functions_number = number;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+bool definition_function(const tree_writer_t *writer,
+                         uint32_t             definition,
+                         tree_function_t     *function) {
+    const language_node_t *record = writer->nodes + definition;
+    if(node_type  (record) != NODE_TYPE_OPERATION ||
+       node_opcode(record) != OPERATION_NEW_FUNC  ||
+       record->left        == NodeNone            ||
+       node_type(writer->nodes + record->left) != NODE_TYPE_IDENTIFIER) {
+        return false;
+    }
+    function->identifier = node_identifier(writer->nodes + record->left);
+    return true;
+}
+
+//===========================================================================//
+
+language_error_t writer_enter(language_t    *ctx,
+                              visit_frame_t *frame,
+                              void          *data) {
+    // Every top level statement starts new scope of shared subtrees, so
+    // records of a definition never point to records of other ones.
+    tree_writer_t *writer = (tree_writer_t *)data;
+    if(*frame->link == writer->spine) {
+        writer->spine = nodes_storage_get(ctx, writer->spine)->right;
+        if(writer->shared != NULL) {
+            hash_cons_scope(writer->shared);
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t writer_add_node(language_t    *ctx,
+                                 visit_frame_t *frame,
+                                 void          *data) {
+    // Children records are on top of results stack, right one is the last.
+    tree_writer_t   *writer = (tree_writer_t *)data;
+    language_node_t *node   = nodes_storage_get(ctx, *frame->link);
+    uint32_t right = node->right == NodeNone ? NodeNone :
+                                               writer->results[--writer->results_size];
+    uint32_t left  = node->left  == NodeNone ? NodeNone :
+                                               writer->results[--writer->results_size];
+    _RETURN_IF_ERROR(writer_reserve(writer, writer->size + 1, writer->results_size + 1));
+    //-----------------------------------------------------------------------//
+    // Pure subtree equal to the written one is replaced by its record.
+    uint32_t own     = (uint32_t)writer->size;
+    bool     is_pure = writer->shared != NULL                    &&
+                       hash_cons_is_pure(ctx, node)              &&
+                       (left  == NodeNone || writer->is_pure[left ]) &&
+                       (right == NodeNone || writer->is_pure[right]);
+    if(is_pure) {
+        hash_cons_entry_t  key   = {};
+        hash_cons_entry_t *entry = NULL;
+        key.type      = (uint64_t)node_type(node);
+        key.value     = node->value;
+        key.left      = left;
+        key.right     = right;
+        key.canonical = own;
+        _RETURN_IF_ERROR(hash_cons_insert(writer->shared, &key, &entry));
+        if(entry->canonical != own) {
+            writer->results[writer->results_size++] = (uint32_t)entry->canonical;
+            writer->shared->shared++;
+            return LANGUAGE_SUCCESS;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    // Children always precede their parent.
+    language_node_t *record = writer->nodes + own;
+    record->value           = node->value;
+    record->left            = left;
+    record->right           = right;
+    writer->is_pure[own]    = is_pure;
+    writer->size++;
+    writer->results[writer->results_size++] = own;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t writer_reserve(tree_writer_t *writer, size_t records, size_t results) {
+    if(records > writer->capacity) {
+        size_t           new_capacity = writer->capacity == 0 ? records : writer->capacity * 2;
+        language_node_t *new_nodes    = (language_node_t *)realloc(writer->nodes,
+                                                                   new_capacity * sizeof(new_nodes[0]));
+        if(new_nodes != NULL) {
+            writer->nodes = new_nodes;
+        }
+        bool *new_pure = (bool *)realloc(writer->is_pure, new_capacity * sizeof(new_pure[0]));
+        if(new_pure != NULL) {
+            writer->is_pure = new_pure;
+        }
+        if(new_nodes == NULL || new_pure == NULL) {
+            print_error("Error while reallocating binary tree records.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        writer->capacity = new_capacity;
+    }
+    //-----------------------------------------------------------------------//
+    if(results > writer->results_capacity) {
+        size_t    new_capacity = writer->results_capacity == 0 ? 64 :
+                                 writer->results_capacity * 2;
+        uint32_t *new_results  = (uint32_t *)realloc(writer->results,
+                                                     new_capacity * sizeof(new_results[0]));
+        if(new_results == NULL) {
+            print_error("Error while reallocating binary tree writer stack.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        writer->results          = new_results;
+        writer->results_capacity = new_capacity;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void writer_dtor(tree_writer_t *writer) {
+    free(writer->nodes);
+    free(writer->is_pure);
+    free(writer->results);
+    free(writer->functions);
+    *writer = {};
+}
+
+//===========================================================================//
+
+language_error_t read_tree_binary(language_t *ctx, bool reachable) {
+    _C_ASSERT(ctx        != NULL, return LANGUAGE_CTX_NULL  );
+    _C_ASSERT(ctx->input != NULL, return LANGUAGE_INPUT_NULL);
+    //-----------------------------------------------------------------------//
+    // Header is copied, input is mapped again before nodes are used.
+    tree_header_t header = {};
+    if(ctx->input_size < sizeof(header)) {
+        print_error("Binary tree header is out of file.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    memcpy(&header, ctx->input, sizeof(header));
+    if(header.version != TreeVersion || header.node_size != sizeof(language_node_t)) {
+        print_error("Unsupported binary tree version.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    //-----------------------------------------------------------------------//
+    // Every section is checked against the file size before it is used.
+    size_t available = ctx->input_size - sizeof(header);
+    if(header.names_number > available / sizeof(tree_name_t)) {
+        print_error("Binary tree name table is out of file.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    available -= header.names_number * sizeof(tree_name_t);
+    if(header.names_size > available ||
+       header.names_size % TreeNamesAlignment != 0) {
+        print_error("Binary tree names are out of file.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    available -= header.names_size;
+    if(header.functions_number > available / sizeof(tree_function_t)) {
+        print_error("Binary tree function index is out of file.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    available -= header.functions_number * sizeof(tree_function_t);
+    if(header.nodes_number > available / sizeof(language_node_t) ||
+       header.nodes_number >= NodeNone) {
+        print_error("Binary tree nodes are out of file.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    if(header.nodes_number == 0 ? header.root != NodeNone :
+                                  header.root >= header.nodes_number) {
+        print_error("Binary tree root is out of nodes.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    //-----------------------------------------------------------------------//
+    // Nodes section becomes the first chunks of storage, so the mapping is
+    // extended with zero pages to the end of the last chunk. Pages are
+    // read at once only if all of them are going to be checked.
+    size_t functions_offset = sizeof(header)                            +
+                              header.names_number * sizeof(tree_name_t) +
+                              header.names_size;
+    size_t nodes_offset     = functions_offset +
+                              header.functions_number * sizeof(tree_function_t);
+    size_t chunks           = (header.nodes_number + NodesChunkSize - 1) >> NodesChunkShift;
+    _RETURN_IF_ERROR(mapped_file_reserve(&ctx->input_map,
+                                         ctx->input_file,
+                                         nodes_offset +
+                                         (chunks << NodesChunkShift) *
+                                         sizeof(language_node_t),
+                                         !reachable));
+    ctx->input          = ctx->input_map.data;
+    ctx->input_size     = ctx->input_map.size;
+    ctx->input_position = ctx->input + ctx->input_size;
+    //-----------------------------------------------------------------------//
+    const tree_name_t *names = (const tree_name_t *)(ctx->input + sizeof(header));
+    const char        *blob  = (const char        *)(names + header.names_number);
+    language_node_t   *nodes = (language_node_t   *)(ctx->input + nodes_offset);
+    _RETURN_IF_ERROR(read_names(ctx, &header, names, blob));
+    //-----------------------------------------------------------------------//
+    // Functions are loaded on demand only if main is in the index, other
+    // trees are checked whole.
+    tree_loader_t loader = {};
+    loader.functions        = (const tree_function_t *)(ctx->input + functions_offset);
+    loader.functions_number = header.functions_number;
+    language_error_t error_code = LANGUAGE_SUCCESS;
+    if(reachable) {
+        error_code = loader_ctor(ctx, &loader);
+    }
+    if(error_code == LANGUAGE_SUCCESS && loader.stack_size != 0) {
+        error_code = load_reachable(ctx, &header, &loader, nodes);
+    }
+    else if(error_code == LANGUAGE_SUCCESS) {
+        error_code = check_nodes(ctx, nodes, 0, header.nodes_number, NULL);
+        ctx->root  = (uint32_t)header.root;
+    }
+    loader_dtor(&loader);
+    _RETURN_IF_ERROR(error_code);
+    _RETURN_IF_ERROR(nodes_storage_attach(ctx, nodes, header.nodes_number));
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_names(language_t          *ctx,
+                            const tree_header_t *header,
+                            const tree_name_t   *names,
+                            const char          *blob) {
+    _RETURN_IF_ERROR(name_table_ctor(ctx, header->names_number + 2));
+    for(size_t elem = 0; elem < header->names_number; elem++) {
+        const tree_name_t *record = names + elem;
+        if((uint64_t)record->offset + record->length > header->names_size ||
+           (record->type != IDENTIFIER_VARIABLE &&
+            record->type != IDENTIFIER_FUNCTION)) {
+            print_error("Broken binary tree name table record " SZ_SP ".\n",
+                        elem);
+            return LANGUAGE_BROKEN_NAME_TABLE_ELEM;
+        }
+        //-------------------------------------------------------------------//
+        // Names point to the input like in text trees.
+        size_t name_index = 0;
+        _RETURN_IF_ERROR(name_table_add(ctx,
+                                        blob + record->offset,
+                                        record->length,
+                                        &name_index,
+                                        (identifier_type_t)record->type));
+        identifier_t *ident = ctx->name_table.identifiers + name_index;
+        ident->parameters_number = record->parameters;
+        ident->is_global         = record->is_global != 0;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t check_nodes(language_t      *ctx,
+                             language_node_t *nodes,
+                             uint64_t         first,
+                             uint64_t         number,
+                             tree_loader_t   *loader) {
+    // Records are used as nodes as they are, so pages are only read.
+    uint64_t end = first + number;
+    for(uint64_t elem = first; elem < end; elem++) {
+        const language_node_t *record = nodes + elem;
+        if(!is_valid_record(ctx, record, elem, first)) {
+            print_error("Broken binary tree node record " SZ_SP ".\n", (size_t)elem);
+            return LANGUAGE_INVALID_NODE_VALUE;
+        }
+        //-------------------------------------------------------------------//
+        // Function identifiers in loaded function are its callees.
+        if(loader != NULL && node_type(record) == NODE_TYPE_IDENTIFIER &&
+           ctx->name_table.identifiers[node_identifier(record)].type == IDENTIFIER_FUNCTION) {
+            _RETURN_IF_ERROR(loader_push(loader, node_identifier(record)));
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t loader_ctor(language_t *ctx, tree_loader_t *loader) {
+    size_t names_number = ctx->name_table.size;
+    loader->by_name = (size_t *)calloc(names_number + 1, sizeof(loader->by_name[0]));
+    loader->stack   = (size_t *)calloc(loader->functions_number + 1,
+                                       sizeof(loader->stack[0]));
+    loader->loaded  = (bool   *)calloc(loader->functions_number + 1,
+                                       sizeof(loader->loaded[0]));
+    if(loader->by_name == NULL || loader->stack == NULL || loader->loaded == NULL) {
+        print_error("Error while allocating binary tree loader.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    // Index records are checked here, their ranges are checked against
+    // statements chain after loading.
+    for(size_t name = 0; name < names_number; name++) {
+        loader->by_name[name] = loader->functions_number;
+    }
+    size_t main_index = names_number;
+    for(size_t elem = 0; elem < loader->functions_number; elem++) {
+        const tree_function_t *function = loader->functions + elem;
+        if(function->identifier >= names_number                              ||
+           loader->by_name[function->identifier] != loader->functions_number ||
+           function->size == 0) {
+            print_error("Broken binary tree function index record " SZ_SP ".\n",
+                        elem);
+            return LANGUAGE_TREE_ERROR;
+        }
+        loader->by_name[function->identifier] = elem;
+        identifier_t *ident = ctx->name_table.identifiers + function->identifier;
+        if(ident->length == MainFunctionLen &&
+           strncmp(ident->name, MainFunctionName, MainFunctionLen) == 0) {
+            main_index = function->identifier;
+        }
+    }
+    if(main_index != names_number) {
+        _RETURN_IF_ERROR(loader_push(loader, main_index));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t loader_push(tree_loader_t *loader, size_t identifier) {
+    // Functions which are not in index (stdlib ones) are not loaded.
+    size_t function = loader->by_name[identifier];
+    if(function == loader->functions_number || loader->loaded[function]) {
+        return LANGUAGE_SUCCESS;
+    }
+    loader->loaded[function]            = true;
+    loader->stack[loader->stack_size++] = function;
+    loader->loaded_number++;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t loader_dtor(tree_loader_t *loader) {
+    free(loader->by_name);
+    free(loader->stack);
+    free(loader->loaded);
+    *loader = {};
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t load_reachable(language_t          *ctx,
+                                const tree_header_t *header,
+                                tree_loader_t       *loader,
+                                language_node_t     *nodes) {
+    // Loaded function pushes its callees, so only reachable ones are read.
+    while(loader->stack_size != 0) {
+        const tree_function_t *function =
+            loader->functions + loader->stack[--loader->stack_size];
+        if(function->first >= header->nodes_number ||
+           function->size  >  header->nodes_number - function->first) {
+            print_error("Binary tree function is out of nodes.\n");
+            return LANGUAGE_TREE_ERROR;
+        }
+        _RETURN_IF_ERROR(check_nodes(ctx,
+                                     nodes,
+                                     function->first,
+                                     function->size,
+                                     loader));
+    }
+    return load_statements(ctx, header, loader, nodes);
+}
+
+//===========================================================================//
+
+language_error_t load_statements(language_t          *ctx,
+                                 const tree_header_t *header,
+                                 tree_loader_t       *loader,
+                                 language_node_t     *nodes) {
+    // Statements chain is relinked without statements of functions which
+    // were not loaded, other definitions are checked whole. Definition
+    // takes records from the end of the previous one, statements follow
+    // all definitions. Index records follow the chain order.
+    uint32_t *link      = &ctx->root;
+    uint32_t  statement = (uint32_t)header->root;
+    uint64_t  begin     = 0;
+    size_t    function  = 0;
+    size_t    matched   = 0;
+    *link = NodeNone;
+    while(statement != NodeNone) {
+        language_node_t *record     = nodes + statement;
+        uint32_t         next       = record->right;
+        uint32_t         definition = record->left;
+        if(!is_valid_record(ctx, record, statement, 0) ||
+           (definition != NodeNone && (definition < begin ||
+                                       (next != NodeNone && next <= definition)))) {
+            print_error("Broken binary tree node record " SZ_SP ".\n",
+                        (size_t)statement);
+            return LANGUAGE_INVALID_NODE_VALUE;
+        }
+        //-------------------------------------------------------------------//
+        if(definition != NodeNone) {
+            uint64_t first = begin;
+            uint64_t size  = definition - begin + 1;
+            begin          = definition + 1;
+            if(function < loader->functions_number &&
+               loader->functions[function].first == first) {
+                if(loader->functions[function].size != size) {
+                    print_error("Binary tree function index does not match nodes.\n");
+                    return LANGUAGE_TREE_ERROR;
+                }
+                if(!loader->loaded[function++]) {
+                    statement = next;
+                    continue;
+                }
+                matched++;
+            }
+            else {
+                _RETURN_IF_ERROR(check_nodes(ctx, nodes, first, size, NULL));
+            }
+        }
+        //-------------------------------------------------------------------//
+        // Only statements chain records are written, next one is kept
+        // already, so records are written after they are read.
+        record->right = NodeNone;
+        *link         = statement;
+        link          = &record->right;
+        statement     = next;
+    }
+    if(matched != loader->loaded_number) {
+        print_error("Binary tree function index does not match nodes.\n");
+        return LANGUAGE_TREE_ERROR;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+bool is_valid_record(language_t            *ctx,
+                     const language_node_t *record,
+                     uint64_t               index,
+                     uint64_t               first) {
+    // Children always precede their parent, so records can not form a loop
+    // even when they are shared.
+    if((record->left  != NodeNone && (record->left  >= index || record->left  < first)) ||
+       (record->right != NodeNone && (record->right >= index || record->right < first))) {
+        return false;
+    }
+    switch(node_type(record)) {
+        case NODE_TYPE_NUMBER: {
+            return true;
+        }
+        case NODE_TYPE_IDENTIFIER: {
+            return node_identifier(record) < ctx->name_table.size;
+        }
+        case NODE_TYPE_OPERATION: {
+            return node_opcode(record) != OPERATION_UNKNOWN &&
+                   node_opcode(record) <= OPERATION_PROGRAM_END;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+//===========================================================================//
+
+bool is_stream_tree(const char *data, size_t size) {
+    return data != NULL                    &&
+           size >= sizeof(TreeStreamMagic) &&
+           memcmp(data, TreeStreamMagic, sizeof(TreeStreamMagic)) == 0;
+}
+
+//===========================================================================//
+
+language_error_t read_tree_stream(language_t *ctx, bool whole) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    tree_stream_t *stream = &ctx->tree_stream;
+    _RETURN_IF_ERROR(stream_wait(ctx, sizeof(tree_stream_header_t)));
+    tree_stream_header_t header = {};
+    memcpy(&header, ctx->input_map.data, sizeof(header));
+    if(header.version != TreeStreamVersion || header.node_size != sizeof(language_node_t)) {
+        print_error("Unsupported stream tree version.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    _RETURN_IF_ERROR(name_table_ctor(ctx, NameTableDefaultCapacity));
+    _RETURN_IF_ERROR(nodes_storage_ctor(ctx, NodesChunkSize, false));
+    stream->offset     = sizeof(header);
+    stream->last       = NodeNone;
+    stream->is_reading = true;
+    ctx->root          = NodeNone;
+    //-----------------------------------------------------------------------//
+    // Otherwise statements are read by the caller one by one.
+    if(!whole) {
+        return LANGUAGE_SUCCESS;
+    }
+    uint32_t statement = NodeNone;
+    do {
+        _RETURN_IF_ERROR(read_tree_frame(ctx, &statement));
+    } while(statement != NodeNone);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_tree_frame(language_t *ctx, uint32_t *statement) {
+    _C_ASSERT(ctx       != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(statement != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    tree_stream_t *stream = &ctx->tree_stream;
+    *statement = NodeNone;
+    if(!stream->is_reading) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // Frame is waited for whole, its sections are checked against its
+    // header before they are used.
+    tree_frame_t frame = {};
+    _RETURN_IF_ERROR(stream_wait(ctx, sizeof(frame)));
+    memcpy(&frame, ctx->input_map.data + stream->offset, sizeof(frame));
+    if(frame.names_number >= NodeNone                                ||
+       frame.names_size   >  UINT32_MAX                              ||
+       frame.names_size   %  TreeNamesAlignment != 0                 ||
+       frame.nodes_number >= NodeNone - ctx->nodes.size) {
+        print_error("Broken stream tree frame.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    size_t frame_size = sizeof(frame)                                    +
+                        frame.names_number * sizeof(tree_frame_name_t)   +
+                        frame.names_size                                 +
+                        frame.nodes_number * sizeof(language_node_t);
+    _RETURN_IF_ERROR(stream_wait(ctx, frame_size));
+    //-----------------------------------------------------------------------//
+    // Input buffer grows while later frames are read, so names are copied
+    // and records become nodes in storage.
+    const char              *data    = ctx->input_map.data + stream->offset + sizeof(frame);
+    const tree_frame_name_t *names   = (const tree_frame_name_t *)data;
+    const char              *blob    = (const char              *)(names + frame.names_number);
+    const language_node_t   *records = (const language_node_t   *)(blob  + frame.names_size);
+    _RETURN_IF_ERROR(read_frame_names(ctx, &frame, names, blob));
+    if(frame.nodes_number == 0) {
+        stream->is_reading = false;
+    }
+    else {
+        _RETURN_IF_ERROR(read_frame_nodes(ctx, &frame, records, statement));
+    }
+    stream->offset += frame_size;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t stream_wait(language_t *ctx, size_t size) {
+    tree_stream_t *stream = &ctx->tree_stream;
+    _RETURN_IF_ERROR(mapped_file_fill(&ctx->input_map, stream->offset + size));
+    if(ctx->input_map.size - stream->offset < size) {
+        print_error("Stream tree ended before its last frame.\n");
+        return LANGUAGE_UNKNOWN_CODE_TREE_TYPE;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_frame_names(language_t              *ctx,
+                                  const tree_frame_t      *frame,
+                                  const tree_frame_name_t *names,
+                                  const char              *blob) {
+    if(frame->names_number == 0) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // Blocks live until the input is closed, like names of other formats
+    // which point to the input.
+    tree_stream_t *stream = &ctx->tree_stream;
+    if(stream->blocks_number == stream->blocks_capacity) {
+        size_t new_capacity = stream->blocks_capacity == 0 ? 64 :
+                              stream->blocks_capacity * 2;
+        char **new_blocks   = (char **)realloc(stream->blocks,
+                                               new_capacity * sizeof(new_blocks[0]));
+        if(new_blocks == NULL) {
+            print_error("Error while allocating stream tree names.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        stream->blocks          = new_blocks;
+        stream->blocks_capacity = new_capacity;
+    }
+    char *block = (char *)malloc(frame->names_size + 1);
+    if(block == NULL) {
+        print_error("Error while allocating stream tree names.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    memcpy(block, blob, frame->names_size);
+    stream->blocks[stream->blocks_number++] = block;
+    //-----------------------------------------------------------------------//
+    for(size_t elem = 0; elem < frame->names_number; elem++) {
+        const tree_frame_name_t *record = names + elem;
+        if((uint64_t)record->name.offset + record->name.length > frame->names_size ||
+           record->name.length == 0                                              ||
+           record->index >= NodeNone                                             ||
+           (record->name.type != IDENTIFIER_VARIABLE &&
+            record->name.type != IDENTIFIER_FUNCTION)                            ||
+           (record->index < ctx->name_table.size &&
+            ctx->name_table.identifiers[record->index].name != NULL)) {
+            print_error("Broken stream tree name table record " SZ_SP ".\n",
+                        elem);
+            return LANGUAGE_BROKEN_NAME_TABLE_ELEM;
+        }
+        _RETURN_IF_ERROR(set_stream_name(ctx, record, block + record->name.offset));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t set_stream_name(language_t              *ctx,
+                                 const tree_frame_name_t *record,
+                                 const char              *name) {
+    // Names come in order of their first use, so table may have holes
+    // which are filled by later frames.
+    size_t size  = ctx->name_table.size;
+    size_t index = record->index;
+    if(index >= size) {
+        _RETURN_IF_ERROR(name_table_reserve(ctx, index + 1));
+        memset(ctx->name_table.identifiers + size,
+               0,
+               (index + 1 - size) * sizeof(ctx->name_table.identifiers[0]));
+        size = index + 1;
+    }
+    ctx->name_table.size = index;
+    language_error_t error_code = name_table_add(ctx,
+                                                 name,
+                                                 record->name.length,
+                                                 NULL,
+                                                 (identifier_type_t)record->name.type);
+    ctx->name_table.size = size;
+    _RETURN_IF_ERROR(error_code);
+    //-----------------------------------------------------------------------//
+    identifier_t *ident = ctx->name_table.identifiers + index;
+    ident->parameters_number = record->name.parameters;
+    ident->is_global         = record->name.is_global != 0;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_frame_nodes(language_t            *ctx,
+                                  const tree_frame_t    *frame,
+                                  const language_node_t *records,
+                                  uint32_t              *statement) {
+    // The last record is the chain node and it has no next statement yet.
+    const language_node_t *chain = records + frame->nodes_number - 1;
+    if(node_type  (chain) != NODE_TYPE_OPERATION ||
+       node_opcode(chain) != OPERATION_STATEMENT ||
+       chain->right       != NodeNone) {
+        print_error("Stream tree frame does not end with statement.\n");
+        return LANGUAGE_INVALID_NODE_VALUE;
+    }
+    //-----------------------------------------------------------------------//
+    size_t first = 0;
+    _RETURN_IF_ERROR(nodes_storage_reserve(ctx, frame->nodes_number, &first));
+    for(uint64_t elem = 0; elem < frame->nodes_number; elem++) {
+        const language_node_t *record = records + elem;
+        if(!is_valid_record(ctx, record, elem, 0) ||
+           (node_type(record) == NODE_TYPE_IDENTIFIER &&
+            ctx->name_table.identifiers[node_identifier(record)].name == NULL)) {
+            print_error("Broken stream tree node record " SZ_SP ".\n", (size_t)elem);
+            return LANGUAGE_INVALID_NODE_VALUE;
+        }
+        language_node_t *node = nodes_storage_get(ctx, (uint32_t)(first + elem));
+        node->value = record->value;
+        node->left  = record->left  == NodeNone ? NodeNone : (uint32_t)(first + record->left );
+        node->right = record->right == NodeNone ? NodeNone : (uint32_t)(first + record->right);
+    }
+    //-----------------------------------------------------------------------//
+    tree_stream_t *stream = &ctx->tree_stream;
+    *statement = (uint32_t)(first + frame->nodes_number - 1);
+    if(stream->last == NodeNone) {
+        ctx->root = *statement;
+    }
+    else {
+        nodes_storage_get(ctx, stream->last)->right = *statement;
+    }
+    stream->last = *statement;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t write_tree_frame(language_t *ctx, uint32_t statement) {
+    _C_ASSERT(ctx       != NULL    , return LANGUAGE_CTX_NULL );
+    _C_ASSERT(statement != NodeNone, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    if(ctx->tree_stream.output == NULL) {
+        _RETURN_IF_ERROR(stream_open(ctx));
+    }
+    // Records are numbered from the frame start, chain node is added after
+    // the statement with no next one.
+    language_node_t *chain  = nodes_storage_get(ctx, statement);
+    uint32_t         root   = chain->left;
+    tree_writer_t    writer = {};
+    writer.spine = NodeNone;
+    language_error_t error_code = writer_reserve(&writer, 1, 1);
+    if(error_code == LANGUAGE_SUCCESS && root != NodeNone) {
+        tree_visitor_t visitor = {};
+        visitor.post = writer_add_node;
+        visitor.data = &writer;
+        error_code   = tree_visit(ctx, &visitor, &root);
+        tree_visitor_dtor(&visitor);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = writer_reserve(&writer, writer.size + 1, 1);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        language_node_t *record = writer.nodes + writer.size;
+        record->value = chain->value;
+        record->left  = root == NodeNone ? NodeNone : (uint32_t)(writer.size - 1);
+        record->right = NodeNone;
+        writer.size++;
+        error_code = write_frame(ctx, writer.nodes, writer.size);
+    }
+    writer_dtor(&writer);
+    _RETURN_IF_ERROR(error_code);
+    ctx->tree_stream.frames++;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t write_tree_stream(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    // Statements which were written while they were made are skipped.
+    tree_stream_t *stream    = &ctx->tree_stream;
+    uint32_t       statement = ctx->root;
+    for(size_t frame = 0; frame < stream->frames && statement != NodeNone; frame++) {
+        statement = nodes_storage_get(ctx, statement)->right;
+    }
+    while(statement != NodeNone) {
+        _RETURN_IF_ERROR(write_tree_frame(ctx, statement));
+        statement = nodes_storage_get(ctx, statement)->right;
+    }
+    //-----------------------------------------------------------------------//
+    if(stream->output == NULL) {
+        _RETURN_IF_ERROR(stream_open(ctx));
+    }
+    _RETURN_IF_ERROR(write_frame(ctx, NULL, 0));
+    return tree_stream_close(ctx);
+}
+
+//===========================================================================//
+
+language_error_t tree_stream_close(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    tree_stream_t *stream = &ctx->tree_stream;
+    if(stream->output != NULL) {
+        tree_file_close(stream->output);
+    }
+    for(size_t block = 0; block < stream->blocks_number; block++) {
+        free(stream->blocks[block]);
+    }
+    free(stream->blocks);
+    free(stream->sent);
+    *stream = {};
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t stream_open(language_t *ctx) {
+    FILE *output = tree_file_open(ctx);
+    if(output == NULL) {
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    tree_stream_header_t header = {};
+    memcpy(header.magic, TreeStreamMagic, sizeof(TreeStreamMagic));
+    header.version   = TreeStreamVersion;
+    header.node_size = sizeof(language_node_t);
+    fwrite(&header, sizeof(header), 1, output);
+    ctx->tree_stream.output = output;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t write_frame(language_t            *ctx,
+                             const language_node_t *records,
+                             size_t                 records_number) {
+    // Frame takes names its records use, frame without records takes all
+    // names which were not sent.
+    tree_stream_t *stream = &ctx->tree_stream;
+    size_t         table  = ctx->name_table.size;
+    if(table > stream->sent_capacity) {
+        bool *new_sent = (bool *)realloc(stream->sent, table * sizeof(new_sent[0]));
+        if(new_sent == NULL) {
+            print_error("Error while allocating stream tree names.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        memset(new_sent + stream->sent_capacity,
+               0,
+               (table - stream->sent_capacity) * sizeof(new_sent[0]));
+        stream->sent          = new_sent;
+        stream->sent_capacity = table;
+    }
+    size_t  candidates = records == NULL ? table : records_number;
+    size_t *names      = (size_t *)calloc(candidates + 1, sizeof(names[0]));
+    if(names == NULL) {
+        print_error("Error while allocating stream tree names.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    size_t names_number = 0;
+    for(size_t elem = 0; elem < candidates; elem++) {
+        if(records == NULL) {
+            mark_name(ctx, elem, names, &names_number);
+        }
+        else if(node_type(records + elem) == NODE_TYPE_IDENTIFIER) {
+            mark_name(ctx, node_identifier(records + elem), names, &names_number);
+        }
+    }
+    //-----------------------------------------------------------------------//
+    tree_frame_t frame = {};
+    uint64_t     names_size = 0;
+    for(size_t elem = 0; elem < names_number; elem++) {
+        names_size += ctx->name_table.identifiers[names[elem]].length;
+    }
+    if(names_size > UINT32_MAX - TreeNamesAlignment) {
+        free(names);
+        print_error("Names of statement are too big for stream tree.\n");
+        return LANGUAGE_TREE_ERROR;
+    }
+    frame.names_number = names_number;
+    frame.names_size   = (names_size + TreeNamesAlignment - 1) /
+                         TreeNamesAlignment * TreeNamesAlignment;
+    frame.nodes_number = records_number;
+    fwrite(&frame, sizeof(frame), 1, stream->output);
+    uint32_t offset = 0;
+    for(size_t elem = 0; elem < names_number; elem++) {
+        identifier_t     *ident  = ctx->name_table.identifiers + names[elem];
+        tree_frame_name_t record = {};
+        record.index           = names[elem];
+        record.name.offset     = offset;
+        record.name.length     = (uint32_t)ident->length;
+        record.name.parameters = (uint32_t)ident->parameters_number;
+        record.name.type       = (uint8_t)ident->type;
+        record.name.is_global  = ident->is_global;
+        offset                += record.name.length;
+        fwrite(&record, sizeof(record), 1, stream->output);
+    }
+    for(size_t elem = 0; elem < names_number; elem++) {
+        identifier_t *ident = ctx->name_table.identifiers + names[elem];
+        fwrite(ident->name, sizeof(char), ident->length, stream->output);
+    }
+    free(names);
+    static const char Padding[TreeNamesAlignment] = {};
+    fwrite(Padding, sizeof(char), frame.names_size - names_size, stream->output);
+    if(records_number != 0) {
+        fwrite(records, sizeof(records[0]), records_number, stream->output);
+    }
+    //-----------------------------------------------------------------------//
+    // Frame is flushed, so the reader gets the statement at once.
+    if(fflush(stream->output) != 0 || ferror(stream->output)) {
+        print_error("Error while writing stream tree.\n");
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void mark_name(language_t *ctx,
+               size_t      index,
+               size_t     *names,
+               size_t     *names_number) {
+    // Holes of the table are not names and are never sent.
+    tree_stream_t *stream = &ctx->tree_stream;
+    if(index >= ctx->name_table.size || stream->sent[index] ||
+       ctx->name_table.identifiers[index].name == NULL) {
+        return;
+    }
+    stream->sent[index]      = true;
+    names[(*names_number)++] = index;
+}
+
+//===========================================================================//
@@ -0,0 +1,175 @@
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "tree_visitor.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static const size_t VisitorDefaultCapacity = 64;
+
+//===========================================================================//
+
+static bool             is_visited    (tree_visitor_t   *visitor,
+                                       uint32_t         *link);
+
+static language_error_t visitor_push  (tree_visitor_t   *visitor,
+                                       size_t           *size,
+                                       uint32_t         *link,
+                                       size_t            level);
+
+static void             frame_enter   (visit_frame_t    *frame,
+                                       uint32_t         *link,
+                                       size_t            level);
+
+//===========================================================================//
+
+language_error_t tree_visit(language_t       *ctx,
+                            tree_visitor_t   *visitor,
+                            uint32_t         *root) {
+    _C_ASSERT(ctx     != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(visitor != NULL, return LANGUAGE_NODE_NULL);
+    _C_ASSERT(root    != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    size_t size = 0;
+    if(!is_visited(visitor, root)) {
+        return LANGUAGE_SUCCESS;
+    }
+    _RETURN_IF_ERROR(visitor_push(visitor, &size, root, 0));
+    //-----------------------------------------------------------------------//
+    // Frame pointer is not used after push, as frames may be moved by it.
+    while(size != 0) {
+        visit_frame_t *frame = visitor->frames + size - 1;
+        if(frame->stage == VISIT_STAGE_PRE) {
+            frame->need_in   = visitor->in   != NULL;
+            frame->need_post = visitor->post != NULL;
+            if(visitor->pre != NULL) {
+                _RETURN_IF_ERROR(visitor->pre(ctx, frame, visitor->data));
+            }
+            language_node_t *node = nodes_storage_get(ctx, *frame->link);
+            if(!frame->is_custom && node != NULL) {
+                frame->children[0] = &node->left;
+                frame->children[1] = &node->right;
+            }
+            frame->stage = VISIT_STAGE_IN;
+            if(is_visited(visitor, frame->children[0])) {
+                _RETURN_IF_ERROR(visitor_push(visitor,
+                                              &size,
+                                              frame->children[0],
+                                              frame->level + 1));
+                continue;
+            }
+        }
+        //-------------------------------------------------------------------//
+        if(frame->stage == VISIT_STAGE_IN) {
+            if(frame->need_in && visitor->in != NULL) {
+                _RETURN_IF_ERROR(visitor->in(ctx, frame, visitor->data));
+            }
+            frame->stage = VISIT_STAGE_POST;
+            uint32_t *second = frame->children[1];
+            if(is_visited(visitor, second)) {
+                if(frame->need_post && !visitor->shared_post) {
+                    _RETURN_IF_ERROR(visitor_push(visitor,
+                                                  &size,
+                                                  second,
+                                                  frame->level + 1));
+                    continue;
+                }
+                if(frame->need_post) {
+                    frame->shared_posts++;
+                }
+                frame_enter(frame, second, frame->level + 1);
+                continue;
+            }
+        }
+        //-------------------------------------------------------------------//
+        if(visitor->post != NULL) {
+            if(frame->need_post) {
+                _RETURN_IF_ERROR(visitor->post(ctx, frame, visitor->data));
+            }
+            for(size_t post = 0; post < frame->shared_posts; post++) {
+                _RETURN_IF_ERROR(visitor->post(ctx, frame, visitor->data));
+            }
+        }
+        size--;
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void visit_children(visit_frame_t    *frame,
+                    uint32_t         *first,
+                    uint32_t         *second) {
+    frame->children[0] = first;
+    frame->children[1] = second;
+    frame->is_custom   = true;
+}
+
+//===========================================================================//
+
+language_error_t tree_visitor_dtor(tree_visitor_t *visitor) {
+    _C_ASSERT(visitor != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    free(visitor->frames);
+    visitor->frames   = NULL;
+    visitor->capacity = 0;
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+bool is_visited(tree_visitor_t *visitor, uint32_t *link) {
+    return link != NULL && (*link != NodeNone || visitor->visit_null);
+}
+
+//===========================================================================//
+
+language_error_t visitor_push(tree_visitor_t   *visitor,
+                              size_t           *size,
+                              uint32_t         *link,
+                              size_t            level) {
+    if(*size == visitor->capacity) {
+        size_t         new_capacity = visitor->capacity == 0 ?
+                                      VisitorDefaultCapacity :
+                                      visitor->capacity * 2;
+        visit_frame_t *new_frames   = (visit_frame_t *)realloc(visitor->frames,
+                                                               new_capacity * sizeof(new_frames[0]));
+        if(new_frames == NULL) {
+            print_error("Error while reallocating visitor stack.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        visitor->frames   = new_frames;
+        visitor->capacity = new_capacity;
+    }
+    //-----------------------------------------------------------------------//
+    visit_frame_t *frame = visitor->frames + (*size)++;
+    frame->shared_posts  = 0;
+    frame_enter(frame, link, level);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void frame_enter(visit_frame_t    *frame,
+                 uint32_t         *link,
+                 size_t            level) {
+    frame->link        = link;
+    frame->children[0] = NULL;
+    frame->children[1] = NULL;
+    frame->stage       = VISIT_STAGE_PRE;
+    frame->level       = level;
+    frame->is_custom   = false;
+    frame->need_in     = false;
+    frame->need_post   = false;
+    frame->state[0]    = {};
+    frame->state[1]    = {};
+}
+
+//===========================================================================//
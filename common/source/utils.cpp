@@ -1,6 +1,13 @@
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
 
 #include "utils.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+static const size_t ReserveMinCapacity = 16;
 
 size_t file_size(FILE *file) {
     long current_position = ftell(file);
@@ -21,3 +28,46 @@ bool is_equal(double first, double second) {
 size_t get_random_index(size_t size) {
     return (size_t)rand() % size;
 }
+
+size_t peak_memory_usage(void) {
+    rusage usage = {};
+    if(getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (size_t)usage.ru_maxrss;
+}
+
+language_error_t reserve_elements(void   **array,
+                                  size_t  *capacity,
+                                  size_t   needed,
+                                  size_t   element_size) {
+    _C_ASSERT(array    != NULL, return LANGUAGE_NULL_OUTPUT);
+    _C_ASSERT(capacity != NULL, return LANGUAGE_NULL_OUTPUT);
+    // Capacity is doubled, new elements are zero.
+    if(needed <= *capacity) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t new_capacity = *capacity == 0 ? ReserveMinCapacity : *capacity;
+    while(new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    void *new_array = realloc(*array, new_capacity * element_size);
+    if(new_array == NULL) {
+        print_error("Error while reallocating array.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    memset((char *)new_array + *capacity * element_size, 0,
+           (new_capacity - *capacity) * element_size);
+    *array    = new_array;
+    *capacity = new_capacity;
+    return LANGUAGE_SUCCESS;
+}
+
+uint64_t fnv1a_hash(const char *data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for(size_t elem = 0; elem < size; elem++) {
+        hash ^= (uint8_t)data[elem];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
@@ -0,0 +1,31 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Whole compilation in one process: tree built by parser is optimized and
+   compiled in place, without writing and reading tree files between the
+   stages. With '--save-temps' trees after front-end and middle-end are
+   written next to output as <output>.tree and <output>.opt.tree.        */
+
+//===========================================================================//
+
+language_error_t driver_ctor      (language_t *ctx,
+                                   int         argc,
+                                   const char *argv[]);
+
+language_error_t driver_frontend  (language_t *ctx);
+
+language_error_t driver_middleend (language_t *ctx);
+
+language_error_t driver_backend   (language_t *ctx);
+
+language_error_t driver_dtor      (language_t *ctx);
+
+//===========================================================================//
+
+#endif
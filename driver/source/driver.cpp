@@ -0,0 +1,119 @@
+#include <stdio.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "driver.h"
+#include "frontend.h"
+#include "syntax_parser.h"
+#include "function_cache.h"
+#include "middleend.h"
+#include "backend.h"
+#include "name_table.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static const char *const FrontendTempSuffix  = ".tree";
+static const char *const MiddleendTempSuffix = ".opt.tree";
+static const size_t      MaxTempNameSize     = 512;
+
+//===========================================================================//
+
+static language_error_t save_temp (language_t *ctx,
+                                   const char *suffix);
+
+//===========================================================================//
+
+language_error_t driver_ctor(language_t *ctx, int argc, const char *argv[]) {
+    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL          );
+    _C_ASSERT(argv != NULL, return LANGUAGE_NULL_PROGRAM_INPUT);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(frontend_ctor(ctx, argc, argv));
+    if(ctx->output_file == NULL) {
+        print_error("Output file is expected to be set with '-o'.\n");
+        return LANGUAGE_PARSING_FLAGS_ERROR;
+    }
+    if(ctx->machine_flag == 0) {
+        ctx->machine_flag = MACHINE_ELF_X86;
+    }
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t driver_frontend(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(parse_tokens(ctx));
+    language_error_t error_code = parse_syntax(ctx);
+    if(error_code == LANGUAGE_CACHE_OUTDATED) {
+        error_code = function_cache_reparse(ctx);
+    }
+    _RETURN_IF_ERROR(error_code);
+    //-----------------------------------------------------------------------//
+    // Scopes of parser are not needed any more and SPU code generator
+    // creates its own.
+    _RETURN_IF_ERROR(variables_stack_dtor(ctx));
+    return save_temp(ctx, FrontendTempSuffix);
+}
+
+//===========================================================================//
+
+language_error_t driver_middleend(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(optimize_tree(ctx));
+    return save_temp(ctx, MiddleendTempSuffix);
+}
+
+//===========================================================================//
+
+language_error_t driver_backend(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(backend_state_ctor(ctx));
+    _RETURN_IF_ERROR(add_stdlib_id(ctx));
+    _RETURN_IF_ERROR(compile_program(ctx));
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t driver_dtor(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    backend_state_dtor(ctx);
+    return frontend_dtor(ctx);
+}
+
+//===========================================================================//
+
+language_error_t save_temp(language_t *ctx, const char *suffix) {
+    if(!ctx->save_temps) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    char filename[MaxTempNameSize] = {};
+    int  length = snprintf(filename,
+                           MaxTempNameSize,
+                           "%s%s",
+                           ctx->output_file,
+                           suffix);
+    if(length < 0 || (size_t)length >= MaxTempNameSize) {
+        print_error("Temporary tree name for '%s' is too long.\n",
+                    ctx->output_file);
+        return LANGUAGE_PARSING_FLAGS_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    const char *output_file = ctx->output_file;
+    ctx->output_file = filename;
+    language_error_t error_code = write_tree(ctx);
+    ctx->output_file = output_file;
+    return error_code;
+}
+
+//===========================================================================//
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "driver.h"
+#include "build_cache.h"
+#include "colors.h"
+
+//===========================================================================//
+
+static int main_exit_failure(language_t *language);
+
+//===========================================================================//
+
+int main(int argc, const char *argv[]) {
+    color_printf(MAGENTA_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 " _____________________________________ \n"
+                 "|                                     |\n"
+                 "|  Compiling source code in one pass  |\n"
+                 "|_____________________________________|\n");
+    if(verify_keywords() != LANGUAGE_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+    //-----------------------------------------------------------------------//
+    language_t language = {};
+    language_error_t error_code = driver_ctor(&language, argc, argv);
+    if(error_code == LANGUAGE_BUILD_CACHE_HIT) {
+        driver_dtor(&language);
+        return EXIT_SUCCESS;
+    }
+    if(error_code != LANGUAGE_SUCCESS) {
+        return main_exit_failure(&language);
+    }
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Successfully initialized context\n");
+    //-----------------------------------------------------------------------//
+    if(driver_frontend(&language) != LANGUAGE_SUCCESS) {
+        return main_exit_failure(&language);
+    }
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Successfully parsed source code\n");
+    //-----------------------------------------------------------------------//
+    if(driver_middleend(&language) != LANGUAGE_SUCCESS) {
+        return main_exit_failure(&language);
+    }
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Successfully optimized tree\n");
+    //-----------------------------------------------------------------------//
+    if(driver_backend(&language) != LANGUAGE_SUCCESS) {
+        return main_exit_failure(&language);
+    }
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Successfully wrote compiled code\n");
+    build_cache_store(&language);
+    //-----------------------------------------------------------------------//
+    driver_dtor(&language);
+    return EXIT_SUCCESS;
+}
+
+//===========================================================================//
+
+int main_exit_failure(language_t *language) {
+    driver_dtor(language);
+    return EXIT_FAILURE;
+}
+
+//===========================================================================//
@@ -7,13 +7,18 @@
 
 //===========================================================================//
 
-language_error_t frontend_ctor  (language_t *ctx,
-                                 int         argc,
-                                 const char *argv[]);
+language_error_t frontend_ctor      (language_t *ctx,
+                                     int         argc,
+                                     const char *argv[]);
 
-language_error_t parse_tokens   (language_t *ctx);
+language_error_t parse_tokens       (language_t *ctx);
 
-language_error_t frontend_dtor  (language_t *ctx);
+language_error_t lex_tokens         (language_t *ctx);
+
+language_error_t frontend_dtor      (language_t *ctx);
+
+language_error_t print_memory_usage (language_t *ctx,
+                                     const char *phase);
 
 //===========================================================================//
 
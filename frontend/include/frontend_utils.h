@@ -13,10 +13,16 @@ char             current_symbol     (language_t        *ctx);
 
 const char      *input_position     (language_t        *ctx);
 
+const char      *input_end          (language_t        *ctx);
+
 language_error_t move_next_token    (language_t        *ctx);
 
 language_node_t *token_position     (language_t        *ctx);
 
+uint32_t         token_index        (language_t        *ctx);
+
+uint32_t         previous_token     (language_t        *ctx);
+
 bool             is_on_operation    (language_t        *ctx,
                                      operation_t        opcode);
 
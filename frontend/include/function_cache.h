@@ -0,0 +1,87 @@
+#ifndef FUNCTION_CACHE_H
+#define FUNCTION_CACHE_H
+
+//===========================================================================//
+
+#include "language.h"
+#include "parser_threads.h"
+
+//===========================================================================//
+
+/* Incremental frontend. Input is split at lines starting with 'func' or
+   'var' outside comments, every span that is exactly one function is
+   keyed by its text: hash finds the entry and the text kept in it has to
+   match. Cache file keeps parsed subtree of each such function with
+   identifiers stored as references to its locals or by name to functions
+   and globals. Unchanged functions are not lexed or parsed, their
+   subtrees are loaded to the reserved nodes after the signature pass. If
+   names used by a cached function now mean something else (callee
+   arguments number changed, global became function, ...) the function is
+   lexed and parsed again with the whole input. Result is the same tree as
+   without cache. Changed functions are appended to the file, it is
+   rewritten when most of its entries are not used anymore.               */
+
+//===========================================================================//
+
+struct cache_entry_t;
+
+//---------------------------------------------------------------------------//
+
+struct cache_slot_t {
+    const cache_entry_t             *entry;
+    bool                             is_stale;
+};
+
+//---------------------------------------------------------------------------//
+
+struct function_span_t {
+    size_t                           start;
+    size_t                           size;
+    size_t                           line;
+    size_t                           lines;
+    size_t                           token;
+    size_t                           tokens_end;
+    uint64_t                         hash;
+    bool                             is_function;
+    cache_slot_t                    *slot;
+};
+
+//---------------------------------------------------------------------------//
+
+struct function_cache_t {
+    mapped_file_t                    file;
+    cache_slot_t                    *slots;
+    size_t                           slots_capacity;
+    function_span_t                 *spans;
+    size_t                           spans_size;
+    size_t                           spans_capacity;
+    size_t                           cursor;
+    size_t                           reused;
+};
+
+//===========================================================================//
+
+language_error_t function_cache_ctor     (language_t         *ctx);
+
+language_error_t function_cache_lex      (language_t         *ctx);
+
+function_span_t *function_cache_find     (language_t         *ctx,
+                                          size_t              token);
+
+language_error_t function_cache_signature(language_t         *ctx,
+                                          global_statement_t *statement);
+
+language_error_t function_cache_load     (language_t         *ctx,
+                                          global_statement_t *statement);
+
+language_error_t function_cache_store    (language_t         *ctx,
+                                          global_statement_t *statements,
+                                          size_t              statements_number);
+
+language_error_t function_cache_reparse  (language_t         *ctx);
+
+language_error_t function_cache_dtor     (language_t         *ctx);
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef KEYWORD_TABLE_H
+#define KEYWORD_TABLE_H
+
+//===========================================================================//
+
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Keywords are recognized with tables built from KeyWords at compile time:
+   single character operators are found by direct indexing and words go
+   through a perfect hash over (first char, last char, length). Any change
+   of KeyWords that breaks the hash is caught by static_assert below.     */
+
+//===========================================================================//
+
+static const size_t KeywordsHashSize    = 32;
+static const size_t KeywordsSymbolsSize = 256;
+
+//---------------------------------------------------------------------------//
+
+struct keywords_lookup_t {
+    operation_t                      symbols[KeywordsSymbolsSize];
+    operation_t                      words  [KeywordsHashSize   ];
+    bool                             is_perfect;
+};
+
+//===========================================================================//
+
+constexpr size_t keyword_hash(const char *word, size_t length) {
+    return ((size_t)(unsigned char)word[0]                +
+            ((size_t)(unsigned char)word[length - 1] << 3) +
+            length) & (KeywordsHashSize - 1);
+}
+
+//---------------------------------------------------------------------------//
+
+constexpr keywords_lookup_t keywords_lookup_ctor(void) {
+    keywords_lookup_t lookup = {};
+    lookup.is_perfect = true;
+    //-----------------------------------------------------------------------//
+    for(size_t elem = 1; elem < (size_t)OPERATION_PROGRAM_END; elem++) {
+        const keyword_t &keyword = KeyWords[elem];
+        if(keyword.length == 1) {
+            size_t symbol = (size_t)(unsigned char)keyword.name[0];
+            if(lookup.symbols[symbol] != OPERATION_UNKNOWN) {
+                lookup.is_perfect = false;
+            }
+            lookup.symbols[symbol] = keyword.code;
+            continue;
+        }
+        //-------------------------------------------------------------------//
+        size_t hash = keyword_hash(keyword.name, keyword.length);
+        if(lookup.words[hash] != OPERATION_UNKNOWN) {
+            lookup.is_perfect = false;
+        }
+        lookup.words[hash] = keyword.code;
+    }
+    //-----------------------------------------------------------------------//
+    return lookup;
+}
+
+//---------------------------------------------------------------------------//
+
+static constexpr keywords_lookup_t KeywordsLookup = keywords_lookup_ctor();
+
+static_assert(KeywordsLookup.is_perfect,
+              "Keywords hash has collisions, change keyword_hash()");
+
+//===========================================================================//
+
+static inline bool is_keyword_symbol(char symbol) {
+    return KeywordsLookup.symbols[(unsigned char)symbol] != OPERATION_UNKNOWN;
+}
+
+//---------------------------------------------------------------------------//
+
+static inline operation_t keyword_lookup(const char *word, size_t length) {
+    if(length == 1) {
+        return KeywordsLookup.symbols[(unsigned char)word[0]];
+    }
+    //-----------------------------------------------------------------------//
+    operation_t code = KeywordsLookup.words[keyword_hash(word, length)];
+    if(code != OPERATION_UNKNOWN               &&
+       KeyWords[code].length == length         &&
+       memcmp(KeyWords[code].name, word, length) == 0) {
+        return code;
+    }
+    //-----------------------------------------------------------------------//
+    return OPERATION_UNKNOWN;
+}
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef LEXER_THREADS_H
+#define LEXER_THREADS_H
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Input is split at lines starting with 'func' or 'var' outside comments.
+   No token except a comment can cross a line, so chunks are lexed on
+   separate threads with their own nodes and used names and then merged
+   in order. Identifiers are re-interned and lines are shifted during the
+   merge, the result is the same token stream as sequential lexing gives.
+   Small inputs are lexed sequentially.                                   */
+
+//===========================================================================//
+
+struct comment_cursor_t {
+    const char                      *start;
+    const char                      *end;
+    const char                      *input_end;
+};
+
+//===========================================================================//
+
+language_error_t lex_tokens_parallel (language_t       *ctx);
+
+const char      *find_split_point    (const char       *position,
+                                      comment_cursor_t *comments);
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef PARSER_THREADS_H
+#define PARSER_THREADS_H
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Global statements found by the signature pass. Every function name is
+   registered before any body is parsed and gets a range of name table
+   indices and call nodes computed from its tokens, so bodies are parsed
+   on separate threads, each with its own variables stack and bindings,
+   and the result is the same as with sequential parsing. With stream
+   output statements of the first range are written as soon as they are
+   parsed, other ranges are written after their workers end.              */
+
+//===========================================================================//
+
+struct function_span_t;
+
+//---------------------------------------------------------------------------//
+
+struct global_statement_t {
+    size_t                           start;
+    size_t                           end;
+    size_t                           nt_index;
+    size_t                           locals;
+    size_t                           calls;
+    size_t                           calls_start;
+    bool                             is_function;
+    function_span_t                 *cached;
+};
+
+//===========================================================================//
+
+language_error_t parse_functions (language_t         *ctx,
+                                  global_statement_t *statements,
+                                  size_t              statements_number);
+
+//===========================================================================//
+
+#endif
@@ -7,7 +7,10 @@
 
 //===========================================================================//
 
-language_error_t parse_syntax(language_t *ctx);
+language_error_t parse_syntax   (language_t       *ctx);
+
+language_error_t parse_function (language_t       *ctx,
+                                 uint32_t         *output);
 
 //===========================================================================//
 
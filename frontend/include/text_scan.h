@@ -0,0 +1,30 @@
+#ifndef TEXT_SCAN_H
+#define TEXT_SCAN_H
+
+//===========================================================================//
+
+#include <stddef.h>
+
+//===========================================================================//
+
+/* Both scanners stop at 'end' and add the number of passed '\n' symbols to
+   'newlines'. scan_spaces returns the first non-space symbol position,
+   scan_comment_end returns the position right after the closing '*' '/'
+   pair or NULL if the comment is not closed before 'end'. The vectorized
+   version is chosen once by CPUID, scalar one is used as a fallback.     */
+
+//===========================================================================//
+
+const char *scan_spaces      (const char *position,
+                              const char *end,
+                              size_t     *newlines);
+
+const char *scan_comment_end (const char *position,
+                              const char *end,
+                              size_t     *newlines);
+
+const char *scan_level_name  (void);
+
+//===========================================================================//
+
+#endif
@@ -14,6 +14,13 @@
 #include "lang_dump.h"
 #include "name_table.h"
 #include "frontend_utils.h"
+#include "mapped_file.h"
+#include "keyword_table.h"
+#include "text_scan.h"
+#include "number_parser.h"
+#include "lexer_threads.h"
+#include "function_cache.h"
+#include "build_cache.h"
 
 //===========================================================================//
 
@@ -33,40 +40,18 @@ language_error_t frontend_ctor(language_t *ctx, int argc, const char *argv[]) {
     _C_ASSERT(argv != NULL, return LANGUAGE_NULL_PROGRAM_INPUT);
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(parse_flags(ctx, argc, argv));
+    _RETURN_IF_ERROR(build_cache_lookup(ctx));
     _RETURN_IF_ERROR(dump_ctor(ctx, "frontend"));
     //-----------------------------------------------------------------------//
-    FILE *source = fopen(ctx->input_file, "rb");
-    if(source == NULL) {
-        print_error("Error while opening source code file '%s'. "
-                    "May be the file does not exist.\n",
-                    ctx->input_file);
-        return LANGUAGE_OPENING_FILE_ERROR;
+    _RETURN_IF_ERROR(input_open(ctx));
+    if(ctx->cache_file != NULL) {
+        _RETURN_IF_ERROR(function_cache_ctor(ctx));
     }
-    ctx->input_size = file_size(source);
     //-----------------------------------------------------------------------//
-    ctx->input = (char *)calloc(ctx->input_size + 1, sizeof(char));
-    if(ctx->input == NULL) {
-        fclose(source);
-        print_error("Error while allocating memory for input.\n");
-        return LANGUAGE_MEMORY_ERROR;
-    }
-    //-----------------------------------------------------------------------//
-    if(fread(ctx->input,
-             sizeof(char),
-             ctx->input_size,
-             source) != ctx->input_size) {
-        fclose(source);
-        print_error("Error while reading source.\n");
-        return LANGUAGE_READING_SOURCE_ERROR;
-    }
-    fclose(source);
+    _RETURN_IF_ERROR(nodes_storage_ctor(ctx, NodesChunkSize, true));
+    _RETURN_IF_ERROR(name_table_ctor(ctx, NameTableDefaultCapacity));
+    _RETURN_IF_ERROR(used_names_ctor(ctx, UsedNamesDefaultCapacity));
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(nodes_storage_ctor(ctx, ctx->input_size * 2));
-    _RETURN_IF_ERROR(name_table_ctor(ctx, ctx->input_size));
-    _RETURN_IF_ERROR(used_names_ctor(ctx, ctx->input_size));
-    //-----------------------------------------------------------------------//
-    ctx->input_position             = ctx->input;
-    ctx->frontend_info.position     = ctx->nodes.nodes;
     ctx->frontend_info.current_line = 1;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -75,16 +60,41 @@ language_error_t frontend_ctor(language_t *ctx, int argc, const char *argv[]) {
 //===========================================================================//
 
 language_error_t parse_tokens(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    if(ctx->frontend_info.cache != NULL) {
+        _RETURN_IF_ERROR(function_cache_lex(ctx));
+    }
+    else if(ctx->threads_number > 1) {
+        _RETURN_IF_ERROR(lex_tokens_parallel(ctx));
+    }
+    else {
+        _RETURN_IF_ERROR(lex_tokens(ctx));
+    }
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(nodes_storage_add(ctx,
+                                       NODE_TYPE_OPERATION,
+                                       OPCODE(OPERATION_PROGRAM_END),
+                                       "",
+                                       0,
+                                       NULL));
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t lex_tokens(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(skip_spaces(ctx));
-    while(current_symbol(ctx) != '\0') {
+    while(input_position(ctx) < input_end(ctx) && current_symbol(ctx) != '\0') {
         _RETURN_IF_ERROR(skip_spaces(ctx));
         //-------------------------------------------------------------------//
         if(isdigit(current_symbol(ctx))) {
-            char *number_end = NULL;
-            double value = strtod(input_position(ctx), &number_end);
-            size_t length = (size_t)number_end - (size_t)input_position(ctx);
+            double      value      = 0;
+            const char *number_end = parse_double(input_position(ctx), &value);
+            size_t      length     = (size_t)number_end -
+                                     (size_t)input_position(ctx);
             _RETURN_IF_ERROR(nodes_storage_add(ctx,
                                                NODE_TYPE_NUMBER,
                                                NUMBER(value),
@@ -100,12 +110,6 @@ language_error_t parse_tokens(language_t *ctx) {
         _RETURN_IF_ERROR(skip_spaces(ctx));
     }
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(nodes_storage_add(ctx,
-                                       NODE_TYPE_OPERATION,
-                                       OPCODE(OPERATION_PROGRAM_END),
-                                       "",
-                                       0,
-                                       NULL));
     return LANGUAGE_SUCCESS;
 }
 
@@ -116,35 +120,27 @@ language_error_t read_word(language_t *ctx) {
     //-----------------------------------------------------------------------//
     size_t length = 0;
     _RETURN_IF_ERROR(get_word_length(ctx, &length));
-    bool found = false;
+    operation_t opcode = keyword_lookup(input_position(ctx), length);
     //-----------------------------------------------------------------------//
-    for(size_t elem = 1; elem < (size_t)OPERATION_PROGRAM_END; elem++) {
-        if(strncmp(KeyWords[elem].name,
-                   input_position(ctx),
-                   KeyWords[elem].length) == 0) {
-            //---------------------------------------------------------------//
+    if(opcode != OPERATION_UNKNOWN) {
+        _RETURN_IF_ERROR(nodes_storage_add(ctx,
+                                           NODE_TYPE_OPERATION,
+                                           OPCODE(opcode),
+                                           input_position(ctx),
+                                           length,
+                                           NULL));
+        //-------------------------------------------------------------------//
+        if(opcode == OPERATION_BODY_END) {
             _RETURN_IF_ERROR(nodes_storage_add(ctx,
                                                NODE_TYPE_OPERATION,
-                                               OPCODE(KeyWords[elem].code),
+                                               OPCODE(OPERATION_STATEMENT),
                                                input_position(ctx),
                                                length,
                                                NULL));
-            found = true;
-            //---------------------------------------------------------------//
-            if(KeyWords[elem].code == OPERATION_BODY_END) {
-                _RETURN_IF_ERROR(nodes_storage_add(ctx,
-                                                   NODE_TYPE_OPERATION,
-                                                   OPCODE(OPERATION_STATEMENT),
-                                                   input_position(ctx),
-                                                   length,
-                                                   NULL));
-            }
-            //---------------------------------------------------------------//
-            break;
         }
     }
     //-----------------------------------------------------------------------//
-    if(!found) {
+    else {
         size_t index = 0;
         _RETURN_IF_ERROR(used_names_add(ctx,
                                         input_position(ctx),
@@ -168,8 +164,11 @@ language_error_t frontend_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
     dump_dtor(ctx);
-    free(ctx->input);
+    function_cache_dtor(ctx);
+    input_close(ctx);
     _RETURN_IF_ERROR(nodes_storage_dtor(ctx));
+    _RETURN_IF_ERROR(variables_stack_dtor(ctx));
+    _RETURN_IF_ERROR(name_table_dtor(ctx));
     memset(ctx, 0, sizeof(*ctx));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -177,17 +176,46 @@ language_error_t frontend_dtor(language_t *ctx) {
 
 //===========================================================================//
 
+language_error_t print_memory_usage(language_t *ctx, const char *phase) {
+    _C_ASSERT(ctx   != NULL, return LANGUAGE_CTX_NULL);
+    _C_ASSERT(phase != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    const size_t kibibyte = 1024;
+    size_t nodes_memory = ctx->nodes.chunks_number *
+                          NodesChunkSize *
+                          (sizeof(language_node_t) + sizeof(source_info_t));
+    size_t names_memory = ctx->name_table.capacity            *
+                          sizeof(ctx->name_table.identifiers[0]) +
+                          ctx->name_table.used_names_capacity *
+                          sizeof(ctx->name_table.used_names[0])  +
+                          ctx->name_table.stack_capacity      *
+                          sizeof(ctx->name_table.stack[0])       +
+                          ctx->name_table.bindings_capacity   *
+                          sizeof(ctx->name_table.bindings[0])    +
+                          ctx->name_table.used_names_buckets_capacity *
+                          sizeof(ctx->name_table.used_names_buckets[0]);
+    //-----------------------------------------------------------------------//
+    color_printf(CYAN_TEXT, NORMAL_TEXT, DEFAULT_BACKGROUND,
+                 "%-8s peak memory " SZ_SP " KiB, "
+                 "nodes " SZ_SP " KiB (" SZ_SP " nodes), "
+                 "names " SZ_SP " KiB\n",
+                 phase,
+                 peak_memory_usage(),
+                 nodes_memory / kibibyte,
+                 ctx->nodes.size,
+                 names_memory / kibibyte);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
 language_error_t get_word_length(language_t *ctx, size_t *length) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(length != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
-    size_t keywords_num = sizeof(KeyWords) / sizeof(KeyWords[0]);
-    for(size_t elem = 0; elem < keywords_num; elem++) {
-        if(KeyWords[elem].length == 1 &&
-           current_symbol(ctx) == KeyWords[elem].name[0]) {
-            *length = 1;
-            return LANGUAGE_SUCCESS;
-        }
+    if(is_keyword_symbol(current_symbol(ctx))) {
+        *length = 1;
+        return LANGUAGE_SUCCESS;
     }
     //-----------------------------------------------------------------------//
     if(!isalpha(current_symbol(ctx))) {
@@ -210,16 +238,11 @@ language_error_t skip_spaces(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
     while(true) {
-        //-------------------------------------------------------------------//
-        if(isspace(current_symbol(ctx))) {
-            //---------------------------------------------------------------//
-            if(current_symbol(ctx) == '\n') {
-                ctx->frontend_info.current_line++;
-            }
-            //---------------------------------------------------------------//
-            move_next_symbol(ctx);
-            continue;
-        }
+        size_t newlines = 0;
+        ctx->input_position = scan_spaces(input_position(ctx),
+                                          input_end(ctx),
+                                          &newlines);
+        ctx->frontend_info.current_line += newlines;
         //-------------------------------------------------------------------//
         if(input_position(ctx)[0] == '/' &&
            input_position(ctx)[1] == '*') {
@@ -238,16 +261,17 @@ language_error_t skip_spaces(language_t *ctx) {
 language_error_t skip_comment(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    while(input_position(ctx)[-2] != '*' || input_position(ctx)[-1] != '/') {
-        move_next_symbol(ctx);
-        //-------------------------------------------------------------------//
-        if(current_symbol(ctx) == '\0') {
-            print_error("Unclosed comment.\n");
-            return LANGUAGE_UNCLOSED_COMMENT;
-        }
-        //-------------------------------------------------------------------//
+    size_t newlines = 0;
+    const char *comment_end = scan_comment_end(input_position(ctx) + 2,
+                                               input_end(ctx),
+                                               &newlines);
+    if(comment_end == NULL) {
+        print_error("Unclosed comment.\n");
+        return LANGUAGE_UNCLOSED_COMMENT;
     }
     //-----------------------------------------------------------------------//
+    ctx->frontend_info.current_line += newlines;
+    ctx->input_position              = comment_end;
     return LANGUAGE_SUCCESS;
 }
 
@@ -12,7 +12,18 @@
 
 language_error_t move_next_token(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
-    ctx->frontend_info.position++;
+    //-----------------------------------------------------------------------//
+    size_t index = ++ctx->frontend_info.position_index;
+    if(index >= ctx->nodes.size) {
+        ctx->frontend_info.position = NULL;
+    }
+    else if((index & (NodesChunkSize - 1)) == 0) {
+        ctx->frontend_info.position = nodes_storage_get(ctx, index);
+    }
+    else {
+        ctx->frontend_info.position++;
+    }
+    //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
@@ -25,6 +36,21 @@ language_node_t *token_position(language_t *ctx) {
 
 //===========================================================================//
 
+uint32_t token_index(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return NodeNone);
+    return (uint32_t)ctx->frontend_info.position_index;
+}
+
+//===========================================================================//
+
+uint32_t previous_token(language_t *ctx) {
+    _C_ASSERT(ctx                               != NULL, return NodeNone);
+    _C_ASSERT(ctx->frontend_info.position_index != 0   , return NodeNone);
+    return (uint32_t)ctx->frontend_info.position_index - 1;
+}
+
+//===========================================================================//
+
 language_error_t move_next_symbol(language_t *ctx) {
     _C_ASSERT(ctx                 != NULL, return LANGUAGE_CTX_NULL           );
     _C_ASSERT(ctx->input          != NULL, return LANGUAGE_INPUT_NULL         );
@@ -54,12 +80,20 @@ const char *input_position(language_t *ctx) {
 
 //===========================================================================//
 
+const char *input_end(language_t *ctx) {
+    _C_ASSERT(ctx        != NULL, return NULL);
+    _C_ASSERT(ctx->input != NULL, return NULL);
+    return ctx->input + ctx->input_size;
+}
+
+//===========================================================================//
+
 bool is_on_ident_type(language_t *ctx, identifier_type_t type) {
     _C_ASSERT(ctx != NULL, return false);
     //-----------------------------------------------------------------------//
     language_node_t *node = token_position(ctx);
-    if(node->type == NODE_TYPE_IDENTIFIER &&
-       ctx->name_table.identifiers[node->value.identifier].type == type) {
+    if(node_type(node) == NODE_TYPE_IDENTIFIER &&
+       ctx->name_table.identifiers[node_identifier(node)].type == type) {
         return true;
     }
     //-----------------------------------------------------------------------//
@@ -71,7 +105,7 @@ bool is_on_ident_type(language_t *ctx, identifier_type_t type) {
 bool is_on_type(language_t *ctx, node_type_t type) {
     _C_ASSERT(ctx != NULL, return false);
     //-----------------------------------------------------------------------//
-    if(token_position(ctx)->type == type) {
+    if(node_type(token_position(ctx)) == type) {
         return true;
     }
     //-----------------------------------------------------------------------//
@@ -83,8 +117,8 @@ bool is_on_type(language_t *ctx, node_type_t type) {
 bool is_on_operation(language_t *ctx, operation_t opcode) {
     _C_ASSERT(ctx != NULL, return false);
     //-----------------------------------------------------------------------//
-    if(ctx->frontend_info.position->type == NODE_TYPE_OPERATION &&
-       ctx->frontend_info.position->value.opcode == opcode) {
+    if(node_type  (ctx->frontend_info.position) == NODE_TYPE_OPERATION &&
+       node_opcode(ctx->frontend_info.position) == opcode) {
         return true;
     }
     //-----------------------------------------------------------------------//
@@ -100,7 +134,7 @@ language_error_t syntax_error(language_t *ctx, const char *format, ...) {
     color_printf(MAGENTA_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                   "%s:%llu",
                   ctx->input_file,
-                  token_position(ctx)->source_info.line);
+                  nodes_storage_source(ctx, ctx->frontend_info.position_index)->line);
     //-----------------------------------------------------------------------//
     color_printf(DEFAULT_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND, " ~ ");
     //-----------------------------------------------------------------------//
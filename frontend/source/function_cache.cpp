@@ -0,0 +1,1071 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "function_cache.h"
+#include "frontend.h"
+#include "syntax_parser.h"
+#include "lexer_threads.h"
+#include "name_table.h"
+#include "frontend_utils.h"
+#include "mapped_file.h"
+#include "utils.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+enum cache_reference_kind_t {
+    CACHE_REFERENCE_OWN              = 1,
+    CACHE_REFERENCE_FUNCTION         = 2,
+    CACHE_REFERENCE_GLOBAL           = 3,
+};
+
+//---------------------------------------------------------------------------//
+
+struct cache_header_t {
+    char                             magic[8];
+    uint64_t                         version;
+    uint64_t                         entries_number;
+    uint64_t                         size;
+};
+
+//---------------------------------------------------------------------------//
+
+struct cache_entry_t {
+    uint64_t                         hash;
+    uint64_t                         span_size;
+    uint64_t                         lines;
+    uint64_t                         nodes_number;
+    uint64_t                         locals;
+    uint64_t                         parameters;
+    uint64_t                         references_number;
+    uint64_t                         records_number;
+    uint64_t                         statement_offset;
+    uint64_t                         statement_line;
+};
+
+//---------------------------------------------------------------------------//
+
+struct cache_reference_t {
+    uint64_t                         kind;
+    uint64_t                         name_offset;
+    uint64_t                         name_length;
+    uint64_t                         parameters;
+};
+
+//---------------------------------------------------------------------------//
+
+struct cache_record_t {
+    uint64_t                         value;
+    uint32_t                         name_offset;
+    uint32_t                         name_length;
+    uint32_t                         line;
+    uint16_t                         type;
+    uint16_t                         children;
+};
+
+//---------------------------------------------------------------------------//
+
+struct cache_writer_t {
+    cache_reference_t               *references;
+    size_t                           references_size;
+    size_t                           references_capacity;
+    cache_record_t                  *records;
+    size_t                           records_size;
+    size_t                           records_capacity;
+    const char                      *source;
+    size_t                           source_size;
+    size_t                           line;
+    size_t                           nt_index;
+    size_t                           locals;
+    uint32_t                         self;
+};
+
+//---------------------------------------------------------------------------//
+
+struct cache_loader_t {
+    const cache_record_t            *records;
+    size_t                           records_number;
+    size_t                           position;
+    size_t                          *resolved;
+    size_t                           references_number;
+    size_t                           next_node;
+    size_t                           last_node;
+    const char                      *source;
+    size_t                           source_size;
+    size_t                           line;
+};
+
+//===========================================================================//
+
+static const char     CacheMagic[8]     = {'K', 'V', 'M', 'F', 'U', 'N', 'C', '\0'};
+static const uint64_t CacheVersion      = 2;
+static const uint16_t CacheLeftChild    = 1;
+static const uint16_t CacheRightChild   = 2;
+static const uint32_t CacheNoName       = UINT32_MAX;
+static const size_t   CacheMinSlots     = 16;
+
+//===========================================================================//
+
+static language_error_t cache_read_entries   (function_cache_t        *cache);
+
+static size_t           entry_size           (const cache_entry_t     *entry);
+
+static const cache_reference_t *
+                        entry_references     (const cache_entry_t     *entry);
+
+static const cache_record_t *
+                        entry_records        (const cache_entry_t     *entry);
+
+static const char      *entry_span           (const cache_entry_t     *entry);
+
+static size_t           span_padded          (size_t                   size);
+
+static cache_slot_t    *find_slot            (function_cache_t        *cache,
+                                              uint64_t                 hash,
+                                              const char              *span,
+                                              size_t                   size);
+
+static bool             is_function_start    (const char              *position,
+                                              const char              *end);
+
+static language_error_t add_span             (function_cache_t        *cache,
+                                              function_span_t        **output);
+
+static language_error_t lex_span             (language_t              *ctx,
+                                              function_span_t         *span);
+
+static language_error_t resolve_references   (language_t              *ctx,
+                                              global_statement_t      *statement,
+                                              size_t                  *resolved);
+
+static language_error_t load_node            (language_t              *ctx,
+                                              cache_loader_t          *loader,
+                                              uint32_t                 node);
+
+static language_error_t append_entries       (language_t              *ctx,
+                                              global_statement_t      *statements,
+                                              size_t                   statements_number);
+
+static language_error_t rewrite_entries      (language_t              *ctx,
+                                              global_statement_t      *statements,
+                                              size_t                   statements_number);
+
+static language_error_t write_entries        (language_t              *ctx,
+                                              global_statement_t      *statements,
+                                              size_t                   statements_number,
+                                              bool                     with_cached,
+                                              cache_header_t          *header,
+                                              FILE                    *output);
+
+static language_error_t store_function       (language_t              *ctx,
+                                              global_statement_t      *statement,
+                                              function_span_t         *span,
+                                              FILE                    *output,
+                                              size_t                  *size);
+
+static language_error_t write_node           (language_t              *ctx,
+                                              cache_writer_t          *writer,
+                                              uint32_t                 node);
+
+static language_error_t add_reference        (language_t              *ctx,
+                                              cache_writer_t          *writer,
+                                              uint32_t                 node,
+                                              uint64_t                *output);
+
+static uint32_t         name_offset          (const char              *source,
+                                              size_t                   source_size,
+                                              const char              *name);
+
+static language_error_t function_cache_print (function_cache_t        *cache,
+                                              size_t                   functions);
+
+static function_span_t *find_stored_span     (function_cache_t        *cache,
+                                              global_statement_t      *statement,
+                                              size_t                  *cursor);
+
+//===========================================================================//
+
+language_error_t function_cache_ctor(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    function_cache_t *cache = (function_cache_t *)calloc(1, sizeof(*cache));
+    if(cache == NULL) {
+        print_error("Error while allocating function cache.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    ctx->frontend_info.cache = cache;
+    //-----------------------------------------------------------------------//
+    // Missing cache file is the first build, broken one is just ignored.
+    if(access(ctx->cache_file, F_OK) != 0) {
+        return cache_read_entries(cache);
+    }
+    _RETURN_IF_ERROR(mapped_file_open(&cache->file, ctx->cache_file));
+    if(cache_read_entries(cache) != LANGUAGE_SUCCESS) {
+        color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Function cache '%s' is broken and will be rewritten.\n",
+                     ctx->cache_file);
+        mapped_file_close(&cache->file);
+        free(cache->slots);
+        cache->slots = NULL;
+        return cache_read_entries(cache);
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t cache_read_entries(function_cache_t *cache) {
+    const cache_header_t *header         = (const cache_header_t *)cache->file.data;
+    size_t                entries_number = 0;
+    if(cache->file.size != 0) {
+        if(cache->file.size < sizeof(*header) ||
+           memcmp(header->magic, CacheMagic, sizeof(CacheMagic)) != 0 ||
+           header->version != CacheVersion                             ||
+           header->size    >  cache->file.size                         ||
+           header->entries_number > header->size / sizeof(cache_entry_t)) {
+            return LANGUAGE_CACHE_ERROR;
+        }
+        entries_number = header->entries_number;
+    }
+    //-----------------------------------------------------------------------//
+    size_t slots_capacity = CacheMinSlots;
+    while(slots_capacity < entries_number * 2) {
+        slots_capacity *= 2;
+    }
+    cache->slots = (cache_slot_t *)calloc(slots_capacity, sizeof(cache->slots[0]));
+    if(cache->slots == NULL) {
+        print_error("Error while allocating function cache slots.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    cache->slots_capacity = slots_capacity;
+    //-----------------------------------------------------------------------//
+    // Every entry is checked to fit the file before it is used.
+    size_t position = sizeof(*header);
+    for(size_t elem = 0; elem < entries_number; elem++) {
+        size_t left = header->size - position;
+        if(position > header->size || left < sizeof(cache_entry_t)) {
+            return LANGUAGE_CACHE_ERROR;
+        }
+        const cache_entry_t *entry = (const cache_entry_t *)(cache->file.data + position);
+        if(entry->references_number > left / sizeof(cache_reference_t) ||
+           entry->records_number    > left / sizeof(cache_record_t)    ||
+           entry->span_size         > left                             ||
+           entry_size(entry)        > left                             ||
+           entry->references_number < entry->locals + 1                ||
+           entry->records_number    > entry->nodes_number + 1          ||
+           entry->records_number    == 0) {
+            return LANGUAGE_CACHE_ERROR;
+        }
+        position += entry_size(entry);
+        //-------------------------------------------------------------------//
+        // Changed functions are appended, so later entries win.
+        find_slot(cache, entry->hash, entry_span(entry), entry->span_size)->entry = entry;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+size_t entry_size(const cache_entry_t *entry) {
+    return sizeof(*entry) +
+           entry->references_number * sizeof(cache_reference_t) +
+           entry->records_number    * sizeof(cache_record_t)    +
+           span_padded(entry->span_size);
+}
+
+//===========================================================================//
+
+const cache_reference_t *entry_references(const cache_entry_t *entry) {
+    return (const cache_reference_t *)(entry + 1);
+}
+
+//===========================================================================//
+
+const cache_record_t *entry_records(const cache_entry_t *entry) {
+    return (const cache_record_t *)(entry_references(entry) +
+                                    entry->references_number);
+}
+
+//===========================================================================//
+
+const char *entry_span(const cache_entry_t *entry) {
+    return (const char *)(entry_records(entry) + entry->records_number);
+}
+
+//===========================================================================//
+
+size_t span_padded(size_t size) {
+    // Text of the function is padded, so the next entry stays aligned.
+    return (size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+//===========================================================================//
+
+cache_slot_t *find_slot(function_cache_t *cache,
+                        uint64_t          hash,
+                        const char       *span,
+                        size_t            size) {
+    // Hash only finds the slot, text of the function has to match, so
+    // colliding spans never take each other's subtrees.
+    size_t mask = cache->slots_capacity - 1;
+    size_t slot = hash & mask;
+    while(cache->slots[slot].entry != NULL) {
+        const cache_entry_t *entry = cache->slots[slot].entry;
+        if(entry->hash == hash && entry->span_size == size &&
+           memcmp(entry_span(entry), span, size) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return cache->slots + slot;
+}
+
+//===========================================================================//
+
+bool is_function_start(const char *position, const char *end) {
+    const keyword_t *keyword = KeyWords + OPERATION_NEW_FUNC;
+    return (size_t)(end - position) > keyword->length                 &&
+           strncmp(position, keyword->name, keyword->length) == 0     &&
+           !isalnum(position[keyword->length])                        &&
+           position[keyword->length] != '_';
+}
+
+//===========================================================================//
+
+language_error_t function_cache_lex(language_t *ctx) {
+    _C_ASSERT(ctx                      != NULL, return LANGUAGE_CTX_NULL);
+    _C_ASSERT(ctx->frontend_info.cache != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    function_cache_t *cache = ctx->frontend_info.cache;
+    cache->spans_size = 0;
+    cache->cursor     = 0;
+    cache->reused     = 0;
+    const char      *end      = ctx->input + ctx->input_size;
+    comment_cursor_t comments = {ctx->input, ctx->input, end};
+    //-----------------------------------------------------------------------//
+    const char *start = ctx->input;
+    while(start < end) {
+        function_span_t *span = NULL;
+        _RETURN_IF_ERROR(add_span(cache, &span));
+        const char *next  = find_split_point(start, &comments);
+        span->start       = (size_t)(start - ctx->input);
+        span->size        = (size_t)(next  - start);
+        span->line        = ctx->frontend_info.current_line;
+        span->token       = ctx->nodes.size;
+        span->is_function = is_function_start(start, next);
+        //-------------------------------------------------------------------//
+        if(span->is_function) {
+            span->hash = fnv1a_hash(start, span->size);
+            cache_slot_t *slot = find_slot(cache, span->hash, start, span->size);
+            if(slot->entry != NULL && !slot->is_stale) {
+                span->slot = slot;
+            }
+        }
+        _RETURN_IF_ERROR(lex_span(ctx, span));
+        span->tokens_end = ctx->nodes.size;
+        span->lines      = ctx->frontend_info.current_line - span->line;
+        start            = next;
+    }
+    //-----------------------------------------------------------------------//
+    ctx->input_position = end;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t add_span(function_cache_t *cache, function_span_t **output) {
+    _RETURN_IF_ERROR(reserve_elements((void **)&cache->spans,
+                                      &cache->spans_capacity,
+                                      cache->spans_size + 1,
+                                      sizeof(cache->spans[0])));
+    *output = cache->spans + cache->spans_size++;
+    memset(*output, 0, sizeof(**output));
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t lex_span(language_t *ctx, function_span_t *span) {
+    const char *source = ctx->input + span->start;
+    //-----------------------------------------------------------------------//
+    // Cached function is represented by its first and last tokens only.
+    if(span->slot != NULL) {
+        const cache_entry_t *entry = span->slot->entry;
+        _RETURN_IF_ERROR(nodes_storage_add(ctx,
+                                           NODE_TYPE_OPERATION,
+                                           OPCODE(OPERATION_NEW_FUNC),
+                                           source,
+                                           KeyWords[OPERATION_NEW_FUNC].length,
+                                           NULL));
+        ctx->frontend_info.current_line = span->line + entry->statement_line;
+        const char *statement = entry->statement_offset < span->size ?
+                                source + entry->statement_offset : source;
+        _RETURN_IF_ERROR(nodes_storage_add(ctx,
+                                           NODE_TYPE_OPERATION,
+                                           OPCODE(OPERATION_STATEMENT),
+                                           statement,
+                                           1,
+                                           NULL));
+        ctx->frontend_info.current_line = span->line + entry->lines;
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // Lexer sees only this span, no token crosses the split line.
+    size_t input_size   = ctx->input_size;
+    ctx->input_position = source;
+    ctx->input_size     = span->start + span->size;
+    language_error_t error_code = lex_tokens(ctx);
+    ctx->input_size     = input_size;
+    return error_code;
+}
+
+//===========================================================================//
+
+function_span_t *function_cache_find(language_t *ctx, size_t token) {
+    _C_ASSERT(ctx != NULL, return NULL);
+    //-----------------------------------------------------------------------//
+    function_cache_t *cache = ctx->frontend_info.cache;
+    if(cache == NULL) {
+        return NULL;
+    }
+    // Statements are asked in order, empty spans share the token index.
+    while(cache->cursor < cache->spans_size &&
+          cache->spans[cache->cursor].token <= token) {
+        function_span_t *span = cache->spans + cache->cursor++;
+        if(span->token == token && span->slot != NULL) {
+            return span;
+        }
+    }
+    return NULL;
+}
+
+//===========================================================================//
+
+language_error_t function_cache_signature(language_t         *ctx,
+                                          global_statement_t *statement) {
+    _C_ASSERT(ctx               != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(statement         != NULL, return LANGUAGE_NULL_OUTPUT);
+    _C_ASSERT(statement->cached != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    const cache_entry_t     *entry = statement->cached->slot->entry;
+    const cache_reference_t *self  = entry_references(entry);
+    if(self->name_offset + self->name_length > entry->span_size) {
+        statement->cached->slot->is_stale = true;
+        return LANGUAGE_CACHE_OUTDATED;
+    }
+    statement->is_function = true;
+    statement->locals      = entry->locals;
+    //-----------------------------------------------------------------------//
+    size_t index = 0;
+    ctx->name_table.size = statement->nt_index;
+    _RETURN_IF_ERROR(name_table_add(ctx,
+                                    ctx->input + statement->cached->start + self->name_offset,
+                                    self->name_length,
+                                    &index,
+                                    IDENTIFIER_FUNCTION));
+    _RETURN_IF_ERROR(name_table_bind_function(ctx, index));
+    ctx->name_table.identifiers[index].parameters_number = entry->parameters;
+    //-----------------------------------------------------------------------//
+    move_next_token(ctx);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t function_cache_load(language_t         *ctx,
+                                     global_statement_t *statement) {
+    _C_ASSERT(ctx               != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(statement         != NULL, return LANGUAGE_NULL_OUTPUT);
+    _C_ASSERT(statement->cached != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    function_span_t     *span  = statement->cached;
+    const cache_entry_t *entry = span->slot->entry;
+    size_t *resolved = (size_t *)calloc(entry->references_number, sizeof(resolved[0]));
+    if(resolved == NULL) {
+        print_error("Error while allocating cached references.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    language_error_t error_code = resolve_references(ctx, statement, resolved);
+    if(error_code != LANGUAGE_SUCCESS) {
+        free(resolved);
+        return error_code;
+    }
+    //-----------------------------------------------------------------------//
+    // Subtree goes to the same number of nodes sequential parsing uses.
+    size_t first = 0;
+    error_code = nodes_storage_reserve(ctx, entry->nodes_number, &first);
+    cache_loader_t loader = {
+        .records           = entry_records(entry),
+        .records_number    = entry->records_number,
+        .position          = 0,
+        .resolved          = resolved,
+        .references_number = entry->references_number,
+        .next_node         = first,
+        .last_node         = first + entry->nodes_number,
+        .source            = ctx->input + span->start,
+        .source_size       = span->size,
+        .line              = span->line,
+    };
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = load_node(ctx, &loader, (uint32_t)statement->start);
+    }
+    if(error_code == LANGUAGE_SUCCESS && loader.position != loader.records_number) {
+        error_code = LANGUAGE_CACHE_ERROR;
+    }
+    free(resolved);
+    //-----------------------------------------------------------------------//
+    if(error_code == LANGUAGE_CACHE_ERROR) {
+        span->slot->is_stale = true;
+        return LANGUAGE_CACHE_OUTDATED;
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        ctx->frontend_info.cache->reused++;
+    }
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t resolve_references(language_t         *ctx,
+                                    global_statement_t *statement,
+                                    size_t             *resolved) {
+    function_span_t         *span       = statement->cached;
+    const cache_entry_t     *entry      = span->slot->entry;
+    const cache_reference_t *references = entry_references(entry);
+    const char              *source     = ctx->input + span->start;
+    name_table_t            *table      = &ctx->name_table;
+    //-----------------------------------------------------------------------//
+    for(size_t elem = 0; elem < entry->references_number; elem++) {
+        const cache_reference_t *reference = references + elem;
+        if(reference->name_offset + reference->name_length > span->size) {
+            span->slot->is_stale = true;
+            return LANGUAGE_CACHE_OUTDATED;
+        }
+        const char *name   = source + reference->name_offset;
+        size_t      symbol = PoisonIndex;
+        size_t      index  = PoisonIndex;
+        _RETURN_IF_ERROR(used_names_find(ctx, name, reference->name_length, &symbol));
+        if(symbol != PoisonIndex) {
+            _RETURN_IF_ERROR(name_table_find(ctx, symbol, &index));
+        }
+        //-------------------------------------------------------------------//
+        // Locals are valid while no function took their names.
+        if(elem == 0) {
+            resolved[elem] = statement->nt_index;
+            continue;
+        }
+        if(elem <= entry->locals) {
+            resolved[elem] = statement->nt_index + elem;
+            identifier_t *local = table->identifiers + resolved[elem];
+            memset(local, 0, sizeof(*local));
+            local->name   = name;
+            local->length = reference->name_length;
+            local->symbol = symbol;
+            local->type   = IDENTIFIER_VARIABLE;
+            if(index == PoisonIndex ||
+               table->identifiers[index].type != IDENTIFIER_FUNCTION) {
+                continue;
+            }
+        }
+        //-------------------------------------------------------------------//
+        // Other names must resolve to what they resolved when cached.
+        else if(index != PoisonIndex) {
+            identifier_t *ident = table->identifiers + index;
+            resolved[elem] = index;
+            if(reference->kind == CACHE_REFERENCE_FUNCTION &&
+               ident->type == IDENTIFIER_FUNCTION &&
+               ident->parameters_number == reference->parameters) {
+                continue;
+            }
+            if(reference->kind == CACHE_REFERENCE_GLOBAL &&
+               ident->type == IDENTIFIER_VARIABLE) {
+                continue;
+            }
+        }
+        span->slot->is_stale = true;
+        return LANGUAGE_CACHE_OUTDATED;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t load_node(language_t     *ctx,
+                           cache_loader_t *loader,
+                           uint32_t        node) {
+    if(loader->position >= loader->records_number) {
+        return LANGUAGE_CACHE_ERROR;
+    }
+    const cache_record_t *record = loader->records + loader->position++;
+    language_node_t      *target = nodes_storage_get   (ctx, node);
+    source_info_t        *source = nodes_storage_source(ctx, node);
+    //-----------------------------------------------------------------------//
+    value_t value = {};
+    switch(record->type) {
+        case NODE_TYPE_NUMBER: {
+            memcpy(&value.number, &record->value, sizeof(double));
+            break;
+        }
+        case NODE_TYPE_OPERATION: {
+            if(record->value >= OPERATION_PROGRAM_END) {
+                return LANGUAGE_CACHE_ERROR;
+            }
+            value.opcode = (operation_t)record->value;
+            break;
+        }
+        case NODE_TYPE_IDENTIFIER: {
+            if(record->value >= loader->references_number) {
+                return LANGUAGE_CACHE_ERROR;
+            }
+            value.identifier = loader->resolved[record->value];
+            break;
+        }
+        default: {
+            return LANGUAGE_CACHE_ERROR;
+        }
+    }
+    node_set_value(target, (node_type_t)record->type, value);
+    //-----------------------------------------------------------------------//
+    if(record->name_offset == CacheNoName) {
+        source->name   = "";
+        source->length = 0;
+    }
+    else if((size_t)record->name_offset + record->name_length <= loader->source_size) {
+        source->name   = loader->source + record->name_offset;
+        source->length = record->name_length;
+    }
+    else {
+        return LANGUAGE_CACHE_ERROR;
+    }
+    source->line = loader->line + record->line;
+    //-----------------------------------------------------------------------//
+    uint32_t *children[] = {&target->left, &target->right};
+    uint16_t  flags   [] = {CacheLeftChild, CacheRightChild};
+    for(size_t elem = 0; elem < sizeof(flags) / sizeof(flags[0]); elem++) {
+        *children[elem] = NodeNone;
+        if((record->children & flags[elem]) == 0) {
+            continue;
+        }
+        if(loader->next_node >= loader->last_node) {
+            return LANGUAGE_CACHE_ERROR;
+        }
+        *children[elem] = (uint32_t)loader->next_node++;
+        _RETURN_IF_ERROR(load_node(ctx, loader, *children[elem]));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t function_cache_store(language_t         *ctx,
+                                      global_statement_t *statements,
+                                      size_t              statements_number) {
+    _C_ASSERT(ctx                      != NULL, return LANGUAGE_CTX_NULL);
+    _C_ASSERT(ctx->frontend_info.cache != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    function_cache_t *cache     = ctx->frontend_info.cache;
+    size_t            functions = 0;
+    for(size_t elem = 0; elem < statements_number; elem++) {
+        functions += statements[elem].is_function ? 1 : 0;
+    }
+    _RETURN_IF_ERROR(function_cache_print(cache, functions));
+    //-----------------------------------------------------------------------//
+    // New functions are appended while the file has more used entries
+    // than unused ones, otherwise it is written again from scratch.
+    const cache_header_t *header = (const cache_header_t *)cache->file.data;
+    if(header == NULL || header->entries_number > cache->reused * 2) {
+        return rewrite_entries(ctx, statements, statements_number);
+    }
+    if(cache->reused == functions) {
+        return LANGUAGE_SUCCESS;
+    }
+    return append_entries(ctx, statements, statements_number);
+}
+
+//===========================================================================//
+
+language_error_t append_entries(language_t         *ctx,
+                                global_statement_t *statements,
+                                size_t              statements_number) {
+    function_cache_t *cache  = ctx->frontend_info.cache;
+    cache_header_t    header = *(const cache_header_t *)cache->file.data;
+    FILE             *output = fopen(ctx->cache_file, "r+b");
+    if(output == NULL) {
+        print_error("Error while opening cache file '%s'.\n", ctx->cache_file);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    // Header is written after entries, so readers never see a part of them.
+    fseek(output, (long)header.size, SEEK_SET);
+    language_error_t error_code = write_entries(ctx,
+                                                statements,
+                                                statements_number,
+                                                false,
+                                                &header,
+                                                output);
+    fflush(output);
+    if(error_code == LANGUAGE_SUCCESS) {
+        fseek(output, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, output);
+    }
+    if(fclose(output) != 0 && error_code == LANGUAGE_SUCCESS) {
+        print_error("Error while writing cache file '%s'.\n", ctx->cache_file);
+        error_code = LANGUAGE_CACHE_ERROR;
+    }
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t rewrite_entries(language_t         *ctx,
+                                 global_statement_t *statements,
+                                 size_t              statements_number) {
+    size_t name_size = strlen(ctx->cache_file) + sizeof(".tmp");
+    char  *temporary = (char *)calloc(name_size, sizeof(char));
+    if(temporary == NULL) {
+        print_error("Error while allocating cache file name.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    snprintf(temporary, name_size, "%s.tmp", ctx->cache_file);
+    FILE *output = fopen(temporary, "wb");
+    if(output == NULL) {
+        print_error("Error while opening cache file '%s'.\n", temporary);
+        free(temporary);
+        return LANGUAGE_OPENING_FILE_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    cache_header_t header = {};
+    memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = CacheVersion;
+    header.size    = sizeof(header);
+    fwrite(&header, sizeof(header), 1, output);
+    language_error_t error_code = write_entries(ctx,
+                                                statements,
+                                                statements_number,
+                                                true,
+                                                &header,
+                                                output);
+    fseek(output, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, output);
+    //-----------------------------------------------------------------------//
+    // Old cache is replaced at once, readers see old or new file only.
+    if(fclose(output) != 0 && error_code == LANGUAGE_SUCCESS) {
+        print_error("Error while writing cache file '%s'.\n", temporary);
+        error_code = LANGUAGE_CACHE_ERROR;
+    }
+    if(error_code == LANGUAGE_SUCCESS && rename(temporary, ctx->cache_file) != 0) {
+        print_error("Error while replacing cache file '%s'.\n", ctx->cache_file);
+        error_code = LANGUAGE_CACHE_ERROR;
+    }
+    if(error_code != LANGUAGE_SUCCESS) {
+        remove(temporary);
+    }
+    free(temporary);
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t write_entries(language_t         *ctx,
+                               global_statement_t *statements,
+                               size_t              statements_number,
+                               bool                with_cached,
+                               cache_header_t     *header,
+                               FILE               *output) {
+    function_cache_t *cache  = ctx->frontend_info.cache;
+    size_t            cursor = 0;
+    for(size_t elem = 0; elem < statements_number; elem++) {
+        global_statement_t *statement = statements + elem;
+        if(!statement->is_function) {
+            continue;
+        }
+        size_t size = 0;
+        if(statement->cached == NULL) {
+            function_span_t *span = find_stored_span(cache, statement, &cursor);
+            if(span == NULL) {
+                continue;
+            }
+            _RETURN_IF_ERROR(store_function(ctx, statement, span, output, &size));
+        }
+        else if(with_cached) {
+            const cache_entry_t *entry = statement->cached->slot->entry;
+            size = entry_size(entry);
+            fwrite(entry, size, 1, output);
+        }
+        else {
+            continue;
+        }
+        header->entries_number++;
+        header->size += size;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t function_cache_print(function_cache_t *cache, size_t functions) {
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Function cache: " SZ_SP " of " SZ_SP " functions reused\n",
+                 cache->reused,
+                 functions);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+function_span_t *find_stored_span(function_cache_t   *cache,
+                                  global_statement_t *statement,
+                                  size_t             *cursor) {
+    // Only a span holding exactly one function is stored.
+    while(*cursor < cache->spans_size &&
+          cache->spans[*cursor].token < statement->start) {
+        (*cursor)++;
+    }
+    for(size_t elem = *cursor; elem < cache->spans_size; elem++) {
+        function_span_t *span = cache->spans + elem;
+        if(span->token != statement->start) {
+            break;
+        }
+        if(span->is_function && span->tokens_end == statement->end + 1) {
+            return span;
+        }
+    }
+    return NULL;
+}
+
+//===========================================================================//
+
+language_error_t store_function(language_t         *ctx,
+                                global_statement_t *statement,
+                                function_span_t    *span,
+                                FILE               *output,
+                                size_t             *size) {
+    if(span->size >= CacheNoName) {
+        return LANGUAGE_SUCCESS;
+    }
+    uint32_t       root   = (uint32_t)statement->start;
+    cache_writer_t writer = {
+        .source      = ctx->input + span->start,
+        .source_size = span->size,
+        .line        = span->line,
+        .nt_index    = statement->nt_index,
+        .locals      = statement->locals,
+        .self        = nodes_storage_get(ctx, root)->left,
+    };
+    //-----------------------------------------------------------------------//
+    // References to self and locals are first, their names are set when met.
+    language_error_t error_code = reserve_elements((void **)&writer.references,
+                                                   &writer.references_capacity,
+                                                   statement->locals + 1,
+                                                   sizeof(writer.references[0]));
+    if(error_code == LANGUAGE_SUCCESS) {
+        writer.references_size = statement->locals + 1;
+        memset(writer.references, 0, writer.references_size * sizeof(writer.references[0]));
+        error_code = write_node(ctx, &writer, root);
+    }
+    //-----------------------------------------------------------------------//
+    if(error_code == LANGUAGE_SUCCESS) {
+        source_info_t   *end   = nodes_storage_source(ctx, statement->end);
+        cache_entry_t    entry = {
+            .hash              = span->hash,
+            .span_size         = span->size,
+            .lines             = span->lines,
+            .nodes_number      = statement->end - statement->start - 1 + statement->calls,
+            .locals            = statement->locals,
+            .parameters        = ctx->name_table.identifiers[statement->nt_index].parameters_number,
+            .references_number = writer.references_size,
+            .records_number    = writer.records_size,
+            .statement_offset  = name_offset(writer.source, writer.source_size, end->name),
+            .statement_line    = end->line - span->line,
+        };
+        fwrite(&entry, sizeof(entry), 1, output);
+        fwrite(writer.references, sizeof(writer.references[0]), writer.references_size, output);
+        fwrite(writer.records, sizeof(writer.records[0]), writer.records_size, output);
+        uint64_t padding = 0;
+        fwrite(writer.source, 1, span->size, output);
+        fwrite(&padding, 1, span_padded(span->size) - span->size, output);
+        *size = entry_size(&entry);
+    }
+    free(writer.references);
+    free(writer.records);
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t write_node(language_t     *ctx,
+                            cache_writer_t *writer,
+                            uint32_t        index) {
+    _RETURN_IF_ERROR(reserve_elements((void **)&writer->records,
+                                      &writer->records_capacity,
+                                      writer->records_size + 1,
+                                      sizeof(writer->records[0])));
+    language_node_t *node   = nodes_storage_get   (ctx, index);
+    source_info_t   *source = nodes_storage_source(ctx, index);
+    cache_record_t  *record = writer->records + writer->records_size++;
+    memset(record, 0, sizeof(*record));
+    record->type        = (uint16_t)node_type(node);
+    record->name_offset = name_offset(writer->source,
+                                      writer->source_size,
+                                      source->name);
+    if(record->name_offset != CacheNoName) {
+        record->name_length = (uint32_t)source->length;
+        record->line        = (uint32_t)(source->line - writer->line);
+    }
+    //-----------------------------------------------------------------------//
+    switch(node_type(node)) {
+        case NODE_TYPE_NUMBER: {
+            double number = node_number(node);
+            memcpy(&record->value, &number, sizeof(double));
+            break;
+        }
+        case NODE_TYPE_OPERATION: {
+            record->value = (uint64_t)node_opcode(node);
+            break;
+        }
+        case NODE_TYPE_IDENTIFIER: {
+            // Records array may move while references are added.
+            uint64_t reference = 0;
+            _RETURN_IF_ERROR(add_reference(ctx, writer, index, &reference));
+            writer->records[writer->records_size - 1].value = reference;
+            break;
+        }
+        default: {
+            return LANGUAGE_UNKNOWN_NODE_TYPE;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    size_t   current = writer->records_size - 1;
+    uint32_t left    = node->left;
+    uint32_t right   = node->right;
+    writer->records[current].children = (uint16_t)((left  != NodeNone ? CacheLeftChild  : 0) |
+                                                   (right != NodeNone ? CacheRightChild : 0));
+    if(left != NodeNone) {
+        _RETURN_IF_ERROR(write_node(ctx, writer, left));
+    }
+    if(right != NodeNone) {
+        _RETURN_IF_ERROR(write_node(ctx, writer, right));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t add_reference(language_t     *ctx,
+                               cache_writer_t *writer,
+                               uint32_t        node,
+                               uint64_t       *output) {
+    source_info_t *source   = nodes_storage_source(ctx, node);
+    size_t         nt_index = node_identifier(nodes_storage_get(ctx, node));
+    identifier_t  *ident    = ctx->name_table.identifiers + nt_index;
+    uint64_t       offset   = name_offset(writer->source,
+                                          writer->source_size,
+                                          source->name);
+    if(offset == CacheNoName) {
+        return LANGUAGE_BROKEN_NAME_TABLE_ELEM;
+    }
+    //-----------------------------------------------------------------------//
+    // Function name in its own definition and locals are stored by index.
+    size_t own = PoisonIndex;
+    if(node == writer->self) {
+        own = 0;
+    }
+    else if(nt_index > writer->nt_index && nt_index <= writer->nt_index + writer->locals) {
+        own = nt_index - writer->nt_index;
+    }
+    if(own != PoisonIndex) {
+        cache_reference_t *reference = writer->references + own;
+        if(reference->kind == 0) {
+            reference->kind        = CACHE_REFERENCE_OWN;
+            reference->name_offset = offset;
+            reference->name_length = source->length;
+        }
+        *output = own;
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    uint64_t kind = ident->type == IDENTIFIER_FUNCTION ? CACHE_REFERENCE_FUNCTION :
+                                                         CACHE_REFERENCE_GLOBAL;
+    for(size_t elem = writer->locals + 1; elem < writer->references_size; elem++) {
+        cache_reference_t *reference = writer->references + elem;
+        if(reference->kind        == kind                     &&
+           reference->name_length == source->length &&
+           memcmp(writer->source + reference->name_offset,
+                  source->name,
+                  source->length) == 0) {
+            *output = elem;
+            return LANGUAGE_SUCCESS;
+        }
+    }
+    _RETURN_IF_ERROR(reserve_elements((void **)&writer->references,
+                                      &writer->references_capacity,
+                                      writer->references_size + 1,
+                                      sizeof(writer->references[0])));
+    cache_reference_t *reference = writer->references + writer->references_size;
+    reference->kind        = kind;
+    reference->name_offset = offset;
+    reference->name_length = source->length;
+    reference->parameters  = ident->parameters_number;
+    *output = writer->references_size++;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+uint32_t name_offset(const char *source, size_t source_size, const char *name) {
+    if(name < source || name >= source + source_size) {
+        return CacheNoName;
+    }
+    return (uint32_t)(name - source);
+}
+
+//===========================================================================//
+
+language_error_t function_cache_reparse(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    // Stale functions are marked now, their spans are lexed this time.
+    _RETURN_IF_ERROR(variables_stack_dtor(ctx));
+    _RETURN_IF_ERROR(nodes_storage_dtor(ctx));
+    _RETURN_IF_ERROR(name_table_dtor(ctx));
+    _RETURN_IF_ERROR(nodes_storage_ctor(ctx, NodesChunkSize, true));
+    _RETURN_IF_ERROR(name_table_ctor(ctx, NameTableDefaultCapacity));
+    _RETURN_IF_ERROR(used_names_ctor(ctx, UsedNamesDefaultCapacity));
+    ctx->frontend_info.current_line = 1;
+    ctx->input_position             = ctx->input;
+    ctx->root                       = NodeNone;
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(parse_tokens(ctx));
+    language_error_t error_code = parse_syntax(ctx);
+    if(error_code == LANGUAGE_CACHE_OUTDATED) {
+        print_error("Function cache is inconsistent with the source.\n");
+        return LANGUAGE_CACHE_ERROR;
+    }
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t function_cache_dtor(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    function_cache_t *cache = ctx->frontend_info.cache;
+    if(cache == NULL) {
+        return LANGUAGE_SUCCESS;
+    }
+    mapped_file_close(&cache->file);
+    free(cache->slots);
+    free(cache->spans);
+    free(cache);
+    ctx->frontend_info.cache = NULL;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "lexer_threads.h"
+#include "frontend.h"
+#include "name_table.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+struct lexer_chunk_t {
+    language_t                       ctx;
+    pthread_t                        thread;
+    bool                             is_started;
+    language_error_t                 error;
+};
+
+
+//===========================================================================//
+
+static const size_t LexerMinChunkSize = 1 << 18;
+static const size_t LexerMaxThreads   = 64;
+
+//===========================================================================//
+
+static size_t           find_split_points (language_t       *ctx,
+                                           size_t           *splits,
+                                           size_t            chunks_number);
+
+static void             next_comment      (comment_cursor_t *comments,
+                                           const char       *position);
+
+static bool             is_top_level_start(const char       *position);
+
+static language_error_t chunk_ctor        (lexer_chunk_t    *chunk,
+                                           language_t       *ctx,
+                                           size_t            start,
+                                           size_t            end);
+
+static void            *chunk_lex         (void             *chunk);
+
+static language_error_t chunks_merge      (language_t       *ctx,
+                                           lexer_chunk_t    *chunks,
+                                           size_t            chunks_number);
+
+static language_error_t chunk_merge       (language_t       *ctx,
+                                           lexer_chunk_t    *chunk,
+                                           size_t            first_line);
+
+static void             chunks_dtor       (lexer_chunk_t    *chunks,
+                                           size_t            chunks_number);
+
+//===========================================================================//
+
+language_error_t lex_tokens_parallel(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    size_t chunks_number = ctx->threads_number;
+    if(chunks_number > LexerMaxThreads) {
+        chunks_number = LexerMaxThreads;
+    }
+    if(chunks_number > ctx->input_size / LexerMinChunkSize) {
+        chunks_number = ctx->input_size / LexerMinChunkSize;
+    }
+    //-----------------------------------------------------------------------//
+    size_t splits[LexerMaxThreads + 1] = {};
+    chunks_number = find_split_points(ctx, splits, chunks_number);
+    if(chunks_number < 2) {
+        return lex_tokens(ctx);
+    }
+    //-----------------------------------------------------------------------//
+    lexer_chunk_t *chunks = (lexer_chunk_t *)calloc(chunks_number,
+                                                    sizeof(chunks[0]));
+    if(chunks == NULL) {
+        print_error("Error while allocating lexer chunks.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    language_error_t error_code = LANGUAGE_SUCCESS;
+    for(size_t chunk = 0; chunk < chunks_number; chunk++) {
+        error_code = chunk_ctor(chunks + chunk,
+                                ctx,
+                                splits[chunk],
+                                splits[chunk + 1]);
+        if(error_code != LANGUAGE_SUCCESS) {
+            break;
+        }
+        // First chunk is lexed by this thread after others are started.
+        if(chunk != 0 &&
+           pthread_create(&chunks[chunk].thread,
+                          NULL,
+                          chunk_lex,
+                          chunks + chunk) == 0) {
+            chunks[chunk].is_started = true;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    for(size_t chunk = 0; chunk < chunks_number; chunk++) {
+        if(chunks[chunk].is_started) {
+            pthread_join(chunks[chunk].thread, NULL);
+        }
+        else if(error_code == LANGUAGE_SUCCESS) {
+            chunk_lex(chunks + chunk);
+        }
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = chunks[chunk].error;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = chunks_merge(ctx, chunks, chunks_number);
+    }
+    chunks_dtor(chunks, chunks_number);
+    return error_code;
+}
+
+//===========================================================================//
+
+size_t find_split_points(language_t *ctx,
+                         size_t     *splits,
+                         size_t      chunks_number) {
+    const char      *end      = ctx->input + ctx->input_size;
+    comment_cursor_t comments = {ctx->input, ctx->input, end};
+    //-----------------------------------------------------------------------//
+    size_t splits_number = 0;
+    splits[splits_number++] = 0;
+    for(size_t chunk = 1; chunk < chunks_number; chunk++) {
+        size_t target = ctx->input_size / chunks_number * chunk;
+        if(target <= splits[splits_number - 1]) {
+            target = splits[splits_number - 1] + 1;
+        }
+        const char *split = find_split_point(ctx->input + target, &comments);
+        if(split == end) {
+            break;
+        }
+        splits[splits_number++] = (size_t)(split - ctx->input);
+    }
+    splits[splits_number] = ctx->input_size;
+    //-----------------------------------------------------------------------//
+    return splits_number;
+}
+
+//===========================================================================//
+
+const char *find_split_point(const char *position, comment_cursor_t *comments) {
+    const char *end = comments->input_end;
+    while(position < end) {
+        const char *line = (const char *)memchr(position,
+                                                '\n',
+                                                (size_t)(end - position));
+        if(line == NULL) {
+            return end;
+        }
+        position = line + 1;
+        //-------------------------------------------------------------------//
+        next_comment(comments, position);
+        if(comments->start < position) {
+            position = comments->end;
+            continue;
+        }
+        //-------------------------------------------------------------------//
+        if(is_top_level_start(position)) {
+            return position;
+        }
+    }
+    return end;
+}
+
+//===========================================================================//
+
+void next_comment(comment_cursor_t *comments, const char *position) {
+    // Comments are searched in order, the input is zero-terminated.
+    while(comments->end <= position && comments->end != comments->input_end) {
+        const char *start = strstr(comments->end, "/*");
+        if(start == NULL) {
+            comments->start = comments->input_end;
+            comments->end   = comments->input_end;
+            return;
+        }
+        const char *end = strstr(start + 2, "*/");
+        comments->start = start;
+        comments->end   = end == NULL ? comments->input_end : end + 2;
+    }
+}
+
+//===========================================================================//
+
+bool is_top_level_start(const char *position) {
+    const keyword_t *starts[] = {KeyWords + OPERATION_NEW_FUNC,
+                                 KeyWords + OPERATION_NEW_VAR };
+    for(size_t elem = 0; elem < sizeof(starts) / sizeof(starts[0]); elem++) {
+        const keyword_t *keyword = starts[elem];
+        if(strncmp(position, keyword->name, keyword->length) == 0 &&
+           !isalpha(position[keyword->length]) &&
+           position[keyword->length] != '_') {
+            return true;
+        }
+    }
+    return false;
+}
+
+//===========================================================================//
+
+language_error_t chunk_ctor(lexer_chunk_t *chunk,
+                            language_t    *ctx,
+                            size_t         start,
+                            size_t         end) {
+    language_t *chunk_ctx = &chunk->ctx;
+    _RETURN_IF_ERROR(nodes_storage_ctor(chunk_ctx, NodesChunkSize, true));
+    _RETURN_IF_ERROR(used_names_ctor(chunk_ctx, UsedNamesDefaultCapacity));
+    //-----------------------------------------------------------------------//
+    // Chunk context sees only its part of the input.
+    chunk_ctx->input                      = ctx->input + start;
+    chunk_ctx->input_size                 = end - start;
+    chunk_ctx->input_position             = chunk_ctx->input;
+    chunk_ctx->frontend_info.current_line = 1;
+    chunk->error                          = LANGUAGE_SUCCESS;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void *chunk_lex(void *chunk) {
+    lexer_chunk_t *lexer_chunk = (lexer_chunk_t *)chunk;
+    lexer_chunk->error = lex_tokens(&lexer_chunk->ctx);
+    return NULL;
+}
+
+//===========================================================================//
+
+language_error_t chunks_merge(language_t    *ctx,
+                              lexer_chunk_t *chunks,
+                              size_t         chunks_number) {
+    size_t first_line = ctx->frontend_info.current_line;
+    for(size_t chunk = 0; chunk < chunks_number; chunk++) {
+        _RETURN_IF_ERROR(chunk_merge(ctx, chunks + chunk, first_line));
+        first_line += chunks[chunk].ctx.frontend_info.current_line - 1;
+    }
+    //-----------------------------------------------------------------------//
+    ctx->frontend_info.current_line = first_line;
+    ctx->input_position             = ctx->input + ctx->input_size;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t chunk_merge(language_t    *ctx,
+                             lexer_chunk_t *chunk,
+                             size_t         first_line) {
+    language_t *chunk_ctx = &chunk->ctx;
+    size_t     *symbols   = (size_t *)calloc(chunk_ctx->name_table.used_names_size + 1,
+                                             sizeof(symbols[0]));
+    if(symbols == NULL) {
+        print_error("Error while allocating symbols remapping table.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    // Chunk names are in order of first use, so global order is kept.
+    language_error_t error_code = LANGUAGE_SUCCESS;
+    for(size_t elem = 0; elem < chunk_ctx->name_table.used_names_size; elem++) {
+        name_t *name = chunk_ctx->name_table.used_names + elem;
+        error_code = used_names_add(ctx, name->name, name->length, symbols + elem);
+        if(error_code != LANGUAGE_SUCCESS) {
+            free(symbols);
+            return error_code;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    for(size_t elem = 0; elem < chunk_ctx->nodes.size; elem++) {
+        language_node_t *token  = nodes_storage_get   (chunk_ctx, elem);
+        source_info_t   *source = nodes_storage_source(chunk_ctx, elem);
+        value_t          value  = node_value(token);
+        if(node_type(token) == NODE_TYPE_IDENTIFIER) {
+            value.identifier = symbols[value.identifier];
+        }
+        ctx->frontend_info.current_line = first_line + source->line - 1;
+        error_code = nodes_storage_add(ctx,
+                                       node_type(token),
+                                       value,
+                                       source->name,
+                                       source->length,
+                                       NULL);
+        if(error_code != LANGUAGE_SUCCESS) {
+            break;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    free(symbols);
+    return error_code;
+}
+
+//===========================================================================//
+
+void chunks_dtor(lexer_chunk_t *chunks, size_t chunks_number) {
+    for(size_t chunk = 0; chunk < chunks_number; chunk++) {
+        nodes_storage_dtor(&chunks[chunk].ctx);
+        used_names_dtor   (&chunks[chunk].ctx);
+    }
+    free(chunks);
+}
+
+//===========================================================================//
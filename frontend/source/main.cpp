@@ -7,6 +7,8 @@
 #include "frontend.h"
 #include "lang_dump.h"
 #include "syntax_parser.h"
+#include "function_cache.h"
+#include "build_cache.h"
 #include "colors.h"
 
 //===========================================================================//
@@ -16,33 +18,46 @@ static int main_exit_failure(language_t *language);
 //===========================================================================//
 
 int main(int argc, const char *argv[]) {
-    color_printf(MAGENTA_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                 " _____________________________________ \n"
-                 "|                                     |\n"
-                 "|     Parsing source code to tree     |\n"
-                 "|_____________________________________|\n");
     if(verify_keywords() != LANGUAGE_SUCCESS) {
         return EXIT_FAILURE;
     }
     //-----------------------------------------------------------------------//
     language_t language = {};
-    if(frontend_ctor(&language, argc, argv) != LANGUAGE_SUCCESS) {
+    language_error_t error_code = frontend_ctor(&language, argc, argv);
+    if(error_code == LANGUAGE_BUILD_CACHE_HIT) {
+        frontend_dtor(&language);
+        return EXIT_SUCCESS;
+    }
+    if(error_code != LANGUAGE_SUCCESS) {
         return main_exit_failure(&language);
     }
+    // Banner follows flags, so it goes to stderr when tree goes to stdout.
+    color_printf(MAGENTA_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 " _____________________________________ \n"
+                 "|                                     |\n"
+                 "|     Parsing source code to tree     |\n"
+                 "|_____________________________________|\n");
     color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully initialized context\n");
+    print_memory_usage(&language, "init");
     //-----------------------------------------------------------------------//
     if(parse_tokens(&language) != LANGUAGE_SUCCESS) {
         return main_exit_failure(&language);
     }
     color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully parsed tokens\n");
+    print_memory_usage(&language, "lexer");
     //-----------------------------------------------------------------------//
-    if(parse_syntax(&language) != LANGUAGE_SUCCESS) {
+    error_code = parse_syntax(&language);
+    if(error_code == LANGUAGE_CACHE_OUTDATED) {
+        error_code = function_cache_reparse(&language);
+    }
+    if(error_code != LANGUAGE_SUCCESS) {
         return main_exit_failure(&language);
     }
     color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully parsed syntax\n");
+    print_memory_usage(&language, "parser");
     //-----------------------------------------------------------------------//
     dump_tree(&language, "frontend result");
     //-----------------------------------------------------------------------//
@@ -51,6 +66,8 @@ int main(int argc, const char *argv[]) {
     }
     color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully wrote tree to file\n");
+    build_cache_store(&language);
+    print_memory_usage(&language, "writer");
     //-----------------------------------------------------------------------//
     frontend_dtor(&language);
     return EXIT_SUCCESS;
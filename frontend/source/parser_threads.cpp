@@ -0,0 +1,307 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "parser_threads.h"
+#include "syntax_parser.h"
+#include "name_table.h"
+#include "frontend_utils.h"
+#include "tree_binary.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+struct parser_worker_t {
+    language_t                       ctx;
+    pthread_t                        thread;
+    bool                             is_started;
+    global_statement_t              *statements;
+    size_t                           first;
+    size_t                           last;
+    language_t                      *stream;
+    language_error_t                 error;
+};
+
+//===========================================================================//
+
+static const size_t ParserMinChunkTokens = 1 << 15;
+static const size_t ParserMaxThreads     = 64;
+
+//===========================================================================//
+
+static language_error_t reserve_calls     (language_t         *ctx,
+                                           global_statement_t *statements,
+                                           size_t              statements_number,
+                                           size_t             *tokens);
+
+static size_t           split_statements  (global_statement_t *statements,
+                                           size_t              statements_number,
+                                           size_t              tokens,
+                                           size_t              workers_number,
+                                           size_t             *splits);
+
+static language_error_t worker_ctor       (parser_worker_t    *worker,
+                                           language_t         *ctx,
+                                           global_statement_t *statements,
+                                           size_t              first,
+                                           size_t              last);
+
+static void            *worker_parse      (void               *worker);
+
+static language_error_t worker_parse_range(parser_worker_t    *worker);
+
+static language_error_t worker_parse_statement
+                                          (parser_worker_t    *worker,
+                                           global_statement_t *statement);
+
+static language_error_t emit_statements   (language_t         *ctx,
+                                           global_statement_t *statements,
+                                           size_t              first,
+                                           size_t              last);
+
+static void             workers_dtor      (parser_worker_t    *workers,
+                                           size_t              workers_number);
+
+//===========================================================================//
+
+language_error_t parse_functions(language_t         *ctx,
+                                 global_statement_t *statements,
+                                 size_t              statements_number) {
+    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
+    //-----------------------------------------------------------------------//
+    size_t tokens = 0;
+    _RETURN_IF_ERROR(reserve_calls(ctx, statements, statements_number, &tokens));
+    if(tokens == 0) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    size_t workers_number = ctx->threads_number;
+    if(workers_number > ParserMaxThreads) {
+        workers_number = ParserMaxThreads;
+    }
+    if(workers_number > tokens / ParserMinChunkTokens) {
+        workers_number = tokens / ParserMinChunkTokens;
+    }
+    if(workers_number == 0) {
+        workers_number = 1;
+    }
+    size_t splits[ParserMaxThreads + 1] = {};
+    workers_number = split_statements(statements,
+                                      statements_number,
+                                      tokens,
+                                      workers_number,
+                                      splits);
+    //-----------------------------------------------------------------------//
+    parser_worker_t *workers = (parser_worker_t *)calloc(workers_number,
+                                                         sizeof(workers[0]));
+    if(workers == NULL) {
+        print_error("Error while allocating parser workers.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    //-----------------------------------------------------------------------//
+    language_error_t error_code = LANGUAGE_SUCCESS;
+    for(size_t worker = 0; worker < workers_number; worker++) {
+        error_code = worker_ctor(workers + worker,
+                                 ctx,
+                                 statements,
+                                 splits[worker],
+                                 splits[worker + 1]);
+        if(error_code != LANGUAGE_SUCCESS) {
+            break;
+        }
+        // First range is parsed by this thread after others are started,
+        // with stream output its statements are written as they are parsed.
+        if(worker == 0 && ctx->tree_format == TREE_FORMAT_STREAM) {
+            workers[worker].stream = ctx;
+        }
+        if(worker != 0 &&
+           pthread_create(&workers[worker].thread,
+                          NULL,
+                          worker_parse,
+                          workers + worker) == 0) {
+            workers[worker].is_started = true;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    for(size_t worker = 0; worker < workers_number; worker++) {
+        if(workers[worker].is_started) {
+            pthread_join(workers[worker].thread, NULL);
+        }
+        else if(error_code == LANGUAGE_SUCCESS) {
+            worker_parse(workers + worker);
+        }
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = workers[worker].error;
+        }
+        if(error_code == LANGUAGE_SUCCESS && worker != 0 &&
+           ctx->tree_format == TREE_FORMAT_STREAM) {
+            error_code = emit_statements(ctx,
+                                         statements,
+                                         workers[worker].first,
+                                         workers[worker].last);
+        }
+    }
+    //-----------------------------------------------------------------------//
+    workers_dtor(workers, workers_number);
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t reserve_calls(language_t         *ctx,
+                               global_statement_t *statements,
+                               size_t              statements_number,
+                               size_t             *tokens) {
+    // Call nodes are the only nodes parser adds, every function gets its
+    // own range of them, so workers never grow the shared storage. Cached
+    // functions are already loaded.
+    for(size_t elem = 0; elem < statements_number; elem++) {
+        global_statement_t *statement = statements + elem;
+        if(!statement->is_function || statement->cached != NULL) {
+            continue;
+        }
+        _RETURN_IF_ERROR(nodes_storage_reserve(ctx,
+                                               statement->calls,
+                                               &statement->calls_start));
+        *tokens += statement->end - statement->start;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+size_t split_statements(global_statement_t *statements,
+                        size_t              statements_number,
+                        size_t              tokens,
+                        size_t              workers_number,
+                        size_t             *splits) {
+    size_t splits_number = 0;
+    size_t passed_tokens = 0;
+    splits[splits_number++] = 0;
+    for(size_t elem = 0; elem < statements_number; elem++) {
+        if(passed_tokens >= tokens / workers_number * splits_number &&
+           splits[splits_number - 1] != elem &&
+           splits_number < workers_number) {
+            splits[splits_number++] = elem;
+        }
+        if(statements[elem].is_function) {
+            passed_tokens += statements[elem].end - statements[elem].start;
+        }
+    }
+    splits[splits_number] = statements_number;
+    return splits_number;
+}
+
+//===========================================================================//
+
+language_error_t worker_ctor(parser_worker_t    *worker,
+                             language_t         *ctx,
+                             global_statement_t *statements,
+                             size_t              first,
+                             size_t              last) {
+    // Worker shares tokens, name table and used names with the context,
+    // only variables stack and bindings are its own.
+    worker->ctx        = *ctx;
+    worker->statements = statements;
+    worker->first      = first;
+    worker->last       = last;
+    worker->error      = LANGUAGE_SUCCESS;
+    //-----------------------------------------------------------------------//
+    name_table_t *table      = &worker->ctx.name_table;
+    table->stack             = NULL;
+    table->scopes            = NULL;
+    table->bindings          = NULL;
+    table->bindings_capacity = 0;
+    _RETURN_IF_ERROR(variables_stack_ctor(&worker->ctx, VariablesStackCapacity));
+    for(size_t symbol = 0; symbol < table->used_names_size; symbol++) {
+        table->bindings[symbol].function = ctx->name_table.bindings[symbol].function;
+    }
+    //-----------------------------------------------------------------------//
+    // Globals declared before the range are visible in it.
+    for(size_t elem = 0; elem < first; elem++) {
+        if(!statements[elem].is_function) {
+            _RETURN_IF_ERROR(variables_stack_push(&worker->ctx,
+                                                  statements[elem].nt_index));
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void *worker_parse(void *worker) {
+    parser_worker_t *parser_worker = (parser_worker_t *)worker;
+    parser_worker->error = worker_parse_range(parser_worker);
+    return NULL;
+}
+
+//===========================================================================//
+
+language_error_t worker_parse_range(parser_worker_t *worker) {
+    for(size_t elem = worker->first; elem < worker->last; elem++) {
+        _RETURN_IF_ERROR(worker_parse_statement(worker, worker->statements + elem));
+        if(worker->stream != NULL) {
+            _RETURN_IF_ERROR(emit_statements(worker->stream,
+                                             worker->statements,
+                                             elem,
+                                             elem + 1));
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t worker_parse_statement(parser_worker_t    *worker,
+                                        global_statement_t *statement) {
+    language_t *ctx = &worker->ctx;
+    if(statement->cached != NULL) {
+        return LANGUAGE_SUCCESS;
+    }
+    if(!statement->is_function) {
+        return variables_stack_push(ctx, statement->nt_index);
+    }
+    //-----------------------------------------------------------------------//
+    // Locals and call nodes go to the ranges reserved for this function.
+    ctx->frontend_info.position_index = statement->start;
+    ctx->frontend_info.position       = nodes_storage_get(ctx, statement->start);
+    ctx->name_table.size              = statement->nt_index + 1;
+    ctx->nodes.size                   = statement->calls_start;
+    uint32_t root = NodeNone;
+    _RETURN_IF_ERROR(parse_function(ctx, &root));
+    if(ctx->frontend_info.position_index != statement->end) {
+        return syntax_error(ctx, "Expected ';' after statements.\n");
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t emit_statements(language_t         *ctx,
+                                 global_statement_t *statements,
+                                 size_t              first,
+                                 size_t              last) {
+    // Chain node gets its statement like in link_statements, statements
+    // of other ranges are not touched, so workers may still parse them.
+    for(size_t elem = first; elem < last; elem++) {
+        global_statement_t *statement = statements + elem;
+        nodes_storage_get(ctx, (uint32_t)statement->end)->left = (uint32_t)statement->start;
+        _RETURN_IF_ERROR(write_tree_frame(ctx, (uint32_t)statement->end));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void workers_dtor(parser_worker_t *workers, size_t workers_number) {
+    for(size_t worker = 0; worker < workers_number; worker++) {
+        variables_stack_dtor(&workers[worker].ctx);
+    }
+    free(workers);
+}
+
+//===========================================================================//
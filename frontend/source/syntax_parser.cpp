@@ -1,7 +1,10 @@
 #include <string.h>
+#include <stdlib.h>
 
 #include "language.h"
 #include "syntax_parser.h"
+#include "parser_threads.h"
+#include "function_cache.h"
 #include "name_table.h"
 #include "frontend_utils.h"
 #include "custom_assert.h"
@@ -14,73 +17,95 @@ static language_error_t set_reference           (language_t       *ctx,
                                                  language_node_t  *node);
 
 static language_error_t get_variable            (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_operation           (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_number              (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_element             (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_power               (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_multiple            (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_expression          (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_function_call_params(language_t       *ctx,
-                                                 language_node_t **output,
+                                                 uint32_t          *output,
                                                  identifier_t     *identifier);
 
 static language_error_t get_function_call       (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_assignment          (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_new_variable        (language_t       *ctx,
-                                                 language_node_t **output,
+                                                 uint32_t          *output,
                                                  bool              is_global);
 
 static language_error_t get_while               (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_if                  (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_body                (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_new_function_params (language_t       *ctx,
-                                                 language_node_t **output,
+                                                 uint32_t          *output,
                                                  size_t           *params_number);
 
 static language_error_t get_new_function        (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_statement           (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_global_statement    (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_return              (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_comparison          (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_in                  (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
 
 static language_error_t get_out                 (language_t       *ctx,
-                                                 language_node_t **output);
+                                                 uint32_t          *output);
+
+static language_error_t get_signatures          (language_t          *ctx,
+                                                 global_statement_t **statements,
+                                                 size_t              *statements_number);
+
+static language_error_t get_signature           (language_t          *ctx,
+                                                 global_statement_t  *statement);
+
+static language_error_t skip_function_tokens    (language_t          *ctx,
+                                                 global_statement_t  *statement,
+                                                 operation_t          open,
+                                                 operation_t          close);
+
+static bool             is_on_call              (language_t          *ctx);
+
+static language_error_t parse_globals           (language_t          *ctx,
+                                                 global_statement_t  *statements,
+                                                 size_t               statements_number);
+
+static void             link_statements         (language_t          *ctx,
+                                                 global_statement_t  *statements,
+                                                 size_t               statements_number);
 
 
 //===========================================================================//
@@ -88,37 +113,265 @@ static language_error_t get_out                 (language_t       *ctx,
 language_error_t parse_syntax(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(variables_stack_ctor(ctx, ctx->input_size));
-    language_node_t **current_node = &ctx->root;
+    _RETURN_IF_ERROR(variables_stack_ctor(ctx, VariablesStackCapacity));
+    ctx->frontend_info.position_index = 0;
+    ctx->frontend_info.position       = nodes_storage_get(ctx, 0);
+    //-----------------------------------------------------------------------//
+    // Functions are known before bodies are parsed, globals are parsed
+    // in order, then function bodies are parsed in parallel.
+    global_statement_t *statements        = NULL;
+    size_t              statements_number = 0;
+    language_error_t error_code = get_signatures(ctx,
+                                                 &statements,
+                                                 &statements_number);
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = parse_globals(ctx, statements, statements_number);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        error_code = parse_functions(ctx, statements, statements_number);
+    }
+    if(error_code == LANGUAGE_SUCCESS) {
+        link_statements(ctx, statements, statements_number);
+    }
+    if(error_code == LANGUAGE_SUCCESS && ctx->frontend_info.cache != NULL) {
+        error_code = function_cache_store(ctx, statements, statements_number);
+    }
+    free(statements);
+    _RETURN_IF_ERROR(error_code);
     //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(variables_stack_dtor(ctx));
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t parse_function(language_t       *ctx,
+                                uint32_t          *output) {
+    return get_new_function(ctx, output);
+}
+
+//===========================================================================//
+
+language_error_t get_signatures(language_t          *ctx,
+                                global_statement_t **statements,
+                                size_t              *statements_number) {
+    _C_ASSERT(ctx               != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(statements        != NULL, return LANGUAGE_NULL_OUTPUT);
+    _C_ASSERT(statements_number != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    size_t capacity = 0;
+    size_t nt_size  = ctx->name_table.size;
     while(!is_on_operation(ctx, OPERATION_PROGRAM_END)) {
+        if(*statements_number == capacity) {
+            capacity = capacity == 0 ? NameTableDefaultCapacity : capacity * 2;
+            global_statement_t *new_statements =
+                (global_statement_t *)realloc(*statements,
+                                              capacity * sizeof(new_statements[0]));
+            if(new_statements == NULL) {
+                print_error("Error while allocating global statements.\n");
+                return LANGUAGE_MEMORY_ERROR;
+            }
+            *statements = new_statements;
+        }
+        global_statement_t *statement = *statements + *statements_number;
+        memset(statement, 0, sizeof(*statement));
+        statement->start    = ctx->frontend_info.position_index;
+        statement->nt_index = nt_size;
         //-------------------------------------------------------------------//
-        language_node_t *statement = NULL;
-        _RETURN_IF_ERROR(get_global_statement(ctx, &statement));
+        statement->cached   = function_cache_find(ctx, statement->start);
+        if(statement->cached != NULL) {
+            _RETURN_IF_ERROR(function_cache_signature(ctx, statement));
+        }
+        else if(is_on_operation(ctx, OPERATION_NEW_FUNC)) {
+            _RETURN_IF_ERROR(get_signature(ctx, statement));
+        }
+        else if(is_on_operation(ctx, OPERATION_NEW_VAR)) {
+            while(!is_on_operation(ctx, OPERATION_STATEMENT  ) &&
+                  !is_on_operation(ctx, OPERATION_PROGRAM_END)) {
+                move_next_token(ctx);
+            }
+        }
+        else if(is_on_operation(ctx, OPERATION_STATEMENT)) {
+            return syntax_error(ctx, "Unexpected ';'.\n");
+        }
         //-------------------------------------------------------------------//
         if(!is_on_operation(ctx, OPERATION_STATEMENT)) {
             return syntax_error(ctx, "Expected ';' after statements.\n");
         }
+        statement->end = ctx->frontend_info.position_index;
+        move_next_token(ctx);
         //-------------------------------------------------------------------//
-        if(statement == NULL) {
-            return syntax_error(ctx, "Unexpected ';'.\n");
+        nt_size += 1 + statement->locals;
+        (*statements_number)++;
+    }
+    //-----------------------------------------------------------------------//
+    // Globals and locals are filled later in the reserved name table slots.
+    _RETURN_IF_ERROR(name_table_reserve(ctx, nt_size));
+    ctx->name_table.size = nt_size;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t get_signature(language_t         *ctx,
+                               global_statement_t *statement) {
+    _C_ASSERT(ctx       != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(statement != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    statement->is_function = true;
+    move_next_token(ctx);
+    if(!is_on_type(ctx, NODE_TYPE_IDENTIFIER)) {
+        return syntax_error(ctx,
+                            "It is expected to see identifier "
+                            "after new function key word.\n");
+    }
+    language_node_t *ident = token_position(ctx);
+    _RETURN_IF_ERROR(move_next_token(ctx));
+    //-----------------------------------------------------------------------//
+    size_t      index  = node_identifier(ident);
+    const char *name   = ctx->name_table.used_names[index].name;
+    size_t      length = ctx->name_table.used_names[index].length;
+    ctx->name_table.size = statement->nt_index;
+    _RETURN_IF_ERROR(name_table_add(ctx,
+                                    name,
+                                    length,
+                                    &index,
+                                    IDENTIFIER_FUNCTION));
+    node_set_value(ident, NODE_TYPE_IDENTIFIER, IDENT(index));
+    _RETURN_IF_ERROR(name_table_bind_function(ctx, index));
+    //-----------------------------------------------------------------------//
+    if(!is_on_operation(ctx, OPERATION_OPEN_BRACKET)) {
+        return syntax_error(ctx,
+                            "It is expected to see '(' "
+                            "after identifier when initializing function.\n");
+    }
+    _RETURN_IF_ERROR(skip_function_tokens(ctx,
+                                          statement,
+                                          OPERATION_OPEN_BRACKET,
+                                          OPERATION_CLOSE_BRACKET));
+    ctx->name_table.identifiers[statement->nt_index].parameters_number =
+        statement->locals;
+    //-----------------------------------------------------------------------//
+    if(!is_on_operation(ctx, OPERATION_BODY_START)) {
+        return syntax_error(ctx,
+                            "It is expected to see some dead bodies here.\n");
+    }
+    return skip_function_tokens(ctx,
+                                statement,
+                                OPERATION_BODY_START,
+                                OPERATION_BODY_END);
+}
+
+//===========================================================================//
+
+language_error_t skip_function_tokens(language_t         *ctx,
+                                      global_statement_t *statement,
+                                      operation_t         open,
+                                      operation_t         close) {
+    _C_ASSERT(ctx       != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(statement != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    // Tokens are skipped up to the pair of the current one while variables
+    // and possible calls are counted for the name table and nodes ranges.
+    size_t depth = 0;
+    do {
+        if(is_on_operation(ctx, OPERATION_PROGRAM_END)) {
+            return syntax_error(ctx,
+                                "Unexpected end of program, '%s' is not closed.\n",
+                                KeyWords[open].name);
+        }
+        if(is_on_operation(ctx, open)) {
+            depth++;
+        }
+        else if(is_on_operation(ctx, close)) {
+            depth--;
+        }
+        else if(is_on_operation(ctx, OPERATION_NEW_VAR)) {
+            statement->locals++;
+        }
+        else if(is_on_call(ctx)) {
+            statement->calls++;
         }
-        *current_node = token_position(ctx);
         move_next_token(ctx);
+    } while(depth != 0);
+    //-----------------------------------------------------------------------//
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+bool is_on_call(language_t *ctx) {
+    _C_ASSERT(ctx != NULL, return false);
+    //-----------------------------------------------------------------------//
+    if(!is_on_type(ctx, NODE_TYPE_IDENTIFIER)) {
+        return false;
+    }
+    // Program always ends with PROGRAM_END, so next token exists.
+    language_node_t *next = nodes_storage_get(ctx,
+                                              ctx->frontend_info.position_index + 1);
+    return node_type  (next) == NODE_TYPE_OPERATION &&
+           node_opcode(next) == OPERATION_OPEN_BRACKET;
+}
+
+//===========================================================================//
+
+language_error_t parse_globals(language_t         *ctx,
+                               global_statement_t *statements,
+                               size_t              statements_number) {
+    _C_ASSERT(ctx        != NULL, return LANGUAGE_CTX_NULL   );
+    _C_ASSERT(statements != NULL || statements_number == 0,
+              return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    // Cached functions are loaded here, when globals before them are seen.
+    size_t           nt_size      = ctx->name_table.size;
+    language_error_t cache_status = LANGUAGE_SUCCESS;
+    for(size_t elem = 0; elem < statements_number; elem++) {
+        global_statement_t *statement = statements + elem;
+        if(statement->cached != NULL) {
+            language_error_t error_code = function_cache_load(ctx, statement);
+            if(error_code == LANGUAGE_CACHE_OUTDATED) {
+                cache_status = error_code;
+                continue;
+            }
+            _RETURN_IF_ERROR(error_code);
+        }
+        if(statement->is_function) {
+            continue;
+        }
         //-------------------------------------------------------------------//
-        (*current_node)->left = statement;
-        current_node = &(*current_node)->right;
-        //-------------------------------------------------------------------//
+        ctx->frontend_info.position_index = statement->start;
+        ctx->frontend_info.position       = nodes_storage_get(ctx, statement->start);
+        ctx->name_table.size              = statement->nt_index;
+        uint32_t root = NodeNone;
+        _RETURN_IF_ERROR(get_global_statement(ctx, &root));
+        if(ctx->frontend_info.position_index != statement->end) {
+            return syntax_error(ctx, "Expected ';' after statements.\n");
+        }
     }
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(variables_stack_dtor(ctx));
-    return LANGUAGE_SUCCESS;
+    ctx->name_table.size = nt_size;
+    return cache_status;
+}
+
+//===========================================================================//
+
+void link_statements(language_t         *ctx,
+                     global_statement_t *statements,
+                     size_t              statements_number) {
+    uint32_t *current_node = &ctx->root;
+    for(size_t elem = 0; elem < statements_number; elem++) {
+        language_node_t *statement = nodes_storage_get(ctx, statements[elem].end);
+        *current_node   = (uint32_t)statements[elem].end;
+        statement->left = (uint32_t)statements[elem].start;
+        current_node    = &statement->right;
+    }
+    *current_node = NodeNone;
 }
 
 //===========================================================================//
 
 language_error_t get_global_statement(language_t       *ctx,
-                                      language_node_t **output) {
+                                      uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
@@ -137,7 +390,7 @@ language_error_t get_global_statement(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_statement(language_t       *ctx,
-                               language_node_t **output) {
+                               uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
@@ -185,16 +438,16 @@ language_error_t get_statement(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_return(language_t       *ctx,
-                            language_node_t **output) {
+                            uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_operation(ctx, OPERATION_RETURN),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    *output = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(get_expression(ctx, &(*output)->left));
+    _RETURN_IF_ERROR(get_expression(ctx, &nodes_storage_get(ctx, *output)->left));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -202,13 +455,13 @@ language_error_t get_return(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_new_function(language_t       *ctx,
-                                  language_node_t **output) {
+                                  uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_operation(ctx, OPERATION_NEW_FUNC),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    *output = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
     if(!is_on_type(ctx, NODE_TYPE_IDENTIFIER)) {
@@ -216,17 +469,10 @@ language_error_t get_new_function(language_t       *ctx,
                             "It is expected to see identifier "
                             "after new function key word.\n");
     }
+    // Name is registered by the signature pass, token holds its index.
     language_node_t *ident = token_position(ctx);
+    nodes_storage_get(ctx, *output)->left = token_index(ctx);
     _RETURN_IF_ERROR(move_next_token(ctx));
-    (*output)->left = ident;
-    //-----------------------------------------------------------------------//
-    const char *name   = ctx->name_table.used_names[ident->value.identifier].name;
-    size_t      length = ctx->name_table.used_names[ident->value.identifier].length;
-    _RETURN_IF_ERROR(name_table_add(ctx,
-                                    name,
-                                    length,
-                                    &ident->value.identifier,
-                                    IDENTIFIER_FUNCTION));
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_OPEN_BRACKET)) {
         return syntax_error(ctx,
@@ -235,12 +481,13 @@ language_error_t get_new_function(language_t       *ctx,
     }
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    size_t old_locals = ctx->frontend_info.used_locals;
-    ctx->frontend_info.used_locals = 0;
+    _RETURN_IF_ERROR(variables_scope_enter(ctx));
     //-----------------------------------------------------------------------//
     size_t params_number = 0;
     _RETURN_IF_ERROR(get_new_function_params(ctx, &ident->left, &params_number));
-    ctx->name_table.identifiers[ident->value.identifier].parameters_number = params_number;
+    _C_ASSERT(ctx->name_table.identifiers[node_identifier(ident)].parameters_number ==
+              params_number,
+              return LANGUAGE_BROKEN_NAME_TABLE_ELEM);
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_CLOSE_BRACKET)) {
         return syntax_error(ctx,
@@ -251,9 +498,7 @@ language_error_t get_new_function(language_t       *ctx,
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(get_body(ctx, &ident->right));
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(variables_stack_remove(ctx,
-                                            ctx->frontend_info.used_locals));
-    ctx->frontend_info.used_locals = old_locals;
+    _RETURN_IF_ERROR(variables_scope_leave(ctx));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -261,7 +506,7 @@ language_error_t get_new_function(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_new_function_params(language_t       *ctx,
-                                         language_node_t **output,
+                                         uint32_t          *output,
                                          size_t           *params_number) {
     _C_ASSERT(ctx           != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output        != NULL, return LANGUAGE_NULL_OUTPUT);
@@ -270,9 +515,9 @@ language_error_t get_new_function_params(language_t       *ctx,
     if(is_on_operation(ctx, OPERATION_CLOSE_BRACKET)) {
         return LANGUAGE_SUCCESS;
     }
-    *output = token_position(ctx) - 1;
-    (*output)->value.opcode = OPERATION_PARAM_LINKER;
-    language_node_t *current_node = *output;
+    *output = previous_token(ctx);
+    language_node_t *current_node = nodes_storage_get(ctx, *output);
+    node_set_value(current_node, NODE_TYPE_OPERATION, OPCODE(OPERATION_PARAM_LINKER));
     //-----------------------------------------------------------------------//
     while(true) {
         _RETURN_IF_ERROR(get_new_variable(ctx,
@@ -290,8 +535,8 @@ language_error_t get_new_function_params(language_t       *ctx,
                                 "between function parameters.\n");
         }
         //-------------------------------------------------------------------//
-        current_node->right = token_position(ctx);
-        current_node = current_node->right;
+        current_node->right = token_index(ctx);
+        current_node = token_position(ctx);
         move_next_token(ctx);
         //-------------------------------------------------------------------//
     }
@@ -300,7 +545,7 @@ language_error_t get_new_function_params(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_body(language_t       *ctx,
-                          language_node_t **output) {
+                          uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
@@ -310,12 +555,11 @@ language_error_t get_body(language_t       *ctx,
     }
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    size_t old_locals = ctx->frontend_info.used_locals;
-    ctx->frontend_info.used_locals = 0;
+    _RETURN_IF_ERROR(variables_scope_enter(ctx));
     //-----------------------------------------------------------------------//
     while(true) {
         //-------------------------------------------------------------------//
-        language_node_t *statement = NULL;
+        uint32_t statement = NodeNone;
         _RETURN_IF_ERROR(get_statement(ctx, &statement));
         //-------------------------------------------------------------------//
         if(!is_on_operation(ctx, OPERATION_STATEMENT)) {
@@ -324,23 +568,21 @@ language_error_t get_body(language_t       *ctx,
                                 "after EVERY statement.\n");
         }
         //-------------------------------------------------------------------//
-        if(statement == NULL) {
+        if(statement == NodeNone) {
             return syntax_error(ctx, "Unexpected ';'.\n");
         }
         //-------------------------------------------------------------------//
-        *output = token_position(ctx);
-        (*output)->left = statement;
+        *output = token_index(ctx);
+        token_position(ctx)->left = statement;
         move_next_token(ctx);
         //-------------------------------------------------------------------//
         if(is_on_operation(ctx, OPERATION_BODY_END)) {
             move_next_token(ctx);
-            _RETURN_IF_ERROR(variables_stack_remove(ctx,
-                                                    ctx->frontend_info.used_locals));
-            ctx->frontend_info.used_locals = old_locals;
+            _RETURN_IF_ERROR(variables_scope_leave(ctx));
             return LANGUAGE_SUCCESS;
         }
         //-------------------------------------------------------------------//
-        output = &(*output)->right;
+        output = &nodes_storage_get(ctx, *output)->right;
         //-------------------------------------------------------------------//
     }
 }
@@ -348,13 +590,14 @@ language_error_t get_body(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_if(language_t       *ctx,
-                        language_node_t **output) {
+                        uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_operation(ctx, OPERATION_IF),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    *output = token_position(ctx);
+    language_node_t *root = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_OPEN_BRACKET)) {
@@ -364,7 +607,7 @@ language_error_t get_if(language_t       *ctx,
     }
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(get_comparison(ctx, &(*output)->left));
+    _RETURN_IF_ERROR(get_comparison(ctx, &root->left));
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_CLOSE_BRACKET)) {
         return syntax_error(ctx,
@@ -372,7 +615,7 @@ language_error_t get_if(language_t       *ctx,
     }
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(get_body(ctx, &(*output)->right));
+    _RETURN_IF_ERROR(get_body(ctx, &root->right));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -380,13 +623,14 @@ language_error_t get_if(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_while(language_t       *ctx,
-                           language_node_t **output) {
+                           uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_operation(ctx, OPERATION_WHILE),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    *output = token_position(ctx);
+    language_node_t *root = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_OPEN_BRACKET)) {
@@ -396,7 +640,7 @@ language_error_t get_while(language_t       *ctx,
     }
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(get_comparison(ctx, &(*output)->left));
+    _RETURN_IF_ERROR(get_comparison(ctx, &root->left));
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_CLOSE_BRACKET)) {
         return syntax_error(ctx,
@@ -405,7 +649,7 @@ language_error_t get_while(language_t       *ctx,
     }
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(get_body(ctx, &(*output)->right));
+    _RETURN_IF_ERROR(get_body(ctx, &root->right));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -413,7 +657,7 @@ language_error_t get_while(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_new_variable(language_t       *ctx,
-                                  language_node_t **output,
+                                  uint32_t          *output,
                                   bool              is_global) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
@@ -423,7 +667,7 @@ language_error_t get_new_variable(language_t       *ctx,
                             "It is expected to see new "
                             "variable key word here.\n");
     }
-    *output = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
     if(!is_on_type(ctx, NODE_TYPE_IDENTIFIER)) {
@@ -432,30 +676,32 @@ language_error_t get_new_variable(language_t       *ctx,
                             "after new variable key word.\n");
     }
     language_node_t *ident = token_position(ctx);
+    uint32_t         index = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    size_t     *value  = &ident->value.identifier;
-    const char *name   = ctx->name_table.used_names[*value].name;
-    size_t      length = ctx->name_table.used_names[*value].length;
+    size_t      value  = node_identifier(ident);
+    const char *name   = ctx->name_table.used_names[value].name;
+    size_t      length = ctx->name_table.used_names[value].length;
     _RETURN_IF_ERROR(name_table_add(ctx,
                                     name,
                                     length,
-                                    value,
+                                    &value,
                                     IDENTIFIER_VARIABLE));
-    _RETURN_IF_ERROR(variables_stack_push(ctx, *value));
-    identifier_t *nt_info = ctx->name_table.identifiers + (*value);
+    node_set_value(ident, NODE_TYPE_IDENTIFIER, IDENT(value));
+    _RETURN_IF_ERROR(variables_stack_push(ctx, value));
+    identifier_t *nt_info = ctx->name_table.identifiers + value;
     nt_info->is_global = is_global;
-    ctx->frontend_info.used_locals++;
     //-----------------------------------------------------------------------//
     if(is_on_operation(ctx, OPERATION_ASSIGNMENT)) {
-        (*output)->left = token_position(ctx);
+        language_node_t *assignment = token_position(ctx);
+        nodes_storage_get(ctx, *output)->left = token_index(ctx);
         move_next_token(ctx);
-        (*output)->left->left = ident;
-        _RETURN_IF_ERROR(get_expression(ctx, &(*output)->left->right));
+        assignment->left = index;
+        _RETURN_IF_ERROR(get_expression(ctx, &assignment->right));
     }
     //-----------------------------------------------------------------------//
     else {
-        (*output)->left = ident;
+        nodes_storage_get(ctx, *output)->left = index;
     }
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -464,23 +710,24 @@ language_error_t get_new_variable(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_assignment(language_t       *ctx,
-                                language_node_t **output) {
+                                uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_type(ctx, NODE_TYPE_IDENTIFIER),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    language_node_t *lvalue = token_position(ctx);
+    uint32_t lvalue = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_ASSIGNMENT)) {
         return syntax_error(ctx, "Expected to see assignment here.\n");
     }
-    *output = token_position(ctx);
+    language_node_t *assignment = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
-    (*output)->left = lvalue;
+    assignment->left = lvalue;
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(get_expression(ctx, &(*output)->right));
+    _RETURN_IF_ERROR(get_expression(ctx, &assignment->right));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -488,22 +735,19 @@ language_error_t get_assignment(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_function_call(language_t       *ctx,
-                                   language_node_t **output) {
+                                   uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_ident_type(ctx, IDENTIFIER_FUNCTION),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    _RETURN_IF_ERROR(nodes_storage_add(ctx,
-                                       NODE_TYPE_OPERATION,
-                                       OPCODE(OPERATION_CALL),
-                                       "", 0,
-                                       output));
-    (*output)->left = token_position(ctx);
+    language_node_t *function = token_position(ctx);
+    uint32_t         index    = token_index(ctx);
     move_next_token(ctx);
     identifier_t *ident = ctx->name_table.identifiers +
-                          (*output)->left->value.identifier;
+                          node_identifier(function);
     //-----------------------------------------------------------------------//
+    // Call node is taken only for 'name(', as the signature pass counted.
     if(!is_on_operation(ctx, OPERATION_OPEN_BRACKET)) {
         return syntax_error(ctx,
                             "'%.*s' can not be used as a variable.\n",
@@ -511,9 +755,15 @@ language_error_t get_function_call(language_t       *ctx,
                             ident->name);
     }
     move_next_token(ctx);
+    _RETURN_IF_ERROR(nodes_storage_add(ctx,
+                                       NODE_TYPE_OPERATION,
+                                       OPCODE(OPERATION_CALL),
+                                       "", 0,
+                                       output));
+    nodes_storage_get(ctx, *output)->left = index;
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(get_function_call_params(ctx,
-                                              &(*output)->left->left,
+                                              &function->left,
                                               ident));
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_CLOSE_BRACKET)) {
@@ -529,7 +779,7 @@ language_error_t get_function_call(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_function_call_params(language_t       *ctx,
-                                          language_node_t **output,
+                                          uint32_t          *output,
                                           identifier_t     *ident) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
@@ -537,10 +787,10 @@ language_error_t get_function_call_params(language_t       *ctx,
     if(ident->parameters_number == 0) {
         return LANGUAGE_SUCCESS;
     }
-    *output = token_position(ctx) - 1;
+    *output = previous_token(ctx);
     //-----------------------------------------------------------------------//
-    language_node_t *current_node = *output;
-    current_node->value.opcode = OPERATION_PARAM_LINKER;
+    language_node_t *current_node = nodes_storage_get(ctx, *output);
+    node_set_value(current_node, NODE_TYPE_OPERATION, OPCODE(OPERATION_PARAM_LINKER));
     for(size_t i = 0; i < ident->parameters_number; i++) {
         //-------------------------------------------------------------------//
         _RETURN_IF_ERROR(get_expression(ctx, &current_node->left));
@@ -556,10 +806,10 @@ language_error_t get_function_call_params(language_t       *ctx,
         }
         //-------------------------------------------------------------------//
         if(i + 1 != ident->parameters_number) {
-            current_node->right = token_position(ctx);
+            current_node->right = token_index(ctx);
             move_next_token(ctx);
         }
-        current_node = current_node->right;
+        current_node = node_right(ctx, current_node);
         //-------------------------------------------------------------------//
     }
     //-----------------------------------------------------------------------//
@@ -569,11 +819,11 @@ language_error_t get_function_call_params(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_comparison(language_t       *ctx,
-                                language_node_t **output) {
+                                uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
-    language_node_t *left_side = NULL;
+    uint32_t left_side = NodeNone;
     _RETURN_IF_ERROR(get_expression(ctx, &left_side));
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_BIGGER ) &&
@@ -582,12 +832,13 @@ language_error_t get_comparison(language_t       *ctx,
         return LANGUAGE_SUCCESS;
     }
     //-----------------------------------------------------------------------//
-    *output = token_position(ctx);
+    language_node_t *comparison = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    (*output)->left = left_side;
+    comparison->left = left_side;
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(get_expression(ctx, &(*output)->right));
+    _RETURN_IF_ERROR(get_expression(ctx, &comparison->right));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
@@ -595,11 +846,11 @@ language_error_t get_comparison(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_expression(language_t       *ctx,
-                                language_node_t **output) {
+                                uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
-    language_node_t *root = NULL;
+    uint32_t root = NodeNone;
     _RETURN_IF_ERROR(get_multiple(ctx, &root));
     //-----------------------------------------------------------------------//
     while(is_on_operation(ctx, OPERATION_ADD) ||
@@ -607,10 +858,10 @@ language_error_t get_expression(language_t       *ctx,
         //-------------------------------------------------------------------//
         language_node_t *new_root = token_position(ctx);
         new_root->left = root;
-        root = new_root;
+        root = token_index(ctx);
         move_next_token(ctx);
         //-------------------------------------------------------------------//
-        _RETURN_IF_ERROR(get_multiple(ctx, &root->right));
+        _RETURN_IF_ERROR(get_multiple(ctx, &new_root->right));
         //-------------------------------------------------------------------//
     }
     //-----------------------------------------------------------------------//
@@ -621,11 +872,11 @@ language_error_t get_expression(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_multiple(language_t       *ctx,
-                              language_node_t **output) {
+                              uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
-    language_node_t *root = NULL;
+    uint32_t root = NodeNone;
     _RETURN_IF_ERROR(get_power(ctx, &root));
     //-----------------------------------------------------------------------//
     while(is_on_operation(ctx, OPERATION_MUL) ||
@@ -633,10 +884,10 @@ language_error_t get_multiple(language_t       *ctx,
         //-------------------------------------------------------------------//
         language_node_t *new_root = token_position(ctx);
         new_root->left = root;
-        root = new_root;
+        root = token_index(ctx);
         move_next_token(ctx);
         //-------------------------------------------------------------------//
-        _RETURN_IF_ERROR(get_power(ctx, &root->right));
+        _RETURN_IF_ERROR(get_power(ctx, &new_root->right));
         //-------------------------------------------------------------------//
     }
     //-----------------------------------------------------------------------//
@@ -647,21 +898,21 @@ language_error_t get_multiple(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_power(language_t       *ctx,
-                           language_node_t **output) {
+                           uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
-    language_node_t *root = NULL;
+    uint32_t root = NodeNone;
     _RETURN_IF_ERROR(get_element(ctx, &root));
     //-----------------------------------------------------------------------//
     while(is_on_operation(ctx, OPERATION_POW)) {
         //-------------------------------------------------------------------//
         language_node_t *new_root = token_position(ctx);
         new_root->left = root;
-        root = new_root;
+        root = token_index(ctx);
         move_next_token(ctx);
         //-------------------------------------------------------------------//
-        _RETURN_IF_ERROR(get_element(ctx, &root->right));
+        _RETURN_IF_ERROR(get_element(ctx, &new_root->right));
         //-------------------------------------------------------------------//
     }
     //-----------------------------------------------------------------------//
@@ -672,7 +923,7 @@ language_error_t get_power(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_element(language_t       *ctx,
-                             language_node_t **output) {
+                             uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
@@ -694,7 +945,7 @@ language_error_t get_element(language_t       *ctx,
     }
     //-----------------------------------------------------------------------//
     if(is_on_type(ctx, NODE_TYPE_OPERATION) &&
-       KeyWords[token_position(ctx)->value.opcode].is_expression_element) {
+       KeyWords[node_opcode(token_position(ctx))].is_expression_element) {
         return get_operation(ctx, output);
     }
     //-----------------------------------------------------------------------//
@@ -719,13 +970,13 @@ language_error_t get_element(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_number(language_t       *ctx,
-                            language_node_t **output) {
+                            uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_type(ctx, NODE_TYPE_NUMBER),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    *output = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -734,32 +985,34 @@ language_error_t get_number(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_operation(language_t       *ctx,
-                               language_node_t **output) {
+                               uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_type(ctx, NODE_TYPE_OPERATION),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    if(!KeyWords[token_position(ctx)->value.opcode].is_expression_element) {
+    if(!KeyWords[node_opcode(token_position(ctx))].is_expression_element) {
         return syntax_error(ctx,
                             "Expected only math operations in expression.\n");
     }
-    *output = token_position(ctx);
+    language_node_t *operation = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_OPEN_BRACKET)) {
         return syntax_error(ctx,
                             "Operation '%s' expected to have parameter in '()'",
-                            KeyWords[(*output)->value.opcode]);
+                            KeyWords[node_opcode(operation)]);
     }
-    (*output)->left = token_position(ctx);
-    _RETURN_IF_ERROR(set_val(token_position(ctx),
+    language_node_t *linker = token_position(ctx);
+    operation->left = token_index(ctx);
+    _RETURN_IF_ERROR(set_val(linker,
                              NODE_TYPE_OPERATION,
                              OPCODE(OPERATION_PARAM_LINKER),
-                             NULL, NULL));
+                             NodeNone, NodeNone));
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(get_expression(ctx, &(*output)->left->left));
+    _RETURN_IF_ERROR(get_expression(ctx, &linker->left));
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_CLOSE_BRACKET)) {
         return syntax_error(ctx, "I supposed to see ')'");
@@ -772,13 +1025,13 @@ language_error_t get_operation(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_variable(language_t       *ctx,
-                              language_node_t **output) {
+                              uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_ident_type(ctx, IDENTIFIER_VARIABLE),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    *output = token_position(ctx);
+    *output = token_index(ctx);
     move_next_token(ctx);
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -787,23 +1040,25 @@ language_error_t get_variable(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_in(language_t       *ctx,
-                        language_node_t **output) {
+                        uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_operation(ctx, OPERATION_IN),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    *output = token_position(ctx);
+    language_node_t *input = token_position(ctx);
+    *output = token_index(ctx);
     _RETURN_IF_ERROR(move_next_token(ctx));
     if(!is_on_operation(ctx, OPERATION_OPEN_BRACKET)) {
         return syntax_error(ctx, "Expected to see '(' after input keyword.");
     }
-    (*output)->left = token_position(ctx);
+    language_node_t *linker = token_position(ctx);
+    input->left = token_index(ctx);
     _RETURN_IF_ERROR(move_next_token(ctx));
-    _RETURN_IF_ERROR(set_val((*output)->left,
+    _RETURN_IF_ERROR(set_val(linker,
                              NODE_TYPE_OPERATION,
                              OPCODE(OPERATION_PARAM_LINKER),
-                             NULL, NULL));
+                             NodeNone, NodeNone));
     if(!is_on_type(ctx, NODE_TYPE_IDENTIFIER)) {
         return syntax_error(ctx, "Expected to see in parameter as variable");
     }
@@ -811,7 +1066,7 @@ language_error_t get_in(language_t       *ctx,
     if(!is_on_ident_type(ctx, IDENTIFIER_VARIABLE)) {
         return syntax_error(ctx, "Expected to see in parameter as variable");
     }
-    (*output)->left->left = token_position(ctx);
+    linker->left = token_index(ctx);
     _RETURN_IF_ERROR(move_next_token(ctx));
     if(!is_on_operation(ctx, OPERATION_CLOSE_BRACKET)) {
         return syntax_error(ctx, "Expected to see ')' after variable in input.");
@@ -824,27 +1079,29 @@ language_error_t get_in(language_t       *ctx,
 //===========================================================================//
 
 language_error_t get_out(language_t       *ctx,
-                         language_node_t **output) {
+                         uint32_t          *output) {
     _C_ASSERT(ctx    != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(output != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
     _C_ASSERT(is_on_operation(ctx, OPERATION_OUT),
               return LANGUAGE_SYNTAX_UNEXPECTED_CALL);
-    *output = token_position(ctx);
+    language_node_t *out = token_position(ctx);
+    *output = token_index(ctx);
     _RETURN_IF_ERROR(move_next_token(ctx));
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_OPEN_BRACKET)) {
         return syntax_error(ctx,
                             "Expected to see ( after out command.\n");
     }
-    (*output)->left = token_position(ctx);
-    _RETURN_IF_ERROR(set_val(token_position(ctx),
+    language_node_t *linker = token_position(ctx);
+    out->left = token_index(ctx);
+    _RETURN_IF_ERROR(set_val(linker,
                              NODE_TYPE_OPERATION,
                              OPCODE(OPERATION_PARAM_LINKER),
-                             NULL, NULL));
+                             NodeNone, NodeNone));
     _RETURN_IF_ERROR(move_next_token(ctx));
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(get_expression(ctx, &(*output)->left->left));
+    _RETURN_IF_ERROR(get_expression(ctx, &linker->left));
     //-----------------------------------------------------------------------//
     if(!is_on_operation(ctx, OPERATION_CLOSE_BRACKET)) {
         return syntax_error(ctx,
@@ -862,39 +1119,19 @@ language_error_t set_reference(language_t      *ctx,
     _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL   );
     _C_ASSERT(node != NULL, return LANGUAGE_NULL_OUTPUT);
     //-----------------------------------------------------------------------//
-    if(node->type != NODE_TYPE_IDENTIFIER) {
+    if(node_type(node) != NODE_TYPE_IDENTIFIER) {
         print_error("Node type is not identifier. Unable to get reference.\n");
         return LANGUAGE_SYNTAX_UNEXPECTED_CALL;
     }
     //-----------------------------------------------------------------------//
-    name_t *name = ctx->name_table.used_names + node->value.identifier;
-    for(size_t elem = 0; elem < ctx->name_table.size; elem++) {
-        identifier_t *ident = ctx->name_table.identifiers + elem;
-
-        if(ident->type != IDENTIFIER_FUNCTION) {
-            continue;
-        }
-        if(strncmp(ident->name, name->name, ident->length) != 0) {
-            continue;
-        }
-        node->value.identifier = elem;
-        return LANGUAGE_SUCCESS;
-    }
-    //-----------------------------------------------------------------------//
-    for(size_t elem = ctx->name_table.stack_size; elem > 0; elem--) {
-        size_t nt_index     = ctx->name_table.stack[elem - 1];
-        identifier_t *ident = ctx->name_table.identifiers + nt_index;
-
-        if(ident->length != name->length) {
-            continue;
-        }
-        if(strncmp(ident->name, name->name, ident->length) != 0) {
-            continue;
-        }
-        node->value.identifier = nt_index;
+    size_t nt_index = PoisonIndex;
+    _RETURN_IF_ERROR(name_table_find(ctx, node_identifier(node), &nt_index));
+    if(nt_index != PoisonIndex) {
+        node_set_value(node, NODE_TYPE_IDENTIFIER, IDENT(nt_index));
         return LANGUAGE_SUCCESS;
     }
     //-----------------------------------------------------------------------//
+    name_t *name = ctx->name_table.used_names + node_identifier(node);
     return syntax_error(ctx,
                         "Undefined reference to '%.*s'.\n",
                         name->length,
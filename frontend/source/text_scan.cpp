@@ -0,0 +1,275 @@
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define TEXT_SCAN_X86
+#endif
+
+//===========================================================================//
+
+#include "text_scan.h"
+
+//===========================================================================//
+
+struct text_scanner_t {
+    const char                    *(*spaces)     (const char *,
+                                                  const char *,
+                                                  size_t     *);
+    const char                    *(*comment_end)(const char *,
+                                                  const char *,
+                                                  size_t     *);
+    const char                      *name;
+};
+
+//===========================================================================//
+
+static const char           *scan_spaces_scalar      (const char *position,
+                                                      const char *end,
+                                                      size_t     *newlines);
+
+static const char           *scan_comment_end_scalar (const char *position,
+                                                      const char *end,
+                                                      size_t     *newlines);
+
+static text_scanner_t        text_scanner_select     (void);
+
+static const text_scanner_t *text_scanner            (void);
+
+static bool                  is_space_symbol         (char        symbol);
+
+//---------------------------------------------------------------------------//
+
+#ifdef TEXT_SCAN_X86
+
+static const char           *scan_spaces_sse2        (const char *position,
+                                                      const char *end,
+                                                      size_t     *newlines);
+
+static const char           *scan_comment_end_sse2   (const char *position,
+                                                      const char *end,
+                                                      size_t     *newlines);
+
+static const char           *scan_spaces_avx2        (const char *position,
+                                                      const char *end,
+                                                      size_t     *newlines);
+
+static const char           *scan_comment_end_avx2   (const char *position,
+                                                      const char *end,
+                                                      size_t     *newlines);
+
+#endif
+
+//===========================================================================//
+
+const char *scan_spaces(const char *position,
+                        const char *end,
+                        size_t     *newlines) {
+    return text_scanner()->spaces(position, end, newlines);
+}
+
+//===========================================================================//
+
+const char *scan_comment_end(const char *position,
+                             const char *end,
+                             size_t     *newlines) {
+    return text_scanner()->comment_end(position, end, newlines);
+}
+
+//===========================================================================//
+
+const char *scan_level_name(void) {
+    return text_scanner()->name;
+}
+
+//===========================================================================//
+
+const text_scanner_t *text_scanner(void) {
+    static const text_scanner_t scanner = text_scanner_select();
+    return &scanner;
+}
+
+//===========================================================================//
+
+text_scanner_t text_scanner_select(void) {
+#ifdef TEXT_SCAN_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        return {scan_spaces_avx2, scan_comment_end_avx2, "avx2"};
+    }
+    if(__builtin_cpu_supports("sse2")) {
+        return {scan_spaces_sse2, scan_comment_end_sse2, "sse2"};
+    }
+#endif
+    return {scan_spaces_scalar, scan_comment_end_scalar, "scalar"};
+}
+
+//===========================================================================//
+
+bool is_space_symbol(char symbol) {
+    return symbol == ' ' || (symbol >= '\t' && symbol <= '\r');
+}
+
+//===========================================================================//
+
+const char *scan_spaces_scalar(const char *position,
+                               const char *end,
+                               size_t     *newlines) {
+    while(position < end && is_space_symbol(*position)) {
+        if(*position == '\n') {
+            (*newlines)++;
+        }
+        position++;
+    }
+    return position;
+}
+
+//===========================================================================//
+
+const char *scan_comment_end_scalar(const char *position,
+                                    const char *end,
+                                    size_t     *newlines) {
+    while(position + 1 < end) {
+        if(position[0] == '*' && position[1] == '/') {
+            return position + 2;
+        }
+        if(position[0] == '\n') {
+            (*newlines)++;
+        }
+        position++;
+    }
+    return NULL;
+}
+
+//===========================================================================//
+
+#ifdef TEXT_SCAN_X86
+
+//===========================================================================//
+
+__attribute__((target("sse2")))
+const char *scan_spaces_sse2(const char *position,
+                             const char *end,
+                             size_t     *newlines) {
+    const __m128i space   = _mm_set1_epi8(' ');
+    const __m128i below   = _mm_set1_epi8('\t' - 1);
+    const __m128i above   = _mm_set1_epi8('\r' + 1);
+    const __m128i newline = _mm_set1_epi8('\n');
+    //-----------------------------------------------------------------------//
+    while(position + sizeof(__m128i) <= end) {
+        __m128i chunk  = _mm_loadu_si128((const __m128i *)position);
+        __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                      _mm_and_si128(_mm_cmpgt_epi8(chunk, below),
+                                                    _mm_cmplt_epi8(chunk, above)));
+        uint32_t others = ~(uint32_t)_mm_movemask_epi8(spaces) & 0xFFFFu;
+        uint32_t lines  =  (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        //-------------------------------------------------------------------//
+        if(others != 0) {
+            uint32_t first = (uint32_t)__builtin_ctz(others);
+            *newlines += (size_t)__builtin_popcount(lines & ((1u << first) - 1u));
+            return position + first;
+        }
+        *newlines += (size_t)__builtin_popcount(lines);
+        position  += sizeof(__m128i);
+    }
+    //-----------------------------------------------------------------------//
+    return scan_spaces_scalar(position, end, newlines);
+}
+
+//===========================================================================//
+
+__attribute__((target("sse2")))
+const char *scan_comment_end_sse2(const char *position,
+                                  const char *end,
+                                  size_t     *newlines) {
+    const __m128i star    = _mm_set1_epi8('*');
+    const __m128i slash   = _mm_set1_epi8('/');
+    const __m128i newline = _mm_set1_epi8('\n');
+    //-----------------------------------------------------------------------//
+    while(position + sizeof(__m128i) + 1 <= end) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) position     );
+        __m128i next  = _mm_loadu_si128((const __m128i *)(position + 1));
+        uint32_t closes = (uint32_t)_mm_movemask_epi8(
+                              _mm_and_si128(_mm_cmpeq_epi8(chunk, star ),
+                                            _mm_cmpeq_epi8(next,  slash)));
+        uint32_t lines  = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        //-------------------------------------------------------------------//
+        if(closes != 0) {
+            uint32_t first = (uint32_t)__builtin_ctz(closes);
+            *newlines += (size_t)__builtin_popcount(lines & ((1u << first) - 1u));
+            return position + first + 2;
+        }
+        *newlines += (size_t)__builtin_popcount(lines);
+        position  += sizeof(__m128i);
+    }
+    //-----------------------------------------------------------------------//
+    return scan_comment_end_scalar(position, end, newlines);
+}
+
+//===========================================================================//
+
+__attribute__((target("avx2")))
+const char *scan_spaces_avx2(const char *position,
+                             const char *end,
+                             size_t     *newlines) {
+    const __m256i space   = _mm256_set1_epi8(' ');
+    const __m256i below   = _mm256_set1_epi8('\t' - 1);
+    const __m256i above   = _mm256_set1_epi8('\r' + 1);
+    const __m256i newline = _mm256_set1_epi8('\n');
+    //-----------------------------------------------------------------------//
+    while(position + sizeof(__m256i) <= end) {
+        __m256i chunk  = _mm256_loadu_si256((const __m256i *)position);
+        __m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space),
+                                         _mm256_and_si256(_mm256_cmpgt_epi8(chunk, below),
+                                                          _mm256_cmpgt_epi8(above, chunk)));
+        uint32_t others = ~(uint32_t)_mm256_movemask_epi8(spaces);
+        uint32_t lines  =  (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline));
+        //-------------------------------------------------------------------//
+        if(others != 0) {
+            uint32_t first = (uint32_t)__builtin_ctz(others);
+            uint32_t mask  = first == 0 ? 0u : (~0u >> (32u - first));
+            *newlines += (size_t)__builtin_popcount(lines & mask);
+            return position + first;
+        }
+        *newlines += (size_t)__builtin_popcount(lines);
+        position  += sizeof(__m256i);
+    }
+    //-----------------------------------------------------------------------//
+    return scan_spaces_sse2(position, end, newlines);
+}
+
+//===========================================================================//
+
+__attribute__((target("avx2")))
+const char *scan_comment_end_avx2(const char *position,
+                                  const char *end,
+                                  size_t     *newlines) {
+    const __m256i star    = _mm256_set1_epi8('*');
+    const __m256i slash   = _mm256_set1_epi8('/');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    //-----------------------------------------------------------------------//
+    while(position + sizeof(__m256i) + 1 <= end) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *) position     );
+        __m256i next  = _mm256_loadu_si256((const __m256i *)(position + 1));
+        uint32_t closes = (uint32_t)_mm256_movemask_epi8(
+                              _mm256_and_si256(_mm256_cmpeq_epi8(chunk, star ),
+                                               _mm256_cmpeq_epi8(next,  slash)));
+        uint32_t lines  = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline));
+        //-------------------------------------------------------------------//
+        if(closes != 0) {
+            uint32_t first = (uint32_t)__builtin_ctz(closes);
+            uint32_t mask  = first == 0 ? 0u : (~0u >> (32u - first));
+            *newlines += (size_t)__builtin_popcount(lines & mask);
+            return position + first + 2;
+        }
+        *newlines += (size_t)__builtin_popcount(lines);
+        position  += sizeof(__m256i);
+    }
+    //-----------------------------------------------------------------------//
+    return scan_comment_end_sse2(position, end, newlines);
+}
+
+//===========================================================================//
+
+#endif
+
+//===========================================================================//
@@ -9,6 +9,8 @@
 #include "colors.h"
 #include "name_table.h"
 #include "custom_assert.h"
+#include "mapped_file.h"
+#include "output.h"
 
 //===========================================================================//
 
@@ -27,11 +29,15 @@ language_error_t frontstart_ctor(language_t *ctx, int argc, const char *argv[])
 language_error_t frontstart_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    free(ctx->input);
-    ctx->input = NULL;
+    _RETURN_IF_ERROR(input_close(ctx));
     _RETURN_IF_ERROR(nodes_storage_dtor(ctx));
     _RETURN_IF_ERROR(name_table_dtor(ctx));
     _RETURN_IF_ERROR(dump_dtor(ctx));
+    _RETURN_IF_ERROR(output_dtor(&ctx->frontstart_info.buffer));
+    if(ctx->frontstart_info.output != NULL) {
+        fclose(ctx->frontstart_info.output);
+        ctx->frontstart_info.output = NULL;
+    }
 
     return LANGUAGE_SUCCESS;
 }
@@ -40,7 +46,7 @@ language_error_t frontstart_dtor(language_t *ctx) {
 
 language_error_t frontstart_write(language_t *ctx) {
     _C_ASSERT(ctx       != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(ctx->root != NULL, return LANGUAGE_ROOT_NULL);
+    _C_ASSERT(ctx->root != NodeNone, return LANGUAGE_ROOT_NULL);
     //-----------------------------------------------------------------------//
     ctx->frontstart_info.output = fopen(ctx->output_file, "wb");
     if(ctx->frontstart_info.output == NULL) {
@@ -48,13 +54,17 @@ language_error_t frontstart_write(language_t *ctx) {
         return LANGUAGE_OPENING_FILE_ERROR;
     }
     //-----------------------------------------------------------------------//
-    language_node_t *node = ctx->root;
+    language_node_t *node = nodes_storage_get(ctx, ctx->root);
     while(node != NULL) {
-        _RETURN_IF_ERROR(to_source_subtree(ctx, node->left));
-        fprintf(ctx->frontstart_info.output, "\r\n\r\n");
-        node = node->right;
+        _RETURN_IF_ERROR(to_source_subtree(ctx, node_left(ctx, node)));
+        _RETURN_IF_ERROR(output_string(&ctx->frontstart_info.buffer,
+                                       "\r\n\r\n",
+                                       4));
+        node = node_right(ctx, node);
     }
-    return LANGUAGE_SUCCESS;
+    //-----------------------------------------------------------------------//
+    return output_flush(&ctx->frontstart_info.buffer,
+                        ctx->frontstart_info.output);
 }
 
 //===========================================================================//
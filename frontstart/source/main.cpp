@@ -32,12 +32,6 @@ int main(int argc, const char *argv[]) {
     color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully initialized context\n");
     //-----------------------------------------------------------------------//
-    if(read_tree(&ctx) != LANGUAGE_SUCCESS) {
-        return main_exit_failure(&ctx);
-    }
-    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                 "Successfully read tree\n");
-    //-----------------------------------------------------------------------//
     if(dump_tree(&ctx, "dump after reading") != LANGUAGE_SUCCESS) {
         return main_exit_failure(&ctx);
     }
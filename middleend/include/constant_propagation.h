@@ -0,0 +1,77 @@
+#ifndef CONSTANT_PROPAGATION_H
+#define CONSTANT_PROPAGATION_H
+
+//===========================================================================//
+
+#include "language.h"
+#include "worklist.h"
+#include "tree_visitor.h"
+
+//===========================================================================//
+
+/* Flow-sensitive constant propagation over function bodies. Every
+   variable used by a function gets a slot, state of the function is a
+   block of slots with known values, slot 0 tells if the point is
+   reachable. Statements are walked in order: assignment and declaration
+   set the value of the variable if the right side folds to a number,
+   input makes it unknown, return makes the rest unreachable. Branch of
+   if is walked on a copy of the state and both are merged after it,
+   values which differ become unknown. Loop starts with all variables
+   assigned in it unknown, so its body and condition see only values
+   which hold on every iteration. Calls may change globals, so reads of
+   globals are not replaced in expressions with calls and globals are
+   unknown after them. Reads of variables with known values are replaced
+   by numbers and expressions are folded by the worklist at once, so
+   later statements see the folded values and the function needs no other
+   folding. Subtrees shared by dag input are copied first, so replacement
+   never changes other places, shared numbers are never changed and stay
+   shared.                                                                */
+
+//===========================================================================//
+
+struct propagation_value_t {
+    double                           value;
+    bool                             is_known;
+};
+
+//---------------------------------------------------------------------------//
+
+struct propagation_t {
+    worklist_t                      *worklist;
+    uint32_t                         epoch;
+    size_t                          *slots;
+    uint32_t                        *slots_epoch;
+    size_t                           names_capacity;
+    uint32_t                        *seen;
+    size_t                           nodes_capacity;
+    size_t                           slots_number;
+    size_t                          *globals;
+    size_t                           globals_number;
+    size_t                           globals_capacity;
+    propagation_value_t             *states;
+    size_t                           states_size;
+    size_t                           states_capacity;
+    uint32_t                        *reads;
+    size_t                           reads_number;
+    size_t                           reads_capacity;
+    size_t                           state;
+    bool                             has_call;
+    tree_visitor_t                   unshare;
+    tree_visitor_t                   substitute;
+    tree_visitor_t                   kill;
+};
+
+//===========================================================================//
+
+language_error_t propagation_ctor    (propagation_t *propagation,
+                                      worklist_t    *worklist);
+
+language_error_t propagate_constants (language_t    *ctx,
+                                      propagation_t *propagation,
+                                      uint32_t      *statement);
+
+language_error_t propagation_dtor    (propagation_t *propagation);
+
+//===========================================================================//
+
+#endif
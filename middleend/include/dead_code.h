@@ -0,0 +1,68 @@
+#ifndef DEAD_CODE_H
+#define DEAD_CODE_H
+
+//===========================================================================//
+
+#include "language.h"
+#include "tree_visitor.h"
+
+//===========================================================================//
+
+/* Dead code elimination over folded function bodies. Statements after
+   return and if or while with condition folded to zero are unlinked from
+   their chains. Then the body is walked backwards with the set of local
+   variables which are read later (live), loop takes passes over its body
+   until the set at its start does not grow. Assignment to a local which
+   is not live is removed and dead initializer of declaration is dropped,
+   unless the right side has a call. Declarations of locals with no other
+   uses and ifs with empty bodies are removed after that. Input, output,
+   calls and writes of globals are never removed. Functions which can not
+   be reached from main by calls are removed from the whole program. All
+   eliminations are written to the dump.                                  */
+
+//===========================================================================//
+
+struct elimination_t {
+    uint32_t                         epoch;
+    size_t                          *slots;
+    uint32_t                        *slots_epoch;
+    size_t                           names_capacity;
+    size_t                           slots_number;
+    size_t                          *references;
+    size_t                           references_capacity;
+    bool                            *live;
+    size_t                           live_size;
+    size_t                           live_capacity;
+    uint32_t                       **links;
+    size_t                           links_size;
+    size_t                           links_capacity;
+    size_t                           block;
+    bool                             is_reading;
+    bool                             has_call;
+    size_t                           function;
+    uint32_t                        *functions;
+    bool                            *reached;
+    size_t                          *called;
+    size_t                           called_number;
+    tree_visitor_t                   collect;
+    tree_visitor_t                   reads;
+    tree_visitor_t                   count;
+    tree_visitor_t                   calls;
+};
+
+//===========================================================================//
+
+language_error_t elimination_ctor    (elimination_t *elimination);
+
+language_error_t eliminate_dead_code (language_t    *ctx,
+                                      elimination_t *elimination,
+                                      uint32_t      *statement);
+
+language_error_t eliminate_functions (language_t    *ctx,
+                                      elimination_t *elimination);
+
+language_error_t elimination_dtor    (elimination_t *elimination);
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef INLINER_H
+#define INLINER_H
+
+//===========================================================================//
+
+#include "language.h"
+#include "tree_visitor.h"
+
+//===========================================================================//
+
+/* Inlining of calls into function bodies. Functions are taken callees
+   first (strongly connected components of the call graph are found in
+   reverse topological order), functions of cycles are never inlined. Call
+   is inlined if the body of the callee is not bigger than the limit plus
+   the cost of the call and of its constant arguments, or if it is the only
+   call of the function, which is removed after that. Growth of one
+   function is bounded by a multiple of the limit. Arguments become
+   declarations of parameters, the body is copied before the statement
+   with the call and the call is replaced by the variable with the result,
+   all locals of the callee get new names in the name table. Return
+   becomes assignment of the result, return inside if or while also clears
+   the running flag and the statements after it are run only while the
+   flag is set, loop with return checks its condition in the body. Call is
+   moved before its statement only if the rest of the statement does not
+   depend on the order, calls in conditions of loops are kept.            */
+
+//===========================================================================//
+
+struct inline_summary_t {
+    size_t                           size;
+    bool                             has_call;
+    bool                             has_io;
+    bool                             writes_globals;
+    bool                             reads_globals;
+};
+
+//---------------------------------------------------------------------------//
+
+struct inline_function_t {
+    uint32_t                         definition;
+    size_t                           calls;
+    size_t                           first_edge;
+    size_t                           last_edge;
+    size_t                           next_edge;
+    size_t                           index;
+    size_t                           lowlink;
+    bool                             is_visited;
+    bool                             is_on_stack;
+    bool                             is_recursive;
+    inline_summary_t                 summary;
+};
+
+//---------------------------------------------------------------------------//
+
+struct inliner_t {
+    size_t                           limit;
+    inline_function_t               *functions;
+    size_t                           functions_number;
+    size_t                           main_function;
+    size_t                          *edges;
+    size_t                           edges_size;
+    size_t                           edges_capacity;
+    size_t                          *order;
+    size_t                           order_size;
+    size_t                          *stack;
+    size_t                           stack_size;
+    size_t                          *frames;
+    size_t                           frames_size;
+    size_t                           counter;
+    uint32_t                         epoch;
+    size_t                          *renamed;
+    uint32_t                        *renamed_epoch;
+    size_t                           names_capacity;
+    size_t                           caller;
+    size_t                           callee;
+    size_t                           growth;
+    size_t                           result;
+    size_t                           running;
+    uint32_t                        *expression;
+    uint32_t                        *call;
+    uint32_t                         skipped;
+    inline_summary_t                 summary;
+    tree_visitor_t                   scan;
+    tree_visitor_t                   measure;
+    tree_visitor_t                   search;
+    tree_visitor_t                   copy;
+};
+
+//===========================================================================//
+
+language_error_t inliner_ctor        (inliner_t     *inliner);
+
+language_error_t inline_functions    (language_t    *ctx,
+                                      inliner_t     *inliner);
+
+language_error_t inliner_dtor        (inliner_t     *inliner);
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef MIDDLEEND_UTILS_H
+#define MIDDLEEND_UTILS_H
+
+//===========================================================================//
+
+#include "language.h"
+#include "nodes_dsl.h"
+#include "utils.h"
+
+//===========================================================================//
+
+language_error_t add_node           (language_t        *ctx,
+                                     node_type_t        type,
+                                     value_t            value,
+                                     uint32_t           left,
+                                     uint32_t           right,
+                                     uint32_t          *output);
+
+language_error_t add_assignment     (language_t        *ctx,
+                                     size_t             identifier,
+                                     uint32_t           value,
+                                     bool               is_declaration,
+                                     uint32_t          *output);
+
+language_error_t fresh_variable     (language_t        *ctx,
+                                     size_t             function,
+                                     name_t             name,
+                                     size_t            *output);
+
+language_error_t guard_rest         (language_t        *ctx,
+                                     size_t             flag,
+                                     bool               is_inverted,
+                                     language_node_t   *chain,
+                                     uint32_t         **link);
+
+//===========================================================================//
+
+static inline identifier_t *identifier_of(language_t *ctx, size_t identifier) {
+    return ctx->name_table.identifiers + identifier;
+}
+
+//---------------------------------------------------------------------------//
+
+static inline bool is_global_variable(language_t *ctx, language_node_t *node) {
+    return is_ident_type(ctx, node, IDENTIFIER_VARIABLE) &&
+           identifier_of(ctx, node_identifier(node))->is_global;
+}
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TAIL_RECURSION_H
+#define TAIL_RECURSION_H
+
+//===========================================================================//
+
+#include "language.h"
+#include "tree_visitor.h"
+
+//===========================================================================//
+
+/* Self tail calls are replaced by loops. Return of a call of the function
+   itself (in the body or in ifs, not in loops, which can not be left
+   without return) becomes assignment of arguments to parameters and of one
+   to the again flag, body is put into while(again) which clears the flag
+   at the start of every iteration. Statements after an if with such call
+   are run only if the flag is not set. Argument which reads a parameter
+   assigned before it is computed into a temporary first, argument equal to
+   its parameter is not assigned. Call is not replaced if its arguments do
+   not commute, as backends compute them in different orders.            */
+
+//===========================================================================//
+
+struct tail_recursion_t {
+    size_t                           function;
+    size_t                           again;
+    size_t                          *parameters;
+    size_t                           parameters_number;
+    size_t                           parameters_capacity;
+    bool                            *is_assigned;
+    size_t                           assigned_capacity;
+    bool                             reads_assigned;
+    bool                             reads_globals;
+    bool                             has_call;
+    tree_visitor_t                   reads;
+};
+
+//===========================================================================//
+
+language_error_t tail_recursion_ctor (tail_recursion_t *tail);
+
+language_error_t eliminate_tail_calls(language_t       *ctx,
+                                      tail_recursion_t *tail,
+                                      uint32_t         *statement);
+
+language_error_t tail_recursion_dtor (tail_recursion_t *tail);
+
+//===========================================================================//
+
+#endif
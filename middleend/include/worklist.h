@@ -0,0 +1,55 @@
+#ifndef WORKLIST_H
+#define WORKLIST_H
+
+//===========================================================================//
+
+#include "language.h"
+
+//===========================================================================//
+
+/* Worklist of nodes for local rewrites. All nodes of a subtree are queued
+   parents first and popped from the end, so children are rewritten before
+   their parents and one sweep reaches the fixpoint of local rules. Parent
+   links are kept by node index. Rules are applied to a node until none of
+   them changes it (in place or by replacing it in its link), then the
+   parent of a changed node is queued again if it is not in the worklist,
+   so a rewrite costs only the visits of its ancestors, not another pass
+   over the whole tree. Rule reports a change by increasing changes
+   counter of middleend info.                                             */
+
+//===========================================================================//
+
+typedef language_error_t (*worklist_rule_t)(language_t *ctx, uint32_t *node);
+
+//---------------------------------------------------------------------------//
+
+struct worklist_t {
+    const worklist_rule_t           *rules;
+    size_t                           rules_number;
+    uint32_t                        *nodes;
+    size_t                           size;
+    size_t                           capacity;
+    uint32_t                        *parents;
+    bool                            *queued;
+    size_t                           links_capacity;
+};
+
+//===========================================================================//
+
+language_error_t worklist_ctor    (worklist_t            *worklist,
+                                   const worklist_rule_t *rules,
+                                   size_t                 rules_number);
+
+language_error_t worklist_run     (language_t            *ctx,
+                                   worklist_t            *worklist,
+                                   uint32_t              *root);
+
+language_error_t worklist_rewrite (language_t            *ctx,
+                                   worklist_t            *worklist,
+                                   uint32_t              *node);
+
+language_error_t worklist_dtor    (worklist_t            *worklist);
+
+//===========================================================================//
+
+#endif
@@ -0,0 +1,502 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "constant_propagation.h"
+#include "middleend_utils.h"
+#include "worklist.h"
+#include "tree_visitor.h"
+#include "nodes_dsl.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static const size_t PropagationNoState = SIZE_MAX;
+
+//===========================================================================//
+
+static language_error_t reserve_names        (language_t           *ctx,
+                                              propagation_t        *propagation);
+
+static language_error_t unshare_node         (language_t           *ctx,
+                                              visit_frame_t        *frame,
+                                              void                 *data);
+
+static language_error_t add_slot             (language_t           *ctx,
+                                              propagation_t        *propagation,
+                                              size_t                identifier);
+
+static size_t           slot_of              (propagation_t        *propagation,
+                                              language_node_t      *node);
+
+static language_error_t state_push           (propagation_t        *propagation,
+                                              size_t                from,
+                                              size_t               *state);
+
+static void             state_merge          (propagation_t        *propagation,
+                                              size_t                to,
+                                              size_t                from);
+
+static void             set_variable         (propagation_t        *propagation,
+                                              size_t                state,
+                                              language_node_t      *node,
+                                              propagation_value_t   value);
+
+static void             kill_globals         (propagation_t        *propagation,
+                                              size_t                state);
+
+static language_error_t propagate_chain      (language_t           *ctx,
+                                              propagation_t        *propagation,
+                                              uint32_t              chain,
+                                              size_t                state);
+
+static language_error_t propagate_statement  (language_t           *ctx,
+                                              propagation_t        *propagation,
+                                              uint32_t             *link,
+                                              size_t                state);
+
+static language_error_t propagate_assignment (language_t           *ctx,
+                                              propagation_t        *propagation,
+                                              language_node_t      *node,
+                                              size_t                state);
+
+static language_error_t propagate_loop       (language_t           *ctx,
+                                              propagation_t        *propagation,
+                                              language_node_t      *node,
+                                              size_t                state);
+
+static language_error_t propagate_expression (language_t           *ctx,
+                                              propagation_t        *propagation,
+                                              uint32_t             *link,
+                                              size_t                state,
+                                              propagation_value_t  *result);
+
+static language_error_t substitute_read      (language_t           *ctx,
+                                              visit_frame_t        *frame,
+                                              void                 *data);
+
+static language_error_t kill_assigned        (language_t           *ctx,
+                                              visit_frame_t        *frame,
+                                              void                 *data);
+
+//===========================================================================//
+
+static inline propagation_value_t *state_at(propagation_t *propagation, size_t state) {
+    return propagation->states + state;
+}
+
+//===========================================================================//
+
+language_error_t propagation_ctor(propagation_t *propagation,
+                                  worklist_t    *worklist) {
+    _C_ASSERT(propagation != NULL, return LANGUAGE_NULL_OUTPUT);
+    _C_ASSERT(worklist    != NULL, return LANGUAGE_INPUT_NULL );
+    //-----------------------------------------------------------------------//
+    *propagation                 = {};
+    propagation->worklist        = worklist;
+    propagation->unshare   .pre  = unshare_node;
+    propagation->unshare   .data = propagation;
+    propagation->substitute.pre  = substitute_read;
+    propagation->substitute.data = propagation;
+    propagation->kill      .pre  = kill_assigned;
+    propagation->kill      .data = propagation;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t propagate_constants(language_t    *ctx,
+                                     propagation_t *propagation,
+                                     uint32_t      *statement) {
+    _C_ASSERT(ctx         != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(propagation != NULL, return LANGUAGE_NODE_NULL);
+    _C_ASSERT(statement   != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // Globals are assigned by any function, so only bodies are walked,
+    // other statements are only folded.
+    if(!is_node_oper_eq(nodes_storage_get(ctx, *statement), OPERATION_NEW_FUNC)) {
+        return worklist_run(ctx, propagation->worklist, statement);
+    }
+    // Marks of other functions have other epoch, so they are not cleared.
+    propagation->epoch++;
+    if(propagation->epoch == 0) {
+        memset(propagation->seen       , 0, propagation->nodes_capacity * sizeof(uint32_t));
+        memset(propagation->slots_epoch, 0, propagation->names_capacity * sizeof(uint32_t));
+        propagation->epoch = 1;
+    }
+    propagation->slots_number   = 0;
+    propagation->globals_number = 0;
+    propagation->states_size    = 0;
+    _RETURN_IF_ERROR(reserve_names(ctx, propagation));
+    _RETURN_IF_ERROR(tree_visit(ctx, &propagation->unshare, statement));
+    //-----------------------------------------------------------------------//
+    size_t state = 0;
+    _RETURN_IF_ERROR(state_push(propagation, PropagationNoState, &state));
+    language_node_t *function = node_left(ctx, nodes_storage_get(ctx, *statement));
+    return propagate_chain(ctx, propagation, function->right, state);
+}
+
+//===========================================================================//
+
+language_error_t propagation_dtor(propagation_t *propagation) {
+    _C_ASSERT(propagation != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    free(propagation->slots      );
+    free(propagation->slots_epoch);
+    free(propagation->seen       );
+    free(propagation->globals    );
+    free(propagation->states     );
+    free(propagation->reads      );
+    tree_visitor_dtor(&propagation->unshare   );
+    tree_visitor_dtor(&propagation->substitute);
+    tree_visitor_dtor(&propagation->kill      );
+    *propagation = {};
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t reserve_names(language_t *ctx, propagation_t *propagation) {
+    size_t capacity = propagation->names_capacity;
+    _RETURN_IF_ERROR(reserve_elements((void **)&propagation->slots,
+                                      &capacity,
+                                      ctx->name_table.size,
+                                      sizeof(propagation->slots[0])));
+    capacity = propagation->names_capacity;
+    _RETURN_IF_ERROR(reserve_elements((void **)&propagation->slots_epoch,
+                                      &capacity,
+                                      ctx->name_table.size,
+                                      sizeof(propagation->slots_epoch[0])));
+    propagation->names_capacity = capacity;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t unshare_node(language_t    *ctx,
+                              visit_frame_t *frame,
+                              void          *data) {
+    // Node met second time is shared, it is replaced by a copy and its
+    // children are reached through the copy, so whole subtree is copied.
+    // Numbers are never changed in place, so they stay shared.
+    propagation_t *propagation = (propagation_t *)data;
+    _RETURN_IF_ERROR(reserve_elements((void **)&propagation->seen,
+                                      &propagation->nodes_capacity,
+                                      ctx->nodes.size + 1,
+                                      sizeof(propagation->seen[0])));
+    if(propagation->seen[*frame->link] == propagation->epoch &&
+       !is_node_type_eq(nodes_storage_get(ctx, *frame->link), NODE_TYPE_NUMBER)) {
+        language_node_t copy = *nodes_storage_get(ctx, *frame->link);
+        _RETURN_IF_ERROR(nodes_storage_add(ctx, node_type(&copy), node_value(&copy), NULL, 0, frame->link));
+        *nodes_storage_get(ctx, *frame->link) = copy;
+        _RETURN_IF_ERROR(reserve_elements((void **)&propagation->seen,
+                                          &propagation->nodes_capacity,
+                                          ctx->nodes.size + 1,
+                                          sizeof(propagation->seen[0])));
+    }
+    propagation->seen[*frame->link] = propagation->epoch;
+    //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *frame->link);
+    if(is_ident_type(ctx, node, IDENTIFIER_VARIABLE)) {
+        _RETURN_IF_ERROR(add_slot(ctx, propagation, node_identifier(node)));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t add_slot(language_t    *ctx,
+                          propagation_t *propagation,
+                          size_t         identifier) {
+    // Slot 0 of the state is reachability, so slots start from 1.
+    if(propagation->slots_epoch[identifier] == propagation->epoch) {
+        return LANGUAGE_SUCCESS;
+    }
+    propagation->slots_epoch[identifier] = propagation->epoch;
+    propagation->slots      [identifier] = ++propagation->slots_number;
+    if(identifier_of(ctx, identifier)->is_global) {
+        _RETURN_IF_ERROR(reserve_elements((void **)&propagation->globals,
+                                          &propagation->globals_capacity,
+                                          propagation->globals_number + 1,
+                                          sizeof(propagation->globals[0])));
+        propagation->globals[propagation->globals_number++] = propagation->slots_number;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+size_t slot_of(propagation_t *propagation, language_node_t *node) {
+    size_t identifier = node_identifier(node);
+    if(propagation->slots_epoch[identifier] != propagation->epoch) {
+        return 0;
+    }
+    return propagation->slots[identifier];
+}
+
+//===========================================================================//
+
+language_error_t state_push(propagation_t *propagation,
+                            size_t         from,
+                            size_t        *state) {
+    // States are blocks of one stack, nested branches are popped in order.
+    size_t block = propagation->slots_number + 1;
+    _RETURN_IF_ERROR(reserve_elements((void **)&propagation->states,
+                                      &propagation->states_capacity,
+                                      propagation->states_size + block,
+                                      sizeof(propagation->states[0])));
+    *state = propagation->states_size;
+    propagation->states_size += block;
+    propagation_value_t *values = state_at(propagation, *state);
+    if(from != PropagationNoState) {
+        memcpy(values, state_at(propagation, from), block * sizeof(values[0]));
+        return LANGUAGE_SUCCESS;
+    }
+    memset(values, 0, block * sizeof(values[0]));
+    values[0].is_known = true;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void state_merge(propagation_t *propagation, size_t to, size_t from) {
+    // Unreachable state brings nothing, value stays known only if it is
+    // the same number in both states.
+    propagation_value_t *first  = state_at(propagation, to  );
+    propagation_value_t *second = state_at(propagation, from);
+    if(!second[0].is_known) {
+        return;
+    }
+    if(!first[0].is_known) {
+        memcpy(first, second, (propagation->slots_number + 1) * sizeof(first[0]));
+        return;
+    }
+    for(size_t slot = 1; slot <= propagation->slots_number; slot++) {
+        if(!second[slot].is_known ||
+           memcmp(&first[slot].value, &second[slot].value, sizeof(first[slot].value)) != 0) {
+            first[slot].is_known = false;
+        }
+    }
+}
+
+//===========================================================================//
+
+void set_variable(propagation_t       *propagation,
+                  size_t               state,
+                  language_node_t     *node,
+                  propagation_value_t  value) {
+    size_t slot = slot_of(propagation, node);
+    if(slot != 0) {
+        state_at(propagation, state)[slot] = value;
+    }
+}
+
+//===========================================================================//
+
+void kill_globals(propagation_t *propagation, size_t state) {
+    propagation_value_t *values = state_at(propagation, state);
+    for(size_t global = 0; global < propagation->globals_number; global++) {
+        values[propagation->globals[global]].is_known = false;
+    }
+}
+
+//===========================================================================//
+
+language_error_t propagate_chain(language_t    *ctx,
+                                 propagation_t *propagation,
+                                 uint32_t       chain,
+                                 size_t         state) {
+    while(chain != NodeNone) {
+        language_node_t *node = nodes_storage_get(ctx, chain);
+        if(!is_node_oper_eq(node, OPERATION_STATEMENT)) {
+            return propagate_statement(ctx, propagation, &chain, state);
+        }
+        if(node->left != NodeNone) {
+            _RETURN_IF_ERROR(propagate_statement(ctx, propagation, &node->left, state));
+        }
+        chain = node->right;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t propagate_statement(language_t    *ctx,
+                                     propagation_t *propagation,
+                                     uint32_t      *link,
+                                     size_t         state) {
+    language_node_t *node = nodes_storage_get(ctx, *link);
+    if(!is_node_type_eq(node, NODE_TYPE_OPERATION)) {
+        return propagate_expression(ctx, propagation, link, state, NULL);
+    }
+    operation_t opcode = node_opcode(node);
+    //-----------------------------------------------------------------------//
+    if(opcode == OPERATION_NEW_VAR) {
+        if(is_node_oper_eq(node_left(ctx, node), OPERATION_ASSIGNMENT)) {
+            return propagate_assignment(ctx, propagation, node_left(ctx, node), state);
+        }
+        set_variable(propagation, state, node_left(ctx, node), {});
+        return LANGUAGE_SUCCESS;
+    }
+    if(opcode == OPERATION_ASSIGNMENT) {
+        return propagate_assignment(ctx, propagation, node, state);
+    }
+    if(opcode == OPERATION_WHILE) {
+        return propagate_loop(ctx, propagation, node, state);
+    }
+    //-----------------------------------------------------------------------//
+    if(opcode == OPERATION_IF) {
+        _RETURN_IF_ERROR(propagate_expression(ctx, propagation, &node->left, state, NULL));
+        size_t branch = 0;
+        _RETURN_IF_ERROR(state_push(propagation, state, &branch));
+        _RETURN_IF_ERROR(propagate_chain(ctx, propagation, node->right, branch));
+        state_merge(propagation, state, branch);
+        propagation->states_size = branch;
+        return LANGUAGE_SUCCESS;
+    }
+    if(opcode == OPERATION_RETURN) {
+        if(node->left != NodeNone) {
+            _RETURN_IF_ERROR(propagate_expression(ctx, propagation, &node->left, state, NULL));
+        }
+        state_at(propagation, state)[0].is_known = false;
+        return LANGUAGE_SUCCESS;
+    }
+    if(opcode == OPERATION_IN) {
+        set_variable(propagation, state, node_left(ctx, node_left(ctx, node)), {});
+        return LANGUAGE_SUCCESS;
+    }
+    if(opcode == OPERATION_OUT) {
+        return propagate_expression(ctx, propagation, &node_left(ctx, node)->left, state, NULL);
+    }
+    //-----------------------------------------------------------------------//
+    return propagate_expression(ctx, propagation, link, state, NULL);
+}
+
+//===========================================================================//
+
+language_error_t propagate_assignment(language_t      *ctx,
+                                      propagation_t   *propagation,
+                                      language_node_t *node,
+                                      size_t           state) {
+    propagation_value_t value = {};
+    _RETURN_IF_ERROR(propagate_expression(ctx, propagation, &node->right, state, &value));
+    set_variable(propagation, state, node_left(ctx, node), value);
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t propagate_loop(language_t      *ctx,
+                                propagation_t   *propagation,
+                                language_node_t *node,
+                                size_t           state) {
+    // Condition and body see values from before the loop and from the end
+    // of any iteration, so variables assigned in the loop are unknown.
+    propagation->state = state;
+    _RETURN_IF_ERROR(tree_visit(ctx, &propagation->kill, &node->left ));
+    _RETURN_IF_ERROR(tree_visit(ctx, &propagation->kill, &node->right));
+    _RETURN_IF_ERROR(propagate_expression(ctx, propagation, &node->left, state, NULL));
+    size_t body = 0;
+    _RETURN_IF_ERROR(state_push(propagation, state, &body));
+    _RETURN_IF_ERROR(propagate_chain(ctx, propagation, node->right, body));
+    state_merge(propagation, state, body);
+    propagation->states_size = body;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t propagate_expression(language_t          *ctx,
+                                      propagation_t       *propagation,
+                                      uint32_t            *link,
+                                      size_t               state,
+                                      propagation_value_t *result) {
+    // Order of calls and reads of globals is not tracked, so globals are
+    // replaced only if expression has no calls.
+    propagation->state        = state;
+    propagation->has_call     = false;
+    propagation->reads_number = 0;
+    _RETURN_IF_ERROR(tree_visit(ctx, &propagation->substitute, link));
+    propagation_value_t *values = state_at(propagation, state);
+    for(size_t read = 0; read < propagation->reads_number && !propagation->has_call; read++) {
+        language_node_t *node = nodes_storage_get(ctx, propagation->reads[read]);
+        _RETURN_IF_ERROR(set_val(node,
+                                 NODE_TYPE_NUMBER,
+                                 NUMBER(values[slot_of(propagation, node)].value),
+                                 NodeNone, NodeNone));
+        ctx->middleend_info.propagated_constants++;
+    }
+    if(propagation->has_call) {
+        kill_globals(propagation, state);
+    }
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(worklist_run(ctx, propagation->worklist, link));
+    if(result != NULL) {
+        language_node_t *node = nodes_storage_get(ctx, *link);
+        *result = {};
+        if(is_node_type_eq(node, NODE_TYPE_NUMBER)) {
+            result->value    = node_number(node);
+            result->is_known = true;
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t substitute_read(language_t    *ctx,
+                                 visit_frame_t *frame,
+                                 void          *data) {
+    propagation_t   *propagation = (propagation_t *)data;
+    language_node_t *node        = nodes_storage_get(ctx, *frame->link);
+    if(is_node_oper_eq(node, OPERATION_CALL) || is_ident_type(ctx, node, IDENTIFIER_FUNCTION)) {
+        propagation->has_call = true;
+        return LANGUAGE_SUCCESS;
+    }
+    if(!is_ident_type(ctx, node, IDENTIFIER_VARIABLE)) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // Unreachable code keeps its reads.
+    propagation_value_t *values = state_at(propagation, propagation->state);
+    size_t               slot   = slot_of(propagation, node);
+    if(!values[0].is_known || slot == 0 || !values[slot].is_known) {
+        return LANGUAGE_SUCCESS;
+    }
+    if(is_global_variable(ctx, node)) {
+        _RETURN_IF_ERROR(reserve_elements((void **)&propagation->reads,
+                                          &propagation->reads_capacity,
+                                          propagation->reads_number + 1,
+                                          sizeof(propagation->reads[0])));
+        propagation->reads[propagation->reads_number++] = *frame->link;
+        return LANGUAGE_SUCCESS;
+    }
+    _RETURN_IF_ERROR(set_val(node, NODE_TYPE_NUMBER, NUMBER(values[slot].value), NodeNone, NodeNone));
+    ctx->middleend_info.propagated_constants++;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t kill_assigned(language_t    *ctx,
+                               visit_frame_t *frame,
+                               void          *data) {
+    propagation_t   *propagation = (propagation_t *)data;
+    language_node_t *node        = nodes_storage_get(ctx, *frame->link);
+    if(is_node_oper_eq(node, OPERATION_ASSIGNMENT)) {
+        set_variable(propagation, propagation->state, node_left(ctx, node), {});
+    }
+    else if(is_node_oper_eq(node, OPERATION_IN)) {
+        set_variable(propagation, propagation->state, node_left(ctx, node_left(ctx, node)), {});
+    }
+    else if(is_node_oper_eq(node, OPERATION_CALL) || is_ident_type(ctx, node, IDENTIFIER_FUNCTION)) {
+        kill_globals(propagation, propagation->state);
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
@@ -0,0 +1,679 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "dead_code.h"
+#include "middleend_utils.h"
+#include "tree_visitor.h"
+#include "lang_dump.h"
+#include "nodes_dsl.h"
+#include "asm_x86.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static const size_t EliminationNoBlock = SIZE_MAX;
+
+//===========================================================================//
+
+static language_error_t reserve_names        (language_t      *ctx,
+                                              elimination_t   *elimination);
+
+static size_t           slot_of              (elimination_t   *elimination,
+                                              language_node_t *node);
+
+static language_error_t live_push            (elimination_t   *elimination,
+                                              size_t           from,
+                                              size_t          *block);
+
+static bool             live_merge           (elimination_t   *elimination,
+                                              size_t           to,
+                                              size_t           from);
+
+static void             live_kill            (elimination_t   *elimination,
+                                              size_t           block,
+                                              language_node_t *node);
+
+static language_error_t live_reads           (language_t      *ctx,
+                                              elimination_t   *elimination,
+                                              uint32_t        *link,
+                                              size_t           block);
+
+static language_error_t has_call             (language_t      *ctx,
+                                              elimination_t   *elimination,
+                                              uint32_t        *link,
+                                              bool            *result);
+
+static bool             is_never_run         (language_t      *ctx,
+                                              language_node_t *node);
+
+static language_error_t eliminate_chain      (language_t      *ctx,
+                                              elimination_t   *elimination,
+                                              uint32_t        *link,
+                                              size_t           block,
+                                              bool             is_final);
+
+static language_error_t eliminate_statement  (language_t      *ctx,
+                                              elimination_t   *elimination,
+                                              uint32_t        *link,
+                                              size_t           block,
+                                              bool             is_final);
+
+static language_error_t eliminate_store      (language_t      *ctx,
+                                              elimination_t   *elimination,
+                                              language_node_t *assignment,
+                                              size_t           block,
+                                              bool            *is_dead);
+
+static language_error_t eliminate_loop       (language_t      *ctx,
+                                              elimination_t   *elimination,
+                                              language_node_t *node,
+                                              size_t           block,
+                                              bool             is_final);
+
+static language_error_t remove_declarations  (language_t      *ctx,
+                                              elimination_t   *elimination,
+                                              uint32_t        *link);
+
+static language_error_t report               (language_t      *ctx,
+                                              elimination_t   *elimination,
+                                              const char      *action,
+                                              language_node_t *node);
+
+static language_error_t collect_local        (language_t      *ctx,
+                                              visit_frame_t   *frame,
+                                              void            *data);
+
+static language_error_t read_local           (language_t      *ctx,
+                                              visit_frame_t   *frame,
+                                              void            *data);
+
+static language_error_t count_local          (language_t      *ctx,
+                                              visit_frame_t   *frame,
+                                              void            *data);
+
+static language_error_t reach_callee         (language_t      *ctx,
+                                              visit_frame_t   *frame,
+                                              void            *data);
+
+//===========================================================================//
+
+static inline bool *live_at(elimination_t *elimination, size_t block) {
+    return elimination->live + block;
+}
+
+//===========================================================================//
+
+language_error_t elimination_ctor(elimination_t *elimination) {
+    _C_ASSERT(elimination != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    *elimination              = {};
+    elimination->collect.pre  = collect_local;
+    elimination->collect.data = elimination;
+    elimination->reads  .pre  = read_local;
+    elimination->reads  .data = elimination;
+    elimination->count  .pre  = count_local;
+    elimination->count  .data = elimination;
+    elimination->calls  .pre  = reach_callee;
+    elimination->calls  .data = elimination;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t eliminate_dead_code(language_t    *ctx,
+                                     elimination_t *elimination,
+                                     uint32_t      *statement) {
+    _C_ASSERT(ctx         != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(elimination != NULL, return LANGUAGE_NODE_NULL);
+    _C_ASSERT(statement   != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // Globals may be read by other functions, so only locals are tracked.
+    if(!is_node_oper_eq(nodes_storage_get(ctx, *statement), OPERATION_NEW_FUNC)) {
+        return LANGUAGE_SUCCESS;
+    }
+    elimination->epoch++;
+    if(elimination->epoch == 0) {
+        memset(elimination->slots_epoch, 0, elimination->names_capacity * sizeof(uint32_t));
+        elimination->epoch = 1;
+    }
+    elimination->slots_number = 0;
+    elimination->live_size    = 0;
+    elimination->links_size   = 0;
+    _RETURN_IF_ERROR(reserve_names(ctx, elimination));
+    _RETURN_IF_ERROR(tree_visit(ctx, &elimination->collect, statement));
+    language_node_t *function = node_left(ctx, nodes_storage_get(ctx, *statement));
+    elimination->function     = node_identifier(function);
+    //-----------------------------------------------------------------------//
+    // No local is read after the end of function.
+    size_t block = 0;
+    _RETURN_IF_ERROR(live_push(elimination, EliminationNoBlock, &block));
+    _RETURN_IF_ERROR(eliminate_chain(ctx, elimination, &function->right, block, true));
+    //-----------------------------------------------------------------------//
+    _RETURN_IF_ERROR(reserve_elements((void **)&elimination->references,
+                                      &elimination->references_capacity,
+                                      elimination->slots_number + 1,
+                                      sizeof(elimination->references[0])));
+    memset(elimination->references,
+           0,
+           (elimination->slots_number + 1) * sizeof(elimination->references[0]));
+    _RETURN_IF_ERROR(tree_visit(ctx, &elimination->count, &function->right));
+    return remove_declarations(ctx, elimination, &function->right);
+}
+
+//===========================================================================//
+
+language_error_t eliminate_functions(language_t    *ctx,
+                                     elimination_t *elimination) {
+    _C_ASSERT(ctx         != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(elimination != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // Functions are reached from main and from initializers of globals.
+    size_t names = ctx->name_table.size;
+    elimination->functions     = (uint32_t *)calloc(names + 1, sizeof(elimination->functions[0]));
+    elimination->reached       = (bool     *)calloc(names + 1, sizeof(elimination->reached  [0]));
+    elimination->called        = (size_t   *)calloc(names + 1, sizeof(elimination->called   [0]));
+    elimination->called_number = 0;
+    language_error_t error_code = LANGUAGE_SUCCESS;
+    if(elimination->functions == NULL || elimination->reached == NULL || elimination->called == NULL) {
+        print_error("Error while allocating memory for reachable functions.\n");
+        error_code = LANGUAGE_MEMORY_ERROR;
+    }
+    size_t main_function = names;
+    for(size_t name = 0; name < names && error_code == LANGUAGE_SUCCESS; name++) {
+        elimination->functions[name] = NodeNone;
+    }
+    for(uint32_t statement = ctx->root;
+        statement != NodeNone && error_code == LANGUAGE_SUCCESS;
+        statement = nodes_storage_get(ctx, statement)->right) {
+        language_node_t *node = node_left(ctx, nodes_storage_get(ctx, statement));
+        if(!is_node_oper_eq(node, OPERATION_NEW_FUNC)) {
+            continue;
+        }
+        size_t        function = node_identifier(node_left(ctx, node));
+        identifier_t *ident    = identifier_of(ctx, function);
+        elimination->functions[function] = nodes_storage_get(ctx, statement)->left;
+        if(ident->length == MainFunctionLen &&
+           strncmp(ident->name, MainFunctionName, MainFunctionLen) == 0) {
+            main_function = function;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    // Program without main is not complete, nothing is removed from it.
+    if(main_function != names && error_code == LANGUAGE_SUCCESS) {
+        elimination->reached[main_function]                 = true;
+        elimination->called [elimination->called_number++] = main_function;
+        for(uint32_t statement = ctx->root;
+            statement != NodeNone && error_code == LANGUAGE_SUCCESS;
+            statement = nodes_storage_get(ctx, statement)->right) {
+            if(!is_node_oper_eq(node_left(ctx, nodes_storage_get(ctx, statement)), OPERATION_NEW_FUNC)) {
+                error_code = tree_visit(ctx, &elimination->calls, &nodes_storage_get(ctx, statement)->left);
+            }
+        }
+        while(elimination->called_number != 0 && error_code == LANGUAGE_SUCCESS) {
+            size_t function = elimination->called[--elimination->called_number];
+            error_code      = tree_visit(ctx, &elimination->calls, &elimination->functions[function]);
+        }
+        uint32_t *link = &ctx->root;
+        while(*link != NodeNone && error_code == LANGUAGE_SUCCESS) {
+            language_node_t *chain = nodes_storage_get(ctx, *link);
+            language_node_t *node  = node_left(ctx, chain);
+            if(is_node_oper_eq(node, OPERATION_NEW_FUNC) &&
+               !elimination->reached[node_identifier(node_left(ctx, node))]) {
+                identifier_t *ident = identifier_of(ctx, node_identifier(node_left(ctx, node)));
+                error_code = dump_message(ctx,
+                                          "Removed unreachable function '%.*s'",
+                                          (int)ident->length,
+                                          ident->name);
+                ctx->middleend_info.eliminated_functions++;
+                *link = chain->right;
+                continue;
+            }
+            link = &chain->right;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    free(elimination->functions);
+    free(elimination->reached  );
+    free(elimination->called   );
+    elimination->functions = NULL;
+    elimination->reached   = NULL;
+    elimination->called    = NULL;
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t elimination_dtor(elimination_t *elimination) {
+    _C_ASSERT(elimination != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    free(elimination->slots      );
+    free(elimination->slots_epoch);
+    free(elimination->references );
+    free(elimination->live       );
+    free(elimination->links      );
+    tree_visitor_dtor(&elimination->collect);
+    tree_visitor_dtor(&elimination->reads  );
+    tree_visitor_dtor(&elimination->count  );
+    tree_visitor_dtor(&elimination->calls  );
+    *elimination = {};
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t reserve_names(language_t *ctx, elimination_t *elimination) {
+    size_t capacity = elimination->names_capacity;
+    _RETURN_IF_ERROR(reserve_elements((void **)&elimination->slots,
+                                      &capacity,
+                                      ctx->name_table.size,
+                                      sizeof(elimination->slots[0])));
+    capacity = elimination->names_capacity;
+    _RETURN_IF_ERROR(reserve_elements((void **)&elimination->slots_epoch,
+                                      &capacity,
+                                      ctx->name_table.size,
+                                      sizeof(elimination->slots_epoch[0])));
+    elimination->names_capacity = capacity;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+size_t slot_of(elimination_t *elimination, language_node_t *node) {
+    // Slot 0 means the variable is not a local of the function.
+    size_t identifier = node_identifier(node);
+    if(elimination->slots_epoch[identifier] != elimination->epoch) {
+        return 0;
+    }
+    return elimination->slots[identifier];
+}
+
+//===========================================================================//
+
+language_error_t live_push(elimination_t *elimination,
+                           size_t         from,
+                           size_t        *block) {
+    size_t size = elimination->slots_number + 1;
+    _RETURN_IF_ERROR(reserve_elements((void **)&elimination->live,
+                                      &elimination->live_capacity,
+                                      elimination->live_size + size,
+                                      sizeof(elimination->live[0])));
+    *block = elimination->live_size;
+    elimination->live_size += size;
+    if(from == EliminationNoBlock) {
+        memset(live_at(elimination, *block), 0, size * sizeof(bool));
+    }
+    else {
+        memcpy(live_at(elimination, *block), live_at(elimination, from), size * sizeof(bool));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+bool live_merge(elimination_t *elimination, size_t to, size_t from) {
+    bool *first   = live_at(elimination, to  );
+    bool *second  = live_at(elimination, from);
+    bool  changed = false;
+    for(size_t slot = 1; slot <= elimination->slots_number; slot++) {
+        if(second[slot] && !first[slot]) {
+            first[slot] = true;
+            changed     = true;
+        }
+    }
+    return changed;
+}
+
+//===========================================================================//
+
+void live_kill(elimination_t *elimination, size_t block, language_node_t *node) {
+    size_t slot = slot_of(elimination, node);
+    if(slot != 0) {
+        live_at(elimination, block)[slot] = false;
+    }
+}
+
+//===========================================================================//
+
+language_error_t live_reads(language_t    *ctx,
+                            elimination_t *elimination,
+                            uint32_t      *link,
+                            size_t         block) {
+    elimination->block      = block;
+    elimination->is_reading = true;
+    elimination->has_call   = false;
+    return tree_visit(ctx, &elimination->reads, link);
+}
+
+//===========================================================================//
+
+language_error_t has_call(language_t    *ctx,
+                          elimination_t *elimination,
+                          uint32_t      *link,
+                          bool          *result) {
+    elimination->is_reading = false;
+    elimination->has_call   = false;
+    _RETURN_IF_ERROR(tree_visit(ctx, &elimination->reads, link));
+    *result = elimination->has_call;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+bool is_never_run(language_t *ctx, language_node_t *node) {
+    // Condition is compared with zero by both backends.
+    if(!is_node_oper_eq(node, OPERATION_IF) && !is_node_oper_eq(node, OPERATION_WHILE)) {
+        return false;
+    }
+    return node->left != NodeNone && is_number_eq(node_left(ctx, node), 0);
+}
+
+//===========================================================================//
+
+language_error_t eliminate_chain(language_t    *ctx,
+                                 elimination_t *elimination,
+                                 uint32_t      *link,
+                                 size_t         block,
+                                 bool           is_final) {
+    // Statements which are never run do not depend on liveness, so they
+    // are unlinked on the way forward, links of others are kept for the
+    // way backward. Nested chains keep their links above these.
+    size_t base = elimination->links_size;
+    while(*link != NodeNone) {
+        language_node_t *chain = nodes_storage_get(ctx, *link);
+        if(!is_node_oper_eq(chain, OPERATION_STATEMENT)) {
+            memset(live_at(elimination, block), 1, (elimination->slots_number + 1) * sizeof(bool));
+            break;
+        }
+        language_node_t *node = chain->left == NodeNone ? NULL : nodes_storage_get(ctx, chain->left);
+        if(node != NULL && is_never_run(ctx, node)) {
+            _RETURN_IF_ERROR(report(ctx, elimination, "Removed statement which is never run", node));
+            *link = chain->right;
+            continue;
+        }
+        _RETURN_IF_ERROR(reserve_elements((void **)&elimination->links,
+                                          &elimination->links_capacity,
+                                          elimination->links_size + 1,
+                                          sizeof(elimination->links[0])));
+        elimination->links[elimination->links_size++] = link;
+        if(node != NULL && is_node_oper_eq(node, OPERATION_RETURN)) {
+            for(uint32_t rest = chain->right; rest != NodeNone; rest = nodes_storage_get(ctx, rest)->right) {
+                _RETURN_IF_ERROR(report(ctx, elimination, "Removed statement after return", NULL));
+            }
+            chain->right = NodeNone;
+        }
+        link = &chain->right;
+    }
+    //-----------------------------------------------------------------------//
+    for(size_t elem = elimination->links_size; elem > base; elem--) {
+        _RETURN_IF_ERROR(eliminate_statement(ctx, elimination, elimination->links[elem - 1], block, is_final));
+    }
+    elimination->links_size = base;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t eliminate_statement(language_t    *ctx,
+                                     elimination_t *elimination,
+                                     uint32_t      *link,
+                                     size_t         block,
+                                     bool           is_final) {
+    language_node_t *chain = nodes_storage_get(ctx, *link);
+    if(chain->left == NodeNone) {
+        return LANGUAGE_SUCCESS;
+    }
+    language_node_t *node = nodes_storage_get(ctx, chain->left);
+    if(!is_node_type_eq(node, NODE_TYPE_OPERATION)) {
+        return live_reads(ctx, elimination, &chain->left, block);
+    }
+    operation_t opcode = node_opcode(node);
+    //-----------------------------------------------------------------------//
+    if(opcode == OPERATION_NEW_VAR) {
+        language_node_t *target = node_left(ctx, node);
+        if(!is_node_oper_eq(target, OPERATION_ASSIGNMENT)) {
+            live_kill(elimination, block, target);
+            return LANGUAGE_SUCCESS;
+        }
+        bool is_dead = false;
+        _RETURN_IF_ERROR(eliminate_store(ctx, elimination, target, block, &is_dead));
+        if(is_dead && is_final) {
+            _RETURN_IF_ERROR(report(ctx, elimination, "Removed dead initializer of", node_left(ctx, target)));
+            node->left = target->left;
+        }
+        return LANGUAGE_SUCCESS;
+    }
+    if(opcode == OPERATION_ASSIGNMENT) {
+        bool is_dead = false;
+        _RETURN_IF_ERROR(eliminate_store(ctx, elimination, node, block, &is_dead));
+        if(is_dead && is_final) {
+            _RETURN_IF_ERROR(report(ctx, elimination, "Removed dead store to", node_left(ctx, node)));
+            *link = chain->right;
+        }
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    if(opcode == OPERATION_IF) {
+        size_t body = 0;
+        _RETURN_IF_ERROR(live_push(elimination, block, &body));
+        _RETURN_IF_ERROR(eliminate_chain(ctx, elimination, &node->right, body, is_final));
+        live_merge(elimination, block, body);
+        elimination->live_size = body;
+        return live_reads(ctx, elimination, &node->left, block);
+    }
+    if(opcode == OPERATION_WHILE) {
+        return eliminate_loop(ctx, elimination, node, block, is_final);
+    }
+    if(opcode == OPERATION_RETURN) {
+        memset(live_at(elimination, block), 0, (elimination->slots_number + 1) * sizeof(bool));
+        return live_reads(ctx, elimination, &node->left, block);
+    }
+    if(opcode == OPERATION_IN) {
+        live_kill(elimination, block, node_left(ctx, node_left(ctx, node)));
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    return live_reads(ctx, elimination, &chain->left, block);
+}
+
+//===========================================================================//
+
+language_error_t eliminate_store(language_t      *ctx,
+                                 elimination_t   *elimination,
+                                 language_node_t *assignment,
+                                 size_t           block,
+                                 bool            *is_dead) {
+    // Store is dead if the local is not read before the next store, but
+    // calls on the right side have to be run anyway.
+    size_t slot = slot_of(elimination, node_left(ctx, assignment));
+    if(slot != 0 && !live_at(elimination, block)[slot]) {
+        bool with_call = false;
+        _RETURN_IF_ERROR(has_call(ctx, elimination, &assignment->right, &with_call));
+        if(!with_call) {
+            *is_dead = true;
+            return LANGUAGE_SUCCESS;
+        }
+    }
+    if(slot != 0) {
+        live_at(elimination, block)[slot] = false;
+    }
+    return live_reads(ctx, elimination, &assignment->right, block);
+}
+
+//===========================================================================//
+
+language_error_t eliminate_loop(language_t      *ctx,
+                                elimination_t   *elimination,
+                                language_node_t *node,
+                                size_t           block,
+                                bool             is_final) {
+    // Locals read by the condition, after the loop or at the start of the
+    // body are live at the end of the body, the set only grows, so passes
+    // stop when the body adds nothing. Last pass removes stores.
+    _RETURN_IF_ERROR(live_reads(ctx, elimination, &node->left, block));
+    bool changed = true;
+    while(changed) {
+        size_t body = 0;
+        _RETURN_IF_ERROR(live_push(elimination, block, &body));
+        _RETURN_IF_ERROR(eliminate_chain(ctx, elimination, &node->right, body, false));
+        changed = live_merge(elimination, block, body);
+        elimination->live_size = body;
+    }
+    if(!is_final) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t body = 0;
+    _RETURN_IF_ERROR(live_push(elimination, block, &body));
+    _RETURN_IF_ERROR(eliminate_chain(ctx, elimination, &node->right, body, true));
+    elimination->live_size = body;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t remove_declarations(language_t    *ctx,
+                                     elimination_t *elimination,
+                                     uint32_t      *link) {
+    // Declaration without initializer is the only use left of a local
+    // whose stores were all dead.
+    while(*link != NodeNone) {
+        language_node_t *chain = nodes_storage_get(ctx, *link);
+        if(!is_node_oper_eq(chain, OPERATION_STATEMENT)) {
+            return LANGUAGE_SUCCESS;
+        }
+        language_node_t *node = chain->left == NodeNone ? NULL : nodes_storage_get(ctx, chain->left);
+        if(node == NULL) {
+            link = &chain->right;
+            continue;
+        }
+        if(is_node_oper_eq(node, OPERATION_NEW_VAR) &&
+           is_node_type_eq(node_left(ctx, node), NODE_TYPE_IDENTIFIER)) {
+            size_t slot = slot_of(elimination, node_left(ctx, node));
+            if(slot != 0 && elimination->references[slot] == 1) {
+                _RETURN_IF_ERROR(report(ctx, elimination, "Removed unused variable", node_left(ctx, node)));
+                *link = chain->right;
+                continue;
+            }
+        }
+        //-------------------------------------------------------------------//
+        if(is_node_oper_eq(node, OPERATION_IF) || is_node_oper_eq(node, OPERATION_WHILE)) {
+            _RETURN_IF_ERROR(remove_declarations(ctx, elimination, &node->right));
+        }
+        if(is_node_oper_eq(node, OPERATION_IF) && node->right == NodeNone) {
+            bool with_call = false;
+            _RETURN_IF_ERROR(has_call(ctx, elimination, &node->left, &with_call));
+            if(!with_call) {
+                _RETURN_IF_ERROR(report(ctx, elimination, "Removed empty if", NULL));
+                *link = chain->right;
+                continue;
+            }
+        }
+        link = &chain->right;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t report(language_t      *ctx,
+                        elimination_t   *elimination,
+                        const char      *action,
+                        language_node_t *node) {
+    ctx->middleend_info.eliminated_statements++;
+    identifier_t *function = identifier_of(ctx, elimination->function);
+    if(node == NULL || !is_node_type_eq(node, NODE_TYPE_IDENTIFIER)) {
+        return dump_message(ctx,
+                            "%s in function '%.*s'",
+                            action,
+                            (int)function->length,
+                            function->name);
+    }
+    identifier_t *variable = identifier_of(ctx, node_identifier(node));
+    return dump_message(ctx,
+                        "%s '%.*s' in function '%.*s'",
+                        action,
+                        (int)variable->length,
+                        variable->name,
+                        (int)function->length,
+                        function->name);
+}
+
+//===========================================================================//
+
+language_error_t collect_local(language_t    *ctx,
+                               visit_frame_t *frame,
+                               void          *data) {
+    // Slot 0 of the live set is not used, so slots start from 1.
+    elimination_t   *elimination = (elimination_t *)data;
+    language_node_t *node        = nodes_storage_get(ctx, *frame->link);
+    if(!is_ident_type(ctx, node, IDENTIFIER_VARIABLE)) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t identifier = node_identifier(node);
+    if(identifier_of(ctx, identifier)->is_global ||
+       elimination->slots_epoch[identifier] == elimination->epoch) {
+        return LANGUAGE_SUCCESS;
+    }
+    elimination->slots_epoch[identifier] = elimination->epoch;
+    elimination->slots      [identifier] = ++elimination->slots_number;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_local(language_t    *ctx,
+                            visit_frame_t *frame,
+                            void          *data) {
+    elimination_t   *elimination = (elimination_t *)data;
+    language_node_t *node        = nodes_storage_get(ctx, *frame->link);
+    if(is_node_oper_eq(node, OPERATION_CALL) || is_ident_type(ctx, node, IDENTIFIER_FUNCTION)) {
+        elimination->has_call = true;
+        return LANGUAGE_SUCCESS;
+    }
+    if(elimination->is_reading && is_ident_type(ctx, node, IDENTIFIER_VARIABLE)) {
+        size_t slot = slot_of(elimination, node);
+        if(slot != 0) {
+            live_at(elimination, elimination->block)[slot] = true;
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t count_local(language_t    *ctx,
+                             visit_frame_t *frame,
+                             void          *data) {
+    elimination_t   *elimination = (elimination_t *)data;
+    language_node_t *node        = nodes_storage_get(ctx, *frame->link);
+    if(is_ident_type(ctx, node, IDENTIFIER_VARIABLE)) {
+        elimination->references[slot_of(elimination, node)]++;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t reach_callee(language_t    *ctx,
+                              visit_frame_t *frame,
+                              void          *data) {
+    // Functions without definition are from stdlib.
+    elimination_t   *elimination = (elimination_t *)data;
+    language_node_t *node        = nodes_storage_get(ctx, *frame->link);
+    if(!is_node_oper_eq(node, OPERATION_CALL)) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t function = node_identifier(node_left(ctx, node));
+    if(elimination->functions[function] == NodeNone || elimination->reached[function]) {
+        return LANGUAGE_SUCCESS;
+    }
+    elimination->reached[function]                      = true;
+    elimination->called [elimination->called_number++] = function;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
@@ -0,0 +1,747 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "inliner.h"
+#include "middleend_utils.h"
+#include "name_table.h"
+#include "tree_visitor.h"
+#include "lang_dump.h"
+#include "nodes_dsl.h"
+#include "asm_x86.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static const size_t InlineDefaultLimit  = 40;
+static const size_t InlineCallCost      = 6;
+static const size_t InlineConstantBonus = 4;
+static const size_t InlineGrowthFactor  = 16;
+
+//===========================================================================//
+
+static language_error_t reserve_names        (language_t         *ctx,
+                                              inliner_t          *inliner);
+
+static language_error_t scan_program         (language_t         *ctx,
+                                              inliner_t          *inliner);
+
+static language_error_t order_functions      (inliner_t          *inliner);
+
+static void             enter_function       (inliner_t          *inliner,
+                                              size_t              function);
+
+static void             leave_function       (inliner_t          *inliner);
+
+static uint32_t        *expression_of        (language_t         *ctx,
+                                              language_node_t    *node);
+
+static language_error_t inline_chain         (language_t         *ctx,
+                                              inliner_t          *inliner,
+                                              uint32_t           *link);
+
+static language_error_t check_call           (language_t         *ctx,
+                                              inliner_t          *inliner,
+                                              uint32_t           *call,
+                                              bool               *is_inlinable);
+
+static language_error_t inline_call          (language_t         *ctx,
+                                              inliner_t          *inliner,
+                                              uint32_t           *link,
+                                              uint32_t           *call);
+
+static language_error_t lower_chain          (language_t         *ctx,
+                                              inliner_t          *inliner,
+                                              uint32_t           *link,
+                                              bool                is_top,
+                                              bool               *may_return);
+
+static language_error_t lower_loop           (language_t         *ctx,
+                                              inliner_t          *inliner,
+                                              uint32_t           *link);
+
+static language_error_t measure              (language_t         *ctx,
+                                              inliner_t          *inliner,
+                                              uint32_t           *link,
+                                              uint32_t            skipped,
+                                              inline_summary_t   *summary);
+
+static language_error_t rename_variable      (language_t         *ctx,
+                                              inliner_t          *inliner,
+                                              size_t              identifier,
+                                              size_t             *output);
+
+static language_error_t scan_call            (language_t         *ctx,
+                                              visit_frame_t      *frame,
+                                              void               *data);
+
+static language_error_t measure_node         (language_t         *ctx,
+                                              visit_frame_t      *frame,
+                                              void               *data);
+
+static language_error_t search_call          (language_t         *ctx,
+                                              visit_frame_t      *frame,
+                                              void               *data);
+
+static language_error_t copy_node            (language_t         *ctx,
+                                              visit_frame_t      *frame,
+                                              void               *data);
+
+//===========================================================================//
+
+static inline size_t callee_of(language_t *ctx, language_node_t *call) {
+    return node_identifier(node_left(ctx, call));
+}
+
+//===========================================================================//
+
+language_error_t inliner_ctor(inliner_t *inliner) {
+    _C_ASSERT(inliner != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    *inliner              = {};
+    inliner->scan   .pre  = scan_call;
+    inliner->scan   .data = inliner;
+    inliner->measure.pre  = measure_node;
+    inliner->measure.data = inliner;
+    inliner->search .pre  = search_call;
+    inliner->search .data = inliner;
+    inliner->copy   .pre  = copy_node;
+    inliner->copy   .data = inliner;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t inline_functions(language_t *ctx,
+                                  inliner_t  *inliner) {
+    _C_ASSERT(ctx     != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(inliner != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // Zero limit turns inlining off.
+    inliner->limit = ctx->has_inline_limit ? ctx->inline_limit : InlineDefaultLimit;
+    if(inliner->limit == 0) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t names = ctx->name_table.size;
+    inliner->functions_number = names;
+    inliner->functions        = (inline_function_t *)calloc(names + 1, sizeof(inliner->functions[0]));
+    inliner->order            = (size_t            *)calloc(names + 1, sizeof(inliner->order    [0]));
+    inliner->stack            = (size_t            *)calloc(names + 1, sizeof(inliner->stack    [0]));
+    inliner->frames           = (size_t            *)calloc(names + 1, sizeof(inliner->frames   [0]));
+    if(inliner->functions == NULL || inliner->order  == NULL ||
+       inliner->stack     == NULL || inliner->frames == NULL) {
+        print_error("Error while allocating memory for inliner.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    _RETURN_IF_ERROR(scan_program(ctx, inliner));
+    _RETURN_IF_ERROR(order_functions(inliner));
+    //-----------------------------------------------------------------------//
+    // Callees come first, so their bodies already have inlined calls and
+    // their sizes are measured after it.
+    for(size_t elem = 0; elem < inliner->order_size; elem++) {
+        size_t           function = inliner->order[elem];
+        language_node_t *ident    = node_left(ctx, nodes_storage_get(ctx, inliner->functions[function].definition));
+        inliner->caller = function;
+        inliner->growth = 0;
+        _RETURN_IF_ERROR(inline_chain(ctx, inliner, &ident->right));
+        _RETURN_IF_ERROR(measure(ctx, inliner, &ident->right, NodeNone, &inliner->functions[function].summary));
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t inliner_dtor(inliner_t *inliner) {
+    _C_ASSERT(inliner != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    free(inliner->functions    );
+    free(inliner->edges        );
+    free(inliner->order        );
+    free(inliner->stack        );
+    free(inliner->frames       );
+    free(inliner->renamed      );
+    free(inliner->renamed_epoch);
+    tree_visitor_dtor(&inliner->scan   );
+    tree_visitor_dtor(&inliner->measure);
+    tree_visitor_dtor(&inliner->search );
+    tree_visitor_dtor(&inliner->copy   );
+    *inliner = {};
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t reserve_names(language_t *ctx, inliner_t *inliner) {
+    // Copies add names, so arrays are grown before every lookup.
+    size_t capacity = inliner->names_capacity;
+    _RETURN_IF_ERROR(reserve_elements((void **)&inliner->renamed,
+                                      &capacity,
+                                      ctx->name_table.size,
+                                      sizeof(inliner->renamed[0])));
+    capacity = inliner->names_capacity;
+    _RETURN_IF_ERROR(reserve_elements((void **)&inliner->renamed_epoch,
+                                      &capacity,
+                                      ctx->name_table.size,
+                                      sizeof(inliner->renamed_epoch[0])));
+    inliner->names_capacity = capacity;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t scan_program(language_t *ctx, inliner_t *inliner) {
+    // Calls from initializers of globals are counted, but they are not
+    // edges of the call graph as they are never inlined.
+    inliner->main_function = PoisonIndex;
+    for(size_t name = 0; name < inliner->functions_number; name++) {
+        inliner->functions[name].definition = NodeNone;
+    }
+    for(uint32_t statement = ctx->root;
+        statement != NodeNone;
+        statement = nodes_storage_get(ctx, statement)->right) {
+        language_node_t *node = node_left(ctx, nodes_storage_get(ctx, statement));
+        if(!is_node_oper_eq(node, OPERATION_NEW_FUNC)) {
+            continue;
+        }
+        size_t        function = node_identifier(node_left(ctx, node));
+        identifier_t *ident    = identifier_of(ctx, function);
+        if(inliner->functions[function].definition == NodeNone) {
+            inliner->functions[function].definition = nodes_storage_get(ctx, statement)->left;
+        }
+        if(ident->length == MainFunctionLen &&
+           strncmp(ident->name, MainFunctionName, MainFunctionLen) == 0) {
+            inliner->main_function = function;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    for(uint32_t statement = ctx->root;
+        statement != NodeNone;
+        statement = nodes_storage_get(ctx, statement)->right) {
+        language_node_t *node = node_left(ctx, nodes_storage_get(ctx, statement));
+        inliner->caller = PoisonIndex;
+        if(is_node_oper_eq(node, OPERATION_NEW_FUNC) &&
+           inliner->functions[node_identifier(node_left(ctx, node))].definition ==
+           nodes_storage_get(ctx, statement)->left) {
+            inliner->caller = node_identifier(node_left(ctx, node));
+            inliner->functions[inliner->caller].first_edge = inliner->edges_size;
+        }
+        _RETURN_IF_ERROR(tree_visit(ctx, &inliner->scan, &nodes_storage_get(ctx, statement)->left));
+        if(inliner->caller != PoisonIndex) {
+            inliner->functions[inliner->caller].last_edge = inliner->edges_size;
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t order_functions(inliner_t *inliner) {
+    // Tarjan's algorithm with explicit stack of frames, components are
+    // completed callees first. Function of a component with more than one
+    // function or with a call of itself is recursive.
+    for(size_t function = 0; function < inliner->functions_number; function++) {
+        if(inliner->functions[function].definition == NodeNone ||
+           inliner->functions[function].is_visited) {
+            continue;
+        }
+        enter_function(inliner, function);
+        while(inliner->frames_size != 0) {
+            inline_function_t *top = inliner->functions + inliner->frames[inliner->frames_size - 1];
+            if(top->next_edge == top->last_edge) {
+                leave_function(inliner);
+                continue;
+            }
+            size_t             callee = inliner->edges[top->next_edge++];
+            inline_function_t *next   = inliner->functions + callee;
+            if(next == top) {
+                top->is_recursive = true;
+            }
+            if(!next->is_visited) {
+                enter_function(inliner, callee);
+            }
+            else if(next->is_on_stack && next->index < top->lowlink) {
+                top->lowlink = next->index;
+            }
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+void enter_function(inliner_t *inliner, size_t function) {
+    inline_function_t *info = inliner->functions + function;
+    info->index       = inliner->counter;
+    info->lowlink     = inliner->counter;
+    info->next_edge   = info->first_edge;
+    info->is_visited  = true;
+    info->is_on_stack = true;
+    inliner->counter++;
+    inliner->stack [inliner->stack_size++ ] = function;
+    inliner->frames[inliner->frames_size++] = function;
+}
+
+//===========================================================================//
+
+void leave_function(inliner_t *inliner) {
+    size_t             function = inliner->frames[--inliner->frames_size];
+    inline_function_t *info     = inliner->functions + function;
+    if(inliner->frames_size != 0) {
+        inline_function_t *parent = inliner->functions + inliner->frames[inliner->frames_size - 1];
+        if(info->lowlink < parent->lowlink) {
+            parent->lowlink = info->lowlink;
+        }
+    }
+    if(info->lowlink != info->index) {
+        return;
+    }
+    //-----------------------------------------------------------------------//
+    size_t first = inliner->order_size;
+    size_t member = PoisonIndex;
+    do {
+        member = inliner->stack[--inliner->stack_size];
+        inliner->functions[member].is_on_stack = false;
+        inliner->order[inliner->order_size++]  = member;
+    } while(member != function);
+    if(inliner->order_size - first > 1) {
+        for(size_t elem = first; elem < inliner->order_size; elem++) {
+            inliner->functions[inliner->order[elem]].is_recursive = true;
+        }
+    }
+}
+
+//===========================================================================//
+
+uint32_t *expression_of(language_t *ctx, language_node_t *node) {
+    // Condition of while is run on every iteration, so calls from it can
+    // not be moved before the loop.
+    if(is_node_oper_eq(node, OPERATION_NEW_VAR)) {
+        if(!is_node_oper_eq(node_left(ctx, node), OPERATION_ASSIGNMENT)) {
+            return NULL;
+        }
+        return &node_left(ctx, node)->right;
+    }
+    if(is_node_oper_eq(node, OPERATION_ASSIGNMENT)) {
+        return &node->right;
+    }
+    if(is_node_oper_eq(node, OPERATION_RETURN) || is_node_oper_eq(node, OPERATION_IF)) {
+        return &node->left;
+    }
+    if(is_node_oper_eq(node, OPERATION_OUT)) {
+        return &node_left(ctx, node)->left;
+    }
+    return NULL;
+}
+
+//===========================================================================//
+
+language_error_t inline_chain(language_t *ctx,
+                              inliner_t  *inliner,
+                              uint32_t   *link) {
+    // Inlined body is put before the statement at the same link, so it is
+    // walked next and calls copied with it are inlined too.
+    while(*link != NodeNone) {
+        language_node_t *chain = nodes_storage_get(ctx, *link);
+        if(!is_node_oper_eq(chain, OPERATION_STATEMENT)) {
+            return LANGUAGE_SUCCESS;
+        }
+        if(chain->left == NodeNone) {
+            link = &chain->right;
+            continue;
+        }
+        language_node_t *node       = nodes_storage_get(ctx, chain->left);
+        uint32_t        *expression = expression_of(ctx, node);
+        if(expression != NULL && *expression != NodeNone) {
+            inliner->expression = expression;
+            inliner->call       = NULL;
+            _RETURN_IF_ERROR(tree_visit(ctx, &inliner->search, expression));
+            if(inliner->call != NULL) {
+                _RETURN_IF_ERROR(inline_call(ctx, inliner, link, inliner->call));
+                continue;
+            }
+        }
+        if(is_node_oper_eq(node, OPERATION_IF) || is_node_oper_eq(node, OPERATION_WHILE)) {
+            _RETURN_IF_ERROR(inline_chain(ctx, inliner, &node->right));
+        }
+        link = &chain->right;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t check_call(language_t *ctx,
+                            inliner_t  *inliner,
+                            uint32_t   *call,
+                            bool       *is_inlinable) {
+    *is_inlinable = false;
+    size_t callee = callee_of(ctx, nodes_storage_get(ctx, *call));
+    if(callee >= inliner->functions_number) {
+        return LANGUAGE_SUCCESS;
+    }
+    inline_function_t *info = inliner->functions + callee;
+    if(info->definition == NodeNone || info->is_recursive || callee == inliner->main_function) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // Arguments are moved to declarations in the order of parameters, but
+    // backends run them in different orders, so they have to commute.
+    inline_summary_t moved      = {};
+    size_t           parameters = 0;
+    size_t           constants  = 0;
+    for(uint32_t argument = node_left(ctx, nodes_storage_get(ctx, *call))->left;
+        argument != NodeNone;
+        argument = nodes_storage_get(ctx, argument)->right) {
+        language_node_t *linker  = nodes_storage_get(ctx, argument);
+        inline_summary_t summary = {};
+        _RETURN_IF_ERROR(measure(ctx, inliner, &linker->left, NodeNone, &summary));
+        if((summary.has_call      && (moved.has_call || moved.reads_globals)) ||
+           (summary.reads_globals &&  moved.has_call)) {
+            return LANGUAGE_SUCCESS;
+        }
+        moved.has_call       |= summary.has_call;
+        moved.reads_globals  |= summary.reads_globals;
+        moved.writes_globals |= summary.writes_globals;
+        moved.has_io         |= summary.has_io;
+        parameters++;
+        if(is_node_type_eq(node_left(ctx, linker), NODE_TYPE_NUMBER)) {
+            constants++;
+        }
+    }
+    //-----------------------------------------------------------------------//
+    // Function called once is removed after inlining, so it does not grow
+    // the program.
+    size_t size  = info->summary.size;
+    size_t bound = inliner->limit + InlineCallCost + parameters + InlineConstantBonus * constants;
+    bool   once  = info->calls == 1 && inliner->main_function != PoisonIndex;
+    if((size > bound && !once) || inliner->growth + size > InlineGrowthFactor * inliner->limit) {
+        return LANGUAGE_SUCCESS;
+    }
+    //-----------------------------------------------------------------------//
+    // Rest of the statement is run after the moved code.
+    moved.has_call       |= info->summary.has_call;
+    moved.reads_globals  |= info->summary.reads_globals;
+    moved.writes_globals |= info->summary.writes_globals;
+    moved.has_io         |= info->summary.has_io;
+    inline_summary_t rest = {};
+    _RETURN_IF_ERROR(measure(ctx, inliner, inliner->expression, *call, &rest));
+    bool has_effect = moved.has_call || moved.writes_globals || moved.has_io;
+    if((rest.has_call      && (has_effect || moved.reads_globals)) ||
+       (rest.reads_globals && (moved.has_call || moved.writes_globals))) {
+        return LANGUAGE_SUCCESS;
+    }
+    *is_inlinable = true;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t inline_call(language_t *ctx,
+                             inliner_t  *inliner,
+                             uint32_t   *link,
+                             uint32_t   *call) {
+    // Marks of other calls have other epoch, so they are not cleared.
+    inliner->epoch++;
+    if(inliner->epoch == 0) {
+        memset(inliner->renamed_epoch, 0, inliner->names_capacity * sizeof(uint32_t));
+        inliner->epoch = 1;
+    }
+    inliner->callee  = callee_of(ctx, nodes_storage_get(ctx, *call));
+    inliner->running = PoisonIndex;
+    language_node_t *function  = nodes_storage_get(ctx, inliner->functions[inliner->callee].definition);
+    language_node_t *ident     = node_left(ctx, function);
+    uint32_t         head      = NodeNone;
+    uint32_t        *tail      = &head;
+    uint32_t         statement = NodeNone;
+    //-----------------------------------------------------------------------//
+    for(uint32_t parameter = ident->left, argument = node_left(ctx, nodes_storage_get(ctx, *call))->left;
+        parameter != NodeNone && argument != NodeNone;
+        parameter = nodes_storage_get(ctx, parameter)->right,
+        argument  = nodes_storage_get(ctx, argument )->right) {
+        language_node_t *variable = node_left(ctx, node_left(ctx, nodes_storage_get(ctx, parameter)));
+        size_t           renamed  = 0;
+        _RETURN_IF_ERROR(rename_variable(ctx, inliner, node_identifier(variable), &renamed));
+        _RETURN_IF_ERROR(add_assignment(ctx, renamed, nodes_storage_get(ctx, argument)->left, true, &statement));
+        *tail = statement;
+        tail  = &nodes_storage_get(ctx, statement)->right;
+    }
+    _RETURN_IF_ERROR(fresh_variable(ctx, inliner->callee, _NAME("result"), &inliner->result));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_IDENTIFIER, IDENT(inliner->result), NodeNone, NodeNone, &statement));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_NEW_VAR), statement, NodeNone, &statement));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_STATEMENT), statement, NodeNone, &statement));
+    *tail = statement;
+    tail  = &nodes_storage_get(ctx, statement)->right;
+    //-----------------------------------------------------------------------//
+    uint32_t body       = ident->right;
+    bool     may_return = false;
+    _RETURN_IF_ERROR(tree_visit(ctx, &inliner->copy, &body));
+    _RETURN_IF_ERROR(lower_chain(ctx, inliner, &body, true, &may_return));
+    if(inliner->running != PoisonIndex) {
+        uint32_t one = NodeNone;
+        _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_NUMBER, NUMBER(1), NodeNone, NodeNone, &one));
+        _RETURN_IF_ERROR(add_assignment(ctx, inliner->running, one, true, &statement));
+        *tail = statement;
+        tail  = &nodes_storage_get(ctx, statement)->right;
+    }
+    *tail = body;
+    while(*tail != NodeNone) {
+        tail = &nodes_storage_get(ctx, *tail)->right;
+    }
+    *tail = *link;
+    *link = head;
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_IDENTIFIER, IDENT(inliner->result), NodeNone, NodeNone, call));
+    //-----------------------------------------------------------------------//
+    inline_function_t *info = inliner->functions + inliner->callee;
+    info->calls--;
+    inliner->growth += info->summary.size;
+    ctx->middleend_info.inlined_calls++;
+    identifier_t *callee = identifier_of(ctx, inliner->callee);
+    identifier_t *caller = identifier_of(ctx, inliner->caller);
+    return dump_message(ctx,
+                        "Inlined call of '%.*s' into '%.*s'",
+                        (int)callee->length,
+                        callee->name,
+                        (int)caller->length,
+                        caller->name);
+}
+
+//===========================================================================//
+
+language_error_t lower_chain(language_t *ctx,
+                             inliner_t  *inliner,
+                             uint32_t   *link,
+                             bool        is_top,
+                             bool       *may_return) {
+    // Return assigns the result and drops the rest of its chain, return
+    // from nested chain also clears running flag, which guards statements
+    // after the if or while around it.
+    *may_return = false;
+    while(*link != NodeNone) {
+        language_node_t *chain = nodes_storage_get(ctx, *link);
+        if(!is_node_oper_eq(chain, OPERATION_STATEMENT)) {
+            return LANGUAGE_SUCCESS;
+        }
+        if(chain->left == NodeNone) {
+            link = &chain->right;
+            continue;
+        }
+        language_node_t *node = nodes_storage_get(ctx, chain->left);
+        if(is_node_oper_eq(node, OPERATION_RETURN)) {
+            uint32_t result = NodeNone;
+            _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_IDENTIFIER, IDENT(inliner->result), NodeNone, NodeNone, &result));
+            _RETURN_IF_ERROR(set_val(node, NODE_TYPE_OPERATION, OPCODE(OPERATION_ASSIGNMENT), result, node->left));
+            chain->right = NodeNone;
+            *may_return  = true;
+            if(is_top) {
+                return LANGUAGE_SUCCESS;
+            }
+            if(inliner->running == PoisonIndex) {
+                _RETURN_IF_ERROR(fresh_variable(ctx, inliner->callee, _NAME("running"), &inliner->running));
+            }
+            uint32_t zero = NodeNone;
+            _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_NUMBER, NUMBER(0), NodeNone, NodeNone, &zero));
+            _RETURN_IF_ERROR(add_assignment(ctx, inliner->running, zero, false, &chain->right));
+            return LANGUAGE_SUCCESS;
+        }
+        //-------------------------------------------------------------------//
+        bool is_returning = false;
+        if(is_node_oper_eq(node, OPERATION_IF)) {
+            _RETURN_IF_ERROR(lower_chain(ctx, inliner, &node->right, false, &is_returning));
+        }
+        if(is_node_oper_eq(node, OPERATION_WHILE)) {
+            _RETURN_IF_ERROR(lower_chain(ctx, inliner, &node->right, false, &is_returning));
+            if(is_returning) {
+                _RETURN_IF_ERROR(lower_loop(ctx, inliner, link));
+                chain = nodes_storage_get(ctx, nodes_storage_get(ctx, *link)->right);
+            }
+        }
+        if(is_returning) {
+            *may_return = true;
+            _RETURN_IF_ERROR(guard_rest(ctx, inliner->running, false, chain, &link));
+            continue;
+        }
+        link = &chain->right;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t lower_loop(language_t *ctx,
+                            inliner_t  *inliner,
+                            uint32_t   *link) {
+    // while(c) {B} becomes
+    // var repeat = 1; while(repeat) {repeat = 0; if(c) {B; repeat = running;}}
+    // so loop is left when its body returns.
+    language_node_t *chain  = nodes_storage_get(ctx, *link);
+    language_node_t *loop   = nodes_storage_get(ctx, chain->left);
+    size_t           repeat = 0;
+    uint32_t         number = NodeNone;
+    uint32_t         flag   = NodeNone;
+    _RETURN_IF_ERROR(fresh_variable(ctx, inliner->callee, _NAME("repeat"), &repeat));
+    //-----------------------------------------------------------------------//
+    uint32_t *tail = &loop->right;
+    while(*tail != NodeNone) {
+        tail = &nodes_storage_get(ctx, *tail)->right;
+    }
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_IDENTIFIER, IDENT(inliner->running), NodeNone, NodeNone, &flag));
+    _RETURN_IF_ERROR(add_assignment(ctx, repeat, flag, false, tail));
+    uint32_t check = NodeNone;
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_IF), loop->left, loop->right, &check));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_STATEMENT), check, NodeNone, &check));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_NUMBER, NUMBER(0), NodeNone, NodeNone, &number));
+    _RETURN_IF_ERROR(add_assignment(ctx, repeat, number, false, &loop->right));
+    nodes_storage_get(ctx, loop->right)->right = check;
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_IDENTIFIER, IDENT(repeat), NodeNone, NodeNone, &loop->left));
+    //-----------------------------------------------------------------------//
+    uint32_t declaration = NodeNone;
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_NUMBER, NUMBER(1), NodeNone, NodeNone, &number));
+    _RETURN_IF_ERROR(add_assignment(ctx, repeat, number, true, &declaration));
+    nodes_storage_get(ctx, declaration)->right = *link;
+    *link = declaration;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t measure(language_t       *ctx,
+                         inliner_t        *inliner,
+                         uint32_t         *link,
+                         uint32_t          skipped,
+                         inline_summary_t *summary) {
+    inliner->summary = {};
+    inliner->skipped = skipped;
+    _RETURN_IF_ERROR(tree_visit(ctx, &inliner->measure, link));
+    *summary = inliner->summary;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t rename_variable(language_t *ctx,
+                                 inliner_t  *inliner,
+                                 size_t      identifier,
+                                 size_t     *output) {
+    // Local gets one new name for the whole inlined call.
+    _RETURN_IF_ERROR(reserve_names(ctx, inliner));
+    if(inliner->renamed_epoch[identifier] == inliner->epoch) {
+        *output = inliner->renamed[identifier];
+        return LANGUAGE_SUCCESS;
+    }
+    identifier_t *ident = identifier_of(ctx, identifier);
+    name_t        name  = {.length = ident->length, .name = ident->name};
+    size_t        fresh = 0;
+    _RETURN_IF_ERROR(fresh_variable(ctx, inliner->callee, name, &fresh));
+    _RETURN_IF_ERROR(reserve_names(ctx, inliner));
+    inliner->renamed_epoch[identifier] = inliner->epoch;
+    inliner->renamed      [identifier] = fresh;
+    *output = fresh;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t scan_call(language_t    *ctx,
+                           visit_frame_t *frame,
+                           void          *data) {
+    inliner_t       *inliner = (inliner_t *)data;
+    language_node_t *node    = nodes_storage_get(ctx, *frame->link);
+    if(!is_node_oper_eq(node, OPERATION_CALL)) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t callee = callee_of(ctx, node);
+    inliner->functions[callee].calls++;
+    if(inliner->caller == PoisonIndex || inliner->functions[callee].definition == NodeNone) {
+        return LANGUAGE_SUCCESS;
+    }
+    _RETURN_IF_ERROR(reserve_elements((void **)&inliner->edges,
+                                      &inliner->edges_capacity,
+                                      inliner->edges_size + 1,
+                                      sizeof(inliner->edges[0])));
+    inliner->edges[inliner->edges_size++] = callee;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t measure_node(language_t    *ctx,
+                              visit_frame_t *frame,
+                              void          *data) {
+    // Assigned global is counted as read too, it only makes checks stricter.
+    inliner_t       *inliner = (inliner_t *)data;
+    language_node_t *node    = nodes_storage_get(ctx, *frame->link);
+    if(*frame->link == inliner->skipped) {
+        visit_children(frame, NULL, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    inliner->summary.size++;
+    if(is_node_oper_eq(node, OPERATION_CALL)) {
+        inliner->summary.has_call = true;
+    }
+    if(is_node_oper_eq(node, OPERATION_IN) || is_node_oper_eq(node, OPERATION_OUT)) {
+        inliner->summary.has_io = true;
+    }
+    if(is_node_oper_eq(node, OPERATION_IN) &&
+       is_global_variable(ctx, node_left(ctx, node_left(ctx, node)))) {
+        inliner->summary.writes_globals = true;
+    }
+    if(is_node_oper_eq(node, OPERATION_ASSIGNMENT) && is_global_variable(ctx, node_left(ctx, node))) {
+        inliner->summary.writes_globals = true;
+    }
+    if(is_global_variable(ctx, node)) {
+        inliner->summary.reads_globals = true;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t search_call(language_t    *ctx,
+                             visit_frame_t *frame,
+                             void          *data) {
+    // Outer call is tried first, arguments of a call which is kept are
+    // searched after it.
+    inliner_t       *inliner = (inliner_t *)data;
+    language_node_t *node    = nodes_storage_get(ctx, *frame->link);
+    if(inliner->call != NULL) {
+        visit_children(frame, NULL, NULL);
+        return LANGUAGE_SUCCESS;
+    }
+    if(!is_node_oper_eq(node, OPERATION_CALL)) {
+        return LANGUAGE_SUCCESS;
+    }
+    bool is_inlinable = false;
+    _RETURN_IF_ERROR(check_call(ctx, inliner, frame->link, &is_inlinable));
+    if(is_inlinable) {
+        inliner->call = frame->link;
+        visit_children(frame, NULL, NULL);
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t copy_node(language_t    *ctx,
+                           visit_frame_t *frame,
+                           void          *data) {
+    // Node is replaced by its copy and children are reached through the
+    // copy, so the whole body is copied. Locals get new names.
+    inliner_t       *inliner  = (inliner_t *)data;
+    language_node_t  original = *nodes_storage_get(ctx, *frame->link);
+    value_t          value    = node_value(&original);
+    if(is_ident_type(ctx, &original, IDENTIFIER_VARIABLE) && !is_global_variable(ctx, &original)) {
+        size_t renamed = 0;
+        _RETURN_IF_ERROR(rename_variable(ctx, inliner, node_identifier(&original), &renamed));
+        value = IDENT(renamed);
+    }
+    if(is_node_oper_eq(&original, OPERATION_CALL) && callee_of(ctx, &original) < inliner->functions_number) {
+        inliner->functions[callee_of(ctx, &original)].calls++;
+    }
+    return add_node(ctx, node_type(&original), value, original.left, original.right, frame->link);
+}
+
+//===========================================================================//
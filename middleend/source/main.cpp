@@ -3,35 +3,64 @@
 #include "language.h"
 #include "middleend.h"
 #include "lang_dump.h"
+#include "build_cache.h"
 #include "colors.h"
+#include "utils.h"
 
 static int main_exit_failure(language_t *ctx);
 
 //===========================================================================//
 
 int main(int argc, const char *argv[]) {
-    color_printf(MAGENTA_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                 " _____________________________________ \n"
-                 "|                                     |\n"
-                 "|           Optimizing tree           |\n"
-                 "|_____________________________________|\n");
     if(verify_keywords() != LANGUAGE_SUCCESS) {
         return EXIT_FAILURE;
     }
     //-----------------------------------------------------------------------//
     language_t ctx = {};
-    if(middleend_ctor(&ctx, argc, argv) != LANGUAGE_SUCCESS) {
+    language_error_t error_code = middleend_ctor(&ctx, argc, argv);
+    if(error_code == LANGUAGE_BUILD_CACHE_HIT) {
+        middleend_dtor(&ctx);
+        return EXIT_SUCCESS;
+    }
+    if(error_code != LANGUAGE_SUCCESS) {
         return main_exit_failure(&ctx);
     }
+    // Banner follows flags, so it goes to stderr when tree goes to stdout.
+    color_printf(MAGENTA_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 " _____________________________________ \n"
+                 "|                                     |\n"
+                 "|           Optimizing tree           |\n"
+                 "|_____________________________________|\n");
     color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully initialized context\n");
-    dump_tree(&ctx, "before");
+    // Stream tree is read by statements while it is optimized.
+    if(!ctx.tree_stream.is_reading) {
+        dump_tree(&ctx, "before");
+    }
     //-----------------------------------------------------------------------//
     if(optimize_tree(&ctx) != LANGUAGE_SUCCESS) {
         return main_exit_failure(&ctx);
     }
     color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully optimized tree\n");
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Folding visited " SZ_SP " nodes, simplification visited " SZ_SP " nodes\n",
+                 ctx.middleend_info.folding_visits,
+                 ctx.middleend_info.simplify_visits);
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Inlined " SZ_SP " calls\n", ctx.middleend_info.inlined_calls);
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Replaced " SZ_SP " tail calls by loops\n", ctx.middleend_info.tail_calls);
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Propagated " SZ_SP " constants\n", ctx.middleend_info.propagated_constants);
+    color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Eliminated " SZ_SP " dead statements and " SZ_SP " unreachable functions\n",
+                 ctx.middleend_info.eliminated_statements,
+                 ctx.middleend_info.eliminated_functions);
+    if(ctx.tree_format == TREE_FORMAT_DAG) {
+        color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Shared " SZ_SP " subtrees\n", ctx.middleend_info.shared_subtrees);
+    }
     dump_tree(&ctx, "after");
     //-----------------------------------------------------------------------//
     if(write_tree(&ctx) != LANGUAGE_SUCCESS) {
@@ -39,6 +68,7 @@ int main(int argc, const char *argv[]) {
     }
     color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully wrote tree\n");
+    build_cache_store(&ctx);
     //-----------------------------------------------------------------------//
     middleend_dtor(&ctx);
     return EXIT_SUCCESS;
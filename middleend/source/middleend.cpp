@@ -1,5 +1,7 @@
 #include <math.h>
 #include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
 
 //===========================================================================//
 
@@ -10,18 +12,71 @@
 #include "colors.h"
 #include "nodes_dsl.h"
 #include "custom_assert.h"
+#include "mapped_file.h"
+#include "tree_visitor.h"
+#include "build_cache.h"
+#include "tree_binary.h"
+#include "worklist.h"
+#include "constant_propagation.h"
+#include "dead_code.h"
+#include "inliner.h"
+#include "tail_recursion.h"
 
 //===========================================================================//
 
+struct optimizer_t {
+    worklist_t                       worklist;
+    propagation_t                    propagation;
+    elimination_t                    elimination;
+    inliner_t                        inliner;
+    tail_recursion_t                 tail;
+};
+
+//---------------------------------------------------------------------------//
+
+struct dag_folding_t {
+    worklist_t                      *worklist;
+    uint32_t                        *folded;
+    size_t                           capacity;
+    size_t                           shared;
+};
+
+//===========================================================================//
+
+static const size_t DagMinCapacity = 64;
+
+//===========================================================================//
+
+static language_error_t prepare_program     (language_t        *ctx,
+                                             optimizer_t       *optimizer);
+
+static language_error_t optimize_statements (language_t        *ctx,
+                                             optimizer_t       *optimizer);
+
+static language_error_t optimize_stream     (language_t        *ctx,
+                                             optimizer_t       *optimizer);
+
+static language_error_t optimize_dag        (language_t        *ctx,
+                                             optimizer_t       *optimizer);
+
+static language_error_t fold_shared         (language_t        *ctx,
+                                             visit_frame_t     *frame,
+                                             void              *data);
+
+static language_error_t fold_private        (language_t        *ctx,
+                                             visit_frame_t     *frame,
+                                             void              *data);
+
+static language_error_t dag_reserve         (language_t        *ctx,
+                                             dag_folding_t     *dag);
+
 static language_error_t constant_folding    (language_t        *ctx,
-                                             language_node_t   *node,
-                                             double            *result);
+                                             uint32_t          *node);
 
 static language_error_t simplify_neutrals   (language_t        *ctx,
-                                             language_node_t  **node);
+                                             uint32_t          *node);
 
-static language_error_t constant_folding_op (language_t        *ctx,
-                                             language_node_t   *node);
+static double           folding_value       (language_node_t   *node);
 
 static double           run_operation       (operation_t        opcode,
                                              double             left,
@@ -29,6 +84,10 @@ static double           run_operation       (operation_t        opcode,
 
 //===========================================================================//
 
+static const worklist_rule_t MiddleendRules[] = {constant_folding, simplify_neutrals};
+
+//===========================================================================//
+
 language_error_t middleend_ctor(language_t *ctx,
                                 int         argc,
                                 const char *argv[]) {
@@ -36,7 +95,8 @@ language_error_t middleend_ctor(language_t *ctx,
     _C_ASSERT(argv != NULL, return LANGUAGE_INPUT_NULL);
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(parse_flags(ctx, argc, argv));
-    _RETURN_IF_ERROR(read_tree(ctx));
+    _RETURN_IF_ERROR(build_cache_lookup(ctx));
+    _RETURN_IF_ERROR(read_tree_streaming(ctx));
     _RETURN_IF_ERROR(dump_ctor(ctx, "middleend"));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -47,28 +107,114 @@ language_error_t middleend_ctor(language_t *ctx,
 language_error_t optimize_tree(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
-    while(true) {
-        _RETURN_IF_ERROR(constant_folding(ctx, ctx->root, NULL));
-        _RETURN_IF_ERROR(simplify_neutrals(ctx, &ctx->root));
-
-        if(ctx->middleend_info.changes_counter == 0) {
-            break;
+    // Rules rewrite one node with already rewritten children, so the whole
+    // tree takes one sweep of the worklist instead of passes until nothing
+    // changes.
+    optimizer_t optimizer = {};
+    _RETURN_IF_ERROR(worklist_ctor(&optimizer.worklist,
+                                   MiddleendRules,
+                                   sizeof(MiddleendRules) / sizeof(MiddleendRules[0])));
+    _RETURN_IF_ERROR(propagation_ctor(&optimizer.propagation, &optimizer.worklist));
+    _RETURN_IF_ERROR(elimination_ctor(&optimizer.elimination));
+    _RETURN_IF_ERROR(inliner_ctor(&optimizer.inliner));
+    _RETURN_IF_ERROR(tail_recursion_ctor(&optimizer.tail));
+    language_error_t error_code = LANGUAGE_SUCCESS;
+    // Shared subtrees are found in whole tree, so stream is read first.
+    if(ctx->tree_format == TREE_FORMAT_DAG) {
+        uint32_t statement = NodeNone;
+        do {
+            error_code = read_tree_frame(ctx, &statement);
+        } while(statement != NodeNone && error_code == LANGUAGE_SUCCESS);
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = prepare_program(ctx, &optimizer);
+        }
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = optimize_dag(ctx, &optimizer);
         }
-        ctx->middleend_info.changes_counter = 0;
     }
-    //-----------------------------------------------------------------------//
+    // Callees have to be known before callers, so stream is not inlined.
+    // Tail calls are not replaced too, as new names would take indices of
+    // names from later frames, backend turns them into jumps anyway.
+    else if(ctx->tree_stream.is_reading) {
+        error_code = optimize_stream(ctx, &optimizer);
+    }
+    else {
+        error_code = prepare_program(ctx, &optimizer);
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = optimize_statements(ctx, &optimizer);
+        }
+    }
+    // Calls are known only in whole program, functions already written to
+    // stream output are kept.
+    bool is_written = ctx->tree_stream.is_reading && ctx->tree_format == TREE_FORMAT_STREAM;
+    if(error_code == LANGUAGE_SUCCESS && !is_written) {
+        error_code = eliminate_functions(ctx, &optimizer.elimination);
+    }
+    tail_recursion_dtor(&optimizer.tail       );
+    inliner_dtor       (&optimizer.inliner    );
+    elimination_dtor   (&optimizer.elimination);
+    propagation_dtor   (&optimizer.propagation);
+    worklist_dtor      (&optimizer.worklist   );
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t prepare_program(language_t *ctx, optimizer_t *optimizer) {
+    // Self tail calls are replaced by loops first, so such functions are
+    // not recursive for the inliner.
+    for(uint32_t statement = ctx->root;
+        statement != NodeNone;
+        statement = nodes_storage_get(ctx, statement)->right) {
+        _RETURN_IF_ERROR(eliminate_tail_calls(ctx, &optimizer->tail, &nodes_storage_get(ctx, statement)->left));
+    }
+    return inline_functions(ctx, &optimizer->inliner);
+}
+
+//===========================================================================//
+
+language_error_t optimize_statements(language_t *ctx, optimizer_t *optimizer) {
+    // Statements are taken one by one, so nodes of the worklist stay close.
+    for(uint32_t statement = ctx->root;
+        statement != NodeNone;
+        statement = nodes_storage_get(ctx, statement)->right) {
+        uint32_t *link = &nodes_storage_get(ctx, statement)->left;
+        _RETURN_IF_ERROR(propagate_constants(ctx, &optimizer->propagation, link));
+        _RETURN_IF_ERROR(eliminate_dead_code(ctx, &optimizer->elimination, link));
+    }
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
+language_error_t optimize_stream(language_t *ctx, optimizer_t *optimizer) {
+    // Rules never look out of a top level statement, so every statement
+    // is optimized when it comes and is written to stream output at once,
+    // while the writer of input is still making the later ones.
+    while(true) {
+        uint32_t statement = NodeNone;
+        _RETURN_IF_ERROR(read_tree_frame(ctx, &statement));
+        if(statement == NodeNone) {
+            return LANGUAGE_SUCCESS;
+        }
+        uint32_t *link = &nodes_storage_get(ctx, statement)->left;
+        _RETURN_IF_ERROR(propagate_constants(ctx, &optimizer->propagation, link));
+        _RETURN_IF_ERROR(eliminate_dead_code(ctx, &optimizer->elimination, link));
+        if(ctx->tree_format == TREE_FORMAT_STREAM) {
+            _RETURN_IF_ERROR(write_tree_frame(ctx, statement));
+        }
+    }
+}
+
+//===========================================================================//
+
 language_error_t middleend_dtor(language_t *ctx) {
     _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
     //-----------------------------------------------------------------------//
     _RETURN_IF_ERROR(nodes_storage_dtor(ctx));
     _RETURN_IF_ERROR(name_table_dtor(ctx));
     _RETURN_IF_ERROR(dump_dtor(ctx));
-    free(ctx->input);
+    _RETURN_IF_ERROR(input_close(ctx));
     memset(ctx, 0, sizeof(*ctx));
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -76,64 +222,116 @@ language_error_t middleend_dtor(language_t *ctx) {
 
 //===========================================================================//
 
-language_error_t constant_folding(language_t      *ctx,
-                                  language_node_t *node,
-                                  double          *result) {
-    _C_ASSERT(ctx != NULL, return LANGUAGE_CTX_NULL);
-    //-----------------------------------------------------------------------//
-    if(node == NULL) {
-        if(result != NULL) {
-            *result = 0;
-        }
-        return LANGUAGE_SUCCESS;
-    }
-    //-----------------------------------------------------------------------//
-    switch(node->type) {
-        case NODE_TYPE_IDENTIFIER: {
-            _RETURN_IF_ERROR(constant_folding(ctx, node->left, NULL));
-            _RETURN_IF_ERROR(constant_folding(ctx, node->right, NULL))
-            break;
+language_error_t optimize_dag(language_t *ctx, optimizer_t *optimizer) {
+    // Subtrees shared by dag input are folded once: folded version of every
+    // reached node is kept by its index, so the next parent takes it and
+    // does not walk the subtree again. Shared node is pure, so folding it
+    // in place is right for all its parents. Propagation goes after it and
+    // copies only shared subtrees which are still not numbers.
+    dag_folding_t    dag        = {};
+    language_error_t error_code = LANGUAGE_SUCCESS;
+    dag.worklist = &optimizer->worklist;
+    tree_visitor_t   folding    = {};
+    folding.pre  = fold_shared;
+    folding.post = fold_private;
+    folding.data = &dag;
+    for(uint32_t statement = ctx->root;
+        statement != NodeNone && error_code == LANGUAGE_SUCCESS;
+        statement = nodes_storage_get(ctx, statement)->right) {
+        error_code = tree_visit(ctx, &folding, &nodes_storage_get(ctx, statement)->left);
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = propagate_constants(ctx, &optimizer->propagation, &nodes_storage_get(ctx, statement)->left);
         }
-        case NODE_TYPE_NUMBER: {
-            *result = node->value.number;
-            break;
-        }
-        case NODE_TYPE_OPERATION: {
-            _RETURN_IF_ERROR(constant_folding_op(ctx, node));
-            break;
-        }
-        default: {
-            print_error("Unknown node type.\n");
-            return LANGUAGE_UNKNOWN_NODE_TYPE;
+        if(error_code == LANGUAGE_SUCCESS) {
+            error_code = eliminate_dead_code(ctx, &optimizer->elimination, &nodes_storage_get(ctx, statement)->left);
         }
     }
     //-----------------------------------------------------------------------//
+    ctx->middleend_info.shared_subtrees = dag.shared;
+    tree_visitor_dtor(&folding);
+    free(dag.folded);
+    return error_code;
+}
+
+//===========================================================================//
+
+language_error_t fold_shared(language_t    *ctx,
+                             visit_frame_t *frame,
+                             void          *data) {
+    // Node reached second time is replaced by its folded version and is
+    // not walked, first time its index is kept for post hook.
+    dag_folding_t *dag = (dag_folding_t *)data;
+    _RETURN_IF_ERROR(dag_reserve(ctx, dag));
+    uint32_t folded = dag->folded[*frame->link];
+    if(folded == NodeNone) {
+        frame->state[0].number = *frame->link;
+        return LANGUAGE_SUCCESS;
+    }
+    *frame->link = folded;
+    visit_children(frame, NULL, NULL);
+    frame->need_post = false;
+    dag->shared++;
     return LANGUAGE_SUCCESS;
 }
 
 //===========================================================================//
 
-language_error_t constant_folding_op(language_t      *ctx,
-                                     language_node_t *node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    double val_left  = NAN;
-    double val_right = NAN;
-    _RETURN_IF_ERROR(constant_folding(ctx, node->left, &val_left));
-    _RETURN_IF_ERROR(constant_folding(ctx, node->right, &val_right));
+language_error_t fold_private(language_t    *ctx,
+                              visit_frame_t *frame,
+                              void          *data) {
+    // Node is rewritten after its children.
+    dag_folding_t *dag = (dag_folding_t *)data;
+    _RETURN_IF_ERROR(worklist_rewrite(ctx, dag->worklist, frame->link));
+    dag->folded[frame->state[0].number] = *frame->link;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t dag_reserve(language_t *ctx, dag_folding_t *dag) {
+    // Nodes made by rewrites are never reached again, but storage grows,
+    // so array follows it. New nodes are not folded yet.
+    if(ctx->nodes.size <= dag->capacity) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t new_capacity = dag->capacity == 0 ? DagMinCapacity : dag->capacity;
+    while(new_capacity < ctx->nodes.size) {
+        new_capacity *= 2;
+    }
+    uint32_t *new_folded = (uint32_t *)realloc(dag->folded, new_capacity * sizeof(new_folded[0]));
+    if(new_folded == NULL) {
+        print_error("Error while reallocating folded nodes.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    memset(new_folded + dag->capacity, 0xFF, (new_capacity - dag->capacity) * sizeof(new_folded[0]));
+    dag->folded   = new_folded;
+    dag->capacity = new_capacity;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t constant_folding(language_t *ctx, uint32_t *node) {
+    _C_ASSERT(ctx   != NULL    , return LANGUAGE_CTX_NULL );
+    _C_ASSERT(node  != NULL    , return LANGUAGE_NODE_NULL);
+    _C_ASSERT(*node != NodeNone, return LANGUAGE_NODE_NULL);
     //-----------------------------------------------------------------------//
+    // Operation is folded if its children are numbers.
+    ctx->middleend_info.folding_visits++;
+    language_node_t *root = nodes_storage_get(ctx, *node);
+    if(node_type(root) != NODE_TYPE_OPERATION) {
+        return LANGUAGE_SUCCESS;
+    }
+    double val_left  = folding_value(node_left (ctx, root));
+    double val_right = folding_value(node_right(ctx, root));
     if(isnan(val_left) || isnan(val_right)) {
         return LANGUAGE_SUCCESS;
     }
-    double value = run_operation(node->value.opcode, val_left, val_right);
+    double value = run_operation(node_opcode(root), val_left, val_right);
     if(isinf(value)) {
         return LANGUAGE_SUCCESS;
     }
-    _RETURN_IF_ERROR(set_val(node,
-                             NODE_TYPE_NUMBER,
-                             NUMBER(value),
-                             NULL, NULL));
+    _RETURN_IF_ERROR(set_val(root, NODE_TYPE_NUMBER, NUMBER(value), NodeNone, NodeNone));
     ctx->middleend_info.changes_counter++;
     //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
@@ -141,24 +339,32 @@ language_error_t constant_folding_op(language_t      *ctx,
 
 //===========================================================================//
 
-language_error_t simplify_neutrals(language_t       *ctx,
-                                   language_node_t **node) {
-    _C_ASSERT(ctx  != NULL, return LANGUAGE_CTX_NULL );
-    _C_ASSERT(node != NULL, return LANGUAGE_NODE_NULL);
-    //-----------------------------------------------------------------------//
-    if(*node == NULL) {
-        return LANGUAGE_SUCCESS;
+double folding_value(language_node_t *node) {
+    if(node == NULL) {
+        return 0;
+    }
+    if(node_type(node) == NODE_TYPE_NUMBER) {
+        return node_number(node);
     }
-    if((*node)->type == NODE_TYPE_OPERATION) {
-        operation_t opcode = (*node)->value.opcode;
+    return NAN;
+}
+
+//===========================================================================//
+
+language_error_t simplify_neutrals(language_t *ctx, uint32_t *node) {
+    _C_ASSERT(ctx   != NULL    , return LANGUAGE_CTX_NULL );
+    _C_ASSERT(node  != NULL    , return LANGUAGE_NODE_NULL);
+    _C_ASSERT(*node != NodeNone, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    ctx->middleend_info.simplify_visits++;
+    language_node_t *root = nodes_storage_get(ctx, *node);
+    if(node_type(root) == NODE_TYPE_OPERATION) {
+        operation_t opcode = node_opcode(root);
         if(KeyWords[opcode].simplifier != NULL) {
             _RETURN_IF_ERROR(KeyWords[opcode].simplifier(ctx, node));
         }
     }
     //-----------------------------------------------------------------------//
-    _RETURN_IF_ERROR(simplify_neutrals(ctx, &(*node)->left));
-    _RETURN_IF_ERROR(simplify_neutrals(ctx, &(*node)->right));
-    //-----------------------------------------------------------------------//
     return LANGUAGE_SUCCESS;
 }
 
@@ -194,9 +400,9 @@ double run_operation(operation_t opcode, double left, double right) {
     }
     if(opcode == OPERATION_SMALLER) {
         if(left < right) {
-            return 0;
+            return 1;
         }
-        return 1;
+        return 0;
     }
 
     return INFINITY;
@@ -0,0 +1,83 @@
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "middleend_utils.h"
+#include "name_table.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+language_error_t add_node(language_t *ctx,
+                          node_type_t type,
+                          value_t     value,
+                          uint32_t    left,
+                          uint32_t    right,
+                          uint32_t   *output) {
+    _RETURN_IF_ERROR(nodes_storage_add(ctx, type, value, NULL, 0, output));
+    language_node_t *node = nodes_storage_get(ctx, *output);
+    node->left  = left;
+    node->right = right;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t add_assignment(language_t *ctx,
+                                size_t      identifier,
+                                uint32_t    value,
+                                bool        is_declaration,
+                                uint32_t   *output) {
+    // Assignment is made as a statement of chain.
+    uint32_t node = NodeNone;
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_IDENTIFIER, IDENT(identifier), NodeNone, NodeNone, &node));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_ASSIGNMENT), node, value, &node));
+    if(is_declaration) {
+        _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_NEW_VAR), node, NodeNone, &node));
+    }
+    return add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_STATEMENT), node, NodeNone, output);
+}
+
+//===========================================================================//
+
+language_error_t fresh_variable(language_t *ctx,
+                                size_t      function,
+                                name_t      name,
+                                size_t     *output) {
+    // Variable made for a function is named function_name.
+    identifier_t *ident  = identifier_of(ctx, function);
+    name_t        prefix = {.length = ident->length, .name = ident->name};
+    return name_table_add_fresh(ctx, prefix, name, output, IDENTIFIER_VARIABLE);
+}
+
+//===========================================================================//
+
+language_error_t guard_rest(language_t       *ctx,
+                            size_t            flag,
+                            bool              is_inverted,
+                            language_node_t  *chain,
+                            uint32_t        **link) {
+    // Rest of the chain is put into if(flag) or if(1 - flag), link is moved
+    // to its body, so the rest is walked next.
+    if(chain->right == NodeNone) {
+        *link = &chain->right;
+        return LANGUAGE_SUCCESS;
+    }
+    uint32_t condition = NodeNone;
+    uint32_t guard     = NodeNone;
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_IDENTIFIER, IDENT(flag), NodeNone, NodeNone, &condition));
+    if(is_inverted) {
+        uint32_t one = NodeNone;
+        _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_NUMBER, NUMBER(1), NodeNone, NodeNone, &one));
+        _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_SUB), one, condition, &condition));
+    }
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_IF), condition, chain->right, &guard));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_STATEMENT), guard, NodeNone, &chain->right));
+    *link = &nodes_storage_get(ctx, guard)->right;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
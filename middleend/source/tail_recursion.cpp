@@ -0,0 +1,311 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "tail_recursion.h"
+#include "middleend_utils.h"
+#include "tree_visitor.h"
+#include "lang_dump.h"
+#include "nodes_dsl.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static language_error_t collect_parameters   (language_t         *ctx,
+                                              tail_recursion_t   *tail,
+                                              language_node_t    *function);
+
+static language_error_t rewrite_chain        (language_t         *ctx,
+                                              tail_recursion_t   *tail,
+                                              uint32_t           *link,
+                                              bool               *is_rewritten);
+
+static language_error_t check_call           (language_t         *ctx,
+                                              tail_recursion_t   *tail,
+                                              language_node_t    *node,
+                                              bool               *is_tail);
+
+static language_error_t replace_call         (language_t         *ctx,
+                                              tail_recursion_t   *tail,
+                                              uint32_t           *link);
+
+static language_error_t make_loop            (language_t         *ctx,
+                                              tail_recursion_t   *tail,
+                                              uint32_t           *link);
+
+static language_error_t read_argument        (language_t         *ctx,
+                                              tail_recursion_t   *tail,
+                                              uint32_t           *link);
+
+static language_error_t read_node            (language_t         *ctx,
+                                              visit_frame_t      *frame,
+                                              void               *data);
+
+//===========================================================================//
+
+language_error_t tail_recursion_ctor(tail_recursion_t *tail) {
+    _C_ASSERT(tail != NULL, return LANGUAGE_NULL_OUTPUT);
+    //-----------------------------------------------------------------------//
+    *tail            = {};
+    tail->reads.pre  = read_node;
+    tail->reads.data = tail;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t eliminate_tail_calls(language_t       *ctx,
+                                      tail_recursion_t *tail,
+                                      uint32_t         *statement) {
+    _C_ASSERT(ctx        != NULL    , return LANGUAGE_CTX_NULL );
+    _C_ASSERT(tail       != NULL    , return LANGUAGE_NODE_NULL);
+    _C_ASSERT(statement  != NULL    , return LANGUAGE_NODE_NULL);
+    _C_ASSERT(*statement != NodeNone, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    language_node_t *node = nodes_storage_get(ctx, *statement);
+    if(!is_node_oper_eq(node, OPERATION_NEW_FUNC)) {
+        return LANGUAGE_SUCCESS;
+    }
+    language_node_t *ident = node_left(ctx, node);
+    tail->function = node_identifier(ident);
+    tail->again    = PoisonIndex;
+    _RETURN_IF_ERROR(collect_parameters(ctx, tail, node));
+    bool is_rewritten = false;
+    _RETURN_IF_ERROR(rewrite_chain(ctx, tail, &ident->right, &is_rewritten));
+    if(!is_rewritten) {
+        return LANGUAGE_SUCCESS;
+    }
+    return make_loop(ctx, tail, &ident->right);
+}
+
+//===========================================================================//
+
+language_error_t tail_recursion_dtor(tail_recursion_t *tail) {
+    _C_ASSERT(tail != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    free(tail->parameters );
+    free(tail->is_assigned);
+    tree_visitor_dtor(&tail->reads);
+    *tail = {};
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t collect_parameters(language_t       *ctx,
+                                    tail_recursion_t *tail,
+                                    language_node_t  *function) {
+    // Marks are cleared after every call, so they are kept between
+    // functions and only grown with the name table.
+    _RETURN_IF_ERROR(reserve_elements((void **)&tail->is_assigned,
+                                      &tail->assigned_capacity,
+                                      ctx->name_table.size,
+                                      sizeof(tail->is_assigned[0])));
+    tail->parameters_number = 0;
+    for(uint32_t parameter = node_left(ctx, function)->left;
+        parameter != NodeNone;
+        parameter = nodes_storage_get(ctx, parameter)->right) {
+        language_node_t *variable = node_left(ctx, node_left(ctx, nodes_storage_get(ctx, parameter)));
+        _RETURN_IF_ERROR(reserve_elements((void **)&tail->parameters,
+                                          &tail->parameters_capacity,
+                                          tail->parameters_number + 1,
+                                          sizeof(tail->parameters[0])));
+        tail->parameters[tail->parameters_number++] = node_identifier(variable);
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t rewrite_chain(language_t       *ctx,
+                               tail_recursion_t *tail,
+                               uint32_t         *link,
+                               bool             *is_rewritten) {
+    // Statements after return are never run, so chain ends on any return.
+    *is_rewritten = false;
+    while(*link != NodeNone) {
+        language_node_t *chain = nodes_storage_get(ctx, *link);
+        if(!is_node_oper_eq(chain, OPERATION_STATEMENT)) {
+            return LANGUAGE_SUCCESS;
+        }
+        if(chain->left == NodeNone) {
+            link = &chain->right;
+            continue;
+        }
+        language_node_t *node = nodes_storage_get(ctx, chain->left);
+        if(is_node_oper_eq(node, OPERATION_RETURN)) {
+            bool is_tail = false;
+            _RETURN_IF_ERROR(check_call(ctx, tail, node, &is_tail));
+            if(!is_tail) {
+                return LANGUAGE_SUCCESS;
+            }
+            *is_rewritten = true;
+            return replace_call(ctx, tail, link);
+        }
+        //-------------------------------------------------------------------//
+        bool is_branch = false;
+        if(is_node_oper_eq(node, OPERATION_IF)) {
+            _RETURN_IF_ERROR(rewrite_chain(ctx, tail, &node->right, &is_branch));
+        }
+        if(is_branch) {
+            *is_rewritten = true;
+            _RETURN_IF_ERROR(guard_rest(ctx, tail->again, true, chain, &link));
+            continue;
+        }
+        link = &chain->right;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t check_call(language_t       *ctx,
+                            tail_recursion_t *tail,
+                            language_node_t  *node,
+                            bool             *is_tail) {
+    // Arguments are assigned in the order of parameters, but backends run
+    // them in different orders, so they have to commute.
+    *is_tail = false;
+    language_node_t *call = node_left(ctx, node);
+    if(call == NULL || !is_node_oper_eq(call, OPERATION_CALL) ||
+       node_identifier(node_left(ctx, call)) != tail->function) {
+        return LANGUAGE_SUCCESS;
+    }
+    bool   has_call      = false;
+    bool   reads_globals = false;
+    size_t arguments     = 0;
+    for(uint32_t argument = node_left(ctx, call)->left;
+        argument != NodeNone;
+        argument = nodes_storage_get(ctx, argument)->right) {
+        _RETURN_IF_ERROR(read_argument(ctx, tail, &nodes_storage_get(ctx, argument)->left));
+        if((tail->has_call      && (has_call || reads_globals)) ||
+           (tail->reads_globals &&  has_call)) {
+            return LANGUAGE_SUCCESS;
+        }
+        has_call      |= tail->has_call;
+        reads_globals |= tail->reads_globals;
+        arguments++;
+    }
+    *is_tail = arguments == tail->parameters_number;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t replace_call(language_t       *ctx,
+                              tail_recursion_t *tail,
+                              uint32_t         *link) {
+    // return f(a, b) becomes
+    // var f_a = a; a = f_a; b = b_value; f_again = 1;
+    // temporary is taken only by argument which reads parameter assigned
+    // before it, argument equal to its parameter is not assigned.
+    if(tail->again == PoisonIndex) {
+        _RETURN_IF_ERROR(fresh_variable(ctx, tail->function, _NAME("again"), &tail->again));
+    }
+    language_node_t *call        = node_left(ctx, nodes_storage_get(ctx, nodes_storage_get(ctx, *link)->left));
+    uint32_t         temporaries = NodeNone;
+    uint32_t        *temporary   = &temporaries;
+    uint32_t         assignments = NodeNone;
+    uint32_t        *assignment  = &assignments;
+    size_t           parameter   = 0;
+    for(uint32_t argument = node_left(ctx, call)->left;
+        argument != NodeNone;
+        argument = nodes_storage_get(ctx, argument)->right, parameter++) {
+        uint32_t         value    = nodes_storage_get(ctx, argument)->left;
+        language_node_t *expr     = nodes_storage_get(ctx, value);
+        size_t           variable = tail->parameters[parameter];
+        if(is_ident_type(ctx, expr, IDENTIFIER_VARIABLE) && node_identifier(expr) == variable) {
+            continue;
+        }
+        _RETURN_IF_ERROR(read_argument(ctx, tail, &value));
+        if(tail->reads_assigned) {
+            identifier_t *ident = identifier_of(ctx, variable);
+            name_t        name  = {.length = ident->length, .name = ident->name};
+            size_t        fresh = 0;
+            _RETURN_IF_ERROR(fresh_variable(ctx, tail->function, name, &fresh));
+            _RETURN_IF_ERROR(add_assignment(ctx, fresh, value, true, temporary));
+            temporary = &nodes_storage_get(ctx, *temporary)->right;
+            _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_IDENTIFIER, IDENT(fresh), NodeNone, NodeNone, &value));
+        }
+        _RETURN_IF_ERROR(add_assignment(ctx, variable, value, false, assignment));
+        assignment = &nodes_storage_get(ctx, *assignment)->right;
+        tail->is_assigned[variable] = true;
+    }
+    for(size_t elem = 0; elem < tail->parameters_number; elem++) {
+        tail->is_assigned[tail->parameters[elem]] = false;
+    }
+    //-----------------------------------------------------------------------//
+    uint32_t one = NodeNone;
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_NUMBER, NUMBER(1), NodeNone, NodeNone, &one));
+    _RETURN_IF_ERROR(add_assignment(ctx, tail->again, one, false, assignment));
+    *temporary = assignments;
+    *link      = temporaries;
+    ctx->middleend_info.tail_calls++;
+    identifier_t *function = identifier_of(ctx, tail->function);
+    return dump_message(ctx,
+                        "Replaced tail call of '%.*s' by loop",
+                        (int)function->length,
+                        function->name);
+}
+
+//===========================================================================//
+
+language_error_t make_loop(language_t       *ctx,
+                           tail_recursion_t *tail,
+                           uint32_t         *link) {
+    // Body B becomes var again = 1; while(again) {again = 0; B}
+    uint32_t number = NodeNone;
+    uint32_t reset  = NodeNone;
+    uint32_t flag   = NodeNone;
+    uint32_t loop   = NodeNone;
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_NUMBER, NUMBER(0), NodeNone, NodeNone, &number));
+    _RETURN_IF_ERROR(add_assignment(ctx, tail->again, number, false, &reset));
+    nodes_storage_get(ctx, reset)->right = *link;
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_IDENTIFIER, IDENT(tail->again), NodeNone, NodeNone, &flag));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_WHILE), flag, reset, &loop));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_OPERATION, OPCODE(OPERATION_STATEMENT), loop, NodeNone, &loop));
+    _RETURN_IF_ERROR(add_node(ctx, NODE_TYPE_NUMBER, NUMBER(1), NodeNone, NodeNone, &number));
+    _RETURN_IF_ERROR(add_assignment(ctx, tail->again, number, true, link));
+    nodes_storage_get(ctx, *link)->right = loop;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t read_argument(language_t       *ctx,
+                               tail_recursion_t *tail,
+                               uint32_t         *link) {
+    tail->has_call       = false;
+    tail->reads_globals  = false;
+    tail->reads_assigned = false;
+    return tree_visit(ctx, &tail->reads, link);
+}
+
+//===========================================================================//
+
+language_error_t read_node(language_t    *ctx,
+                           visit_frame_t *frame,
+                           void          *data) {
+    // Temporaries are added after the marks are grown, they are never
+    // parameters, so names out of the marks are not assigned.
+    tail_recursion_t *tail = (tail_recursion_t *)data;
+    language_node_t  *node = nodes_storage_get(ctx, *frame->link);
+    if(is_node_oper_eq(node, OPERATION_CALL)) {
+        tail->has_call = true;
+    }
+    if(is_global_variable(ctx, node)) {
+        tail->reads_globals = true;
+    }
+    else if(is_ident_type(ctx, node, IDENTIFIER_VARIABLE) &&
+            node_identifier(node) < tail->assigned_capacity &&
+            tail->is_assigned[node_identifier(node)]) {
+        tail->reads_assigned = true;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
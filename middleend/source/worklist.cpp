@@ -0,0 +1,200 @@
+#include <stdlib.h>
+#include <string.h>
+
+//===========================================================================//
+
+#include "language.h"
+#include "worklist.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//===========================================================================//
+
+static const size_t WorklistDefaultCapacity = 1024;
+
+//===========================================================================//
+
+static language_error_t worklist_reserve (language_t            *ctx,
+                                          worklist_t            *worklist);
+
+static language_error_t worklist_push    (worklist_t            *worklist,
+                                          uint32_t               node,
+                                          uint32_t               parent);
+
+static uint32_t        *worklist_link    (language_t            *ctx,
+                                          worklist_t            *worklist,
+                                          uint32_t              *root,
+                                          uint32_t               node);
+
+//===========================================================================//
+
+language_error_t worklist_ctor(worklist_t            *worklist,
+                               const worklist_rule_t *rules,
+                               size_t                 rules_number) {
+    _C_ASSERT(worklist != NULL, return LANGUAGE_NULL_OUTPUT);
+    _C_ASSERT(rules    != NULL, return LANGUAGE_INPUT_NULL );
+    //-----------------------------------------------------------------------//
+    *worklist              = {};
+    worklist->rules        = rules;
+    worklist->rules_number = rules_number;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t worklist_run(language_t *ctx,
+                              worklist_t *worklist,
+                              uint32_t   *root) {
+    _C_ASSERT(ctx      != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(worklist != NULL, return LANGUAGE_NODE_NULL);
+    _C_ASSERT(root     != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    if(*root == NodeNone) {
+        return LANGUAGE_SUCCESS;
+    }
+    _RETURN_IF_ERROR(worklist_reserve(ctx, worklist));
+    // Worklist itself is the queue of breadth first walk, so every parent
+    // is queued before its children and no other stack is needed.
+    worklist->size = 0;
+    _RETURN_IF_ERROR(worklist_push(worklist, *root, NodeNone));
+    for(size_t elem = 0; elem < worklist->size; elem++) {
+        uint32_t         index = worklist->nodes[elem];
+        language_node_t *node  = nodes_storage_get(ctx, index);
+        if(node->left  != NodeNone) {
+            _RETURN_IF_ERROR(worklist_push(worklist, node->left , index));
+        }
+        if(node->right != NodeNone) {
+            _RETURN_IF_ERROR(worklist_push(worklist, node->right, index));
+        }
+    }
+    //-----------------------------------------------------------------------//
+    while(worklist->size != 0) {
+        uint32_t index = worklist->nodes[--worklist->size];
+        worklist->queued[index] = false;
+        uint32_t *link   = worklist_link(ctx, worklist, root, index);
+        uint32_t  parent = worklist->parents[index];
+        size_t    before = ctx->middleend_info.changes_counter;
+        _RETURN_IF_ERROR(worklist_rewrite(ctx, worklist, link));
+        if(ctx->middleend_info.changes_counter == before && *link == index) {
+            continue;
+        }
+        // Node is at its fixpoint, so only the parent can change now.
+        worklist->parents[*link] = parent;
+        if(parent != NodeNone && !worklist->queued[parent]) {
+            _RETURN_IF_ERROR(worklist_push(worklist, parent, worklist->parents[parent]));
+        }
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t worklist_rewrite(language_t *ctx,
+                                  worklist_t *worklist,
+                                  uint32_t   *node) {
+    _C_ASSERT(ctx      != NULL, return LANGUAGE_CTX_NULL );
+    _C_ASSERT(worklist != NULL, return LANGUAGE_NODE_NULL);
+    _C_ASSERT(node     != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    // Rules are tried again from the first one after every change.
+    size_t rule = 0;
+    while(rule < worklist->rules_number) {
+        uint32_t index  = *node;
+        size_t   before = ctx->middleend_info.changes_counter;
+        _RETURN_IF_ERROR(worklist->rules[rule](ctx, node));
+        if(ctx->middleend_info.changes_counter != before || *node != index) {
+            rule = 0;
+            continue;
+        }
+        rule++;
+    }
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t worklist_dtor(worklist_t *worklist) {
+    _C_ASSERT(worklist != NULL, return LANGUAGE_NODE_NULL);
+    //-----------------------------------------------------------------------//
+    free(worklist->nodes  );
+    free(worklist->parents);
+    free(worklist->queued );
+    *worklist = {};
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t worklist_reserve(language_t *ctx, worklist_t *worklist) {
+    // Links are indexed by node, storage may grow between runs.
+    size_t size = ctx->nodes.size;
+    if(size <= worklist->links_capacity) {
+        return LANGUAGE_SUCCESS;
+    }
+    size_t new_capacity = worklist->links_capacity == 0 ? WorklistDefaultCapacity :
+                                                          worklist->links_capacity;
+    while(new_capacity < size) {
+        new_capacity *= 2;
+    }
+    uint32_t *parents = (uint32_t *)realloc(worklist->parents,
+                                            new_capacity * sizeof(parents[0]));
+    if(parents == NULL) {
+        print_error("Error while reallocating worklist parents.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    worklist->parents = parents;
+    bool *queued = (bool *)realloc(worklist->queued,
+                                   new_capacity * sizeof(queued[0]));
+    if(queued == NULL) {
+        print_error("Error while reallocating worklist flags.\n");
+        return LANGUAGE_MEMORY_ERROR;
+    }
+    memset(queued + worklist->links_capacity,
+           0,
+           (new_capacity - worklist->links_capacity) * sizeof(queued[0]));
+    worklist->queued         = queued;
+    worklist->links_capacity = new_capacity;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+language_error_t worklist_push(worklist_t *worklist,
+                               uint32_t    node,
+                               uint32_t    parent) {
+    if(worklist->size == worklist->capacity) {
+        size_t    new_capacity = worklist->capacity == 0 ? WorklistDefaultCapacity :
+                                                           worklist->capacity * 2;
+        uint32_t *new_nodes    = (uint32_t *)realloc(worklist->nodes,
+                                                     new_capacity * sizeof(new_nodes[0]));
+        if(new_nodes == NULL) {
+            print_error("Error while reallocating worklist.\n");
+            return LANGUAGE_MEMORY_ERROR;
+        }
+        worklist->nodes    = new_nodes;
+        worklist->capacity = new_capacity;
+    }
+    worklist->nodes[worklist->size++] = node;
+    worklist->queued [node]           = true;
+    worklist->parents[node]           = parent;
+    return LANGUAGE_SUCCESS;
+}
+
+//===========================================================================//
+
+uint32_t *worklist_link(language_t *ctx,
+                        worklist_t *worklist,
+                        uint32_t   *root,
+                        uint32_t    node) {
+    uint32_t parent = worklist->parents[node];
+    if(parent == NodeNone) {
+        return root;
+    }
+    language_node_t *parent_node = nodes_storage_get(ctx, parent);
+    if(parent_node->left == node) {
+        return &parent_node->left;
+    }
+    return &parent_node->right;
+}
+
+//===========================================================================//